@@ -25,4 +25,7 @@ TextureCompiler color -cmp -mipmap ../../.. level6/carpet_c.png
 TextureCompiler normal -cmp -mipmap ../../.. level6/carpet_n.png
 MeshCompiler -gen_ts -cmp_pos -cmp_vec -cmp_uvs ../../.. level6/level6.dae
 
+REM Cache pack
+PackCompiler -cmp ../../..
+
 pause
\ No newline at end of file
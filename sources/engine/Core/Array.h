@@ -6,18 +6,66 @@
 
 #include "Core/MemoryManager.h"
 #include "Core/MemoryUtils.h"
+#include "Core/TypeTraits.h"
 
 #include "Core/Assert.h"
 
 namespace Core
 {
+    //====================================================================================
+    // Growth policies
+    //====================================================================================
+
+    // Compute the new capacity of an array which needs room for required elements.
+
+    struct DoubleGrowth
+    {
+        static SizeT Compute( SizeT capacity, SizeT required );
+    };
+
+    struct HalfGrowth       // x1.5, less memory slack
+    {
+        static SizeT Compute( SizeT capacity, SizeT required );
+    };
+
+    template< SizeT N >
+    struct LinearGrowth     // N more elements each time
+    {
+        static SizeT Compute( SizeT capacity, SizeT required );
+    };
+
+    //==================================================================== Growth policies
+
+    inline SizeT DoubleGrowth::Compute( SizeT capacity, SizeT required )
+    {
+        const SizeT c = ( capacity == 0 ) ? 4 : 2 * capacity;
+        return ( c < required ) ? required : c;
+    }
+
+    inline SizeT HalfGrowth::Compute( SizeT capacity, SizeT required )
+    {
+        const SizeT c = ( capacity < 4 ) ? 4 : capacity + capacity / 2;
+        return ( c < required ) ? required : c;
+    }
+
+    template< SizeT N >
+    SizeT LinearGrowth< N >::Compute( SizeT capacity, SizeT required )
+    {
+        const SizeT c = capacity + N;
+        return ( c < required ) ? required : c;
+    }
+
+    //==================================================================== Growth policies
+
     //====================================================================================
     // Array
     //====================================================================================
 
-    // TODO : improve POD managment
+    // Trivially relocatable elements (see TypeTraits.h) are moved with the allocator
+    // Reallocate, which can extend the block in place. Other elements are move
+    // constructed into the new block.
 
-    template < typename T, typename Alloc = DefaultAllocator >
+    template < typename T, typename Alloc = DefaultAllocator, typename Growth = DoubleGrowth >
     class Array : public IArray< T >
     {
     public:
@@ -40,6 +88,13 @@ namespace Core
 
         Array&          operator=( const Array& other );
 
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+        Array( Array&& other );
+        Array&          operator=( Array&& other );
+#endif
+
+        void            Swap( Array& other );
+
         ConstPointer    ConstPtr() const;
         Pointer         Ptr();
 
@@ -65,6 +120,8 @@ namespace Core
         SizeType        Size() const;
         SizeType        Capacity() const;
 
+        // Reserve( 0 ) clears the array and releases its memory, a smaller capacity
+        // shrinks the array storage down to its size.
         void            Reserve( SizeType capacity );
         void            Resize( SizeType size, ConstReference value = ValueType() );
 
@@ -72,14 +129,36 @@ namespace Core
         void            PushBack( ConstPointer p, SizeType n );
         void            PushBack( ConstIterator begin, ConstIterator end );
 
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+        void            PushBack( ValueType&& value );
+#endif
+
+        // Construct the element in place from up to 4 arguments
+        Reference       EmplaceBack();
+        template< typename A1 >
+        Reference       EmplaceBack( CARBON_FWD_REF( A1 ) a1 );
+        template< typename A1, typename A2 >
+        Reference       EmplaceBack( CARBON_FWD_REF( A1 ) a1, CARBON_FWD_REF( A2 ) a2 );
+        template< typename A1, typename A2, typename A3 >
+        Reference       EmplaceBack( CARBON_FWD_REF( A1 ) a1, CARBON_FWD_REF( A2 ) a2, CARBON_FWD_REF( A3 ) a3 );
+        template< typename A1, typename A2, typename A3, typename A4 >
+        Reference       EmplaceBack( CARBON_FWD_REF( A1 ) a1, CARBON_FWD_REF( A2 ) a2, CARBON_FWD_REF( A3 ) a3, CARBON_FWD_REF( A4 ) a4 );
+
+        Iterator        Insert( Iterator pos, ConstReference value );
+        Iterator        Erase( Iterator pos );
+        Iterator        Erase( Iterator begin, Iterator end );
+        void            EraseUnordered( Iterator pos );     // O(1), the last element takes its place
+
         void            PopBack();
         void            Clear();
 
     protected:
         Pointer         DoAllocate( SizeType capacity );
         void            DoFree( Pointer memory );
-        SizeType        ComputeNewCapacity() const;
+        SizeType        ComputeNewCapacity( SizeType required ) const;
         void            IncreaseCapacity( SizeType capacity );
+        void            Relocate( SizeType capacity );
+        Pointer         PrepareEmplace();
 
     protected:
         ValueType *	    m_begin;
@@ -87,16 +166,19 @@ namespace Core
         ValueType *	    m_capacity;
     };
 
+    template< typename T, typename Alloc, typename Growth >
+    struct IsTriviallyRelocatable< Array< T, Alloc, Growth > > : public TrueType { };
+
     //============================================================================== Array
 
-    template< typename T, typename Alloc >
-    Array< T, Alloc >::Array()
+    template< typename T, typename Alloc, typename Growth >
+    Array< T, Alloc, Growth >::Array()
     : m_begin( 0 ), m_end( 0 ), m_capacity( 0 )
     {
     }
 
-    template< typename T, typename Alloc >
-    Array< T, Alloc >::Array( SizeType size, ConstReference value = ValueType() )
+    template< typename T, typename Alloc, typename Growth >
+    Array< T, Alloc, Growth >::Array( SizeType size, ConstReference value )
     {
         if ( size > 0 )
         {
@@ -110,8 +192,8 @@ namespace Core
         }
     }
 
-    template< typename T, typename Alloc >
-    Array< T, Alloc >::Array( ConstIterator v, SizeType n )
+    template< typename T, typename Alloc, typename Growth >
+    Array< T, Alloc, Growth >::Array( ConstIterator v, SizeType n )
     {
         if ( n > 0 )
         {
@@ -125,8 +207,8 @@ namespace Core
         }
     }
 
-    template< typename T, typename Alloc >
-    Array< T, Alloc >::Array( ConstIterator begin, ConstIterator end )
+    template< typename T, typename Alloc, typename Growth >
+    Array< T, Alloc, Growth >::Array( ConstIterator begin, ConstIterator end )
     {
         const SizeType size = static_cast< SizeType >( end - begin );
         if ( size > 0 )
@@ -141,8 +223,8 @@ namespace Core
         }
     }
 
-    template< typename T, typename Alloc >
-    Array< T, Alloc >::Array( const Array& other )
+    template< typename T, typename Alloc, typename Growth >
+    Array< T, Alloc, Growth >::Array( const Array& other )
     {
         const SizeType size = other.Size();
         if ( size > 0 )
@@ -157,192 +239,269 @@ namespace Core
         }
     }
 
-    template< typename T, typename Alloc >
-    Array< T, Alloc >::~Array()
+    template< typename T, typename Alloc, typename Growth >
+    Array< T, Alloc, Growth >::~Array()
     {
         Clear();
         DoFree( m_begin );
     }
 
-    template< typename T, typename Alloc >
-    Array< T, Alloc >& Array< T, Alloc >::operator=( const Array& other )
+    template< typename T, typename Alloc, typename Growth >
+    Array< T, Alloc, Growth >& Array< T, Alloc, Growth >::operator=( const Array& other )
     {
-        Clear();
-        PushBack( other.Begin(), other.End() );
+        if ( this == &other )
+        {
+            return *this;
+        }
+
+        const SizeType size = other.Size();
+
+        if ( IsPOD< T >::value || size > Capacity() )
+        {
+            Clear();
+            PushBack( other.Begin(), other.End() );
+        }
+        else
+        {
+            // reuse the live elements, construct or destroy the difference
+            const SizeType common = ( size < Size() ) ? size : Size();
+            for ( SizeType i=0; i<common; ++i )
+            {
+                m_begin[ i ] = other.m_begin[ i ];
+            }
+
+            if ( size > common )
+            {
+                MemoryUtils::Copy( other.m_begin + common, other.m_end, m_end );
+                m_end = m_begin + size;
+            }
+            else
+            {
+                while ( Size() > size )
+                {
+                    PopBack();
+                }
+            }
+        }
+
+        return *this;
+    }
+
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+    template< typename T, typename Alloc, typename Growth >
+    Array< T, Alloc, Growth >::Array( Array&& other )
+    : m_begin( other.m_begin ), m_end( other.m_end ), m_capacity( other.m_capacity )
+    {
+        other.m_begin = other.m_end = other.m_capacity = 0;
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    Array< T, Alloc, Growth >& Array< T, Alloc, Growth >::operator=( Array&& other )
+    {
+        if ( this != &other )
+        {
+            Clear();
+            DoFree( m_begin );
+
+            m_begin     = other.m_begin;
+            m_end       = other.m_end;
+            m_capacity  = other.m_capacity;
+
+            other.m_begin = other.m_end = other.m_capacity = 0;
+        }
 
         return *this;
     }
+#endif
+
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::Swap( Array& other )
+    {
+        Pointer b = m_begin;
+        Pointer e = m_end;
+        Pointer c = m_capacity;
+
+        m_begin     = other.m_begin;
+        m_end       = other.m_end;
+        m_capacity  = other.m_capacity;
+
+        other.m_begin       = b;
+        other.m_end         = e;
+        other.m_capacity    = c;
+    }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::ConstPointer Array< T, Alloc >::ConstPtr() const
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::ConstPointer Array< T, Alloc, Growth >::ConstPtr() const
     {
         return m_begin;
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::Pointer Array< T, Alloc >::Ptr()
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Pointer Array< T, Alloc, Growth >::Ptr()
     {
         return m_begin;
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::ConstIterator Array< T, Alloc >::Begin() const
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::ConstIterator Array< T, Alloc, Growth >::Begin() const
     {
         return m_begin;
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::Iterator Array< T, Alloc >::Begin()
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Iterator Array< T, Alloc, Growth >::Begin()
     {
         return m_begin;
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::ConstIterator Array< T, Alloc >::End() const
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::ConstIterator Array< T, Alloc, Growth >::End() const
     {
         return m_end;
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::Iterator Array< T, Alloc >::End()
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Iterator Array< T, Alloc, Growth >::End()
     {
         return m_end;
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::ConstReference Array< T, Alloc >::Front() const
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::ConstReference Array< T, Alloc, Growth >::Front() const
     {
         CARBON_ASSERT( m_begin );
         return *m_begin;
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::Reference Array< T, Alloc >::Front()
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Reference Array< T, Alloc, Growth >::Front()
     {
         CARBON_ASSERT( m_begin );
         return *m_begin;
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::ConstReference Array< T, Alloc >::Back() const
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::ConstReference Array< T, Alloc, Growth >::Back() const
     {
         CARBON_ASSERT( m_begin );
         return *( m_end - 1 );
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::Reference Array< T, Alloc >::Back()
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Reference Array< T, Alloc, Growth >::Back()
     {
         CARBON_ASSERT( m_begin );
         return *( m_end - 1 );
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::ConstReference Array< T, Alloc >::At( SizeType index ) const
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::ConstReference Array< T, Alloc, Growth >::At( SizeType index ) const
     {
         CARBON_ASSERT( index < Size() );
         return *( m_begin + index );
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::Reference Array< T, Alloc >::At( SizeType index )
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Reference Array< T, Alloc, Growth >::At( SizeType index )
     {
         CARBON_ASSERT( index < Size() );
         return *( m_begin + index );
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::ConstReference Array< T, Alloc >::operator[]( SizeType index ) const
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::ConstReference Array< T, Alloc, Growth >::operator[]( SizeType index ) const
     {
         return At( index );
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::Reference Array< T, Alloc >::operator[]( SizeType index )
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Reference Array< T, Alloc, Growth >::operator[]( SizeType index )
     {
         return At( index );
     }
 
-    template< typename T, typename Alloc >
-    Bool Array< T, Alloc >::Empty() const
+    template< typename T, typename Alloc, typename Growth >
+    Bool Array< T, Alloc, Growth >::Empty() const
     {
         return ( m_begin == m_end );
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::SizeType Array< T, Alloc >::Size() const
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::SizeType Array< T, Alloc, Growth >::Size() const
     {
         return static_cast< SizeType >( m_end - m_begin );
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::SizeType Array< T, Alloc >::Capacity() const
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::SizeType Array< T, Alloc, Growth >::Capacity() const
     {
         return static_cast< SizeType >( m_capacity - m_begin );
     }
 
-    template< typename T, typename Alloc >
-    void Array< T, Alloc >::Reserve( SizeType capacity )
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::Reserve( SizeType capacity )
     {
         if ( Capacity() < capacity )
         {
             IncreaseCapacity( capacity );
         }
+        else if ( capacity == 0 )
+        {
+            Clear();
+            DoFree( m_begin );
+            m_begin = m_end = m_capacity = 0;
+        }
         else
         {
-            if ( capacity == 0 )
+            if ( capacity < Size() )
             {
-                Clear();
-                DoFree( m_begin );
-                m_begin = m_end = m_capacity = 0;
+                capacity = Size();
             }
-            else
+            if ( capacity < Capacity() )
             {
-                Pointer ptr = DoAllocate( capacity );
-                MemoryUtils::Copy( m_begin, m_begin + capacity, ptr );
-                if ( ! IsPOD< T >::value )
-                {
-                    for ( Iterator it=m_begin; it!=m_end; ++it ) { it->~ValueType(); }
-                }
-                DoFree( m_begin );
-                m_begin = ptr;
-                m_end = m_capacity = ptr + capacity;
+                Relocate( capacity );
             }
         }
     }
 
-    template< typename T, typename Alloc >
-    void Array< T, Alloc >::Resize( SizeType size, ConstReference value )
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::Resize( SizeType size, ConstReference value )
     {
-        Iterator end = m_begin + size;
         if ( size < Size() )
         {
-            if ( IsPOD< T >::value )
-            {
-                m_end = end;
-            }
-            else
+            while ( Size() > size )
             {
-                while ( m_begin != m_end )
-                {
-                    PopBack();
-                }
+                PopBack();
             }
         }
-        else
+        else if ( size > Size() )
         {
-            Reserve( size );
-            MemoryUtils::Fill( m_end, m_capacity, value );
-            m_end = m_capacity;
+            if ( size > Capacity() )
+            {
+                IncreaseCapacity( size );
+            }
+            MemoryUtils::Fill( m_end, m_begin + size, value );
+            m_end = m_begin + size;
         }
     }
 
-    template< typename T, typename Alloc >
-    void Array< T, Alloc >::PushBack( ConstReference value )
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::PushBack( ConstReference value )
     {
         if ( m_end == m_capacity )
         {
-            IncreaseCapacity( ComputeNewCapacity() );
+            // value may be an element of the array
+            const Bool inside = ( &value >= m_begin ) && ( &value < m_end );
+            const SizeType index = static_cast< SizeType >( &value - m_begin );
+
+            IncreaseCapacity( ComputeNewCapacity( Size() + 1 ) );
+
+            if ( inside )
+            {
+                ::new( m_end ) ValueType( m_begin[ index ] );
+                ++m_end;
+                return;
+            }
         }
         if ( IsPOD< T >::value )
         {
@@ -355,26 +514,187 @@ namespace Core
         ++m_end;
     }
 
-    template< typename T, typename Alloc >
-    void Array< T, Alloc >::PushBack( ConstPointer p, SizeType n )
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::PushBack( ValueType&& value )
+    {
+        if ( m_end == m_capacity )
+        {
+            const Bool inside = ( &value >= m_begin ) && ( &value < m_end );
+            const SizeType index = static_cast< SizeType >( &value - m_begin );
+
+            IncreaseCapacity( ComputeNewCapacity( Size() + 1 ) );
+
+            if ( inside )
+            {
+                ::new( m_end ) ValueType( Move( m_begin[ index ] ) );
+                ++m_end;
+                return;
+            }
+        }
+        ::new( m_end ) ValueType( Move( value ) );
+        ++m_end;
+    }
+#endif
+
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::PushBack( ConstPointer p, SizeType n )
     {
         PushBack( p, p + n );
     }
 
-    template< typename T, typename Alloc >
-    void Array< T, Alloc >::PushBack( ConstIterator begin, ConstIterator end )
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::PushBack( ConstIterator begin, ConstIterator end )
     {
-        const SizeType capacity = Size() + ( end - begin );
-        if ( ( m_begin + capacity ) > m_capacity )
+        const SizeType size = Size() + static_cast< SizeType >( end - begin );
+        if ( size > Capacity() )
         {
-            IncreaseCapacity( capacity );
+            CARBON_ASSERT( end <= m_begin || begin >= m_end );  // can't append a range of itself when growing
+            IncreaseCapacity( ComputeNewCapacity( size ) );
         }
         MemoryUtils::Copy( begin, end, m_end );
-        m_end = m_begin + capacity;
+        m_end = m_begin + size;
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Pointer Array< T, Alloc, Growth >::PrepareEmplace()
+    {
+        if ( m_end == m_capacity )
+        {
+            IncreaseCapacity( ComputeNewCapacity( Size() + 1 ) );
+        }
+        return m_end++;
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Reference Array< T, Alloc, Growth >::EmplaceBack()
+    {
+        return *::new( PrepareEmplace() ) ValueType();
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    template< typename A1 >
+    typename Array< T, Alloc, Growth >::Reference Array< T, Alloc, Growth >::EmplaceBack( CARBON_FWD_REF( A1 ) a1 )
+    {
+        return *::new( PrepareEmplace() ) ValueType( CARBON_FORWARD( A1, a1 ) );
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    template< typename A1, typename A2 >
+    typename Array< T, Alloc, Growth >::Reference Array< T, Alloc, Growth >::EmplaceBack( CARBON_FWD_REF( A1 ) a1, CARBON_FWD_REF( A2 ) a2 )
+    {
+        return *::new( PrepareEmplace() ) ValueType( CARBON_FORWARD( A1, a1 ), CARBON_FORWARD( A2, a2 ) );
     }
 
-    template< typename T, typename Alloc >
-    void Array< T, Alloc >::PopBack()
+    template< typename T, typename Alloc, typename Growth >
+    template< typename A1, typename A2, typename A3 >
+    typename Array< T, Alloc, Growth >::Reference Array< T, Alloc, Growth >::EmplaceBack( CARBON_FWD_REF( A1 ) a1, CARBON_FWD_REF( A2 ) a2, CARBON_FWD_REF( A3 ) a3 )
+    {
+        return *::new( PrepareEmplace() ) ValueType( CARBON_FORWARD( A1, a1 ), CARBON_FORWARD( A2, a2 ), CARBON_FORWARD( A3, a3 ) );
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    template< typename A1, typename A2, typename A3, typename A4 >
+    typename Array< T, Alloc, Growth >::Reference Array< T, Alloc, Growth >::EmplaceBack( CARBON_FWD_REF( A1 ) a1, CARBON_FWD_REF( A2 ) a2, CARBON_FWD_REF( A3 ) a3, CARBON_FWD_REF( A4 ) a4 )
+    {
+        return *::new( PrepareEmplace() ) ValueType( CARBON_FORWARD( A1, a1 ), CARBON_FORWARD( A2, a2 ), CARBON_FORWARD( A3, a3 ), CARBON_FORWARD( A4, a4 ) );
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Iterator Array< T, Alloc, Growth >::Insert( Iterator pos, ConstReference value )
+    {
+        CARBON_ASSERT( pos >= m_begin && pos <= m_end );
+
+        const SizeType index = static_cast< SizeType >( pos - m_begin );
+
+        if ( pos == m_end )
+        {
+            PushBack( value );
+            return m_begin + index;
+        }
+
+        ValueType tmp( value );     // value may be an element of the array
+
+        if ( m_end == m_capacity )
+        {
+            IncreaseCapacity( ComputeNewCapacity( Size() + 1 ) );
+        }
+        pos = m_begin + index;
+
+        if ( IsTriviallyRelocatable< T >::value )
+        {
+            MemoryUtils::MemMove( pos + 1, pos, ( m_end - pos ) * sizeof( ValueType ) );
+            ::new( pos ) ValueType( Move( tmp ) );
+        }
+        else
+        {
+            ::new( m_end ) ValueType( Move( *( m_end - 1 ) ) );
+            for ( Iterator it = m_end - 1; it != pos; --it )
+            {
+                *it = Move( *( it - 1 ) );
+            }
+            *pos = Move( tmp );
+        }
+        ++m_end;
+
+        return pos;
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Iterator Array< T, Alloc, Growth >::Erase( Iterator pos )
+    {
+        return Erase( pos, pos + 1 );
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Iterator Array< T, Alloc, Growth >::Erase( Iterator begin, Iterator end )
+    {
+        CARBON_ASSERT( begin >= m_begin && begin <= end && end <= m_end );
+
+        if ( begin == end )
+        {
+            return begin;
+        }
+
+        if ( IsTriviallyRelocatable< T >::value )
+        {
+            if ( ! IsPOD< T >::value )
+            {
+                for ( Iterator it=begin; it!=end; ++it ) { it->~ValueType(); }
+            }
+            MemoryUtils::MemMove( begin, end, ( m_end - end ) * sizeof( ValueType ) );
+            m_end -= ( end - begin );
+        }
+        else
+        {
+            Iterator to = begin;
+            for ( Iterator from = end; from != m_end; ++from, ++to )
+            {
+                *to = Move( *from );
+            }
+            while ( m_end != to )
+            {
+                PopBack();
+            }
+        }
+
+        return begin;
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::EraseUnordered( Iterator pos )
+    {
+        CARBON_ASSERT( pos >= m_begin && pos < m_end );
+
+        if ( pos != m_end - 1 )
+        {
+            *pos = Move( *( m_end - 1 ) );
+        }
+        PopBack();
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::PopBack()
     {
         CARBON_ASSERT( m_begin < m_end );
         --m_end;
@@ -384,8 +704,8 @@ namespace Core
         }
     }
 
-    template< typename T, typename Alloc >
-    void Array< T, Alloc >::Clear()
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::Clear()
     {
         if ( IsPOD< T >::value )
         {
@@ -400,39 +720,61 @@ namespace Core
         }
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::Pointer Array< T, Alloc >::DoAllocate( SizeType capacity )
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::Pointer Array< T, Alloc, Growth >::DoAllocate( SizeType capacity )
     {
         return static_cast< Pointer >( Alloc::Allocate( capacity * sizeof( ValueType ), MemoryUtils::AlignOf< ValueType >() ) );
     }
 
-    template< typename T, typename Alloc >
-    void Array< T, Alloc >::DoFree( Pointer memory )
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::DoFree( Pointer memory )
     {
         Alloc::Deallocate( memory );
     }
 
-    template< typename T, typename Alloc >
-    typename Array< T, Alloc >::SizeType Array< T, Alloc >::ComputeNewCapacity() const
+    template< typename T, typename Alloc, typename Growth >
+    typename Array< T, Alloc, Growth >::SizeType Array< T, Alloc, Growth >::ComputeNewCapacity( SizeType required ) const
     {
-        return ( m_capacity == 0 ) ? 1 : 2 * Capacity();
+        return Growth::Compute( Capacity(), required );
     }
 
-    template< typename T, typename Alloc >
-    void Array< T, Alloc >::IncreaseCapacity( SizeType capacity )
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::IncreaseCapacity( SizeType capacity )
     {
-        Pointer ptr = DoAllocate( capacity );
-        if ( capacity > 1 )
+        if ( m_begin && Alloc::TryGrow( m_begin, capacity * sizeof( ValueType ) ) )
         {
-            MemoryUtils::Copy( m_begin, m_end, ptr );
-            if ( ! IsPOD< T >::value )
+            m_capacity = m_begin + capacity;
+            return;
+        }
+
+        Relocate( capacity );
+    }
+
+    template< typename T, typename Alloc, typename Growth >
+    void Array< T, Alloc, Growth >::Relocate( SizeType capacity )
+    {
+        CARBON_ASSERT( capacity >= Size() );
+
+        const SizeType size = Size();
+        Pointer ptr;
+
+        if ( IsTriviallyRelocatable< T >::value )
+        {
+            ptr = static_cast< Pointer >( Alloc::Reallocate( m_begin, Capacity() * sizeof( ValueType ), capacity * sizeof( ValueType ), MemoryUtils::AlignOf< ValueType >() ) );
+        }
+        else
+        {
+            ptr = DoAllocate( capacity );
+            for ( SizeType i=0; i<size; ++i )
             {
-                for ( Iterator it=m_begin; it!=m_end; ++it ) { it->~ValueType(); }
+                ::new( ptr + i ) ValueType( Move( m_begin[ i ] ) );
+                m_begin[ i ].~ValueType();
             }
             DoFree( m_begin );
         }
-        m_end = ptr + Size();
+
         m_begin = ptr;
+        m_end = ptr + size;
         m_capacity = ptr + capacity;
     }
 
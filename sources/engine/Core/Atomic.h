@@ -0,0 +1,11 @@
+#pragma once
+#ifndef _CORE_ATOMIC_H
+#define _CORE_ATOMIC_H
+
+#if defined( CARBON_PLATFORM_WIN32 )
+    #include "Core/ps/win32/Atomic.inl"
+#else
+    #error Atomic not defined
+#endif
+
+#endif // _CORE_ATOMIC_H
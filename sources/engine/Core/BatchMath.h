@@ -0,0 +1,97 @@
+#pragma once
+#ifndef _CORE_BATCHMATH_H
+#define _CORE_BATCHMATH_H
+
+#include "Core/Types.h"
+#include "Core/DLL.h"
+#include "Core/Matrix.h"
+#include "Core/Frustum.h"
+
+namespace Core
+{
+    enum BatchPath
+    {
+        BP_SSE,                 // 4 lanes
+        BP_AVX2,                // 8 lanes and fused multiply add
+        BP_COUNT
+    };
+
+    // Structure of arrays views, each array holds the count elements of a batch
+
+    struct SoaPoints
+    {
+        F32 *   m_x;
+        F32 *   m_y;
+        F32 *   m_z;
+    };
+
+    struct SoaBoxes
+    {
+        SoaPoints   m_min;
+        SoaPoints   m_max;
+    };
+
+    struct SoaMatrices
+    {
+        F32 *   m_element[ 16 ];    // m_element[ column * 4 + row ]
+    };
+
+    struct SoaSpheres
+    {
+        SoaPoints   m_center;
+        F32 *       m_radius;
+    };
+
+    // Visibility bitmasks, bit ( i % 32 ) of the word i / 32 is set when the object i is visible
+    inline SizeT VisibilityWordCount( SizeT count )
+    {
+        return ( count + 31 ) / 32;
+    }
+
+    inline Bool IsVisible( const U32 * visibility, SizeT i )
+    {
+        return ( visibility[ i / 32 ] & ( 1u << ( i % 32 ) ) ) != 0;
+    }
+
+    //====================================================================================
+    // BatchMath
+    //====================================================================================
+
+    // Math kernels on float arrays. The widest path supported by the CPU is selected at
+    // startup. Arrays need no alignment and can have any size, destinations can be the
+    // sources.
+
+    class _CoreExport BatchMath
+    {
+    public:
+        static BatchPath    GetPath();
+        static Bool         IsSupported( BatchPath path );
+        static void         SetPath( BatchPath path );      // to compare the paths
+
+        // dest[ i ] = a[ i ] * b[ i ] + c[ i ]
+        static void         MulAdd( F32 * dest, const F32 * a, const F32 * b, const F32 * c, SizeT count );
+
+        // dest[ i ] = a[ i ] + ( b[ i ] - a[ i ] ) * ratio
+        static void         Lerp( F32 * dest, const F32 * a, const F32 * b, F32 ratio, SizeT count );
+
+        // dest[ i ] = l * r[ i ], typically view projection * world
+        static void         MulMatrices( const Matrix& l, const SoaMatrices& r, const SoaMatrices& dest, SizeT count );
+
+        // dest[ i ] = inverse of src[ i ], matrices are affine : last row is [ 0 0 0 1 ]
+        static void         AffineInverses( const SoaMatrices& src, const SoaMatrices& dest, SizeT count );
+
+        // dest[ i ] = m * src[ i ], m is affine
+        static void         TransformPoints( const Matrix& m, const SoaPoints& src, const SoaPoints& dest, SizeT count );
+
+        // dest[ i ] = axis aligned box around m * src[ i ], m is affine
+        static void         TransformBoxes( const Matrix& m, const SoaBoxes& src, const SoaBoxes& dest, SizeT count );
+
+        // visibility bitmasks against a frustum, VisibilityWordCount( count ) words are written
+        static void         CullSpheres( const Frustum& frustum, const SoaSpheres& src, U32 * visibility, SizeT count );
+        static void         CullBoxes( const Frustum& frustum, const SoaBoxes& src, U32 * visibility, SizeT count );
+    };
+
+    //========================================================================= BatchMath
+}
+
+#endif // _CORE_BATCHMATH_H
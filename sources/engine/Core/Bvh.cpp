@@ -0,0 +1,412 @@
+#include "Core/Bvh.h"
+
+#include "Core/Assert.h"
+#include "Core/Math.h"
+#include "Core/MemoryUtils.h"
+
+#include <float.h>
+
+namespace Core
+{
+    namespace
+    {
+        const SizeT maxDepth = 64;
+
+        struct StackEntry
+        {
+            U32     m_node;
+            U32     m_state;    // what is left to test, 0 when the parent is fully accepted
+        };
+
+        // Box against the planes of the state, false when the box is behind one of them.
+        // The state keeps the planes crossed by the box, its children can skip the others.
+        struct FrustumQuery
+        {
+            U32 Root() const
+            {
+                return ( 1 << FP_COUNT ) - 1;
+            }
+
+            Bool Test( const F32 * min, const F32 * max, U32& state ) const
+            {
+                const F32 cx = ( min[ 0 ] + max[ 0 ] ) * 0.5f;
+                const F32 cy = ( min[ 1 ] + max[ 1 ] ) * 0.5f;
+                const F32 cz = ( min[ 2 ] + max[ 2 ] ) * 0.5f;
+                const F32 ex = ( max[ 0 ] - min[ 0 ] ) * 0.5f;
+                const F32 ey = ( max[ 1 ] - min[ 1 ] ) * 0.5f;
+                const F32 ez = ( max[ 2 ] - min[ 2 ] ) * 0.5f;
+
+                U32 crossing = 0;
+                for ( SizeT k=0; k<FP_COUNT; ++k )
+                {
+                    if ( state & ( 1 << k ) )
+                    {
+                        const F128& p = m_planes[ k ];
+                        const F32 d = p[ 0 ] * cx + p[ 1 ] * cy + p[ 2 ] * cz + p[ 3 ];
+                        const F32 r = Abs( p[ 0 ] ) * ex + Abs( p[ 1 ] ) * ey + Abs( p[ 2 ] ) * ez;
+                        if ( d + r < 0.0f )
+                        {
+                            return false;
+                        }
+                        if ( d - r < 0.0f )
+                        {
+                            crossing |= 1 << k;
+                        }
+                    }
+                }
+
+                state = crossing;
+                return true;
+            }
+
+            F128    m_planes[ FP_COUNT ];
+        };
+
+        // Box against a sphere, the state is cleared when the box is inside the sphere
+        struct SphereQuery
+        {
+            U32 Root() const
+            {
+                return 1;
+            }
+
+            Bool Test( const F32 * min, const F32 * max, U32& state ) const
+            {
+                if ( state == 0 )
+                {
+                    return true;
+                }
+
+                F32 nearest = 0.0f;
+                F32 farthest = 0.0f;
+                for ( SizeT k=0; k<3; ++k )
+                {
+                    const F32 toMin = m_center[ k ] - min[ k ];
+                    const F32 toMax = max[ k ] - m_center[ k ];
+                    const F32 outside = Max( 0.0f, Max( -toMin, -toMax ) );
+                    const F32 across = Max( Abs( toMin ), Abs( toMax ) );
+                    nearest += outside * outside;
+                    farthest += across * across;
+                }
+
+                if ( nearest > m_squareRadius )
+                {
+                    return false;
+                }
+                if ( farthest <= m_squareRadius )
+                {
+                    state = 0;
+                }
+                return true;
+            }
+
+            F128    m_center;
+            F32     m_squareRadius;
+        };
+
+        //================================================================================
+        // Build
+        //================================================================================
+
+        const SizeT binCount        = 16;
+        const SizeT maxLeafSize     = 4;
+
+        struct Box
+        {
+            F32     m_min[ 3 ];
+            F32     m_max[ 3 ];
+        };
+
+        void ResetBox( Box& box )
+        {
+            for ( SizeT k=0; k<3; ++k )
+            {
+                box.m_min[ k ] = FLT_MAX;
+                box.m_max[ k ] = -FLT_MAX;
+            }
+        }
+
+        void GrowBox( Box& box, const F32 * min, const F32 * max )
+        {
+            for ( SizeT k=0; k<3; ++k )
+            {
+                box.m_min[ k ] = Min( box.m_min[ k ], min[ k ] );
+                box.m_max[ k ] = Max( box.m_max[ k ], max[ k ] );
+            }
+        }
+
+        F32 BoxArea( const Box& box )
+        {
+            const F32 dx = box.m_max[ 0 ] - box.m_min[ 0 ];
+            const F32 dy = box.m_max[ 1 ] - box.m_min[ 1 ];
+            const F32 dz = box.m_max[ 2 ] - box.m_min[ 2 ];
+            return ( dx < 0.0f ) ? 0.0f : dx * dy + dy * dz + dz * dx;
+        }
+
+        struct Builder
+        {
+            void GetBox( U32 item, Box& box ) const
+            {
+                box.m_min[ 0 ] = m_bounds.m_min.m_x[ item ];
+                box.m_min[ 1 ] = m_bounds.m_min.m_y[ item ];
+                box.m_min[ 2 ] = m_bounds.m_min.m_z[ item ];
+                box.m_max[ 0 ] = m_bounds.m_max.m_x[ item ];
+                box.m_max[ 1 ] = m_bounds.m_max.m_y[ item ];
+                box.m_max[ 2 ] = m_bounds.m_max.m_z[ item ];
+            }
+
+            F32 Centroid( U32 item, SizeT axis ) const
+            {
+                const F32 * min[ 3 ] = { m_bounds.m_min.m_x, m_bounds.m_min.m_y, m_bounds.m_min.m_z };
+                const F32 * max[ 3 ] = { m_bounds.m_max.m_x, m_bounds.m_max.m_y, m_bounds.m_max.m_z };
+                return ( min[ axis ][ item ] + max[ axis ][ item ] ) * 0.5f;
+            }
+
+            // Nodes are stored depth first, the left child follows its parent. The depth
+            // is limited by the traversal stack, deep nodes become bigger leaves.
+            void Build( SizeT begin, SizeT end, SizeT depth )
+            {
+                const SizeT index   = m_nodeCount++;
+                const SizeT count   = end - begin;
+
+                Box box;
+                Box centroids;
+                ResetBox( box );
+                ResetBox( centroids );
+                for ( SizeT i=begin; i<end; ++i )
+                {
+                    Box item;
+                    GetBox( m_items[ i ], item );
+                    GrowBox( box, item.m_min, item.m_max );
+
+                    F32 c[ 3 ];
+                    for ( SizeT k=0; k<3; ++k )
+                    {
+                        c[ k ] = ( item.m_min[ k ] + item.m_max[ k ] ) * 0.5f;
+                    }
+                    GrowBox( centroids, c, c );
+                }
+
+                BvhNode& node = m_nodes[ index ];
+                for ( SizeT k=0; k<3; ++k )
+                {
+                    node.m_min[ k ] = box.m_min[ k ];
+                    node.m_max[ k ] = box.m_max[ k ];
+                }
+
+                // cheapest bin boundary, one traversal step costs the parent area
+                const F32 area  = BoxArea( box );
+                F32 splitCost   = FLT_MAX;
+                SizeT splitAxis = 0;
+                SizeT splitBin  = 0;
+
+                if ( count > maxLeafSize && depth + 2 < maxDepth )
+                {
+                    for ( SizeT axis=0; axis<3; ++axis )
+                    {
+                        const F32 extent = centroids.m_max[ axis ] - centroids.m_min[ axis ];
+                        if ( extent <= 0.0f )
+                        {
+                            continue;
+                        }
+
+                        Box binBoxes[ binCount ];
+                        SizeT binSizes[ binCount ];
+                        for ( SizeT b=0; b<binCount; ++b )
+                        {
+                            ResetBox( binBoxes[ b ] );
+                            binSizes[ b ] = 0;
+                        }
+
+                        const F32 scale = binCount / extent;
+                        for ( SizeT i=begin; i<end; ++i )
+                        {
+                            const SizeT b = BinIndex( m_items[ i ], axis, centroids.m_min[ axis ], scale );
+
+                            Box item;
+                            GetBox( m_items[ i ], item );
+                            GrowBox( binBoxes[ b ], item.m_min, item.m_max );
+                            ++binSizes[ b ];
+                        }
+
+                        F32 rightAreas[ binCount ];
+                        SizeT rightSizes[ binCount ];
+                        Box right;
+                        ResetBox( right );
+                        SizeT rightSize = 0;
+                        for ( SizeT b=binCount-1; b>0; --b )
+                        {
+                            GrowBox( right, binBoxes[ b ].m_min, binBoxes[ b ].m_max );
+                            rightSize += binSizes[ b ];
+                            rightAreas[ b ] = BoxArea( right );
+                            rightSizes[ b ] = rightSize;
+                        }
+
+                        Box left;
+                        ResetBox( left );
+                        SizeT leftSize = 0;
+                        for ( SizeT b=1; b<binCount; ++b )
+                        {
+                            GrowBox( left, binBoxes[ b - 1 ].m_min, binBoxes[ b - 1 ].m_max );
+                            leftSize += binSizes[ b - 1 ];
+                            if ( leftSize == 0 || rightSizes[ b ] == 0 )
+                            {
+                                continue;
+                            }
+
+                            const F32 cost = area + BoxArea( left ) * leftSize + rightAreas[ b ] * rightSizes[ b ];
+                            if ( cost < splitCost )
+                            {
+                                splitCost   = cost;
+                                splitAxis   = axis;
+                                splitBin    = b;
+                            }
+                        }
+                    }
+                }
+
+                if ( splitCost == FLT_MAX )
+                {
+                    node.m_offset   = begin;
+                    node.m_count    = count;
+                    return;
+                }
+
+                // items of the bins below the split go first
+                const F32 scale = binCount / ( centroids.m_max[ splitAxis ] - centroids.m_min[ splitAxis ] );
+                SizeT middle = begin;
+                for ( SizeT i=begin; i<end; ++i )
+                {
+                    if ( BinIndex( m_items[ i ], splitAxis, centroids.m_min[ splitAxis ], scale ) < splitBin )
+                    {
+                        const U32 item      = m_items[ i ];
+                        m_items[ i ]        = m_items[ middle ];
+                        m_items[ middle ]   = item;
+                        ++middle;
+                    }
+                }
+
+                Build( begin, middle, depth + 1 );
+                m_nodes[ index ].m_offset   = m_nodeCount;
+                m_nodes[ index ].m_count    = 0;
+                Build( middle, end, depth + 1 );
+            }
+
+            SizeT BinIndex( U32 item, SizeT axis, F32 min, F32 scale ) const
+            {
+                const SizeT b = static_cast< SizeT >( ( Centroid( item, axis ) - min ) * scale );
+                return ( b < binCount ) ? b : binCount - 1;
+            }
+
+            SoaBoxes    m_bounds;
+            BvhNode *   m_nodes;
+            SizeT       m_nodeCount;
+            U32 *       m_items;
+        };
+
+        //================================================================================
+        // Traversal
+        //================================================================================
+
+        template< typename Query >
+        void Traverse( const Bvh& bvh, const Query& query, U32 * visibility )
+        {
+            CARBON_COMPILE_TIME_ASSERT( sizeof( BvhNode ) == 32 );
+
+            MemoryUtils::MemSet( visibility, 0, VisibilityWordCount( bvh.m_itemCount ) * sizeof( U32 ) );
+
+            if ( bvh.m_nodeCount == 0 )
+            {
+                return;
+            }
+
+            StackEntry stack[ maxDepth ];
+            stack[ 0 ].m_node   = 0;
+            stack[ 0 ].m_state  = query.Root();
+            SizeT top = 1;
+
+            while ( top > 0 )
+            {
+                const StackEntry entry  = stack[ --top ];
+                const BvhNode& node     = bvh.m_nodes[ entry.m_node ];
+
+                U32 state = entry.m_state;
+                if ( ! query.Test( node.m_min, node.m_max, state ) )
+                {
+                    continue;
+                }
+
+                if ( node.m_count == 0 )
+                {
+                    CARBON_ASSERT( top + 2 <= maxDepth );
+
+                    stack[ top ].m_node     = node.m_offset;
+                    stack[ top ].m_state    = state;
+                    ++top;
+                    stack[ top ].m_node     = entry.m_node + 1;
+                    stack[ top ].m_state    = state;
+                    ++top;
+                    continue;
+                }
+
+                const U32 * item    = bvh.m_items + node.m_offset;
+                const U32 * end     = item + node.m_count;
+                for ( ; item != end; ++item )
+                {
+                    const SoaBoxes& b   = bvh.m_bounds;
+                    const U32 i         = *item;
+                    const F32 min[ 3 ]  = { b.m_min.m_x[ i ], b.m_min.m_y[ i ], b.m_min.m_z[ i ] };
+                    const F32 max[ 3 ]  = { b.m_max.m_x[ i ], b.m_max.m_y[ i ], b.m_max.m_z[ i ] };
+
+                    U32 itemState = state;
+                    if ( query.Test( min, max, itemState ) )
+                    {
+                        visibility[ i / 32 ] |= 1u << ( i % 32 );
+                    }
+                }
+            }
+        }
+    }
+
+    SizeT BuildBvh( const SoaBoxes& bounds, SizeT count, BvhNode * nodes, U32 * items )
+    {
+        for ( SizeT i=0; i<count; ++i )
+        {
+            items[ i ] = static_cast< U32 >( i );
+        }
+
+        if ( count == 0 )
+        {
+            return 0;
+        }
+
+        Builder builder;
+        builder.m_bounds    = bounds;
+        builder.m_nodes     = nodes;
+        builder.m_nodeCount = 0;
+        builder.m_items     = items;
+        builder.Build( 0, count, 0 );
+
+        return builder.m_nodeCount;
+    }
+
+    void CullBvh( const Bvh& bvh, const Frustum& frustum, U32 * visibility )
+    {
+        FrustumQuery query;
+        for ( SizeT k=0; k<FP_COUNT; ++k )
+        {
+            Store( query.m_planes[ k ], frustum.m_plane[ k ] );
+        }
+
+        Traverse( bvh, query, visibility );
+    }
+
+    void QueryBvh( const Bvh& bvh, const Vector& center, F32 radius, U32 * visibility )
+    {
+        SphereQuery query;
+        Store( query.m_center, center );
+        query.m_squareRadius = radius * radius;
+
+        Traverse( bvh, query, visibility );
+    }
+}
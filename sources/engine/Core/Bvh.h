@@ -0,0 +1,46 @@
+#pragma once
+#ifndef _CORE_BVH_H
+#define _CORE_BVH_H
+
+#include "Core/Types.h"
+#include "Core/DLL.h"
+#include "Core/BatchMath.h"
+#include "Core/Frustum.h"
+
+namespace Core
+{
+    // Node of a bounding volume hierarchy, 32 bytes. Nodes are stored depth first : the
+    // left child follows its parent and m_offset is the index of the right child. Leaves
+    // reference the m_count items from m_offset in the item list.
+    struct BvhNode
+    {
+        F32     m_min[ 3 ];
+        F32     m_max[ 3 ];
+        U32     m_offset;
+        U32     m_count;        // 0 for inner nodes
+    };
+
+    struct Bvh
+    {
+        const BvhNode * m_nodes;
+        SizeT           m_nodeCount;
+        const U32 *     m_items;        // item indices, grouped by leaf
+        SizeT           m_itemCount;
+        SoaBoxes        m_bounds;       // item bounds, by item index
+    };
+
+    // Binned surface area heuristic build, for hierarchies made at runtime. Meshes have
+    // theirs built offline. nodes holds 2 * count - 1 nodes and items count indices,
+    // returns the node count.
+    SizeT _CoreExport BuildBvh( const SoaBoxes& bounds, SizeT count, BvhNode * nodes, U32 * items );
+
+    // Items of the hierarchy visible in a frustum, in a visibility bitmask of
+    // VisibilityWordCount( bvh.m_itemCount ) words. Matches BatchMath::CullBoxes on the
+    // item bounds, subtrees fully inside the frustum are accepted without tests.
+    void _CoreExport CullBvh( const Bvh& bvh, const Frustum& frustum, U32 * visibility );
+
+    // Items whose bounds are closer than radius to center, in a visibility bitmask
+    void _CoreExport QueryBvh( const Bvh& bvh, const Vector& center, F32 radius, U32 * visibility );
+}
+
+#endif // _CORE_BVH_H
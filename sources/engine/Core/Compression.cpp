@@ -0,0 +1,378 @@
+#include "Core/Compression.h"
+
+#include "Core/MemoryUtils.h"
+#include "Core/Assert.h"
+
+#include <cstring>
+
+namespace Core
+{
+    namespace
+    {
+        const SizeT minMatch        = 4;
+        const SizeT lastLiterals    = 5;            // a block ends by literals
+        const SizeT matchLimit      = 12;           // no match starts in the last bytes
+        const SizeT hashLog         = 12;
+
+        inline U32 Read32( const U8 * ptr )
+        {
+            U32 value;
+            memcpy( &value, ptr, sizeof(value) );
+            return value;
+        }
+
+        inline U32 HashSequence( U32 sequence )
+        {
+            return ( sequence * 2654435761u ) >> ( 32 - hashLog );
+        }
+
+        // Lengths from 15 go on in bytes of 255 and a last smaller one
+        inline U8 * WriteLength( U8 * out, SizeT length )
+        {
+            for ( ; length >= 255; length -= 255 )
+            {
+                *out++ = 255;
+            }
+            *out++ = static_cast< U8 >( length );
+            return out;
+        }
+
+        inline Bool ReadLength( const U8 *& in, const U8 * end, SizeT& length )
+        {
+            U8 byte;
+            do
+            {
+                if ( in == end )
+                {
+                    return false;
+                }
+                byte = *in++;
+                length += byte;
+            }
+            while ( byte == 255 );
+            return true;
+        }
+
+        inline U8 * WriteSequence( U8 * out, const U8 * literals, SizeT literalCount, SizeT offset, SizeT matchLength )
+        {
+            U8 * token = out++;
+
+            *token = static_cast< U8 >( ( ( literalCount < 15 ) ? literalCount : 15 ) << 4 );
+            if ( literalCount >= 15 )
+            {
+                out = WriteLength( out, literalCount - 15 );
+            }
+
+            memcpy( out, literals, literalCount );
+            out += literalCount;
+
+            if ( matchLength )
+            {
+                *out++ = static_cast< U8 >( offset );
+                *out++ = static_cast< U8 >( offset >> 8 );
+
+                const SizeT length = matchLength - minMatch;
+                *token |= static_cast< U8 >( ( length < 15 ) ? length : 15 );
+                if ( length >= 15 )
+                {
+                    out = WriteLength( out, length - 15 );
+                }
+            }
+
+            return out;
+        }
+
+        const U32 * GetBlockEnds( const void * data )
+        {
+            return reinterpret_cast< const U32 * >( static_cast< const U8 * >( data ) + sizeof(CompressedHeader) );
+        }
+    }
+
+    //======================================================================== Compression
+
+    SizeT Compression::GetBlockBound( SizeT size )
+    {
+        return size + size / 255 + 16;
+    }
+
+    SizeT Compression::CompressBlock( const void * src, SizeT size, void * dest )
+    {
+        CARBON_ASSERT( size <= CompressedHeader::ms_blockSize );
+
+        const U8 * const in = static_cast< const U8 * >( src );
+        U8 * out = static_cast< U8 * >( dest );
+
+        const U8 * anchor = in;
+
+        if ( size > matchLimit )
+        {
+            // last position of each hashed sequence, from the block start
+            U16 table[ 1 << hashLog ];
+            MemoryUtils::MemSet( table, 0, sizeof(table) );
+
+            const U8 * ip           = in + 1;
+            const U8 * const limit  = in + size - matchLimit;
+            const U8 * const end    = in + size - lastLiterals;
+
+            while ( ip < limit )
+            {
+                const U32 sequence  = Read32( ip );
+                const U32 hash      = HashSequence( sequence );
+                const U8 * ref      = in + table[ hash ];
+                table[ hash ]       = static_cast< U16 >( ip - in );
+
+                if ( Read32( ref ) != sequence )
+                {
+                    ++ip;
+                    continue;
+                }
+
+                const SizeT offset = ip - ref;
+
+                const U8 * matchEnd = ip + minMatch;
+                for ( ref += minMatch; matchEnd < end && *matchEnd == *ref; ++ref )
+                {
+                    ++matchEnd;
+                }
+
+                out = WriteSequence( out, anchor, ip - anchor, offset, matchEnd - ip );
+
+                ip      = matchEnd;
+                anchor  = ip;
+            }
+        }
+
+        out = WriteSequence( out, anchor, in + size - anchor, 0, 0 );
+
+        return out - static_cast< U8 * >( dest );
+    }
+
+    Bool Compression::DecompressBlock( const void * src, SizeT size, void * dest, SizeT rawSize )
+    {
+        const U8 * in           = static_cast< const U8 * >( src );
+        const U8 * const inEnd  = in + size;
+        U8 * const outStart     = static_cast< U8 * >( dest );
+        U8 * out                = outStart;
+        U8 * const outEnd       = outStart + rawSize;
+
+        while ( in < inEnd )
+        {
+            const U8 token = *in++;
+
+            SizeT literalCount = token >> 4;
+            if ( literalCount == 15 && ! ReadLength( in, inEnd, literalCount ) )
+            {
+                return false;
+            }
+
+            if ( literalCount > static_cast< SizeT >( inEnd - in ) || literalCount > static_cast< SizeT >( outEnd - out ) )
+            {
+                return false;
+            }
+
+            // short runs are copied by 16 bytes when both buffers have room past them
+            if ( literalCount <= 16 && inEnd - in >= 16 && outEnd - out >= 16 )
+            {
+                memcpy( out, in, 16 );
+            }
+            else
+            {
+                memcpy( out, in, literalCount );
+            }
+            in  += literalCount;
+            out += literalCount;
+
+            if ( in == inEnd )
+            {
+                break;                      // last literals
+            }
+
+            if ( inEnd - in < 2 )
+            {
+                return false;
+            }
+
+            const SizeT offset = in[0] | ( in[1] << 8 );
+            in += 2;
+
+            if ( offset == 0 || offset > static_cast< SizeT >( out - outStart ) )
+            {
+                return false;
+            }
+
+            SizeT matchLength = token & 15;
+            if ( matchLength == 15 && ! ReadLength( in, inEnd, matchLength ) )
+            {
+                return false;
+            }
+            matchLength += minMatch;
+
+            if ( matchLength > static_cast< SizeT >( outEnd - out ) )
+            {
+                return false;
+            }
+
+            const U8 * ref = out - offset;
+            U8 * const matchEnd = out + matchLength;
+
+            if ( offset >= 8 && outEnd - matchEnd >= 8 )
+            {
+                // may write up to 7 bytes past the match, rewritten by the next sequence
+                do
+                {
+                    memcpy( out, ref, 8 );
+                    out += 8;
+                    ref += 8;
+                }
+                while ( out < matchEnd );
+            }
+            else
+            {
+                // overlapping copy, repeats the last offset bytes
+                for ( ; out < matchEnd; ++out, ++ref )
+                {
+                    *out = *ref;
+                }
+            }
+            out = matchEnd;
+        }
+
+        return out == outEnd;
+    }
+
+    SizeT Compression::GetCompressedBound( SizeT size )
+    {
+        const SizeT blockCount = ( size + CompressedHeader::ms_blockSize - 1 ) / CompressedHeader::ms_blockSize;
+        return sizeof(CompressedHeader) + blockCount * sizeof(U32) + size;
+    }
+
+    SizeT Compression::Compress( const void * src, SizeT size, void * dest )
+    {
+        const SizeT blockCount = ( size + CompressedHeader::ms_blockSize - 1 ) / CompressedHeader::ms_blockSize;
+
+        CompressedHeader * header   = static_cast< CompressedHeader * >( dest );
+        header->m_magic             = CompressedHeader::ms_magic;
+        header->m_blockSize         = CompressedHeader::ms_blockSize;
+        header->m_blockCount        = static_cast< U32 >( blockCount );
+        header->m_rawSize           = static_cast< U32 >( size );
+
+        U32 * blockEnds = const_cast< U32 * >( GetBlockEnds( dest ) );
+        U8 * const blocks = reinterpret_cast< U8 * >( blockEnds + blockCount );
+        U8 * out = blocks;
+
+        U8 scratch[ CompressedHeader::ms_blockSize + CompressedHeader::ms_blockSize / 255 + 16 ];
+
+        const U8 * in = static_cast< const U8 * >( src );
+        for ( SizeT b=0; b<blockCount; ++b )
+        {
+            const SizeT offset      = b * CompressedHeader::ms_blockSize;
+            const SizeT rawSize     = ( size - offset < CompressedHeader::ms_blockSize ) ? size - offset : CompressedHeader::ms_blockSize;
+
+            const SizeT packedSize  = CompressBlock( in + offset, rawSize, scratch );
+            if ( packedSize < rawSize )
+            {
+                memcpy( out, scratch, packedSize );
+                out += packedSize;
+            }
+            else
+            {
+                memcpy( out, in + offset, rawSize );
+                out += rawSize;
+            }
+
+            blockEnds[ b ] = static_cast< U32 >( out - blocks );
+        }
+
+        return out - static_cast< U8 * >( dest );
+    }
+
+    Bool Compression::IsCompressed( const void * data, SizeT size )
+    {
+        if ( ! data || size < sizeof(CompressedHeader) )
+        {
+            return false;
+        }
+
+        const CompressedHeader * header = static_cast< const CompressedHeader * >( data );
+        if ( header->m_magic != CompressedHeader::ms_magic || header->m_blockSize != CompressedHeader::ms_blockSize )
+        {
+            return false;
+        }
+
+        const SizeT blockCount = header->m_blockCount;
+        if ( blockCount != ( header->m_rawSize + CompressedHeader::ms_blockSize - 1 ) / CompressedHeader::ms_blockSize )
+        {
+            return false;
+        }
+
+        const SizeT tableEnd = sizeof(CompressedHeader) + blockCount * sizeof(U32);
+        if ( size < tableEnd )
+        {
+            return false;
+        }
+
+        // blocks are laid out in order, so checking the ends checks every block range
+        const U32 * blockEnds = GetBlockEnds( data );
+        U32 previous = 0;
+        for ( SizeT b=0; b<blockCount; ++b )
+        {
+            if ( blockEnds[ b ] < previous )
+            {
+                return false;
+            }
+            previous = blockEnds[ b ];
+        }
+
+        return tableEnd + previous <= size;
+    }
+
+    SizeT Compression::GetRawSize( const void * data )
+    {
+        return static_cast< const CompressedHeader * >( data )->m_rawSize;
+    }
+
+    SizeT Compression::GetBlockCount( const void * data )
+    {
+        return static_cast< const CompressedHeader * >( data )->m_blockCount;
+    }
+
+    Bool Compression::DecompressBlock( const void * data, SizeT index, void * dest )
+    {
+        const CompressedHeader * header = static_cast< const CompressedHeader * >( data );
+        CARBON_ASSERT( index < header->m_blockCount );
+
+        const U32 * blockEnds   = GetBlockEnds( data );
+        const U8 * blocks       = reinterpret_cast< const U8 * >( blockEnds + header->m_blockCount );
+
+        const SizeT start       = ( index > 0 ) ? blockEnds[ index - 1 ] : 0;
+        const SizeT packedSize  = blockEnds[ index ] - start;
+
+        const SizeT offset      = index * CompressedHeader::ms_blockSize;
+        const SizeT rawSize     = ( header->m_rawSize - offset < CompressedHeader::ms_blockSize ) ? header->m_rawSize - offset : CompressedHeader::ms_blockSize;
+
+        U8 * out = static_cast< U8 * >( dest ) + offset;
+
+        if ( packedSize == rawSize )
+        {
+            memcpy( out, blocks + start, rawSize );
+            return true;
+        }
+
+        return DecompressBlock( blocks + start, packedSize, out, rawSize );
+    }
+
+    Bool Compression::Decompress( const void * data, void * dest )
+    {
+        const SizeT blockCount = GetBlockCount( data );
+        for ( SizeT b=0; b<blockCount; ++b )
+        {
+            if ( ! DecompressBlock( data, b, dest ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //======================================================================== Compression
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef _CORE_COMPRESSION_H
+#define _CORE_COMPRESSION_H
+
+#include "Core/DLL.h"
+#include "Core/Types.h"
+
+namespace Core
+{
+    //====================================================================================
+    // Compression
+    //====================================================================================
+
+    // LZ4 block format : sequences of literals followed by a copy of earlier output, no
+    // entropy coding so decompression runs at memory speed. Compressed files are split
+    // in independent blocks, decoded in any order by any thread :
+    //
+    //  | CompressedHeader | U32 blockEnds[ blockCount ] | block 0 | block 1 | ...
+    //
+    // blockEnds are offsets from the first block. A block as large as its raw data is
+    // stored raw. Raw blocks are ms_blockSize bytes, the last one is shorter.
+
+    struct CompressedHeader
+    {
+        static const U32 ms_magic       = 0x4b4c4243;      // "CBLK"
+        static const U32 ms_blockSize   = 64 * 1024;        // offsets of a block fit 16 bits
+
+        U32     m_magic;
+        U32     m_blockSize;
+        U32     m_blockCount;
+        U32     m_rawSize;
+    };
+
+    class _CoreExport Compression
+    {
+    public:
+        // One block, at most ms_blockSize bytes. dest holds GetBlockBound( size ) bytes.
+        // Returns the compressed size.
+        static SizeT    GetBlockBound( SizeT size );
+        static SizeT    CompressBlock( const void * src, SizeT size, void * dest );
+        static Bool     DecompressBlock( const void * src, SizeT size, void * dest, SizeT rawSize );
+
+        // Whole file. dest holds GetCompressedBound( size ) bytes, returns the compressed size.
+        static SizeT    GetCompressedBound( SizeT size );
+        static SizeT    Compress( const void * src, SizeT size, void * dest );
+
+        // data is a compressed file of size bytes, checked by IsCompressed
+        static Bool     IsCompressed( const void * data, SizeT size );
+        static SizeT    GetRawSize( const void * data );
+        static SizeT    GetBlockCount( const void * data );
+
+        // Decompresses block index into its place in dest, which holds GetRawSize bytes
+        static Bool     DecompressBlock( const void * data, SizeT index, void * dest );
+        static Bool     Decompress( const void * data, void * dest );
+    };
+
+    //======================================================================== Compression
+}
+
+#endif // _CORE_COMPRESSION_H
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef _CORE_DIRECTORYWATCHER_H
+#define _CORE_DIRECTORYWATCHER_H
+
+#include "Core/Types.h"
+#include "Core/DLL.h"
+
+#include "Core/FixedString.h"
+
+namespace Core
+{
+    //====================================================================================
+    // DirectoryWatcher
+    //====================================================================================
+
+    // Tells when files of a directory were written, created, renamed or deleted. The
+    // system only says that something changed, callers compare the write times of the
+    // files they depend on.
+
+    class _CoreExport DirectoryWatcher
+    {
+    public:
+        DirectoryWatcher();
+        ~DirectoryWatcher();
+
+        // False when the system cannot watch the directory, callers then poll it
+        Bool    Watch( const PathString& dir );
+        void    Stop();
+
+        Bool    IsWatching() const;
+
+        // True when the directory changed since the last call, never waits
+        Bool    HasChanged();
+
+    private:
+        DirectoryWatcher( const DirectoryWatcher& );
+        DirectoryWatcher& operator=( const DirectoryWatcher& );
+
+        void *  m_handle;
+    };
+
+    //=================================================================== DirectoryWatcher
+}
+
+#endif // _CORE_DIRECTORYWATCHER_H
@@ -10,6 +10,30 @@
 
 namespace Core
 {
+    // Read only view of a mapped file, its pages are read from the file cache on their
+    // first access. Empty files give a null view.
+    struct FileView
+    {
+        const void *    m_data;
+        SizeT           m_size;
+        void *          m_base;         // mapped address, given back by FileSystem::Unmap
+    };
+
+    // Whole file read of FileSystem::ReadBatch. Open sets the size, the caller gives a
+    // buffer of at least m_size bytes.
+    struct FileRead
+    {
+        void *          m_buffer;
+        SizeT           m_size;
+        void *          m_userData;
+        void *          m_file;         // loose file, null when packed
+        SizeT           m_pack;
+        U64             m_offset;       // in the pack
+    };
+
+    // Called as each read of a batch completes
+    typedef void ( *ReadCallback )( FileRead& read, Bool success );
+
     class _CoreExport FileSystem
     {
     public:
@@ -24,13 +48,48 @@ namespace Core
         static void Initialize( const Char * rootPath, const Char * dataDir = "data", const Char * cacheDir = "cache" );
         static void Destroy();
 
+        // Files under the cache directory are loaded from the mounted packs before the
+        // loose files, the last mounted pack first. A file saved after the mount
+        // overrides its packed copy. Packs stay open until Destroy.
+        static Bool Mount( const PathString& packName );
+
         static void BuildPathName( const Char * src, PathString& dest, PathType relativeTo = PT_ROOT );
 
         static Bool Load( const PathString& fileName, void *& buffer, SizeT& size );
         static Bool Save( const PathString& fileName, const void * buffer, SizeT size );
+        static Bool Delete( const PathString& fileName );   // loose files only
+
+        // Loose files only, the mounted packs are skipped : for the files the tools rewrite
+        // while the game runs, whose packed copies are older. The write time of a missing
+        // file is 0.
+        static Bool LoadLoose( const PathString& fileName, void *& buffer, SizeT& size );
+        static U64  GetLooseWriteTime( const PathString& fileName );
+
+        // Drops the pages of a loose file from the system file cache, the next reads come
+        // from the disk. Files open elsewhere may keep their pages.
+        static void EvictFromCache( const PathString& fileName );
+
+        // Maps the file instead of copying it like Load, packed files are mapped from
+        // their pack. The view stays valid until Unmap, whichever thread calls it.
+        // Load decompresses the packed files, Map gives them as stored ( Compression ).
+        static Bool Map( const PathString& fileName, FileView& view );
+        static void Unmap( FileView& view );
+
+        // Starts reading the pages of the views in the background, every range at once,
+        // so the first accesses do not wait for one read after the other. Does nothing
+        // when the system cannot prefetch.
+        static void Prefetch( const FileView * views, SizeT count );
+
+        // Batched reads : every file of the batch is read at once and the reads complete
+        // in any order, the callback runs on the calling thread as each one completes.
+        // A file opened stays open until ReadBatch or Close. Packed files are read as
+        // stored, like Map.
+        static Bool Open( const PathString& fileName, FileRead& read );
+        static void Close( FileRead& read );
+        static void ReadBatch( FileRead * reads, SizeT count, ReadCallback callback );
 
         static Bool Exists( const PathString& fileName );
-        static Bool Find( const Char * searchStr, Core::Array< PathString >& fileNames, Bool absolute = true );
+        static Bool Find( const Char * searchStr, Core::IArray< PathString >& fileNames, Bool absolute = true );
         static U64  GetLastWriteTime( const PathString& fileName );
     };
 }
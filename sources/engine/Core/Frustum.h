@@ -0,0 +1,85 @@
+#pragma once
+#ifndef _CORE_FRUSTUM_H
+#define _CORE_FRUSTUM_H
+
+#include "Core/Matrix.h"
+
+namespace Core
+{
+    enum FrustumPlane
+    {
+        FP_LEFT     = 0,
+        FP_RIGHT,
+        FP_BOTTOM,
+        FP_TOP,
+        FP_NEAR,
+        FP_FAR,
+        FP_COUNT
+    };
+
+    /*
+    // Planes [ a b c d ] facing inside, a point is in front of a plane when
+    // a * x + b * y + c * z + d >= 0. Normals have a unit length so the
+    // equations give distances.
+    */
+    struct Frustum
+    {
+        Vector m_plane[ FP_COUNT ];
+    };
+
+    // Planes of the clip volume -w <= x, y, z <= w, in the space the matrix transforms
+    // from : world space for a view projection matrix
+    inline Frustum ExtractFrustum( const Matrix& viewProj )
+    {
+        const Matrix rows = Transpose( viewProj );
+
+        Frustum f;
+        f.m_plane[ FP_LEFT ]    = Add( rows.m_column[ 3 ], rows.m_column[ 0 ] );
+        f.m_plane[ FP_RIGHT ]   = Sub( rows.m_column[ 3 ], rows.m_column[ 0 ] );
+        f.m_plane[ FP_BOTTOM ]  = Add( rows.m_column[ 3 ], rows.m_column[ 1 ] );
+        f.m_plane[ FP_TOP ]     = Sub( rows.m_column[ 3 ], rows.m_column[ 1 ] );
+        f.m_plane[ FP_NEAR ]    = Add( rows.m_column[ 3 ], rows.m_column[ 2 ] );
+        f.m_plane[ FP_FAR ]     = Sub( rows.m_column[ 3 ], rows.m_column[ 2 ] );
+
+        for ( SizeT i=0; i<FP_COUNT; ++i )
+        {
+            Vector normal   = Select( f.m_plane[ i ], Zero4(), Mask< 0, 0, 0, 1 >() );
+            f.m_plane[ i ]  = Div( f.m_plane[ i ], Length( normal ) );
+        }
+
+        return f;
+    }
+
+    // Conservative tests : false when the volume is fully behind a plane.
+    // BatchMath::CullSpheres and BatchMath::CullBoxes test arrays of volumes.
+    inline Bool IsSphereVisible( const Frustum& f, const Vector& center, F32 radius )
+    {
+        const Vector c = Select( center, One4(), Mask< 0, 0, 0, 1 >() );
+        const Vector r = Splat( -radius );
+
+        Vector outside = Zero4();
+        for ( SizeT i=0; i<FP_COUNT; ++i )
+        {
+            outside = Or( outside, LessThan( Dot( f.m_plane[ i ], c ), r ) );
+        }
+        return MoveMask( outside ) == 0;
+    }
+
+    inline Bool IsBoxVisible( const Frustum& f, const Vector& min, const Vector& max )
+    {
+        // distance of the center against the projected half size
+        const Vector half   = Splat( 0.5f );
+        const Vector c      = Select( Mul( Add( min, max ), half ), One4(), Mask< 0, 0, 0, 1 >() );
+        const Vector e      = Select( Mul( Sub( max, min ), half ), Zero4(), Mask< 0, 0, 0, 1 >() );
+
+        Vector outside = Zero4();
+        for ( SizeT i=0; i<FP_COUNT; ++i )
+        {
+            const Vector d = Add( Dot( f.m_plane[ i ], c ), Dot( Abs( f.m_plane[ i ] ), e ) );
+            outside = Or( outside, LessThan( d, Zero4() ) );
+        }
+        return MoveMask( outside ) == 0;
+    }
+}
+
+#endif // _CORE_FRUSTUM_H
@@ -1,19 +1,127 @@
 #include "Core/Hash.h"
 
+#if defined( CARBON_TRACK_HASHED_STRINGS )
+    #include "Core/HashTable.h"
+    #include "Core/LinearArena.h"
+    #include "Core/MemoryUtils.h"
+    #include "Core/SpinLock.h"
+    #include "Core/Trace.h"
+#endif
+
 namespace Core
 {
     U32 HashString( const Char * str )
     {
-        // FNV hash
-        // http://eternallyconfuzzled.com/tuts/algorithms/jsw_tut_hashing.aspx
-        // Thx !
+        // FNV-1a hash
+        // http://www.isthe.com/chongo/tech/comp/fnv/
         //
-        U32 h = 2166136261;
+        U32 h = 2166136261u;
 
-        while ( *(str++) != 0 ) // be sure that the string ends by '\0'
+        for ( ; *str != 0; ++str ) // be sure that the string ends by '\0'
         {
-            h = ( h * 16777619 ) ^ (*str);
+            h = ( h ^ static_cast< U8 >( *str ) ) * 16777619u;
         }
         return h;
-    };
+    }
+
+    U32 HashString( const Char * str, SizeT len )
+    {
+        U32 h = 2166136261u;
+
+        const Char * end = str + len;
+        for ( ; str != end; ++str )
+        {
+            h = ( h ^ static_cast< U8 >( *str ) ) * 16777619u;
+        }
+        return h;
+    }
+
+    //====================================================================================
+    // HashedString
+    //====================================================================================
+
+#if defined( CARBON_TRACK_HASHED_STRINGS )
+    namespace
+    {
+        // Reverse lookup table, strings are copied in an arena which lives until exit
+        struct StringTable
+        {
+            ~StringTable()
+            {
+                if ( m_strings.IsInitialized() )
+                {
+                    m_strings.Destroy();
+                }
+            }
+
+            HashTable< const Char *, U32, Hasher< U32 >, ToolsAllocator >   m_table;
+            LinearArena                                                     m_strings;
+            SpinLock                                                        m_lock;
+        };
+
+        StringTable stringTable;
+
+        // Last literal registered for each hash slot. The same literal is found at the
+        // same address, it is checked against the table only the first time.
+        const SizeT literalCacheSize = 1024;
+
+        const Char * volatile literalCache[ literalCacheSize ];
+    }
+
+    void HashedString::Register( U32 hash, const Char * str, SizeT len )
+    {
+        ScopedLock< SpinLock > lock( stringTable.m_lock );
+
+        const Char ** known = stringTable.m_table.Find( hash );
+        if ( known )
+        {
+            if ( StringUtils::StrCmp( *known, str ) != 0 )
+            {
+                Char msg[ 512 ];
+                StringUtils::FormatString( msg, sizeof( msg ), "Hash collision : \"%s\" and \"%s\" give 0x%08x\n", *known, str, hash );
+                CARBON_TRACE( msg );
+                CARBON_ASSERT( !"hash collision" );
+            }
+            return;
+        }
+
+        if ( ! stringTable.m_strings.IsInitialized() )
+        {
+            stringTable.m_strings.Initialize( 16 * 1024 );
+        }
+
+        Char * copy = static_cast< Char * >( stringTable.m_strings.Allocate( len + 1 ) );
+        MemoryUtils::MemCpy( copy, str, len );
+        copy[ len ] = 0;
+
+        stringTable.m_table.Insert( hash, copy );
+    }
+
+    void HashedString::RegisterLiteral( U32 hash, const Char * str )
+    {
+        const Char * volatile & cached = literalCache[ hash & ( literalCacheSize - 1 ) ];
+        if ( cached == str )
+        {
+            return;
+        }
+
+        Register( hash, str, StringUtils::StrLen( str ) );
+        cached = str;
+    }
+
+    const Char * HashedString::GetString( U32 hash )
+    {
+        ScopedLock< SpinLock > lock( stringTable.m_lock );
+
+        const Char ** str = stringTable.m_table.Find( hash );
+        return str ? *str : "?";
+    }
+#else
+    const Char * HashedString::GetString( U32 )
+    {
+        return "?";
+    }
+#endif
+
+    //======================================================================= HashedString
 }
@@ -4,10 +4,151 @@
 
 #include "Core/DLL.h"
 #include "Core/Types.h"
+#include "Core/TypeTraits.h"
+
+#include "Core/Assert.h"
+#include "Core/StringUtils.h"
+
+// Hashed strings remember their string for reverse lookups in debug builds, literals
+// are still hashed at compile time but registered at runtime
+#if defined( CARBON_DEBUG )
+    #define CARBON_TRACK_HASHED_STRINGS
+    #define CARBON_HASHED_STRING_CONSTEXPR inline
+#else
+    #define CARBON_HASHED_STRING_CONSTEXPR CARBON_CONSTEXPR
+#endif
 
 namespace Core
 {
+    // FNV-1a hash, the string must end by '\0'
     U32 _CoreExport HashString( const Char * str );
+    U32 _CoreExport HashString( const Char * str, SizeT len );
+
+    // Spreads the bits of an integer key, from the MurmurHash3 finalizer
+    inline U32 HashInteger( U32 key )
+    {
+        key ^= key >> 16;
+        key *= 0x85ebca6b;
+        key ^= key >> 13;
+        key *= 0xc2b2ae35;
+        key ^= key >> 16;
+        return key;
+    }
+
+    //====================================================================================
+    // FnvHash
+    //====================================================================================
+
+    // FNV-1a of a character array up to its '\0', I characters at most, unrolled by the
+    // compiler. A literal ends with its array, a shorter string in a bigger array is
+    // hashed like HashString does.
+
+    template< SizeT I >
+    struct FnvHash
+    {
+        template< SizeT N >
+        static CARBON_CONSTEXPR U32 Hash( const Char (&str)[ N ], U32 hash = 2166136261u )
+        {
+            return str[ N - 1 - I ] ? FnvHash< I - 1 >::Hash( str, ( hash ^ static_cast< U8 >( str[ N - 1 - I ] ) ) * 16777619u ) : hash;
+        }
+    };
+
+    template< >
+    struct FnvHash< 0 >
+    {
+        template< SizeT N >
+        static CARBON_CONSTEXPR U32 Hash( const Char (&)[ N ], U32 hash = 2166136261u )
+        {
+            return hash;
+        }
+    };
+
+    //============================================================================ FnvHash
+
+    //====================================================================================
+    // HashedString
+    //====================================================================================
+
+    // 32 bits identifier of a string, equal to HashString( str ).
+    // String literals are hashed at compile time (constexpr when available, folded by the
+    // optimizer otherwise), other strings at runtime :
+    //
+    //      HashedString id( "level3" );        // constant
+    //      HashedString id( name.ConstPtr() ); // runtime
+    //
+    // Constant character arrays are hashed up to their '\0' like literals, at compile time
+    // when their content is constant. Mutable buffers are hashed at runtime.
+
+    class _CoreExport HashedString
+    {
+    public:
+        struct DynamicString
+        {
+            DynamicString( const Char * str ) : m_str( str ) {}
+            const Char * m_str;
+        };
+
+    public:
+        template< SizeT N >
+        CARBON_HASHED_STRING_CONSTEXPR HashedString( const Char (&str)[ N ] );
+        template< SizeT N >
+        HashedString( Char (&str)[ N ] );
+        HashedString( DynamicString str );
+
+        CARBON_CONSTEXPR U32        GetHash() const;
+        CARBON_CONSTEXPR operator   U32() const;
+
+        // String of a hash, "?" when unknown or in builds without CARBON_TRACK_HASHED_STRINGS
+        static const Char * GetString( U32 hash );
+
+    private:
+#if defined( CARBON_TRACK_HASHED_STRINGS )
+        static void         Register( U32 hash, const Char * str, SizeT len );
+        static void         RegisterLiteral( U32 hash, const Char * str );             // once per literal
+#endif
+
+        U32                 m_hash;
+    };
+
+    //======================================================================= HashedString
+
+    template< SizeT N >
+    CARBON_HASHED_STRING_CONSTEXPR HashedString::HashedString( const Char (&str)[ N ] )
+        : m_hash( FnvHash< N - 1 >::Hash( str ) )
+    {
+#if defined( CARBON_TRACK_HASHED_STRINGS )
+        RegisterLiteral( m_hash, str );
+#endif
+    }
+
+    template< SizeT N >
+    inline HashedString::HashedString( Char (&str)[ N ] )
+        : m_hash( HashString( str ) )
+    {
+#if defined( CARBON_TRACK_HASHED_STRINGS )
+        Register( m_hash, str, StringUtils::StrLen( str ) );
+#endif
+    }
+
+    inline HashedString::HashedString( DynamicString str )
+        : m_hash( HashString( str.m_str ) )
+    {
+#if defined( CARBON_TRACK_HASHED_STRINGS )
+        Register( m_hash, str.m_str, StringUtils::StrLen( str.m_str ) );
+#endif
+    }
+
+    CARBON_CONSTEXPR U32 HashedString::GetHash() const
+    {
+        return m_hash;
+    }
+
+    CARBON_CONSTEXPR HashedString::operator U32() const
+    {
+        return m_hash;
+    }
+
+    //======================================================================= HashedString
 }
 
 #endif // _CORE_HASH_H
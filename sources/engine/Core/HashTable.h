@@ -2,15 +2,70 @@
 #ifndef _CORE_HASHTABLE_H
 #define _CORE_HASHTABLE_H
 
-#include "Core/Bucket.h"
+#include "Core/IArray.h"
+#include "Core/Hash.h"
+
+#include "Core/MemoryManager.h"
+#include "Core/MemoryUtils.h"
+#include "Core/TypeTraits.h"
+
+#include "Core/Assert.h"
 
 namespace Core
 {
+    //====================================================================================
+    // Hasher
+    //====================================================================================
+
+    // Default hash functions, specialize Hasher or give another one to the table for
+    // other key types.
+
+    template< typename K >
+    struct Hasher
+    {
+        static U32 Hash( const K& key )     { return HashInteger( static_cast< U32 >( key ) ); }
+    };
+
+    template< typename K >
+    struct Hasher< K * >
+    {
+        static U32 Hash( K * key )          { return HashInteger( static_cast< U32 >( reinterpret_cast< SizeT >( key ) ) ); }
+    };
+
+    //============================================================================= Hasher
+
+    //====================================================================================
+    // HashGroup
+    //====================================================================================
+
+    // Compares the tags of 16 consecutive slots at once
+
+    struct HashGroup
+    {
+        static const SizeT ms_size = 16;
+
+        static U32 Match( const U8 * tags, U8 tag );    // bit i is set when tags[i] == tag
+        static U32 FirstBit( U32 mask );
+    };
+
+    //========================================================================== HashGroup
+
     //====================================================================================
     // HashTable
     //====================================================================================
 
-    template< typename T, typename K = U32, SizeT S = 256, typename Alloc = DefaultAllocator >
+    // Open addressing hash table with Robin Hood insertion : an element displaces the
+    // ones which are closer to their home slot, which bounds the probe length. Removal
+    // shifts the following elements back so there are no tombstones.
+    //
+    // Each slot has a tag, 0 when empty or the 7 high bits of the hash with the high bit
+    // set, and its distance to its home slot. Lookups compare the tags of a whole group
+    // of slots before looking at the keys. The table doesn't wrap around, it ends with
+    // overflow slots. When an element would go beyond them the table grows, or the
+    // overflow does when the table is less than half full (poorly spread hash).
+    // Pointers to values are invalidated by Insert and Remove.
+
+    template< typename T, typename K = U32, typename H = Hasher< K >, typename Alloc = DefaultAllocator >
     class HashTable
     {
     public:
@@ -28,138 +83,353 @@ namespace Core
             ValueType       m_value;
         };
 
-        typedef Bucket< Pair, Alloc >  BucketType;
+        static const SizeT  ms_minCapacity  = 16;
+        static const SizeT  ms_minOverflow  = 64;
+        static const SizeT  ms_maxOverflow  = 0xFFFF;
 
     public:
         HashTable();
+        ~HashTable();
 
         SizeType            Count() const;
+        SizeType            Capacity() const;
 
-        ConstPointer        Find( KeyType key ) const;
-        Pointer             Find( KeyType key );
+        ConstPointer        Find( const KeyType& key ) const;
+        Pointer             Find( const KeyType& key );
 
-        void                Insert( KeyType key, ConstReference value );
-        void                Remove( KeyType key );
+        // Replaces the value when the key is already in the table
+        void                Insert( const KeyType& key, ConstReference value );
+        Bool                Remove( const KeyType& key );
 
+        void                Reserve( SizeType count );
         void                Clear();
 
-        template< typename ArrayAlloc >
-        void                Dump( Array< ValueType, ArrayAlloc >& dmp )
-        {
-            BucketType * b = m_table;
-            BucketType * bEnd = m_table + S;
-            for ( ; b != bEnd; ++b )
-            {
-                BucketType::Iterator p = b->Begin();
-                BucketType::ConstIterator pEnd = b->End();
-                for ( ; p != pEnd; ++p )
-                {
-                    dmp.PushBack( p->m_value );
-                }
-            }
-        }
+        void                Dump( IArray< ValueType >& dmp ) const;
 
     private:
-        BucketType          m_table[ S ];
+        HashTable( const HashTable& );
+        HashTable& operator=( const HashTable& );
+
+        static U8           MakeTag( U32 hash );
+        SizeType            FindSlot( const KeyType& key ) const;
+        void                InsertNew( U32 hash, Pair& pair );
+        Bool                TryInsert( U32 hash, Pair& pair );
+        void                Rehash( SizeType capacity, SizeType overflow );
+        void                Destroy();
+
+    private:
+        Pair *              mp_slots;
+        U8 *                mp_tags;
+        U16 *               mp_distances;
+        SizeType            m_capacity;         // power of 2
+        SizeType            m_overflow;         // slots after the last home slot
+        SizeType            m_count;
+        SizeType            m_maxProbe;         // max distance of an element since the last rehash
     };
 
     //========================================================================== HashTable
 
-    template< typename T, typename K, SizeT S, typename Alloc >
-    HashTable< T, K, S, Alloc >::HashTable()
+    template< typename T, typename K, typename H, typename Alloc >
+    HashTable< T, K, H, Alloc >::HashTable()
+        : mp_slots( 0 ), mp_tags( 0 ), mp_distances( 0 ), m_capacity( 0 ), m_overflow( ms_minOverflow ), m_count( 0 ), m_maxProbe( 0 )
+    {
+    }
+
+    template< typename T, typename K, typename H, typename Alloc >
+    HashTable< T, K, H, Alloc >::~HashTable()
     {
+        Destroy();
+    }
 
+    template< typename T, typename K, typename H, typename Alloc >
+    typename HashTable< T, K, H, Alloc >::SizeType HashTable< T, K, H, Alloc >::Count() const
+    {
+        return m_count;
     }
 
-    template< typename T, typename K, SizeT S, typename Alloc >
-    typename HashTable< T, K, S, Alloc >::SizeType HashTable< T, K, S, Alloc >::Count() const
+    template< typename T, typename K, typename H, typename Alloc >
+    typename HashTable< T, K, H, Alloc >::SizeType HashTable< T, K, H, Alloc >::Capacity() const
     {
-        SizeType count = 0;
+        return m_capacity;
+    }
 
-        const BucketType * b = m_table;
-        const BucketType * end = m_table + S;
-        for ( ; b != end; ++b )
+    template< typename T, typename K, typename H, typename Alloc >
+    typename HashTable< T, K, H, Alloc >::ConstPointer HashTable< T, K, H, Alloc >::Find( const KeyType& key ) const
+    {
+        const SizeType idx = FindSlot( key );
+        return ( idx == m_capacity + m_overflow ) ? 0 : &mp_slots[ idx ].m_value;
+    }
+
+    template< typename T, typename K, typename H, typename Alloc >
+    typename HashTable< T, K, H, Alloc >::Pointer HashTable< T, K, H, Alloc >::Find( const KeyType& key )
+    {
+        const SizeType idx = FindSlot( key );
+        return ( idx == m_capacity + m_overflow ) ? 0 : &mp_slots[ idx ].m_value;
+    }
+
+    template< typename T, typename K, typename H, typename Alloc >
+    void HashTable< T, K, H, Alloc >::Insert( const KeyType& key, ConstReference value )
+    {
+        Pointer p = Find( key );
+        if ( p )
         {
-            count += b->Size();
+            *p = value;
+            return;
         }
 
-        return count;
+        Pair pair = { key, value };     // value may live in the table
+
+        if ( ( m_count + 1 ) * 8 > m_capacity * 7 )        // max load factor of 7/8
+        {
+            Rehash( ( m_capacity == 0 ) ? ms_minCapacity : 2 * m_capacity, m_overflow );
+        }
+
+        InsertNew( H::Hash( key ), pair );
+        ++m_count;
     }
 
-    template< typename T, typename K, SizeT S, typename Alloc >
-    void HashTable< T, K, S, Alloc >::Insert( KeyType key, const ValueType& value )
+    template< typename T, typename K, typename H, typename Alloc >
+    Bool HashTable< T, K, H, Alloc >::Remove( const KeyType& key )
     {
-        SizeType idx = key % S;
+        SizeType idx = FindSlot( key );
+        if ( idx == m_capacity + m_overflow )
+        {
+            return false;
+        }
+
+        // shift back the next elements until an empty slot or one at its home slot
+        SizeType next = idx + 1;
+        while ( mp_tags[ next ] && mp_distances[ next ] )
+        {
+            mp_slots[ idx ]     = Move( mp_slots[ next ] );
+            mp_tags[ idx ]      = mp_tags[ next ];
+            mp_distances[ idx ] = mp_distances[ next ] - 1;
+            idx = next++;
+        }
 
-        Pair e = { key, value };
-        m_table[idx].PushBack( e );
+        mp_slots[ idx ].~Pair();
+        mp_tags[ idx ] = 0;
+        --m_count;
+
+        return true;
     }
 
-    template< typename T, typename K, SizeT S, typename Alloc >
-    void HashTable< T, K, S, Alloc >::Remove( KeyType key )
+    template< typename T, typename K, typename H, typename Alloc >
+    void HashTable< T, K, H, Alloc >::Reserve( SizeType count )
     {
-        SizeType idx = key % S;
+        SizeType capacity = ( m_capacity == 0 ) ? ms_minCapacity : m_capacity;
+        while ( count * 8 > capacity * 7 )
+        {
+            capacity *= 2;
+        }
 
-        BucketType::Iterator it = m_table[idx].Begin();
-        BucketType::ConstIterator end = m_table[idx].End();
-        for ( ; it != end; ++it )
+        if ( capacity > m_capacity )
         {
-            if ( key == it->m_key )
+            Rehash( capacity, m_overflow );
+        }
+    }
+
+    template< typename T, typename K, typename H, typename Alloc >
+    void HashTable< T, K, H, Alloc >::Clear()
+    {
+        if ( m_count == 0 )
+        {
+            return;
+        }
+
+        const SizeType slotCount = m_capacity + m_overflow;
+        for ( SizeType i=0; i<slotCount; ++i )
+        {
+            if ( mp_tags[ i ] )
+            {
+                mp_slots[ i ].~Pair();
+                mp_tags[ i ] = 0;
+            }
+        }
+
+        m_count = 0;
+        m_maxProbe = 0;
+    }
+
+    template< typename T, typename K, typename H, typename Alloc >
+    void HashTable< T, K, H, Alloc >::Dump( IArray< ValueType >& dmp ) const
+    {
+        if ( m_count == 0 )
+        {
+            return;
+        }
+
+        const SizeType slotCount = m_capacity + m_overflow;
+        for ( SizeType i=0; i<slotCount; ++i )
+        {
+            if ( mp_tags[ i ] )
+            {
+                dmp.PushBack( mp_slots[ i ].m_value );
+            }
+        }
+    }
+
+    template< typename T, typename K, typename H, typename Alloc >
+    U8 HashTable< T, K, H, Alloc >::MakeTag( U32 hash )
+    {
+        return static_cast< U8 >( 0x80 | ( hash >> 25 ) );
+    }
+
+    template< typename T, typename K, typename H, typename Alloc >
+    typename HashTable< T, K, H, Alloc >::SizeType HashTable< T, K, H, Alloc >::FindSlot( const KeyType& key ) const
+    {
+        const SizeType notFound = m_capacity + m_overflow;
+        if ( m_count == 0 )
+        {
+            return notFound;
+        }
+
+        const U32 hash      = H::Hash( key );
+        const U8 tag        = MakeTag( hash );
+        const SizeType home = hash & ( m_capacity - 1 );
+
+        // an element is at most m_maxProbe slots after its home slot
+        for ( SizeType group = home; group <= home + m_maxProbe; group += HashGroup::ms_size )
+        {
+            U32 mask = HashGroup::Match( mp_tags + group, tag );
+            while ( mask )
             {
-                m_table[idx].Remove( it );
-                break;
+                const SizeType idx = group + HashGroup::FirstBit( mask );
+                if ( mp_slots[ idx ].m_key == key )
+                {
+                    return idx;
+                }
+                mask &= mask - 1;
             }
         }
+
+        return notFound;
     }
 
-    template< typename T, typename K, SizeT S, typename Alloc >
-    typename HashTable< T, K, S, Alloc >::ConstPointer HashTable< T, K, S, Alloc >::Find( KeyType key ) const
+    template< typename T, typename K, typename H, typename Alloc >
+    void HashTable< T, K, H, Alloc >::InsertNew( U32 hash, Pair& pair )
     {
-        SizeT idx = key % S;
+        // when the overflow is full pair is swapped with the element which didn't fit,
+        // grow and insert it instead
+        while ( ! TryInsert( hash, pair ) )
+        {
+            if ( m_count * 2 < m_capacity )
+            {
+                CARBON_ASSERT( 2 * m_overflow <= ms_maxOverflow );
+                Rehash( m_capacity, 2 * m_overflow );
+            }
+            else
+            {
+                Rehash( 2 * m_capacity, m_overflow );
+            }
+            hash = H::Hash( pair.m_key );
+        }
+    }
 
-        BucketType::ConstIterator it = m_table[idx].Begin();
-        BucketType::ConstIterator end = m_table[idx].End();
-        for ( ; it != end; ++it )
+    template< typename T, typename K, typename H, typename Alloc >
+    Bool HashTable< T, K, H, Alloc >::TryInsert( U32 hash, Pair& pair )
+    {
+        SizeType idx    = hash & ( m_capacity - 1 );
+        SizeType dist   = 0;
+        U8 tag          = MakeTag( hash );
+
+        for ( ; dist < m_overflow; ++idx, ++dist )
         {
-            if ( key == it->m_key )
+            if ( mp_tags[ idx ] == 0 )
             {
-                value = &(it->m_value);
+                ::new( &mp_slots[ idx ] ) Pair( Move( pair ) );
+                mp_tags[ idx ]      = tag;
+                mp_distances[ idx ] = static_cast< U16 >( dist );
+                if ( dist > m_maxProbe )
+                {
+                    m_maxProbe = dist;
+                }
+                return true;
+            }
+
+            if ( mp_distances[ idx ] < dist )
+            {
+                // take the place of the richer element and carry it on
+                Pair tmp( Move( mp_slots[ idx ] ) );
+                mp_slots[ idx ] = Move( pair );
+                pair = Move( tmp );
+
+                const U8 t = mp_tags[ idx ];
+                mp_tags[ idx ] = tag;
+                tag = t;
+
+                const SizeType d = mp_distances[ idx ];
+                mp_distances[ idx ] = static_cast< U16 >( dist );
+                if ( dist > m_maxProbe )
+                {
+                    m_maxProbe = dist;
+                }
+                dist = d;
             }
         }
 
-        return 0;
+        return false;
     }
 
-    template< typename T, typename K, SizeT S, typename Alloc >
-    typename HashTable< T, K, S, Alloc >::Pointer HashTable< T, K, S, Alloc >::Find( KeyType key )
+    template< typename T, typename K, typename H, typename Alloc >
+    void HashTable< T, K, H, Alloc >::Rehash( SizeType capacity, SizeType overflow )
     {
-        SizeT idx = key % S;
+        CARBON_ASSERT( ( capacity & ( capacity - 1 ) ) == 0 );
+
+        Pair * slots            = mp_slots;
+        U8 * tags               = mp_tags;
+        const SizeType count    = slots ? m_capacity + m_overflow : 0;
+
+        // slots, then distances, then tags with a group of padding for the last loads
+        const SizeType slotCount    = capacity + overflow;
+        const SizeType distOffset   = MemoryUtils::GetNextAlignedAddress( slotCount * sizeof( Pair ), MemoryUtils::AlignOf< U16 >() );
+        const SizeType tagOffset    = distOffset + slotCount * sizeof( U16 );
+        const SizeType align        = MemoryUtils::AlignOf< Pair >();
+
+        U8 * memory = static_cast< U8 * >( Alloc::Allocate( tagOffset + slotCount + HashGroup::ms_size, ( align > 2 ) ? align : 2 ) );
+        mp_slots        = reinterpret_cast< Pair * >( memory );
+        mp_distances    = reinterpret_cast< U16 * >( memory + distOffset );
+        mp_tags         = memory + tagOffset;
+        m_capacity      = capacity;
+        m_overflow      = overflow;
+        m_maxProbe      = 0;
 
-        BucketType::Iterator it = m_table[idx].Begin();
-        BucketType::ConstIterator end = m_table[idx].End();
-        for ( ; it != end; ++it )
+        MemoryUtils::MemSet( mp_tags, 0, slotCount + HashGroup::ms_size );
+
+        for ( SizeType i=0; i<count; ++i )
         {
-            if ( key == it->m_key )
+            if ( tags[ i ] )
             {
-                return &(it->m_value);
+                InsertNew( H::Hash( slots[ i ].m_key ), slots[ i ] );
+                slots[ i ].~Pair();
             }
         }
 
-        return 0;
+        Alloc::Deallocate( slots );
     }
 
-    template< typename T, typename K, SizeT S, typename Alloc >
-    void HashTable< T, K, S, Alloc >::Clear()
+    template< typename T, typename K, typename H, typename Alloc >
+    void HashTable< T, K, H, Alloc >::Destroy()
     {
-        BucketType * b = m_table;
-        BucketType * end = m_table + S;
-        for ( ; b != end; ++b )
+        if ( mp_slots )
         {
-            b->Clear();
+            Clear();
+            Alloc::Deallocate( mp_slots );
         }
+
+        mp_slots        = 0;
+        mp_tags         = 0;
+        mp_distances    = 0;
+        m_capacity      = 0;
     }
 
     //========================================================================== HashTable
 }
 
+#if defined( CARBON_PLATFORM_WIN32 )
+    #include "Core/ps/win32/HashTable.inl"
+#else
+    #error HashTable not defined
+#endif
+
 #endif // _CORE_HASHTABLE_H
@@ -0,0 +1,11 @@
+#pragma once
+#ifndef _CORE_INTRINSICS256_H
+#define _CORE_INTRINSICS256_H
+
+#if defined( CARBON_PLATFORM_WIN32 )
+    #include "Core/ps/win32/Intrinsics256.inl"
+#else
+    #error Intrinsics256 not defined
+#endif
+
+#endif // _CORE_INTRINSICS256_H
@@ -0,0 +1,106 @@
+#pragma once
+#ifndef _CORE_JOBSYSTEM_H
+#define _CORE_JOBSYSTEM_H
+
+#include "Core/Types.h"
+#include "Core/DLL.h"
+#include "Core/Atomic.h"
+#include "Core/SpinLock.h"
+
+namespace Core
+{
+    typedef void ( *JobFunction )( void * data );
+
+    // Function called on the items [ begin, end ) of a ParallelFor
+    typedef void ( *RangeFunction )( SizeT begin, SizeT end, void * data );
+
+    struct Job
+    {
+        JobFunction     m_function;
+        void *          m_data;
+    };
+
+    struct JobContinuation;
+
+    //====================================================================================
+    // JobCounter
+    //====================================================================================
+
+    // Count of the jobs left in a group, updated by the JobSystem only. Jobs can be run
+    // after a group is done, the counter must outlive its jobs and the jobs depending on it :
+    // it can be released once JobSystem::Wait returned, not as soon as IsDone is true.
+
+    struct JobCounter
+    {
+        JobCounter();
+
+        Bool                IsDone() const;
+
+        volatile S32        m_count;
+        SpinLock            m_lock;             // protects the continuations
+        JobContinuation *   m_continuations;
+    };
+
+    //========================================================================= JobCounter
+
+    //====================================================================================
+    // JobSystem
+    //====================================================================================
+
+    // Work stealing scheduler. Each thread owns a Chase-Lev deque : it pushes and pops
+    // its jobs at the bottom, idle threads steal from the top of the others. The thread
+    // calling Initialize owns deque 0 and runs jobs while it waits. Other threads, an
+    // I/O thread for instance, push to a shared queue the workers take from first.
+    //
+    //      JobCounter counter;
+    //      JobSystem::Run( jobs, count, &counter );
+    //      JobSystem::RunAfter( counter, &finalize, 1, &finalizeCounter );
+    //      JobSystem::Wait( &finalizeCounter );
+
+    class _CoreExport JobSystem
+    {
+    public:
+        static const SizeT ms_maxWorkerCount    = 16;
+        static const SizeT ms_maxQueuedJobCount = 4096;     // per thread, power of 2
+
+        // workerCount threads are started besides the calling one, usually
+        // GetHardwareThreadCount() - 1. Without workers jobs run in Wait.
+        static void     Initialize( SizeT workerCount );
+        static void     Destroy();
+
+        static SizeT    GetWorkerCount();
+        static SizeT    GetHardwareThreadCount();
+
+        // counter can be null when nobody waits for the jobs
+        static void     Run( const Job * jobs, SizeT count, JobCounter * counter );
+        static void     Run( JobFunction function, void * data, JobCounter * counter );
+
+        // Jobs started once dependency is done
+        static void     RunAfter( JobCounter& dependency, const Job * jobs, SizeT count, JobCounter * counter );
+
+        // Runs queued jobs until the counter is done
+        static void     Wait( JobCounter * counter );
+
+        // Runs one queued or stolen job, false when none was found
+        static Bool     RunPendingJob();
+
+        // Splits [ 0, count ) in ranges of grain items, shared by the workers and the
+        // calling thread. A grain of 0 is chosen from the count and the worker count.
+        static void     ParallelFor( SizeT count, SizeT grain, RangeFunction function, void * data );
+    };
+
+    //========================================================================== JobSystem
+
+    inline JobCounter::JobCounter()
+        : m_count( 0 )
+        , m_continuations( 0 )
+    {
+    }
+
+    inline Bool JobCounter::IsDone() const
+    {
+        return AtomicLoad( &m_count ) == 0;
+    }
+}
+
+#endif // _CORE_JOBSYSTEM_H
@@ -0,0 +1,178 @@
+#include "Core/LinearArena.h"
+
+#include "Core/NativeAllocator.h"
+#include "Core/MemoryUtils.h"
+#include "Core/Assert.h"
+
+namespace Core
+{
+    //====================================================================================
+    // LinearArena
+    //====================================================================================
+
+    const SizeT pageAlignment   = 16;
+    const SizeT headerSize      = pageAlignment;   // keep the page data aligned
+
+    LinearArena::LinearArena()
+        : mp_first( 0 ), mp_current( 0 ), m_head( 0 ), m_end( 0 ), m_pageSize( 0 ), m_used( 0 ), m_peak( 0 ), m_highWaterMark( 0 )
+    {
+    }
+
+    void LinearArena::Initialize( SizeT pageSize )
+    {
+        CARBON_COMPILE_TIME_ASSERT( sizeof(Page) <= headerSize );
+        CARBON_ASSERT( pageSize > 0 );
+        CARBON_ASSERT( mp_first == 0 );
+
+        m_pageSize      = pageSize;
+        m_used          = 0;
+        m_peak          = 0;
+        m_highWaterMark = 0;
+
+        mp_first = CreatePage( pageSize );
+        SetCurrentPage( mp_first );
+    }
+
+    void LinearArena::Destroy()
+    {
+        DestroyPages( mp_first );
+        mp_first = mp_current = 0;
+        m_head = m_end = 0;
+        m_used = m_peak = 0;
+    }
+
+    Bool LinearArena::IsInitialized() const
+    {
+        return mp_first != 0;
+    }
+
+    void * LinearArena::Allocate( SizeT sizeBytes, SizeT align )
+    {
+        CARBON_ASSERT( mp_first );
+
+        SizeT a = MemoryUtils::GetNextAlignedAddress( m_head, align );
+
+        if ( a + sizeBytes > m_end )
+        {
+            // chain an overflow page big enough for this request
+            SizeT size = sizeBytes + align;
+            if ( size < m_pageSize )
+            {
+                size = m_pageSize;
+            }
+
+            m_used += m_end - m_head;   // lost at the end of the previous page
+
+            Page * page = CreatePage( size );
+            mp_current->m_next = page;
+            SetCurrentPage( page );
+
+            a = MemoryUtils::GetNextAlignedAddress( m_head, align );
+        }
+
+        m_used += ( a + sizeBytes ) - m_head;
+        m_head = a + sizeBytes;
+
+        if ( m_used > m_peak )
+        {
+            m_peak = m_used;
+            if ( m_peak > m_highWaterMark )
+            {
+                m_highWaterMark = m_peak;
+            }
+        }
+
+        return reinterpret_cast< void * >( a );
+    }
+
+    void LinearArena::Reset()
+    {
+        CARBON_ASSERT( mp_first );
+
+        // the peak can come from overflow pages already released by Rewind
+        if ( m_peak > mp_first->m_size )
+        {
+            // grow the first page so the next cycle fits in it
+            SizeT size = mp_first->m_size;
+            while ( size < m_peak )
+            {
+                size *= 2;
+            }
+
+            DestroyPages( mp_first );
+            mp_first = CreatePage( size );
+        }
+
+        SetCurrentPage( mp_first );
+        m_used = m_peak = 0;
+    }
+
+    LinearArena::Marker LinearArena::GetMarker() const
+    {
+        Marker marker = { mp_current, m_head, m_used };
+        return marker;
+    }
+
+    void LinearArena::Rewind( const Marker& marker )
+    {
+        CARBON_ASSERT( mp_first );
+        CARBON_ASSERT( marker.m_used <= m_used );
+
+        Page * page = static_cast< Page * >( marker.m_page );
+
+        if ( page != mp_current )
+        {
+            DestroyPages( page->m_next );
+            page->m_next = 0;
+            SetCurrentPage( page );
+        }
+
+        CARBON_ASSERT( marker.m_head >= reinterpret_cast< SizeT >( page ) + headerSize && marker.m_head <= m_end );
+
+        m_head = marker.m_head;
+        m_used = marker.m_used;
+    }
+
+    SizeT LinearArena::GetUsedBytes() const
+    {
+        return m_used;
+    }
+
+    SizeT LinearArena::GetPeakBytes() const
+    {
+        return m_peak;
+    }
+
+    SizeT LinearArena::GetHighWaterMark() const
+    {
+        return m_highWaterMark;
+    }
+
+    LinearArena::Page * LinearArena::CreatePage( SizeT sizeBytes )
+    {
+        Page * page     = static_cast< Page * >( NativeAllocator::Malloc( headerSize + sizeBytes, pageAlignment ) );
+        page->m_next    = 0;
+        page->m_size    = sizeBytes;
+
+        return page;
+    }
+
+    void LinearArena::SetCurrentPage( Page * page )
+    {
+        mp_current  = page;
+        m_head      = reinterpret_cast< SizeT >( page ) + headerSize;
+        m_end       = m_head + page->m_size;
+    }
+
+    void LinearArena::DestroyPages( Page * page )
+    {
+        while ( page )
+        {
+            Page * next = page->m_next;
+            NativeAllocator::Free( page );
+            page = next;
+        }
+    }
+
+    //======================================================================== LinearArena
+}
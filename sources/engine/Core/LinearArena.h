@@ -0,0 +1,72 @@
+#pragma once
+#ifndef _CORE_LINEARARENA_H
+#define _CORE_LINEARARENA_H
+
+#include "Core/Types.h"
+#include "Core/DLL.h"
+
+namespace Core
+{
+    //====================================================================================
+    // LinearArena
+    //====================================================================================
+
+    // Linear allocator owning its memory. When the current page is full a new page is
+    // chained instead of failing. On Reset the overflow pages are released and the first
+    // page grows to the amount used, so the arena converges to a single page.
+    // Scratch memory can be given back early by rewinding to a marker (see StackScope),
+    // pages chained after the marker are released.
+    // Not thread safe : one arena is meant to be used by one thread at a time.
+
+    class _CoreExport LinearArena
+    {
+    public:
+        struct Marker
+        {
+            void *  m_page;
+            SizeT   m_head;
+            SizeT   m_used;
+        };
+
+        LinearArena();
+
+        void    Initialize( SizeT pageSize );
+        void    Destroy();
+
+        Bool    IsInitialized() const;
+
+        void *  Allocate( SizeT sizeBytes, SizeT align = 1 );
+        void    Reset();
+
+        Marker  GetMarker() const;
+        void    Rewind( const Marker& marker );
+
+        SizeT   GetUsedBytes() const;
+        SizeT   GetPeakBytes() const;           // max of used bytes since the last Reset
+        SizeT   GetHighWaterMark() const;       // max of used bytes since Initialize
+
+    private:
+        struct Page
+        {
+            Page *  m_next;
+            SizeT   m_size;
+        };
+
+        Page *  CreatePage( SizeT sizeBytes );
+        void    DestroyPages( Page * page );
+        void    SetCurrentPage( Page * page );
+
+        Page *  mp_first;
+        Page *  mp_current;
+        SizeT   m_head;
+        SizeT   m_end;
+        SizeT   m_pageSize;
+        SizeT   m_used;
+        SizeT   m_peak;
+        SizeT   m_highWaterMark;
+    };
+
+    //======================================================================== LinearArena
+}
+
+#endif // _CORE_LINEARARENA_H
@@ -329,6 +329,38 @@ namespace Core
         return Add( l, r );
     }
 
+    // Affine matrices, last row is [ 0 0 0 1 ]
+    inline Matrix MulAffine( const Matrix& l, const Matrix& r )
+    {
+        Matrix m;
+        m.m_column[ 0 ] = TransformVector( l, r.m_column[ 0 ] );
+        m.m_column[ 1 ] = TransformVector( l, r.m_column[ 1 ] );
+        m.m_column[ 2 ] = TransformVector( l, r.m_column[ 2 ] );
+        m.m_column[ 3 ] = TransformVertex( l, r.m_column[ 3 ] );
+        return m;
+    }
+
+    inline Matrix AffineInverse( const Matrix& m )
+    {
+        // rows of the 3x3 inverse are the cross products of the columns, over the determinant
+        Vector row0     = Cross( m.m_column[ 1 ], m.m_column[ 2 ] );
+        Vector row1     = Cross( m.m_column[ 2 ], m.m_column[ 0 ] );
+        Vector row2     = Cross( m.m_column[ 0 ], m.m_column[ 1 ] );
+
+        Vector invDet   = Div( Splat( 1.0f ), Dot( m.m_column[ 0 ], row0 ) );
+
+        Matrix inv;
+        inv.m_column[ 0 ]   = Mul( row0, invDet );
+        inv.m_column[ 1 ]   = Mul( row1, invDet );
+        inv.m_column[ 2 ]   = Mul( row2, invDet );
+        inv.m_column[ 3 ]   = UnitW();
+        inv                 = Transpose( inv );
+
+        Vector translation  = Neg( TransformVector( inv, m.m_column[ 3 ] ) );
+        inv.m_column[ 3 ]   = Select( translation, One4(), Mask< 0, 0, 0, 1 >() );
+        return inv;
+    }
+
     // Units
     inline Matrix Identity()
     {
@@ -1,7 +1,13 @@
 #include "Core/MemoryManager.h"
 
 #include "Core/NativeAllocator.h"
-#include "Core/StackAllocator.h"
+#include "Core/SmallObjectAllocator.h"
+#include "Core/LinearArena.h"
+#include "Core/Thread.h"
+#include "Core/MemoryUtils.h"
+#include "Core/Atomic.h"
+#include "Core/StringUtils.h"
+#include "Core/Trace.h"
 
 #include "Core/Assert.h"
 
@@ -11,46 +17,466 @@ namespace Core
     // MemoryManager
     //====================================================================================
 
-    static void *           frameAllocatorBuffer = 0;
-    static StackAllocator   frameAllocator;
+    // One linear arena per thread and per buffered frame.
+    // The arenas of a frame are reset only when the frame index comes back to it, so
+    // data allocated during a frame stays valid for the next frameBufferCount-1 frames.
 
-    void MemoryManager::Initialize( SizeT frameAllocatorSize )
+    static LinearArena  frameArenas[ MemoryManager::ms_maxFrameBufferCount ][ Thread::ms_maxThreadCount ];
+    static SizeT        frameArenaSize          = 0;
+    static SizeT        frameBufferCount        = 0;
+    static SizeT        frameIndex              = 0;
+    static SizeT        frameHighWaterMark      = 0;
+    static SizeT        framePeakHighWaterMark  = 0;
+
+    static LinearArena& GetFrameArena()
     {
-        CARBON_ASSERT( frameAllocatorBuffer == 0 );
-        frameAllocatorBuffer = Malloc( frameAllocatorSize );
-        frameAllocator.Initialize( frameAllocatorBuffer, frameAllocatorSize );
+        CARBON_ASSERT( frameArenaSize > 0 );
+
+        LinearArena& arena = frameArenas[ frameIndex ][ Thread::GetCurrentIndex() ];
+        if ( ! arena.IsInitialized() )
+        {
+            arena.Initialize( frameArenaSize );
+        }
+
+        return arena;
     }
 
-    void MemoryManager::Destroy()
+    inline Bool IsSmallObject( SizeT sizeBytes, SizeT align )
     {
-        frameAllocator.Destroy();
-        Free( frameAllocatorBuffer );
-        frameAllocatorBuffer = 0;
+        return ( sizeBytes <= SmallObjectAllocator::ms_maxBlockSize ) && ( align <= SmallObjectAllocator::ms_granularity );
     }
 
-    void * MemoryManager::Malloc( SizeT sizeBytes, SizeT align )
+    static void * RawMalloc( SizeT sizeBytes, SizeT align )
     {
+        if ( IsSmallObject( sizeBytes, align ) )
+        {
+            void * ptr = SmallObjectAllocator::Allocate( sizeBytes );
+            if ( ptr )
+            {
+                return ptr;
+            }
+        }
+
         return NativeAllocator::Malloc( sizeBytes, align );
     }
 
-    void * MemoryManager::Realloc( void * ptr, SizeT sizeBytes, SizeT align )
+    static void * RawRealloc( void * ptr, SizeT sizeBytes, SizeT align )
+    {
+        if ( ! SmallObjectAllocator::IsOwner( ptr ) )
+        {
+            return ptr ? NativeAllocator::Realloc( ptr, sizeBytes, align ) : RawMalloc( sizeBytes, align );
+        }
+
+        const SizeT blockSize = SmallObjectAllocator::GetBlockSize( ptr );
+        if ( sizeBytes <= blockSize && align <= SmallObjectAllocator::ms_granularity )
+        {
+            return ptr;
+        }
+
+        void * newPtr = RawMalloc( sizeBytes, align );
+        MemoryUtils::MemCpy( newPtr, ptr, ( sizeBytes < blockSize ) ? sizeBytes : blockSize );
+        SmallObjectAllocator::Free( ptr );
+
+        return newPtr;
+    }
+
+    static void RawFree( void * ptr )
+    {
+        if ( SmallObjectAllocator::IsOwner( ptr ) )
+        {
+            SmallObjectAllocator::Free( ptr );
+        }
+        else
+        {
+            NativeAllocator::Free( ptr );
+        }
+    }
+
+#if defined( CARBON_TRACK_MEMORY )
+
+    // Small blocks keep their tag in the small object allocator and are counted by their
+    // block size, so tracking does not change which allocator serves a request.
+    // Other tracked blocks are preceded by a header holding their size and tag, the
+    // header is padded to the block alignment so the user pointer keeps it.
+    //
+    //  | padding | AllocHeader | user data ... |
+    //  ^ base               ptr ^
+
+    struct AllocHeader
+    {
+        SizeT       m_size;
+        U16         m_offset;       // from the block base to the user pointer
+        U16         m_tag;
+    };
+
+    static const SizeT minHeaderAlign = 16;
+
+    struct TagCounters
+    {
+        volatile S32    m_liveBytes;
+        volatile S32    m_peakBytes;
+        volatile S32    m_allocCount;
+        volatile S32    m_frameAllocCount;
+        S32             m_lastFrameAllocCount;
+    };
+
+    // Not reset by Initialize : blocks allocated before it are still released through Free
+    static TagCounters tagCounters[ MEMORY_TAG_COUNT ];
+
+    inline SizeT HeaderOffset( SizeT align )
+    {
+        return ( align > minHeaderAlign ) ? align : minHeaderAlign;
+    }
+
+    inline AllocHeader * GetHeader( void * ptr )
+    {
+        return reinterpret_cast< AllocHeader * >( ptr ) - 1;
+    }
+
+    static void TrackAlloc( MemoryTag tag, SizeT sizeBytes )
+    {
+        TagCounters& counters = tagCounters[ tag ];
+
+        const S32 live = AtomicAdd( &counters.m_liveBytes, (S32)sizeBytes );
+        AtomicIncrement( &counters.m_allocCount );
+        AtomicIncrement( &counters.m_frameAllocCount );
+
+        S32 peak = AtomicLoad( &counters.m_peakBytes );
+        while ( live > peak )
+        {
+            const S32 prev = AtomicCompareExchange( &counters.m_peakBytes, live, peak );
+            if ( prev == peak )
+            {
+                break;
+            }
+            peak = prev;
+        }
+    }
+
+    static void TrackFree( MemoryTag tag, SizeT sizeBytes )
     {
-        return NativeAllocator::Realloc( ptr, sizeBytes, align );
+        AtomicAdd( &tagCounters[ tag ].m_liveBytes, - (S32)sizeBytes );
+    }
+
+    static void * TrackedMalloc( SizeT sizeBytes, SizeT align, MemoryTag tag )
+    {
+        CARBON_COMPILE_TIME_ASSERT( sizeof( AllocHeader ) <= minHeaderAlign );
+        CARBON_ASSERT( tag < MEMORY_TAG_COUNT );
+
+        if ( IsSmallObject( sizeBytes, align ) )
+        {
+            void * ptr = SmallObjectAllocator::Allocate( sizeBytes );
+            if ( ptr )
+            {
+                SmallObjectAllocator::SetTag( ptr, (U8)tag );
+                TrackAlloc( tag, SmallObjectAllocator::GetBlockSize( ptr ) );
+                return ptr;
+            }
+        }
+
+        const SizeT offset = HeaderOffset( align );
+
+        U8 * base = static_cast< U8 * >( NativeAllocator::Malloc( sizeBytes + offset, offset ) );
+        if ( ! base )
+        {
+            return 0;
+        }
+
+        void * ptr = base + offset;
+
+        AllocHeader * header = GetHeader( ptr );
+        header->m_size      = sizeBytes;
+        header->m_offset    = (U16)offset;
+        header->m_tag       = (U16)tag;
+
+        TrackAlloc( tag, sizeBytes );
+
+        return ptr;
+    }
+
+    static void TrackedFree( void * ptr )
+    {
+        if ( ! ptr )
+        {
+            return;
+        }
+
+        if ( SmallObjectAllocator::IsOwner( ptr ) )
+        {
+            TrackFree( MemoryTag( SmallObjectAllocator::GetTag( ptr ) ), SmallObjectAllocator::GetBlockSize( ptr ) );
+            SmallObjectAllocator::Free( ptr );
+            return;
+        }
+
+        AllocHeader * header = GetHeader( ptr );
+        TrackFree( MemoryTag( header->m_tag ), header->m_size );
+
+        NativeAllocator::Free( static_cast< U8 * >( ptr ) - header->m_offset );
+    }
+
+    static void * TrackedRealloc( void * ptr, SizeT sizeBytes, SizeT align, MemoryTag tag )
+    {
+        if ( ! ptr )
+        {
+            return TrackedMalloc( sizeBytes, align, tag );
+        }
+
+        if ( SmallObjectAllocator::IsOwner( ptr ) )
+        {
+            const SizeT blockSize = SmallObjectAllocator::GetBlockSize( ptr );
+            if ( sizeBytes <= blockSize && align <= SmallObjectAllocator::ms_granularity )
+            {
+                TrackFree( MemoryTag( SmallObjectAllocator::GetTag( ptr ) ), blockSize );
+                SmallObjectAllocator::SetTag( ptr, (U8)tag );
+                TrackAlloc( tag, blockSize );
+                return ptr;
+            }
+
+            void * newPtr = TrackedMalloc( sizeBytes, align, tag );
+            if ( newPtr )
+            {
+                MemoryUtils::MemCpy( newPtr, ptr, ( sizeBytes < blockSize ) ? sizeBytes : blockSize );
+                TrackedFree( ptr );
+            }
+            return newPtr;
+        }
+
+        AllocHeader * header = GetHeader( ptr );
+        const SizeT offset = HeaderOffset( align );
+
+        if ( header->m_offset != offset )
+        {
+            // The header layout changes with the alignment, move the block
+            void * newPtr = TrackedMalloc( sizeBytes, align, tag );
+            MemoryUtils::MemCpy( newPtr, ptr, ( sizeBytes < header->m_size ) ? sizeBytes : header->m_size );
+            TrackedFree( ptr );
+            return newPtr;
+        }
+
+        const SizeT oldSize     = header->m_size;
+        const MemoryTag oldTag  = MemoryTag( header->m_tag );
+
+        U8 * base = static_cast< U8 * >( NativeAllocator::Realloc( static_cast< U8 * >( ptr ) - offset, sizeBytes + offset, offset ) );
+        if ( ! base )
+        {
+            return 0;
+        }
+
+        TrackFree( oldTag, oldSize );
+
+        void * newPtr = base + offset;
+
+        header = GetHeader( newPtr );
+        header->m_size  = sizeBytes;
+        header->m_tag   = (U16)tag;
+
+        TrackAlloc( tag, sizeBytes );
+
+        return newPtr;
+    }
+
+#endif // CARBON_TRACK_MEMORY
+
+    static const Char * tagNames[ MEMORY_TAG_COUNT ] =
+    {
+        "Core",
+        "Graphic",
+        "Resource",
+        "Frame",
+        "Tools"
+    };
+
+    void MemoryManager::Initialize( SizeT frameAllocatorSize, SizeT bufferCount, SizeT smallObjectHeapSize )
+    {
+        CARBON_ASSERT( frameArenaSize == 0 );
+        CARBON_ASSERT( frameAllocatorSize > 0 );
+        CARBON_ASSERT( bufferCount > 0 && bufferCount <= ms_maxFrameBufferCount );
+
+        frameArenaSize          = frameAllocatorSize;
+        frameBufferCount        = bufferCount;
+        frameIndex              = 0;
+        frameHighWaterMark      = 0;
+        framePeakHighWaterMark  = 0;
+
+        SmallObjectAllocator::Initialize( smallObjectHeapSize );
+    }
+
+    void MemoryManager::Destroy()
+    {
+        for ( SizeT i=0; i<ms_maxFrameBufferCount; ++i )
+        {
+            for ( SizeT t=0; t<Thread::ms_maxThreadCount; ++t )
+            {
+                LinearArena& arena = frameArenas[ i ][ t ];
+                if ( arena.IsInitialized() )
+                {
+                    arena.Destroy();
+                }
+            }
+        }
+
+        frameArenaSize = 0;
+
+        SmallObjectAllocator::Destroy();
+    }
+
+    void * MemoryManager::Malloc( SizeT sizeBytes, SizeT align, MemoryTag tag )
+    {
+    #if defined( CARBON_TRACK_MEMORY )
+        return TrackedMalloc( sizeBytes, align, tag );
+    #else
+        return RawMalloc( sizeBytes, align );
+    #endif
+    }
+
+    void * MemoryManager::Realloc( void * ptr, SizeT sizeBytes, SizeT align, MemoryTag tag )
+    {
+    #if defined( CARBON_TRACK_MEMORY )
+        return TrackedRealloc( ptr, sizeBytes, align, tag );
+    #else
+        return RawRealloc( ptr, sizeBytes, align );
+    #endif
     }
 
     void MemoryManager::Free( void * ptr )
     {
-        NativeAllocator::Free( ptr );
+    #if defined( CARBON_TRACK_MEMORY )
+        TrackedFree( ptr );
+    #else
+        RawFree( ptr );
+    #endif
     }
 
     void MemoryManager::FrameUpdate()
     {
-        frameAllocator.Clear();
+        // Measure the frame which ends
+        SizeT used = 0;
+        for ( SizeT t=0; t<Thread::ms_maxThreadCount; ++t )
+        {
+            const LinearArena& arena = frameArenas[ frameIndex ][ t ];
+            if ( arena.IsInitialized() )
+            {
+                used += arena.GetPeakBytes();
+            }
+        }
+
+        frameHighWaterMark = used;
+        if ( used > framePeakHighWaterMark )
+        {
+            framePeakHighWaterMark = used;
+        }
+
+        // Recycle the oldest frame
+        frameIndex = ( frameIndex + 1 ) % frameBufferCount;
+
+        for ( SizeT t=0; t<Thread::ms_maxThreadCount; ++t )
+        {
+            LinearArena& arena = frameArenas[ frameIndex ][ t ];
+            if ( arena.IsInitialized() )
+            {
+                arena.Reset();
+            }
+        }
+
+    #if defined( CARBON_TRACK_MEMORY )
+        // Live frame memory is what the buffered frames still hold
+        SizeT live = 0;
+        for ( SizeT i=0; i<frameBufferCount; ++i )
+        {
+            for ( SizeT t=0; t<Thread::ms_maxThreadCount; ++t )
+            {
+                const LinearArena& arena = frameArenas[ i ][ t ];
+                if ( arena.IsInitialized() )
+                {
+                    live += arena.GetUsedBytes();
+                }
+            }
+        }
+        AtomicStore( &tagCounters[ MEMORY_TAG_FRAME ].m_liveBytes, (S32)live );
+
+        for ( SizeT i=0; i<MEMORY_TAG_COUNT; ++i )
+        {
+            TagCounters& counters = tagCounters[ i ];
+            counters.m_lastFrameAllocCount = AtomicExchange( &counters.m_frameAllocCount, 0 );
+        }
+    #endif
     }
 
     void * MemoryManager::FrameAlloc( SizeT sizeBytes, SizeT align )
     {
-        return frameAllocator.Allocate( sizeBytes, align );
+    #if defined( CARBON_TRACK_MEMORY )
+        TrackAlloc( MEMORY_TAG_FRAME, sizeBytes );
+    #endif
+
+        return GetFrameArena().Allocate( sizeBytes, align );
+    }
+
+    MemoryManager::FrameMarker MemoryManager::GetFrameMarker()
+    {
+        return GetFrameArena().GetMarker();
+    }
+
+    void MemoryManager::RewindFrame( const FrameMarker& marker )
+    {
+        LinearArena& arena = GetFrameArena();
+
+    #if defined( CARBON_TRACK_MEMORY )
+        TrackFree( MEMORY_TAG_FRAME, arena.GetUsedBytes() - marker.m_used );
+    #endif
+
+        arena.Rewind( marker );
+    }
+
+    SizeT MemoryManager::GetFrameHighWaterMark()
+    {
+        return frameHighWaterMark;
+    }
+
+    SizeT MemoryManager::GetFramePeakHighWaterMark()
+    {
+        return framePeakHighWaterMark;
+    }
+
+    void MemoryManager::GetStats( MemoryTag tag, MemoryStats& stats )
+    {
+        CARBON_ASSERT( tag < MEMORY_TAG_COUNT );
+
+    #if defined( CARBON_TRACK_MEMORY )
+        const TagCounters& counters = tagCounters[ tag ];
+        stats.m_liveBytes       = AtomicLoad( &counters.m_liveBytes );
+        stats.m_peakBytes       = AtomicLoad( &counters.m_peakBytes );
+        stats.m_allocCount      = AtomicLoad( &counters.m_allocCount );
+        stats.m_frameAllocCount = counters.m_lastFrameAllocCount;
+    #else
+        MemoryUtils::MemSet( &stats, 0, sizeof( MemoryStats ) );
+    #endif
+    }
+
+    const Char * MemoryManager::GetTagName( MemoryTag tag )
+    {
+        CARBON_ASSERT( tag < MEMORY_TAG_COUNT );
+        return tagNames[ tag ];
+    }
+
+    void MemoryManager::DumpStats()
+    {
+    #if defined( CARBON_TRACK_MEMORY )
+        Char line[ 128 ];
+
+        CARBON_TRACE( "Memory    |   live bytes |   peak bytes |       allocs | frame allocs\n" );
+        for ( SizeT i=0; i<MEMORY_TAG_COUNT; ++i )
+        {
+            MemoryStats stats;
+            GetStats( MemoryTag( i ), stats );
+
+            CARBON_TRACE( StringUtils::FormatString( line, 128, "%-9s | %12u | %12u | %12u | %12u\n"
+                                                   , tagNames[ i ]
+                                                   , stats.m_liveBytes
+                                                   , stats.m_peakBytes
+                                                   , stats.m_allocCount
+                                                   , stats.m_frameAllocCount ) );
+        }
+    #endif
     }
 
     //====================================================================== MemoryManager
@@ -4,9 +4,41 @@
 
 #include "Core/DLL.h"
 #include "Core/Types.h"
+#include "Core/LinearArena.h"
+#include "Core/MemoryUtils.h"
+
+// Memory accounting costs a small header per large allocation and a few atomic
+// operations, it is compiled out of retail builds.
+#if ! defined( CARBON_RETAIL )
+    #define CARBON_TRACK_MEMORY
+#endif
 
 namespace Core
 {
+    //====================================================================================
+    // MemoryTag
+    //====================================================================================
+
+    enum MemoryTag
+    {
+        MEMORY_TAG_CORE = 0,
+        MEMORY_TAG_GRAPHIC,
+        MEMORY_TAG_RESOURCE,
+        MEMORY_TAG_FRAME,
+        MEMORY_TAG_TOOLS,
+        MEMORY_TAG_COUNT
+    };
+
+    struct MemoryStats
+    {
+        SizeT   m_liveBytes;            // bytes currently allocated
+        SizeT   m_peakBytes;            // max of live bytes since Initialize
+        SizeT   m_allocCount;           // allocations since Initialize
+        SizeT   m_frameAllocCount;      // allocations made during the last frame
+    };
+
+    //========================================================================== MemoryTag
+
     //====================================================================================
     // MemoryManager
     //====================================================================================
@@ -14,43 +46,93 @@ namespace Core
     class _CoreExport MemoryManager
     {
     public:
-        static void Initialize( SizeT frameAllocatorSize );
+        static const SizeT ms_maxFrameBufferCount = 3;
+        static const SizeT ms_defaultSmallObjectHeapSize = 16 * 1024 * 1024;
+
+        static void Initialize( SizeT frameAllocatorSize, SizeT frameBufferCount = 2, SizeT smallObjectHeapSize = ms_defaultSmallObjectHeapSize );
         static void Destroy();
 
-        static void * Malloc( SizeT sizeBytes, SizeT align = 1 );
-        static void * Realloc( void * ptr, SizeT sizeBytes, SizeT align = 1 );
+        // Blocks up to SmallObjectAllocator::ms_maxBlockSize bytes come from the size
+        // class allocator, bigger ones from the native allocator.
+        static void * Malloc( SizeT sizeBytes, SizeT align = 1, MemoryTag tag = MEMORY_TAG_CORE );
+        static void * Realloc( void * ptr, SizeT sizeBytes, SizeT align = 1, MemoryTag tag = MEMORY_TAG_CORE );
         static void Free( void * ptr );
 
+        // Frame memory is lock free : each thread allocates in its own arena.
+        // Data stays valid for frameBufferCount frames.
+        // FrameUpdate must be called while no other thread allocates frame memory.
         static void FrameUpdate();
         static void * FrameAlloc( SizeT sizeBytes, SizeT align = 1 );
+
+        // Scratch frame memory can be given back before the end of the frame by rewinding
+        // the calling thread arena to a marker taken earlier in the same frame (see FrameScope).
+        typedef LinearArena::Marker FrameMarker;
+        static FrameMarker GetFrameMarker();
+        static void RewindFrame( const FrameMarker& marker );
+
+        static SizeT GetFrameHighWaterMark();       // peak frame memory of the last frame, all threads
+        static SizeT GetFramePeakHighWaterMark();   // max of the above since Initialize
+
+        // Per tag statistics, all zero when CARBON_TRACK_MEMORY is not defined.
+        // Frame memory is accounted under MEMORY_TAG_FRAME.
+        static void GetStats( MemoryTag tag, MemoryStats& stats );
+        static const Char * GetTagName( MemoryTag tag );
+        static void DumpStats();
     };
 
     //====================================================================== MemoryManager
 
     //====================================================================================
-    // DefaultAllocator
+    // TaggedAllocator
     //====================================================================================
 
-    class DefaultAllocator
+    // Allocators used by containers provide Allocate, Deallocate, TryGrow and Reallocate.
+    // TryGrow extends a block in place when possible, containers reallocate otherwise.
+    // Reallocate moves the bytes of a block to a bigger or smaller one, it is only used
+    // for trivially relocatable elements.
+
+    template< MemoryTag TAG >
+    class TaggedAllocator
     {
     public:
         static void *   Allocate( SizeT sizeBytes, SizeT align = 1 );
         static void     Deallocate( void * ptr );
+        static Bool     TryGrow( void * ptr, SizeT sizeBytes );
+        static void *   Reallocate( void * ptr, SizeT oldSizeBytes, SizeT sizeBytes, SizeT align = 1 );
     };
 
-    //=================================================================== DefaultAllocator
+    //==================================================================== TaggedAllocator
 
-    inline void * DefaultAllocator::Allocate( SizeT sizeBytes, SizeT align )
+    template< MemoryTag TAG >
+    void * TaggedAllocator< TAG >::Allocate( SizeT sizeBytes, SizeT align )
     {
-        return MemoryManager::Malloc( sizeBytes, align );
+        return MemoryManager::Malloc( sizeBytes, align, TAG );
     }
 
-    inline void DefaultAllocator::Deallocate( void * ptr )
+    template< MemoryTag TAG >
+    void TaggedAllocator< TAG >::Deallocate( void * ptr )
     {
         MemoryManager::Free( ptr );
     }
 
-    //=================================================================== DefaultAllocator
+    template< MemoryTag TAG >
+    Bool TaggedAllocator< TAG >::TryGrow( void *, SizeT )
+    {
+        return false;
+    }
+
+    template< MemoryTag TAG >
+    void * TaggedAllocator< TAG >::Reallocate( void * ptr, SizeT, SizeT sizeBytes, SizeT align )
+    {
+        return MemoryManager::Realloc( ptr, sizeBytes, align, TAG );
+    }
+
+    typedef TaggedAllocator< MEMORY_TAG_CORE >      DefaultAllocator;
+    typedef TaggedAllocator< MEMORY_TAG_GRAPHIC >   GraphicAllocator;
+    typedef TaggedAllocator< MEMORY_TAG_RESOURCE >  UnknownAllocator;      // resource objects and loaded file data
+    typedef TaggedAllocator< MEMORY_TAG_TOOLS >     ToolsAllocator;
+
+    //==================================================================== TaggedAllocator
 
     //====================================================================================
     // FrameAllocator
@@ -61,6 +143,8 @@ namespace Core
     public:
         static void *   Allocate( SizeT sizeBytes, SizeT align = 1 );
         static void     Deallocate( void * ptr );
+        static Bool     TryGrow( void * ptr, SizeT sizeBytes );
+        static void *   Reallocate( void * ptr, SizeT oldSizeBytes, SizeT sizeBytes, SizeT align = 1 );
     };
 
     //===================================================================== FrameAllocator
@@ -75,32 +159,56 @@ namespace Core
         // Do nothing
     }
 
+    inline Bool FrameAllocator::TryGrow( void *, SizeT )
+    {
+        return false;
+    }
+
+    inline void * FrameAllocator::Reallocate( void * ptr, SizeT oldSizeBytes, SizeT sizeBytes, SizeT align )
+    {
+        void * newPtr = MemoryManager::FrameAlloc( sizeBytes, align );
+        if ( ptr )
+        {
+            MemoryUtils::MemCpy( newPtr, ptr, ( oldSizeBytes < sizeBytes ) ? oldSizeBytes : sizeBytes );
+        }
+        return newPtr;
+    }
+
     //===================================================================== FrameAllocator
 
     //====================================================================================
-    // UnknownAllocator
+    // FrameScope
     //====================================================================================
 
-    class UnknownAllocator
+    // Frame memory allocated by the current thread inside the scope is released
+    // when leaving it.
+
+    class FrameScope
     {
     public:
-        static void *   Allocate( SizeT sizeBytes, SizeT align = 1 );
-        static void     Deallocate( void * ptr );
+        FrameScope();
+        ~FrameScope();
+
+    private:
+        FrameScope( const FrameScope& );
+        FrameScope& operator=( const FrameScope& );
+
+        MemoryManager::FrameMarker m_marker;
     };
 
-    //==================================================================== UnknownAllocator
+    //========================================================================= FrameScope
 
-    inline void * UnknownAllocator::Allocate( SizeT sizeBytes, SizeT align )
+    inline FrameScope::FrameScope()
+        : m_marker( MemoryManager::GetFrameMarker() )
     {
-        return MemoryManager::Malloc( sizeBytes, align );
     }
 
-    inline void UnknownAllocator::Deallocate( void * ptr )
+    inline FrameScope::~FrameScope()
     {
-        MemoryManager::Free( ptr );
+        MemoryManager::RewindFrame( m_marker );
     }
 
-    //==================================================================== UnknownAllocator
+    //========================================================================= FrameScope
 }
 
 #endif // _CORE_MEMORYMANAGER_H
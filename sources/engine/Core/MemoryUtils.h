@@ -17,6 +17,7 @@ namespace Core
         static SizeT GetNextAlignedAddress( SizeT ptr, SizeT alignment );
 
         static void * MemCpy( void * dest, const void * src, SizeT sizeBytes );
+        static void * MemMove( void * dest, const void * src, SizeT sizeBytes );     // overlapping ranges
         static void * MemSet( void * ptr, U8 value, SizeT sizeBytes );
 
         template < typename T >
@@ -0,0 +1,169 @@
+#pragma once
+#ifndef _CORE_MPMCQUEUE_H
+#define _CORE_MPMCQUEUE_H
+
+#include "Core/Atomic.h"
+#include "Core/Assert.h"
+
+namespace Core
+{
+    //====================================================================================
+    // MpmcQueue
+    //====================================================================================
+
+    // Bounded queue between any number of producer and consumer threads, C is a power
+    // of 2. Each cell holds a sequence number telling which turn it is ready for :
+    //
+    //  sequence == position        free, for the producer claiming position
+    //  sequence == position + 1    full, for the consumer claiming position
+    //
+    // A position is claimed by one compare and swap, only retried under contention.
+
+    template< typename T, SizeT C >
+    class MpmcQueue
+    {
+    public:
+        typedef T           ValueType;
+        typedef const T&    ConstReference;
+        typedef T&          Reference;
+        typedef SizeT       SizeType;
+
+    public:
+        MpmcQueue();
+
+        Bool            Push( ConstReference value );       // false when full
+        Bool            Pop( Reference value );             // false when empty
+
+        // Snapshots, only exact while no thread is pushing or popping
+        Bool            Empty() const;
+        SizeType        Size() const;
+        SizeType        Capacity() const;
+
+    private:
+        MpmcQueue( const MpmcQueue& );
+        MpmcQueue& operator=( const MpmcQueue& );
+
+        struct Cell
+        {
+            volatile S32    m_sequence;
+            ValueType       m_value;
+        };
+
+        static const U32 ms_mask = C - 1;
+
+        volatile S32    m_head;
+        U8              m_pad0[ CARBON_CACHE_LINE_SIZE - sizeof( S32 ) ];
+        volatile S32    m_tail;
+        U8              m_pad1[ CARBON_CACHE_LINE_SIZE - sizeof( S32 ) ];
+        Cell            m_cells[ C ];
+    };
+
+    //========================================================================== MpmcQueue
+
+    template< typename T, SizeT C >
+    MpmcQueue< T, C >::MpmcQueue()
+        : m_head( 0 )
+        , m_tail( 0 )
+    {
+        CARBON_COMPILE_TIME_ASSERT( C > 0 && ( C & ( C - 1 ) ) == 0 );
+
+        for ( SizeT i=0; i<C; ++i )
+        {
+            m_cells[ i ].m_sequence = static_cast< S32 >( i );
+        }
+    }
+
+    template< typename T, SizeT C >
+    Bool MpmcQueue< T, C >::Push( ConstReference value )
+    {
+        U32 pos = AtomicLoad( &m_tail );
+
+        Cell * cell;
+        for ( ;; )
+        {
+            cell = &m_cells[ pos & ms_mask ];
+
+            const S32 diff = AtomicLoad( &cell->m_sequence ) - static_cast< S32 >( pos );
+            if ( diff == 0 )
+            {
+                const U32 prev = AtomicCompareExchange( &m_tail, static_cast< S32 >( pos + 1 ), static_cast< S32 >( pos ) );
+                if ( prev == pos )
+                {
+                    break;
+                }
+                pos = prev;
+            }
+            else if ( diff < 0 )
+            {
+                return false;                               // the cell still holds the previous lap
+            }
+            else
+            {
+                pos = AtomicLoad( &m_tail );                // another producer took it
+            }
+        }
+
+        cell->m_value = value;
+        AtomicStore( &cell->m_sequence, static_cast< S32 >( pos + 1 ) );
+        return true;
+    }
+
+    template< typename T, SizeT C >
+    Bool MpmcQueue< T, C >::Pop( Reference value )
+    {
+        U32 pos = AtomicLoad( &m_head );
+
+        Cell * cell;
+        for ( ;; )
+        {
+            cell = &m_cells[ pos & ms_mask ];
+
+            const S32 diff = AtomicLoad( &cell->m_sequence ) - static_cast< S32 >( pos + 1 );
+            if ( diff == 0 )
+            {
+                const U32 prev = AtomicCompareExchange( &m_head, static_cast< S32 >( pos + 1 ), static_cast< S32 >( pos ) );
+                if ( prev == pos )
+                {
+                    break;
+                }
+                pos = prev;
+            }
+            else if ( diff < 0 )
+            {
+                return false;                               // not written yet
+            }
+            else
+            {
+                pos = AtomicLoad( &m_head );                // another consumer took it
+            }
+        }
+
+        value = cell->m_value;
+        AtomicStore( &cell->m_sequence, static_cast< S32 >( pos + C ) );
+        return true;
+    }
+
+    template< typename T, SizeT C >
+    Bool MpmcQueue< T, C >::Empty() const
+    {
+        return Size() == 0;
+    }
+
+    template< typename T, SizeT C >
+    SizeT MpmcQueue< T, C >::Size() const
+    {
+        const U32 head = AtomicLoad( &m_head );
+        const U32 tail = AtomicLoad( &m_tail );
+        return tail - head;
+    }
+
+    template< typename T, SizeT C >
+    SizeT MpmcQueue< T, C >::Capacity() const
+    {
+        return C;
+    }
+
+    //========================================================================== MpmcQueue
+}
+
+#endif // _CORE_MPMCQUEUE_H
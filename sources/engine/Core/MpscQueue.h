@@ -0,0 +1,148 @@
+#pragma once
+#ifndef _CORE_MPSCQUEUE_H
+#define _CORE_MPSCQUEUE_H
+
+#include "Core/Atomic.h"
+#include "Core/Assert.h"
+
+namespace Core
+{
+    //====================================================================================
+    // MpscQueue
+    //====================================================================================
+
+    // Bounded queue from any number of producer threads to one consumer thread, C is a
+    // power of 2. Producers claim cells like MpmcQueue does, the consumer owns the head
+    // so popping is wait free and never compares and swaps.
+
+    template< typename T, SizeT C >
+    class MpscQueue
+    {
+    public:
+        typedef T           ValueType;
+        typedef const T&    ConstReference;
+        typedef T&          Reference;
+        typedef SizeT       SizeType;
+
+    public:
+        MpscQueue();
+
+        Bool            Push( ConstReference value );       // any thread, false when full
+        Bool            Pop( Reference value );             // consumer, false when empty
+
+        // Snapshots, only exact while no thread is pushing or popping
+        Bool            Empty() const;
+        SizeType        Size() const;
+        SizeType        Capacity() const;
+
+    private:
+        MpscQueue( const MpscQueue& );
+        MpscQueue& operator=( const MpscQueue& );
+
+        struct Cell
+        {
+            volatile S32    m_sequence;                     // position when free, position + 1 when full
+            ValueType       m_value;
+        };
+
+        static const U32 ms_mask = C - 1;
+
+        volatile S32    m_head;                             // consumer side
+        U8              m_pad0[ CARBON_CACHE_LINE_SIZE - sizeof( S32 ) ];
+        volatile S32    m_tail;
+        U8              m_pad1[ CARBON_CACHE_LINE_SIZE - sizeof( S32 ) ];
+        Cell            m_cells[ C ];
+    };
+
+    //========================================================================== MpscQueue
+
+    template< typename T, SizeT C >
+    MpscQueue< T, C >::MpscQueue()
+        : m_head( 0 )
+        , m_tail( 0 )
+    {
+        CARBON_COMPILE_TIME_ASSERT( C > 0 && ( C & ( C - 1 ) ) == 0 );
+
+        for ( SizeT i=0; i<C; ++i )
+        {
+            m_cells[ i ].m_sequence = static_cast< S32 >( i );
+        }
+    }
+
+    template< typename T, SizeT C >
+    Bool MpscQueue< T, C >::Push( ConstReference value )
+    {
+        U32 pos = AtomicLoad( &m_tail );
+
+        Cell * cell;
+        for ( ;; )
+        {
+            cell = &m_cells[ pos & ms_mask ];
+
+            const S32 diff = AtomicLoad( &cell->m_sequence ) - static_cast< S32 >( pos );
+            if ( diff == 0 )
+            {
+                const U32 prev = AtomicCompareExchange( &m_tail, static_cast< S32 >( pos + 1 ), static_cast< S32 >( pos ) );
+                if ( prev == pos )
+                {
+                    break;
+                }
+                pos = prev;
+            }
+            else if ( diff < 0 )
+            {
+                return false;
+            }
+            else
+            {
+                pos = AtomicLoad( &m_tail );
+            }
+        }
+
+        cell->m_value = value;
+        AtomicStore( &cell->m_sequence, static_cast< S32 >( pos + 1 ) );
+        return true;
+    }
+
+    template< typename T, SizeT C >
+    Bool MpscQueue< T, C >::Pop( Reference value )
+    {
+        const U32 pos = m_head;
+        Cell& cell = m_cells[ pos & ms_mask ];
+
+        // a claimed cell not written yet reads as empty, its producer is still copying
+        if ( AtomicLoad( &cell.m_sequence ) != static_cast< S32 >( pos + 1 ) )
+        {
+            return false;
+        }
+
+        value = cell.m_value;
+        AtomicStore( &cell.m_sequence, static_cast< S32 >( pos + C ) );
+        AtomicStore( &m_head, static_cast< S32 >( pos + 1 ) );
+        return true;
+    }
+
+    template< typename T, SizeT C >
+    Bool MpscQueue< T, C >::Empty() const
+    {
+        return Size() == 0;
+    }
+
+    template< typename T, SizeT C >
+    SizeT MpscQueue< T, C >::Size() const
+    {
+        const U32 head = AtomicLoad( &m_head );
+        const U32 tail = AtomicLoad( &m_tail );
+        return tail - head;
+    }
+
+    template< typename T, SizeT C >
+    SizeT MpscQueue< T, C >::Capacity() const
+    {
+        return C;
+    }
+
+    //========================================================================== MpscQueue
+}
+
+#endif // _CORE_MPSCQUEUE_H
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef _CORE_PACK_H
+#define _CORE_PACK_H
+
+#include "Core/Types.h"
+
+namespace Core
+{
+    //====================================================================================
+    // Pack
+    //====================================================================================
+
+    // Pack file, the files of a directory in one file found by the id of their path
+    // relative to that directory ( HashString, '/' separators, as Resource::MakeIdFromName ) :
+    //
+    //  | PackHeader | PackEntry[ slotCount ] | file data ... |
+    //
+    // The entries form an open addressing table of a power of 2 slot count : an id is
+    // looked up from slot id & ( slotCount - 1 ) to the next empty slot. Empty slots have
+    // a null offset. Entries and file data are aligned on ms_alignment bytes. File data
+    // may be stored compressed, see Compression::IsCompressed.
+    // Written by the PackCompiler tool.
+
+    struct PackHeader
+    {
+        static const U32 ms_magic       = 0x4b434150;      // "PACK"
+        static const U32 ms_version     = 1;
+        static const U32 ms_alignment   = 16;
+
+        U32     m_magic;
+        U32     m_version;
+        U32     m_fileCount;
+        U32     m_slotCount;
+    };
+
+    struct PackEntry
+    {
+        U32     m_id;
+        U32     m_size;
+        U64     m_offset;               // from the pack start
+    };
+
+    //=============================================================================== Pack
+}
+
+#endif // _CORE_PACK_H
@@ -7,10 +7,22 @@
 
 namespace Core
 {
+    enum CpuFeature
+    {
+        CF_SSE2     = 1 << 0,
+        CF_SSE41    = 1 << 1,
+        CF_AVX      = 1 << 2,       // with the OS support of the YMM registers
+        CF_AVX2     = 1 << 3,
+        CF_FMA      = 1 << 4
+    };
+
     class _CoreExport Platform
     {
     public:
         static const Char * GetName();
+
+        static U32          GetCpuFeatures();                   // CpuFeature bits, queried once
+        static Bool         HasCpuFeatures( U32 features );
     };
 }
 
@@ -0,0 +1,319 @@
+#pragma once
+#ifndef _CORE_POOL_H
+#define _CORE_POOL_H
+
+#include "Core/MemoryManager.h"
+#include "Core/MemoryUtils.h"
+
+#include "Core/Assert.h"
+
+namespace Core
+{
+    //====================================================================================
+    // Pool
+    //====================================================================================
+
+    // Fixed size object pool. Objects live in pages of S slots, allocation and
+    // destruction pop and push a free list. Each slot is prefixed by its owner page
+    // address, its low bit flags live slots so live objects can be iterated page by page.
+    // Pages are kept until the pool is destroyed. Not thread safe.
+    //
+    //  page : | Page | slot 0 | slot 1 | ... | slot S-1 |
+    //  slot : | owner | T |
+
+    template< typename T, SizeT S = 64, typename Alloc = DefaultAllocator >
+    class Pool
+    {
+    private:
+        struct Page
+        {
+            Page *  m_next;
+            SizeT   m_liveCount;
+        };
+
+    public:
+        class Iterator
+        {
+        public:
+            Iterator();
+
+            T&          operator*() const;
+            T *         operator->() const;
+            Iterator&   operator++();
+
+            Bool        operator==( const Iterator& other ) const;
+            Bool        operator!=( const Iterator& other ) const;
+
+        private:
+            friend class Pool;
+
+            Iterator( const Pool * pool, Page * page, SizeT index );
+            void        SkipFree();
+
+            const Pool *    mp_pool;
+            Page *          mp_page;
+            SizeT           m_index;
+        };
+
+    public:
+        Pool();
+        ~Pool();
+
+        T *         Create();
+        void        Destroy( T * obj );
+
+        void *      Allocate();
+        void        Free( void * ptr );
+
+        SizeT       Count() const;
+        SizeT       Capacity() const;
+
+        Iterator    Begin() const;
+        Iterator    End() const;
+
+    private:
+        Pool( const Pool& );
+        Pool& operator=( const Pool& );
+
+        static const SizeT ms_liveBit = 1;
+
+        U8 *        GetSlot( Page * page, SizeT index ) const;
+        SizeT&      GetOwner( U8 * slot ) const;
+        void        AddPage();
+
+        Page *      mp_pages;
+        void *      mp_free;
+        SizeT       m_slotOffset;   // from the page to the first slot
+        SizeT       m_dataOffset;   // from the slot to the object
+        SizeT       m_stride;
+        SizeT       m_count;
+        SizeT       m_capacity;
+    };
+
+    //=============================================================================== Pool
+
+    template< typename T, SizeT S, typename Alloc >
+    Pool< T, S, Alloc >::Pool()
+        : mp_pages( 0 ), mp_free( 0 ), m_count( 0 ), m_capacity( 0 )
+    {
+        SizeT align = MemoryUtils::AlignOf< T >();
+        if ( align < MemoryUtils::AlignOf< SizeT >() )
+        {
+            align = MemoryUtils::AlignOf< SizeT >();
+        }
+
+        SizeT dataSize = ( sizeof(T) > sizeof(void*) ) ? sizeof(T) : sizeof(void*);
+
+        m_slotOffset    = MemoryUtils::GetNextAlignedAddress( sizeof(Page), align );
+        m_dataOffset    = MemoryUtils::GetNextAlignedAddress( sizeof(SizeT), align );
+        m_stride        = MemoryUtils::GetNextAlignedAddress( m_dataOffset + dataSize, align );
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    Pool< T, S, Alloc >::~Pool()
+    {
+        Page * page = mp_pages;
+        while ( page )
+        {
+            Page * next = page->m_next;
+            Alloc::Deallocate( page );
+            page = next;
+        }
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    T * Pool< T, S, Alloc >::Create()
+    {
+        return ::new( Allocate() ) T();
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    void Pool< T, S, Alloc >::Destroy( T * obj )
+    {
+        obj->~T();
+        Free( obj );
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    void * Pool< T, S, Alloc >::Allocate()
+    {
+        if ( ! mp_free )
+        {
+            AddPage();
+        }
+
+        U8 * data   = static_cast< U8 * >( mp_free );
+        mp_free     = *reinterpret_cast< void ** >( data );
+
+        SizeT& owner = GetOwner( data - m_dataOffset );
+        CARBON_ASSERT( ( owner & ms_liveBit ) == 0 );
+
+        owner |= ms_liveBit;
+        ++reinterpret_cast< Page * >( owner & ~ms_liveBit )->m_liveCount;
+        ++m_count;
+
+        return data;
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    void Pool< T, S, Alloc >::Free( void * ptr )
+    {
+        if ( ! ptr )
+        {
+            return;
+        }
+
+        U8 * data       = static_cast< U8 * >( ptr );
+        SizeT& owner    = GetOwner( data - m_dataOffset );
+        CARBON_ASSERT( ( owner & ms_liveBit ) != 0 );
+
+        owner &= ~ms_liveBit;
+        --reinterpret_cast< Page * >( owner )->m_liveCount;
+        --m_count;
+
+        *reinterpret_cast< void ** >( data ) = mp_free;
+        mp_free = data;
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    SizeT Pool< T, S, Alloc >::Count() const
+    {
+        return m_count;
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    SizeT Pool< T, S, Alloc >::Capacity() const
+    {
+        return m_capacity;
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    typename Pool< T, S, Alloc >::Iterator Pool< T, S, Alloc >::Begin() const
+    {
+        Iterator it( this, mp_pages, 0 );
+        it.SkipFree();
+        return it;
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    typename Pool< T, S, Alloc >::Iterator Pool< T, S, Alloc >::End() const
+    {
+        return Iterator( this, 0, 0 );
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    U8 * Pool< T, S, Alloc >::GetSlot( Page * page, SizeT index ) const
+    {
+        return reinterpret_cast< U8 * >( page ) + m_slotOffset + index * m_stride;
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    SizeT& Pool< T, S, Alloc >::GetOwner( U8 * slot ) const
+    {
+        return *reinterpret_cast< SizeT * >( slot );
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    void Pool< T, S, Alloc >::AddPage()
+    {
+        SizeT align = MemoryUtils::AlignOf< T >();
+        if ( align < MemoryUtils::AlignOf< Page >() )
+        {
+            align = MemoryUtils::AlignOf< Page >();
+        }
+
+        Page * page         = static_cast< Page * >( Alloc::Allocate( m_slotOffset + S * m_stride, align ) );
+        page->m_next        = mp_pages;
+        page->m_liveCount   = 0;
+        mp_pages            = page;
+
+        // chain the slots in address order
+        for ( SizeT i=S; i>0; --i )
+        {
+            U8 * slot = GetSlot( page, i - 1 );
+            U8 * data = slot + m_dataOffset;
+
+            GetOwner( slot ) = reinterpret_cast< SizeT >( page );
+            *reinterpret_cast< void ** >( data ) = mp_free;
+            mp_free = data;
+        }
+
+        m_capacity += S;
+    }
+
+    //=============================================================================== Pool
+
+    //====================================================================================
+    // Pool::Iterator
+    //====================================================================================
+
+    template< typename T, SizeT S, typename Alloc >
+    Pool< T, S, Alloc >::Iterator::Iterator()
+        : mp_pool( 0 ), mp_page( 0 ), m_index( 0 )
+    {
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    Pool< T, S, Alloc >::Iterator::Iterator( const Pool * pool, Page * page, SizeT index )
+        : mp_pool( pool ), mp_page( page ), m_index( index )
+    {
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    T& Pool< T, S, Alloc >::Iterator::operator*() const
+    {
+        return *operator->();
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    T * Pool< T, S, Alloc >::Iterator::operator->() const
+    {
+        CARBON_ASSERT( mp_page );
+        return reinterpret_cast< T * >( mp_pool->GetSlot( mp_page, m_index ) + mp_pool->m_dataOffset );
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    typename Pool< T, S, Alloc >::Iterator& Pool< T, S, Alloc >::Iterator::operator++()
+    {
+        ++m_index;
+        SkipFree();
+        return *this;
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    Bool Pool< T, S, Alloc >::Iterator::operator==( const Iterator& other ) const
+    {
+        return mp_page == other.mp_page && m_index == other.m_index;
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    Bool Pool< T, S, Alloc >::Iterator::operator!=( const Iterator& other ) const
+    {
+        return ! operator==( other );
+    }
+
+    template< typename T, SizeT S, typename Alloc >
+    void Pool< T, S, Alloc >::Iterator::SkipFree()
+    {
+        while ( mp_page )
+        {
+            if ( mp_page->m_liveCount )
+            {
+                for ( ; m_index < S; ++m_index )
+                {
+                    if ( mp_pool->GetOwner( mp_pool->GetSlot( mp_page, m_index ) ) & ms_liveBit )
+                    {
+                        return;
+                    }
+                }
+            }
+
+            mp_page = mp_page->m_next;
+            m_index = 0;
+        }
+    }
+
+    //===================================================================== Pool::Iterator
+}
+
+#endif // _CORE_POOL_H
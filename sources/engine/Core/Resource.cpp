@@ -48,7 +48,7 @@ namespace Core
 
     U32 Resource::MakeIdFromName( const Char * name )
     {
-        return HashString( name );
+        return HashedString( name );
     }
 
     void Resource::SetId( U32 id )
@@ -63,6 +63,11 @@ namespace Core
     }
 #endif
 
+    bool Resource::Decode( const void * )
+    {
+        return true;
+    }
+
     void Resource::SelfDelete()
     {
         ResourceManager::Destroy( this );
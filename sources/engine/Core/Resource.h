@@ -4,6 +4,7 @@
 
 #include "Core/SharedPtr.h"
 #include "Core/FixedString.h"
+#include "Core/Pool.h"
 
 namespace Core
 {
@@ -41,8 +42,12 @@ namespace Core
         void            SetName( const Char * name );
 #endif
 
+        // Decode runs on a worker once the file is read, for the parsing which does not
+        // touch the device. Load then runs on the thread updating the ResourceManager.
+        virtual bool    Decode( const void * data );
         virtual bool    Load( const void * data ) = 0;
         virtual void    Unload() = 0;
+        virtual void    Dispose() = 0;      // destroys the resource and gives it back to its pool
 
         void            SelfDelete();
 
@@ -55,4 +60,26 @@ namespace Core
     };
 }
 
+// Each resource type owns a pool, ResourceManager::Create< T > allocates from T::GetPool().
+// CARBON_DECLARE_RESOURCE_POOL goes in the class declaration (it changes the access to public),
+// CARBON_DEFINE_RESOURCE_POOL in the source file of the module exporting the type.
+
+#define CARBON_DECLARE_RESOURCE_POOL( type ) \
+    protected: \
+        void Dispose(); \
+    public: \
+        typedef Core::Pool< type, 64, Core::UnknownAllocator > ResourcePool; \
+        static ResourcePool& GetPool();
+
+#define CARBON_DEFINE_RESOURCE_POOL( type ) \
+    type::ResourcePool& type::GetPool() \
+    { \
+        static ResourcePool pool; \
+        return pool; \
+    } \
+    void type::Dispose() \
+    { \
+        GetPool().Destroy( this ); \
+    }
+
 #endif // _CORE_RESOURCE_H
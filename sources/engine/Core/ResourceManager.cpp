@@ -1,9 +1,19 @@
 #include "Core/ResourceManager.h"
 
+#include "Core/Compression.h"
 #include "Core/Hash.h"
 #include "Core/HashTable.h"
 #include "Core/FileSystem.h"
 #include "Core/Resource.h"
+#include "Core/SpscQueue.h"
+#include "Core/MpscQueue.h"
+#include "Core/JobSystem.h"
+#include "Core/MemoryManager.h"
+#include "Core/Semaphore.h"
+#include "Core/SpinLock.h"
+#include "Core/Thread.h"
+#include "Core/TimeUtils.h"
+#include "Core/VirtualMemory.h"
 
 #include "Core/Assert.h"
 #include "Core/Trace.h"
@@ -21,20 +31,141 @@ namespace Core
     CARBON_DECLARE_POD_TYPE( ResourceRequest );
 
     typedef Array< ResourceRequest, FrameAllocator > ResourceRequestStack;
-    ResourceRequestStack pendingResources;
+
+    // Requests are queued between updates and can wait for a free load request over many
+    // of them, they are not in the frame memory. The waiting ones are swapped with the
+    // pending ones on each update.
+    typedef Array< ResourceRequest, UnknownAllocator > ResourceRequestArray;
+    ResourceRequestArray removedResources;
+    ResourceRequestArray pendingResources[ ResourceManager::LP_COUNT ];
+    ResourceRequestArray waitingResources;
+
+    // Resources released by other threads, removed by the owner thread on its next update
+    typedef MpscQueue< Resource *, 4096 > ReleaseQueue;
+    ReleaseQueue releasedResources;
+    // Releases that did not fit in the queue, the owner thread may not update for a while
+    typedef Array< Resource *, UnknownAllocator > ReleaseArray;
+    ReleaseArray releasedOverflow;
+    SpinLock releasedOverflowLock;
+    U32 ownerThreadId = 0;
+
+    // Loads in flight. The owner thread hands them to the I/O thread which reads the
+    // file and has a worker decode it, the owner thread takes them back to finalize :
+    //
+    //  owner -- ioRequests --> I/O thread -- job --> worker -- loadedRequests --> owner
+    //
+    // The I/O thread reads the queued requests in batches, and hands each file to the
+    // workers as soon as its read completes. Big files are mapped rather than copied,
+    // the pages of the batch are prefetched together while the small files are read.
+    //
+    // The blocks of a compressed file are shared by several jobs, the last one to
+    // finish decodes the resource.
+
+    const SizeT maxLoadCount        = 256;
+    const SizeT reservedLoadCount   = maxLoadCount / 4;     // not used by background loads
+    const SizeT maxReadCount        = 64;                   // per batch
+    const SizeT minMappedSize       = 256 * 1024;           // smaller files are read, a copy costs less than a mapping
+
+    struct LoadRequest
+    {
+        Resource *                      m_res;      // null when free
+        void *                          m_read;     // file as read, freed once finalized
+        FileView                        m_view;     // or as mapped, released once finalized
+        const void *                    m_file;     // file content, read or mapped
+        SizeT                           m_fileSize;
+        void *                          m_buffer;   // decompressed file, freed once finalized
+        const void *                    m_data;     // file content, in the file or the buffer
+        SizeT                           m_size;
+        volatile S32                    m_nextBlock;
+        volatile S32                    m_failedBlockCount;
+        volatile S32                    m_jobCount; // decompressing
+        Bool                            m_success;
+        ResourceManager::LoadPriority   m_priority;
+        PathString                      m_path;
+        LoadRequest *                   m_next;     // free or ready list, owner thread only
+    };
+
+    // Decoded loads waiting for their finalization, in arrival order
+    struct ReadyList
+    {
+        LoadRequest *   m_head;
+        LoadRequest *   m_tail;
+        SizeT           m_count;
+    };
+
+    typedef SpscQueue< LoadRequest *, maxLoadCount > IORequestQueue;
+
+    LoadRequest                             loadRequests[ maxLoadCount ];
+    LoadRequest *                           freeLoadRequests = 0;
+    SizeT                                   loadingCount = 0;
+    SizeT                                   loadingCounts[ ResourceManager::LP_COUNT ];
+    ReadyList                               readyRequests[ ResourceManager::LP_COUNT ];
+
+    IORequestQueue                          ioRequests[ ResourceManager::LP_COUNT ];    // a null request stops the thread
+    MpscQueue< LoadRequest *, maxLoadCount > loadedRequests;
+    Semaphore                               ioSignal;
+    ThreadHandle                            ioThread = 0;
+
+    // Finalization budget of an update, 0 for no limit
+    U64                                     budgetTicks = 0;
+    SizeT                                   budgetBytes = 0;
 
     //====================================================================================
 
     void ResourceManager::Initialize()
     {
         CARBON_ASSERT( resourceTable.Count() == 0 );
-        CARBON_ASSERT( pendingResources.Empty() );
+        CARBON_ASSERT( removedResources.Empty() );
+        CARBON_ASSERT( releasedResources.Empty() );
+        CARBON_ASSERT( releasedOverflow.Empty() );
+        CARBON_ASSERT( loadingCount == 0 );
+
+        ownerThreadId = Thread::GetCurrentId();
+
+        for ( SizeT p=0; p<LP_COUNT; ++p )
+        {
+            CARBON_ASSERT( pendingResources[ p ].Empty() );
+
+            loadingCounts[ p ]              = 0;
+            readyRequests[ p ].m_head       = 0;
+            readyRequests[ p ].m_tail       = 0;
+            readyRequests[ p ].m_count      = 0;
+        }
+
+        for ( SizeT i=0; i<maxLoadCount; ++i )
+        {
+            loadRequests[ i ].m_res  = 0;
+            loadRequests[ i ].m_next = ( i + 1 < maxLoadCount ) ? &loadRequests[ i + 1 ] : 0;
+        }
+        freeLoadRequests = loadRequests;
+
+        ioThread = Thread::Start( ReadFiles, 0 );
     }
 
     void ResourceManager::Destroy()
     {
         ProcessRequests();
 
+        // the resources in flight are finalized or released once back
+        while ( loadingCount > 0 )
+        {
+            CpuPause();
+            ProcessRequests();
+        }
+
+        ioRequests[ LP_BACKGROUND ].Push( 0 );
+        ioSignal.Signal();
+        Thread::Join( ioThread );
+        ioThread = 0;
+
+        for ( SizeT p=0; p<LP_COUNT; ++p )
+        {
+            pendingResources[ p ].Reserve( 0 );
+        }
+        waitingResources.Reserve( 0 );
+        removedResources.Reserve( 0 );
+        releasedOverflow.Reserve( 0 );
+
 #if defined( CARBON_DEBUG )
         if ( resourceTable.Count() )
         {
@@ -67,6 +198,26 @@ namespace Core
         ProcessRequests();
     }
 
+    void ResourceManager::SetFrameBudget( F32 milliseconds, SizeT bytes )
+    {
+        budgetTicks = static_cast< U64 >( milliseconds * 0.001 * TimeUtils::ClockFrequency() );
+        budgetBytes = bytes;
+    }
+
+    SizeT ResourceManager::GetLoadingCount()
+    {
+        return loadingCount;
+    }
+
+    void ResourceManager::GetQueueStats( LoadPriority priority, QueueStats& stats )
+    {
+        CARBON_ASSERT( priority < LP_COUNT );
+
+        stats.m_waitingCount    = pendingResources[ priority ].Size();
+        stats.m_loadingCount    = loadingCounts[ priority ] - readyRequests[ priority ].m_count;
+        stats.m_readyCount      = readyRequests[ priority ].m_count;
+    }
+
     const Resource * ResourceManager::FindByName( const Char * name )
     {
         U32 id = Resource::MakeIdFromName( name );
@@ -87,7 +238,7 @@ namespace Core
             return 0;
     }
 
-    void ResourceManager::Add( const Char * name, Resource * res )
+    void ResourceManager::Add( const Char * name, Resource * res, LoadPriority priority )
     {
         PathString path;
         FileSystem::BuildPathName( name, path, FileSystem::PT_CACHE );
@@ -98,75 +249,456 @@ namespace Core
         if ( !res->IsPending() )
         {
             res->m_state |= Resource::PENDING;
-            pendingResources.PushBack( req );
+            pendingResources[ priority ].PushBack( req );
         }
 
         resourceTable.Insert( res->GetId(), res );
     }
 
+    void ResourceManager::Raise( Resource * res, LoadPriority priority )
+    {
+        // Not started : moved to the more urgent queue
+        for ( SizeT p=priority+1; p<LP_COUNT; ++p )
+        {
+            ResourceRequestArray& requests = pendingResources[ p ];
+
+            ResourceRequestArray::Iterator it = requests.Begin();
+            ResourceRequestArray::ConstIterator end = requests.End();
+            for ( ; it != end; ++it )
+            {
+                if ( it->m_res == res )
+                {
+                    pendingResources[ priority ].PushBack( *it );
+                    requests.Erase( it );
+                    return;
+                }
+            }
+        }
+
+        // In flight : the file is read in its original order, the resource is finalized
+        // with the new priority. The priority only changes on this thread, a load already
+        // back from the workers is moved to the new ready list.
+        for ( SizeT i=0; i<maxLoadCount; ++i )
+        {
+            LoadRequest * load = &loadRequests[ i ];
+            if ( load->m_res != res )
+            {
+                continue;
+            }
+
+            if ( load->m_priority > priority )
+            {
+                ReadyList& ready = readyRequests[ load->m_priority ];
+
+                LoadRequest * prev = 0;
+                LoadRequest * it = ready.m_head;
+                while ( it && it != load )
+                {
+                    prev = it;
+                    it = it->m_next;
+                }
+
+                if ( it )
+                {
+                    if ( prev )
+                        prev->m_next = load->m_next;
+                    else
+                        ready.m_head = load->m_next;
+                    if ( ready.m_tail == load )
+                        ready.m_tail = prev;
+                    --ready.m_count;
+
+                    ReadyList& raised = readyRequests[ priority ];
+
+                    load->m_next = 0;
+                    if ( raised.m_tail )
+                        raised.m_tail->m_next = load;
+                    else
+                        raised.m_head = load;
+                    raised.m_tail = load;
+                    ++raised.m_count;
+                }
+
+                --loadingCounts[ load->m_priority ];
+                ++loadingCounts[ priority ];
+                load->m_priority = priority;
+            }
+            return;
+        }
+    }
+
     void ResourceManager::Remove( Resource * res )
     {
+        // the requests and the resource states belong to the owner thread
+        if ( Thread::GetCurrentId() != ownerThreadId )
+        {
+            if ( ! releasedResources.Push( res ) )
+            {
+                releasedOverflowLock.Lock();
+                releasedOverflow.PushBack( res );
+                releasedOverflowLock.Unlock();
+            }
+            return;
+        }
+
         ResourceRequest req = { res, 0 };
         if ( !res->IsPending() )
         {
             res->m_state |= Resource::PENDING;
-            pendingResources.PushBack( req );
+            removedResources.PushBack( req );
         }
     }
 
     void ResourceManager::ProcessRequests()
     {
-        ResourceRequestStack toDeleteResources;
+        Resource * released;
+        while ( releasedResources.Pop( released ) )
+        {
+            Remove( released );
+        }
+
+        releasedOverflowLock.Lock();
+        Array< Resource *, FrameAllocator > overflow( releasedOverflow.Begin(), releasedOverflow.End() );
+        releasedOverflow.Clear();
+        releasedOverflowLock.Unlock();
 
-        // Proceed resource loading
-        while ( ! pendingResources.Empty() )
+        for ( SizeT i=0; i<overflow.Size(); ++i )
         {
-            ResourceRequest req = pendingResources.Back();
-            pendingResources.PopBack();
+            Remove( overflow[ i ] );
+        }
 
-            if ( req.m_res->GetRefCount() == 0 )
-            {
-                toDeleteResources.PushBack( req );
-            }
-            else if ( ! req.m_res->IsLoaded() )
+        ResourceRequestStack toDeleteResources( removedResources.Begin(), removedResources.End() );
+        removedResources.Clear();
+
+        // Queue the loads back from the workers by priority
+        LoadRequest * load;
+        while ( loadedRequests.Pop( load ) )
+        {
+            ReadyList& ready = readyRequests[ load->m_priority ];
+
+            load->m_next = 0;
+            if ( ready.m_tail )
+                ready.m_tail->m_next = load;
+            else
+                ready.m_head = load;
+            ready.m_tail = load;
+            ++ready.m_count;
+        }
+
+        // Finalize them, the blocking ones whatever they cost, the others within the budget
+        const U64 startTime = TimeUtils::ClockTime();
+        SizeT finalizedBytes = 0;
+        Bool finalized = false;
+
+        for ( SizeT p=0; p<LP_COUNT; ++p )
+        {
+            ReadyList& ready = readyRequests[ p ];
+            while ( ready.m_head )
             {
-                void * data = 0;
-                SizeT size;
+                if ( p != LP_BLOCKING && finalized )
+                {
+                    if ( budgetBytes && finalizedBytes >= budgetBytes )
+                        break;
+                    if ( budgetTicks && TimeUtils::ClockTime() - startTime >= budgetTicks )
+                        break;
+                }
+
+                load = ready.m_head;
+                ready.m_head = load->m_next;
+                if ( ! ready.m_head )
+                    ready.m_tail = 0;
+                --ready.m_count;
 
-                if ( ! ( FileSystem::Load( req.m_path, data, size ) && req.m_res->Load( data ) ) )
+                Resource * res = load->m_res;
+
+                if ( res->GetRefCount() == 0 )
+                {
+                    // released while loading, its device objects are not worth creating
+                    ResourceRequest req = { res, 0 };
+                    toDeleteResources.PushBack( req );
+                }
+                else
                 {
-                    req.m_res->m_state &= ~Resource::VALID;
+                    if ( ! ( load->m_success && res->Load( load->m_data ) ) )
+                    {
+                        res->m_state &= ~Resource::VALID;
+                    }
+
+                    res->m_state |= Resource::LOADED;
+                    res->m_state &= ~Resource::PENDING;
+
+                    finalizedBytes += load->m_size;
+                    finalized = true;
                 }
 
-                req.m_res->m_state |= Resource::LOADED;
-                req.m_res->m_state &= ~Resource::PENDING;
+                if ( load->m_buffer )
+                {
+                    UnknownAllocator::Deallocate( load->m_buffer );
+                }
+                if ( load->m_read )
+                {
+                    UnknownAllocator::Deallocate( load->m_read );
+                }
+                FileSystem::Unmap( load->m_view );
 
-                UnknownAllocator::Deallocate( data );
+                load->m_res         = 0;
+                load->m_next        = freeLoadRequests;
+                freeLoadRequests    = load;
+                --loadingCounts[ p ];
+                --loadingCount;
             }
         }
 
-        pendingResources = toDeleteResources;
+        // Start the loads by priority, the resources stay pending until finalized
+        for ( SizeT p=0; p<LP_COUNT; ++p )
+        {
+            const SizeT reserved = ( p == LP_BACKGROUND ) ? reservedLoadCount : 0;
+
+            ResourceRequestArray& requests = pendingResources[ p ];
+            while ( ! requests.Empty() )
+            {
+                ResourceRequest req = requests.Back();
+                requests.PopBack();
+
+                if ( req.m_res->GetRefCount() == 0 )
+                {
+                    toDeleteResources.PushBack( req );
+                }
+                else if ( req.m_res->IsLoaded() )
+                {
+                    req.m_res->m_state &= ~Resource::PENDING;
+                }
+                else if ( maxLoadCount - loadingCount <= reserved )
+                {
+                    waitingResources.PushBack( req );
+                }
+                else
+                {
+                    load                = freeLoadRequests;
+                    freeLoadRequests    = load->m_next;
+                    ++loadingCounts[ p ];
+                    ++loadingCount;
+
+                    load->m_res         = req.m_res;
+                    load->m_buffer      = 0;
+                    load->m_priority    = static_cast< LoadPriority >( p );
+                    load->m_path        = req.m_path;
+
+                    ioRequests[ p ].Push( load );
+                    ioSignal.Signal();
+                }
+            }
+
+            // retried on the next update
+            requests.Swap( waitingResources );
+        }
 
         // Delete unreferenced resources
-        while ( ! pendingResources.Empty() )
+        while ( ! toDeleteResources.Empty() )
         {
-            Resource * res = pendingResources.Back().m_res;
-            pendingResources.PopBack();
+            Resource * res = toDeleteResources.Back().m_res;
+            toDeleteResources.PopBack();
 
             if ( res->GetRefCount() == 0 )
             {
                 resourceTable.Remove( res->GetId() );
                 if ( res->IsLoaded() )
                     res->Unload();
-                res->~Resource();
-                UnknownAllocator::Deallocate( res );
+                res->Dispose();
             }
             else
             {
                 res->m_state &= ~Resource::PENDING;
             }
         }
+    }
+
+    void ResourceManager::DecodeResource( void * data )
+    {
+        LoadRequest * load = reinterpret_cast< LoadRequest * >( data );
+
+        load->m_success = load->m_success && load->m_res->Decode( load->m_data );
 
-        pendingResources.Reserve( 0 );
+        // never full, it can hold every request
+        loadedRequests.Push( load );
+    }
+
+    void ResourceManager::DecompressBlocks( void * data )
+    {
+        LoadRequest * load = reinterpret_cast< LoadRequest * >( data );
+
+        const void * file       = load->m_file;
+        const SizeT blockCount  = Compression::GetBlockCount( file );
+
+        for ( ;; )
+        {
+            const SizeT b = AtomicIncrement( &load->m_nextBlock ) - 1;
+            if ( b >= blockCount )
+            {
+                break;
+            }
+
+            if ( ! Compression::DecompressBlock( file, b, load->m_buffer ) )
+            {
+                AtomicIncrement( &load->m_failedBlockCount );
+            }
+        }
+
+        if ( AtomicDecrement( &load->m_jobCount ) == 0 )
+        {
+            load->m_success = ( AtomicLoad( &load->m_failedBlockCount ) == 0 );
+            DecodeResource( load );
+        }
+    }
+
+    void ResourceManager::ReadCompleted( FileRead& read, Bool success )
+    {
+        LoadRequest * load = reinterpret_cast< LoadRequest * >( read.m_userData );
+
+        load->m_success = success;
+
+        const SizeT workerCount = JobSystem::GetWorkerCount();
+
+        if ( load->m_success && Compression::IsCompressed( load->m_file, load->m_fileSize ) )
+        {
+            const SizeT blockCount = Compression::GetBlockCount( load->m_file );
+
+            // decompressed straight into the buffer the resource reads
+            load->m_size                = Compression::GetRawSize( load->m_file );
+            load->m_buffer              = load->m_size ? UnknownAllocator::Allocate( load->m_size ) : 0;
+            load->m_data                = load->m_buffer;
+            load->m_nextBlock           = 0;
+            load->m_failedBlockCount    = 0;
+
+            const SizeT jobCount = ( blockCount < workerCount ) ? blockCount : workerCount;
+            if ( jobCount > 0 )
+            {
+                Job jobs[ JobSystem::ms_maxWorkerCount ];
+                for ( SizeT i=0; i<jobCount; ++i )
+                {
+                    jobs[ i ].m_function    = DecompressBlocks;
+                    jobs[ i ].m_data        = load;
+                }
+
+                load->m_jobCount = static_cast< S32 >( jobCount );
+                JobSystem::Run( jobs, jobCount, 0 );
+            }
+            else
+            {
+                load->m_jobCount = 1;
+                DecompressBlocks( load );
+            }
+        }
+        else
+        {
+            load->m_data = load->m_file;
+            load->m_size = load->m_fileSize;
+
+            if ( workerCount > 0 )
+            {
+                JobSystem::Run( DecodeResource, load, 0 );
+            }
+            else
+            {
+                DecodeResource( load );
+            }
+        }
+    }
+
+    void ResourceManager::ReadFiles( void * )
+    {
+        const SizeT pageSize = VirtualMemory::GetPageSize();
+
+        FileRead reads[ maxReadCount ];
+        LoadRequest * mappedLoads[ maxReadCount ];
+        FileView views[ maxReadCount ];
+
+        for ( ;; )
+        {
+            ioSignal.Wait();
+
+            // every request queued, the most urgent first, extra signals find the queues empty
+            SizeT readCount = 0;
+            SizeT mappedCount = 0;
+            Bool stopped = false;
+
+            for ( SizeT p=0; p<LP_COUNT && readCount + mappedCount < maxReadCount; ++p )
+            {
+                LoadRequest * load;
+                while ( readCount + mappedCount < maxReadCount && ioRequests[ p ].Pop( load ) )
+                {
+                    if ( ! load )
+                    {
+                        stopped = true;
+                        continue;
+                    }
+
+                    FileRead& read = reads[ readCount ];
+                    read.m_userData = load;
+
+                    load->m_read        = 0;
+                    load->m_view.m_data = 0;
+                    load->m_view.m_size = 0;
+                    load->m_view.m_base = 0;
+                    load->m_file        = 0;
+                    load->m_fileSize    = 0;
+
+                    if ( ! FileSystem::Open( load->m_path, read ) )
+                    {
+                        ReadCompleted( read, false );
+                        continue;
+                    }
+
+                    if ( read.m_size >= minMappedSize )
+                    {
+                        FileSystem::Close( read );
+
+                        if ( ! FileSystem::Map( load->m_path, load->m_view ) )
+                        {
+                            ReadCompleted( read, false );
+                            continue;
+                        }
+
+                        load->m_file                = load->m_view.m_data;
+                        load->m_fileSize            = load->m_view.m_size;
+                        views[ mappedCount ]        = load->m_view;
+                        mappedLoads[ mappedCount ]  = load;
+                        ++mappedCount;
+                        continue;
+                    }
+
+                    load->m_read        = read.m_size ? UnknownAllocator::Allocate( read.m_size ) : 0;
+                    load->m_file        = load->m_read;
+                    load->m_fileSize    = read.m_size;
+                    read.m_buffer       = load->m_read;
+                    ++readCount;
+                }
+            }
+
+            // the mapped pages are read with the small files
+            FileSystem::Prefetch( views, mappedCount );
+            FileSystem::ReadBatch( reads, readCount, ReadCompleted );
+
+            for ( SizeT i=0; i<mappedCount; ++i )
+            {
+                LoadRequest * load = mappedLoads[ i ];
+
+                // fault the pages in here rather than in Decode or in Load
+                const volatile U8 * bytes = static_cast< const volatile U8 * >( load->m_view.m_data );
+                for ( SizeT b=0; b<load->m_view.m_size; b+=pageSize )
+                {
+                    bytes[ b ];
+                }
+
+                FileRead read;
+                read.m_userData = load;
+                ReadCompleted( read, true );
+            }
+
+            if ( stopped )
+            {
+                return;
+            }
+        }
     }
 }
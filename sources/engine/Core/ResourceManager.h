@@ -8,6 +8,7 @@
 namespace Core
 {
     class Resource;
+    struct FileRead;
 
     //====================================================================================
     // ResourceManager
@@ -15,37 +16,74 @@ namespace Core
 
     class _CoreExport ResourceManager
     {
+    public:
+        // Order in which the resources are read and finalized. Blocking resources are
+        // finalized as soon as they are decoded, the others within the frame budget.
+        enum LoadPriority
+        {
+            LP_BLOCKING = 0,
+            LP_VISIBLE,             // needed in the next frames
+            LP_BACKGROUND,          // prefetch, never takes the last load requests
+            LP_COUNT
+        };
+
+        struct QueueStats
+        {
+            SizeT   m_waitingCount;     // not started, no load request free
+            SizeT   m_loadingCount;     // being read or decoded
+            SizeT   m_readyCount;       // decoded, waiting for their finalization
+        };
+
     public:
         static void Initialize();
         static void Destroy();
 
-        template < typename T > static T * Create( const Char * name );
+        // A later Create of a resource not loaded yet with a more urgent priority raises
+        // the priority of its load, a less urgent one is ignored
+        template < typename T > static T * Create( const Char * name, LoadPriority priority = LP_VISIBLE );
         template < typename T > static void Destroy( T * res );
 
+        // Finalizes the loaded resources and starts the loads of the new ones. Files are
+        // read in batches on an I/O thread, big ones are mapped, and decoded by the
+        // JobSystem workers, only Resource::Load runs on the calling thread. Resources
+        // parse the file as read or mapped, or the buffer a compressed file is
+        // decompressed to by several workers.
         static void             Update();
 
+        // Time and file bytes Update may spend in Resource::Load, 0 for no limit. At least
+        // one resource is finalized per update so loads always progress.
+        static void             SetFrameBudget( F32 milliseconds, SizeT bytes );
+
+        static SizeT            GetLoadingCount();      // resources in flight
+        static void             GetQueueStats( LoadPriority priority, QueueStats& stats );
+
         static const Resource * FindByName( const Char * name );
         static const Resource * FindById( U32 id );
 
     private:
         static Resource *       Find( U32 id );
-        static void             Add( const Char * name, Resource * res );
+        static void             Add( const Char * name, Resource * res, LoadPriority priority );
+        static void             Raise( Resource * res, LoadPriority priority );
         static void             Remove( Resource * res );
         static void             ProcessRequests();
+
+        static void             ReadFiles( void * );                            // I/O thread
+        static void             ReadCompleted( FileRead& read, Bool success );  // I/O thread
+        static void             DecompressBlocks( void * data );                // job
+        static void             DecodeResource( void * data );                  // job
     };
 
     //==================================================================== ResourceManager
 
     template < typename T >
-    T * ResourceManager::Create( const Char * name )
+    T * ResourceManager::Create( const Char * name, LoadPriority priority )
     {
         U32 id = Resource::MakeIdFromName( name );
 
         Resource * res = Find( id );
         if ( !res )
         {
-            res = static_cast< Resource * >( UnknownAllocator::Allocate( sizeof(T), MemoryUtils::AlignOf< T >() ) );
-            ::new( res ) T();
+            res = T::GetPool().Create();
 
             res->SetId( id );
 #if defined( CARBON_DEBUG )
@@ -53,7 +91,11 @@ namespace Core
 #endif
             res->m_state |= Resource::VALID;
 
-            Add( name, res );
+            Add( name, res, priority );
+        }
+        else if ( res->IsPending() && ! res->IsLoaded() )
+        {
+            Raise( res, priority );
         }
 
         return static_cast< T * >( res );
@@ -0,0 +1,36 @@
+#pragma once
+#ifndef _CORE_SEMAPHORE_H
+#define _CORE_SEMAPHORE_H
+
+#include "Core/Types.h"
+#include "Core/DLL.h"
+
+namespace Core
+{
+    //====================================================================================
+    // Semaphore
+    //====================================================================================
+
+    // Counting semaphore, for threads sleeping until there is work. Signals are
+    // counted so a signal sent before the wait is not lost.
+
+    class _CoreExport Semaphore
+    {
+    public:
+        Semaphore();
+        ~Semaphore();
+
+        void    Signal( SizeT count = 1 );
+        void    Wait();
+
+    private:
+        Semaphore( const Semaphore& );
+        Semaphore& operator=( const Semaphore& );
+
+        void *  m_handle;
+    };
+
+    //========================================================================== Semaphore
+}
+
+#endif // _CORE_SEMAPHORE_H
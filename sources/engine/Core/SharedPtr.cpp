@@ -1,5 +1,7 @@
 #include "Core/SharedPtr.h"
 
+#include "Core/Atomic.h"
+
 namespace Core
 {
     RefCounted::RefCounted()
@@ -9,14 +11,14 @@ namespace Core
 
     void RefCounted::Increment()
     {
-        ++m_refCount;
+        AtomicIncrement( &m_refCount );
     }
 
     void RefCounted::Decrement()
     {
-        CARBON_ASSERT( m_refCount > 0 );
-        --m_refCount;
-        if ( !m_refCount )
+        const S32 count = AtomicDecrement( &m_refCount );
+        CARBON_ASSERT( count >= 0 );
+        if ( count == 0 )
         {
             SelfDelete();
         }
@@ -24,6 +26,6 @@ namespace Core
 
     SizeT RefCounted::GetRefCount() const
     {
-        return m_refCount;
+        return AtomicLoad( &m_refCount );
     }
 }
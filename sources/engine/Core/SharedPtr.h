@@ -4,6 +4,7 @@
 
 #include "Core/DLL.h"
 #include "Core/Types.h"
+#include "Core/TypeTraits.h"
 
 #include "Core/Assert.h"
 
@@ -13,6 +14,9 @@ namespace Core
     // RefCounted
     //====================================================================================
 
+    // Atomic reference count, references can be taken and dropped from any thread.
+    // SelfDelete runs on the thread dropping the last one.
+
     class _CoreExport RefCounted
     {
     public:
@@ -30,7 +34,7 @@ namespace Core
         RefCounted( const RefCounted& );
 
     private:
-        SizeT   m_refCount;
+        volatile S32    m_refCount;
     };
 
     //========================================================================= RefCounted
@@ -39,6 +43,8 @@ namespace Core
     // SharedPtr
     //====================================================================================
 
+    // Moves transfer the reference without touching the counter
+
     template< typename T >
     class SharedPtr
     {
@@ -51,6 +57,11 @@ namespace Core
         SharedPtr& operator=( T * ptr );
         SharedPtr& operator=( SharedPtr& ptr );
 
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+        SharedPtr( SharedPtr&& ptr );
+        SharedPtr& operator=( SharedPtr&& ptr );
+#endif
+
         const T * ConstPtr() const;
         T * Ptr();
 
@@ -123,6 +134,28 @@ namespace Core
         return *this;
     }
 
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+    template< typename T >
+    SharedPtr< T >::SharedPtr( SharedPtr&& ptr )
+        : m_ptr( ptr.m_ptr )
+    {
+        ptr.m_ptr = 0;
+    }
+
+    template< typename T >
+    SharedPtr< T >& SharedPtr< T >::operator=( SharedPtr&& ptr )
+    {
+        if ( this != &ptr )
+        {
+            Release();
+            m_ptr = ptr.m_ptr;
+            ptr.m_ptr = 0;
+        }
+
+        return *this;
+    }
+#endif
+
     template< typename T >
     const T * SharedPtr< T >::ConstPtr() const
     {
@@ -0,0 +1,603 @@
+#pragma once
+#ifndef _CORE_SMALLARRAY_H
+#define _CORE_SMALLARRAY_H
+
+#include "Core/IArray.h"
+
+#include "Core/MemoryManager.h"
+#include "Core/MemoryUtils.h"
+#include "Core/TypeTraits.h"
+
+#include "Core/Assert.h"
+
+namespace Core
+{
+    //====================================================================================
+    // SmallArray
+    //====================================================================================
+
+    // Array storing up to N elements inline, bigger arrays spill to the allocator.
+    // Use it where the size is usually small but has no hard limit. The inline storage is
+    // aligned for 8 bytes types at most. Like FixedArray it points into itself, so it is
+    // not trivially relocatable.
+
+    template < typename T, SizeT N, typename Alloc = DefaultAllocator >
+    class SmallArray : public IArray< T >
+    {
+    public:
+        typedef T               ValueType;
+        typedef T *             Pointer;
+        typedef const T *       ConstPointer;
+        typedef T&              Reference;
+        typedef const T&        ConstReference;
+        typedef SizeT           SizeType;
+        typedef T *             Iterator;
+        typedef const T *       ConstIterator;
+
+    public:
+        SmallArray();
+        SmallArray( SizeType size, ConstReference value = ValueType() );
+        SmallArray( ConstIterator v, SizeType n );
+        SmallArray( ConstIterator begin, ConstIterator end );
+        SmallArray( const SmallArray& other );
+        ~SmallArray();
+
+        SmallArray&     operator=( const SmallArray& other );
+
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+        SmallArray( SmallArray&& other );
+        SmallArray&     operator=( SmallArray&& other );
+#endif
+
+        ConstPointer    ConstPtr() const;
+        Pointer         Ptr();
+
+        ConstIterator   Begin() const;
+        Iterator        Begin();
+
+        ConstIterator   End() const;
+        Iterator        End();
+
+        ConstReference  Front() const;
+        Reference       Front();
+
+        ConstReference  Back() const;
+        Reference       Back();
+
+        ConstReference  At( SizeType index ) const;
+        Reference       At( SizeType index );
+
+        ConstReference  operator[]( SizeType index ) const;
+        Reference       operator[]( SizeType index );
+
+        Bool            Empty() const;
+        SizeType        Size() const;
+        SizeType        Capacity() const;
+        Bool            IsInline() const;
+
+        // Reserve( 0 ) clears the array and goes back to the inline storage
+        void            Reserve( SizeType capacity );
+        void            Resize( SizeType size, ConstReference value = ValueType() );
+
+        void            PushBack( ConstReference value );
+        void            PushBack( ConstPointer p, SizeType n );
+        void            PushBack( ConstIterator begin, ConstIterator end );
+
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+        void            PushBack( ValueType&& value );
+#endif
+
+        Reference       EmplaceBack();
+        template< typename A1 >
+        Reference       EmplaceBack( CARBON_FWD_REF( A1 ) a1 );
+        template< typename A1, typename A2 >
+        Reference       EmplaceBack( CARBON_FWD_REF( A1 ) a1, CARBON_FWD_REF( A2 ) a2 );
+        template< typename A1, typename A2, typename A3 >
+        Reference       EmplaceBack( CARBON_FWD_REF( A1 ) a1, CARBON_FWD_REF( A2 ) a2, CARBON_FWD_REF( A3 ) a3 );
+
+        Iterator        Erase( Iterator pos );
+        Iterator        Erase( Iterator begin, Iterator end );
+        void            EraseUnordered( Iterator pos );
+
+        void            PopBack();
+        void            Clear();
+
+    private:
+        Pointer         InlineBuffer();
+        void            IncreaseCapacity( SizeType capacity );
+        void            Release();
+        void            StealOrMove( SmallArray& other );
+        Pointer         PrepareEmplace();
+
+    private:
+        union Storage
+        {
+            U8      m_bytes[ N * sizeof( T ) ];
+            F64     m_alignF64;
+            void *  m_alignPtr;
+        };
+
+        ValueType *	    m_begin;
+        ValueType *	    m_end;
+        ValueType *	    m_capacity;
+        Storage         m_storage;
+    };
+
+    //========================================================================= SmallArray
+
+    template< typename T, SizeT N, typename Alloc >
+    SmallArray< T, N, Alloc >::SmallArray()
+    {
+        CARBON_COMPILE_TIME_ASSERT( N > 0 );
+        CARBON_ASSERT( ( reinterpret_cast< SizeT >( &m_storage ) & ( MemoryUtils::AlignOf< T >() - 1 ) ) == 0 );
+
+        m_begin = m_end = InlineBuffer();
+        m_capacity = m_begin + N;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    SmallArray< T, N, Alloc >::SmallArray( SizeType size, ConstReference value )
+    {
+        m_begin = m_end = InlineBuffer();
+        m_capacity = m_begin + N;
+        Resize( size, value );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    SmallArray< T, N, Alloc >::SmallArray( ConstIterator v, SizeType n )
+    {
+        m_begin = m_end = InlineBuffer();
+        m_capacity = m_begin + N;
+        PushBack( v, v + n );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    SmallArray< T, N, Alloc >::SmallArray( ConstIterator begin, ConstIterator end )
+    {
+        m_begin = m_end = InlineBuffer();
+        m_capacity = m_begin + N;
+        PushBack( begin, end );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    SmallArray< T, N, Alloc >::SmallArray( const SmallArray& other )
+    {
+        m_begin = m_end = InlineBuffer();
+        m_capacity = m_begin + N;
+        PushBack( other.Begin(), other.End() );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    SmallArray< T, N, Alloc >::~SmallArray()
+    {
+        Clear();
+        Release();
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    SmallArray< T, N, Alloc >& SmallArray< T, N, Alloc >::operator=( const SmallArray& other )
+    {
+        if ( this != &other )
+        {
+            Clear();
+            PushBack( other.Begin(), other.End() );
+        }
+        return *this;
+    }
+
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+    template< typename T, SizeT N, typename Alloc >
+    SmallArray< T, N, Alloc >::SmallArray( SmallArray&& other )
+    {
+        m_begin = m_end = InlineBuffer();
+        m_capacity = m_begin + N;
+        StealOrMove( other );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    SmallArray< T, N, Alloc >& SmallArray< T, N, Alloc >::operator=( SmallArray&& other )
+    {
+        if ( this != &other )
+        {
+            Clear();
+            StealOrMove( other );
+        }
+        return *this;
+    }
+#endif
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::ConstPointer SmallArray< T, N, Alloc >::ConstPtr() const
+    {
+        return m_begin;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Pointer SmallArray< T, N, Alloc >::Ptr()
+    {
+        return m_begin;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::ConstIterator SmallArray< T, N, Alloc >::Begin() const
+    {
+        return m_begin;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Iterator SmallArray< T, N, Alloc >::Begin()
+    {
+        return m_begin;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::ConstIterator SmallArray< T, N, Alloc >::End() const
+    {
+        return m_end;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Iterator SmallArray< T, N, Alloc >::End()
+    {
+        return m_end;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::ConstReference SmallArray< T, N, Alloc >::Front() const
+    {
+        CARBON_ASSERT( m_begin != m_end );
+        return *m_begin;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Reference SmallArray< T, N, Alloc >::Front()
+    {
+        CARBON_ASSERT( m_begin != m_end );
+        return *m_begin;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::ConstReference SmallArray< T, N, Alloc >::Back() const
+    {
+        CARBON_ASSERT( m_begin != m_end );
+        return *( m_end - 1 );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Reference SmallArray< T, N, Alloc >::Back()
+    {
+        CARBON_ASSERT( m_begin != m_end );
+        return *( m_end - 1 );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::ConstReference SmallArray< T, N, Alloc >::At( SizeType index ) const
+    {
+        CARBON_ASSERT( index < Size() );
+        return *( m_begin + index );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Reference SmallArray< T, N, Alloc >::At( SizeType index )
+    {
+        CARBON_ASSERT( index < Size() );
+        return *( m_begin + index );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::ConstReference SmallArray< T, N, Alloc >::operator[]( SizeType index ) const
+    {
+        return At( index );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Reference SmallArray< T, N, Alloc >::operator[]( SizeType index )
+    {
+        return At( index );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    Bool SmallArray< T, N, Alloc >::Empty() const
+    {
+        return ( m_begin == m_end );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::SizeType SmallArray< T, N, Alloc >::Size() const
+    {
+        return static_cast< SizeType >( m_end - m_begin );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::SizeType SmallArray< T, N, Alloc >::Capacity() const
+    {
+        return static_cast< SizeType >( m_capacity - m_begin );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    Bool SmallArray< T, N, Alloc >::IsInline() const
+    {
+        return m_begin == reinterpret_cast< ConstPointer >( m_storage.m_bytes );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::Reserve( SizeType capacity )
+    {
+        if ( capacity > Capacity() )
+        {
+            IncreaseCapacity( capacity );
+        }
+        else if ( capacity == 0 )
+        {
+            Clear();
+            Release();
+        }
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::Resize( SizeType size, ConstReference value )
+    {
+        if ( size < Size() )
+        {
+            while ( Size() > size )
+            {
+                PopBack();
+            }
+        }
+        else if ( size > Size() )
+        {
+            if ( size > Capacity() )
+            {
+                IncreaseCapacity( size );
+            }
+            MemoryUtils::Fill( m_end, m_begin + size, value );
+            m_end = m_begin + size;
+        }
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::PushBack( ConstReference value )
+    {
+        if ( m_end == m_capacity )
+        {
+            // value may be an element of the array
+            const Bool inside = ( &value >= m_begin ) && ( &value < m_end );
+            const SizeType index = static_cast< SizeType >( &value - m_begin );
+
+            IncreaseCapacity( 2 * Capacity() );
+
+            if ( inside )
+            {
+                ::new( m_end ) ValueType( m_begin[ index ] );
+                ++m_end;
+                return;
+            }
+        }
+        ::new( m_end ) ValueType( value );
+        ++m_end;
+    }
+
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::PushBack( ValueType&& value )
+    {
+        if ( m_end == m_capacity )
+        {
+            const Bool inside = ( &value >= m_begin ) && ( &value < m_end );
+            const SizeType index = static_cast< SizeType >( &value - m_begin );
+
+            IncreaseCapacity( 2 * Capacity() );
+
+            if ( inside )
+            {
+                ::new( m_end ) ValueType( Move( m_begin[ index ] ) );
+                ++m_end;
+                return;
+            }
+        }
+        ::new( m_end ) ValueType( Move( value ) );
+        ++m_end;
+    }
+#endif
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::PushBack( ConstPointer p, SizeType n )
+    {
+        PushBack( p, p + n );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::PushBack( ConstIterator begin, ConstIterator end )
+    {
+        const SizeType size = Size() + static_cast< SizeType >( end - begin );
+        if ( size > Capacity() )
+        {
+            CARBON_ASSERT( end <= m_begin || begin >= m_end );  // can't append a range of itself when growing
+            IncreaseCapacity( ( size > 2 * Capacity() ) ? size : 2 * Capacity() );
+        }
+        MemoryUtils::Copy( begin, end, m_end );
+        m_end = m_begin + size;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Pointer SmallArray< T, N, Alloc >::PrepareEmplace()
+    {
+        if ( m_end == m_capacity )
+        {
+            IncreaseCapacity( 2 * Capacity() );
+        }
+        return m_end++;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Reference SmallArray< T, N, Alloc >::EmplaceBack()
+    {
+        return *::new( PrepareEmplace() ) ValueType();
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    template< typename A1 >
+    typename SmallArray< T, N, Alloc >::Reference SmallArray< T, N, Alloc >::EmplaceBack( CARBON_FWD_REF( A1 ) a1 )
+    {
+        return *::new( PrepareEmplace() ) ValueType( CARBON_FORWARD( A1, a1 ) );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    template< typename A1, typename A2 >
+    typename SmallArray< T, N, Alloc >::Reference SmallArray< T, N, Alloc >::EmplaceBack( CARBON_FWD_REF( A1 ) a1, CARBON_FWD_REF( A2 ) a2 )
+    {
+        return *::new( PrepareEmplace() ) ValueType( CARBON_FORWARD( A1, a1 ), CARBON_FORWARD( A2, a2 ) );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    template< typename A1, typename A2, typename A3 >
+    typename SmallArray< T, N, Alloc >::Reference SmallArray< T, N, Alloc >::EmplaceBack( CARBON_FWD_REF( A1 ) a1, CARBON_FWD_REF( A2 ) a2, CARBON_FWD_REF( A3 ) a3 )
+    {
+        return *::new( PrepareEmplace() ) ValueType( CARBON_FORWARD( A1, a1 ), CARBON_FORWARD( A2, a2 ), CARBON_FORWARD( A3, a3 ) );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Iterator SmallArray< T, N, Alloc >::Erase( Iterator pos )
+    {
+        return Erase( pos, pos + 1 );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Iterator SmallArray< T, N, Alloc >::Erase( Iterator begin, Iterator end )
+    {
+        CARBON_ASSERT( begin >= m_begin && begin <= end && end <= m_end );
+
+        Iterator to = begin;
+        for ( Iterator from = end; from != m_end; ++from, ++to )
+        {
+            *to = Move( *from );
+        }
+        while ( m_end != to )
+        {
+            PopBack();
+        }
+
+        return begin;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::EraseUnordered( Iterator pos )
+    {
+        CARBON_ASSERT( pos >= m_begin && pos < m_end );
+
+        if ( pos != m_end - 1 )
+        {
+            *pos = Move( *( m_end - 1 ) );
+        }
+        PopBack();
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::PopBack()
+    {
+        CARBON_ASSERT( m_begin < m_end );
+        --m_end;
+        if ( ! IsPOD< T >::value )
+        {
+            m_end->~ValueType();
+        }
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::Clear()
+    {
+        if ( IsPOD< T >::value )
+        {
+            m_end = m_begin;
+        }
+        else
+        {
+            while ( m_begin != m_end )
+            {
+                PopBack();
+            }
+        }
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    typename SmallArray< T, N, Alloc >::Pointer SmallArray< T, N, Alloc >::InlineBuffer()
+    {
+        return reinterpret_cast< Pointer >( m_storage.m_bytes );
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::IncreaseCapacity( SizeType capacity )
+    {
+        CARBON_ASSERT( capacity > Capacity() );
+
+        const SizeType size = Size();
+        Pointer ptr = static_cast< Pointer >( Alloc::Allocate( capacity * sizeof( ValueType ), MemoryUtils::AlignOf< ValueType >() ) );
+
+        if ( IsTriviallyRelocatable< T >::value )
+        {
+            MemoryUtils::MemCpy( ptr, m_begin, size * sizeof( ValueType ) );
+        }
+        else
+        {
+            for ( SizeType i=0; i<size; ++i )
+            {
+                ::new( ptr + i ) ValueType( Move( m_begin[ i ] ) );
+                m_begin[ i ].~ValueType();
+            }
+        }
+
+        if ( ! IsInline() )
+        {
+            Alloc::Deallocate( m_begin );
+        }
+
+        m_begin = ptr;
+        m_end = ptr + size;
+        m_capacity = ptr + capacity;
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::Release()
+    {
+        CARBON_ASSERT( Empty() );
+
+        if ( ! IsInline() )
+        {
+            Alloc::Deallocate( m_begin );
+            m_begin = m_end = InlineBuffer();
+            m_capacity = m_begin + N;
+        }
+    }
+
+    template< typename T, SizeT N, typename Alloc >
+    void SmallArray< T, N, Alloc >::StealOrMove( SmallArray& other )
+    {
+        CARBON_ASSERT( Empty() );
+
+        if ( other.IsInline() )
+        {
+            // other fits in any capacity, move its elements
+            for ( Iterator it = other.m_begin; it != other.m_end; ++it )
+            {
+                ::new( m_end ) ValueType( Move( *it ) );
+                ++m_end;
+            }
+            other.Clear();
+        }
+        else
+        {
+            Release();
+
+            m_begin     = other.m_begin;
+            m_end       = other.m_end;
+            m_capacity  = other.m_capacity;
+
+            other.m_begin = other.m_end = other.InlineBuffer();
+            other.m_capacity = other.m_begin + N;
+        }
+    }
+
+    //========================================================================= SmallArray
+}
+
+#endif // _CORE_SMALLARRAY_H
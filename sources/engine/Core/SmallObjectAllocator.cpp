@@ -0,0 +1,284 @@
+#include "Core/SmallObjectAllocator.h"
+
+#include "Core/MemoryManager.h"
+#include "Core/NativeAllocator.h"
+#include "Core/SpinLock.h"
+#include "Core/Thread.h"
+#include "Core/Atomic.h"
+#include "Core/MemoryUtils.h"
+
+#include "Core/Assert.h"
+
+namespace Core
+{
+    //====================================================================================
+    // SmallObjectAllocator
+    //====================================================================================
+
+    const SizeT transferBatchSize   = 32;                       // blocks moved between a cache and the shared lists
+    const SizeT maxCachedBlockCount = 2 * transferBatchSize;    // per class and per thread
+
+    struct FreeBlock
+    {
+        FreeBlock * m_next;
+    };
+
+    struct FreeList
+    {
+        FreeBlock * m_head;
+        SizeT       m_count;
+    };
+
+    struct SharedFreeList
+    {
+        SpinLock    m_lock;
+        FreeList    m_list;
+    };
+
+    struct ThreadCache
+    {
+        FreeList    m_lists[ SmallObjectAllocator::ms_classCount ];
+        U8 *        m_slabHead[ SmallObjectAllocator::ms_classCount ];  // lazy carving of the last slab taken
+        U8 *        m_slabEnd[ SmallObjectAllocator::ms_classCount ];
+        SizeT       m_allocCount;
+        SizeT       m_freeCount;
+        U8          m_padding[ 64 ];                                    // keep caches on different cache lines
+    };
+
+    static U8 *             heapBegin       = 0;
+    static U8 *             heapEnd         = 0;
+    static U8 *             slabClasses     = 0;    // size class of each slab
+    static U8 *             blockTags       = 0;    // memory tag of each granule, when memory is tracked
+    static volatile S32     slabCount       = 0;
+    static SizeT            maxSlabCount    = 0;
+    static SharedFreeList   sharedLists[ SmallObjectAllocator::ms_classCount ];
+    static ThreadCache      threadCaches[ Thread::ms_maxThreadCount ];
+
+    inline SizeT SizeToClass( SizeT sizeBytes )
+    {
+        return ( sizeBytes == 0 ) ? 0 : ( sizeBytes - 1 ) / SmallObjectAllocator::ms_granularity;
+    }
+
+    inline SizeT ClassToSize( SizeT sizeClass )
+    {
+        return ( sizeClass + 1 ) * SmallObjectAllocator::ms_granularity;
+    }
+
+    static Bool TakeSlab( ThreadCache& cache, SizeT sizeClass )
+    {
+        S32 slab = AtomicIncrement( &slabCount ) - 1;
+        if ( static_cast< SizeT >( slab ) >= maxSlabCount )
+        {
+            return false;
+        }
+
+        slabClasses[ slab ] = static_cast< U8 >( sizeClass );
+
+        U8 * begin = heapBegin + slab * SmallObjectAllocator::ms_slabSize;
+        cache.m_slabHead[ sizeClass ]   = begin;
+        cache.m_slabEnd[ sizeClass ]    = begin + SmallObjectAllocator::ms_slabSize;
+
+        return true;
+    }
+
+    static Bool Refill( ThreadCache& cache, SizeT sizeClass )
+    {
+        FreeList& list = cache.m_lists[ sizeClass ];
+
+        // Get a batch from the shared list
+        SharedFreeList& shared = sharedLists[ sizeClass ];
+        if ( shared.m_list.m_count )
+        {
+            ScopedLock< SpinLock > lock( shared.m_lock );
+
+            while ( shared.m_list.m_head && list.m_count < transferBatchSize )
+            {
+                FreeBlock * block       = shared.m_list.m_head;
+                shared.m_list.m_head    = block->m_next;
+                --shared.m_list.m_count;
+
+                block->m_next           = list.m_head;
+                list.m_head             = block;
+                ++list.m_count;
+            }
+        }
+
+        if ( list.m_head )
+        {
+            return true;
+        }
+
+        // Or carve the slab
+        const SizeT blockSize = ClassToSize( sizeClass );
+        if ( ( cache.m_slabHead[ sizeClass ] + blockSize > cache.m_slabEnd[ sizeClass ] ) && ! TakeSlab( cache, sizeClass ) )
+        {
+            return false;
+        }
+
+        FreeBlock * block = reinterpret_cast< FreeBlock * >( cache.m_slabHead[ sizeClass ] );
+        cache.m_slabHead[ sizeClass ] += blockSize;
+
+        block->m_next   = 0;
+        list.m_head     = block;
+        list.m_count    = 1;
+
+        return true;
+    }
+
+    // Moves the cached blocks of a class past keepCount to the shared list
+    static void Flush( ThreadCache& cache, SizeT sizeClass, SizeT keepCount )
+    {
+        FreeList& list = cache.m_lists[ sizeClass ];
+        SharedFreeList& shared = sharedLists[ sizeClass ];
+
+        ScopedLock< SpinLock > lock( shared.m_lock );
+
+        while ( list.m_count > keepCount )
+        {
+            FreeBlock * block       = list.m_head;
+            list.m_head             = block->m_next;
+            --list.m_count;
+
+            block->m_next           = shared.m_list.m_head;
+            shared.m_list.m_head    = block;
+            ++shared.m_list.m_count;
+        }
+    }
+
+    void SmallObjectAllocator::Initialize( SizeT heapSize )
+    {
+        CARBON_ASSERT( heapSize >= ms_slabSize );
+
+        if ( heapBegin )
+        {
+            // blocks survived the last Destroy, keep the same heap
+            return;
+        }
+
+        maxSlabCount    = heapSize / ms_slabSize;
+        heapBegin       = static_cast< U8 * >( NativeAllocator::Malloc( maxSlabCount * ms_slabSize, ms_slabSize ) );
+        heapEnd         = heapBegin + maxSlabCount * ms_slabSize;
+        slabClasses     = static_cast< U8 * >( NativeAllocator::Malloc( maxSlabCount ) );
+        slabCount       = 0;
+
+    #if defined( CARBON_TRACK_MEMORY )
+        blockTags       = static_cast< U8 * >( NativeAllocator::Malloc( maxSlabCount * ( ms_slabSize / ms_granularity ) ) );
+    #endif
+
+        MemoryUtils::MemSet( sharedLists, 0, sizeof(sharedLists) );
+        MemoryUtils::MemSet( threadCaches, 0, sizeof(threadCaches) );
+    }
+
+    void SmallObjectAllocator::Destroy()
+    {
+        SizeT liveCount = 0;
+        for ( SizeT i=0; i<Thread::ms_maxThreadCount; ++i )
+        {
+            liveCount += threadCaches[ i ].m_allocCount - threadCaches[ i ].m_freeCount;
+        }
+
+        // Some blocks may be released later (by static destructors), the heap is left
+        // to the system in that case
+        if ( liveCount == 0 )
+        {
+            NativeAllocator::Free( blockTags );
+            NativeAllocator::Free( slabClasses );
+            NativeAllocator::Free( heapBegin );
+            heapBegin = heapEnd = slabClasses = blockTags = 0;
+            maxSlabCount = 0;
+        }
+    }
+
+    void * SmallObjectAllocator::Allocate( SizeT sizeBytes )
+    {
+        CARBON_ASSERT( sizeBytes <= ms_maxBlockSize );
+
+        if ( ! heapBegin )
+        {
+            return 0;
+        }
+
+        const SizeT sizeClass = SizeToClass( sizeBytes );
+
+        ThreadCache& cache = threadCaches[ Thread::GetCurrentIndex() ];
+        FreeList& list = cache.m_lists[ sizeClass ];
+
+        if ( ! list.m_head && ! Refill( cache, sizeClass ) )
+        {
+            return 0;
+        }
+
+        FreeBlock * block = list.m_head;
+        list.m_head = block->m_next;
+        --list.m_count;
+        ++cache.m_allocCount;
+
+        return block;
+    }
+
+    void SmallObjectAllocator::Free( void * ptr )
+    {
+        CARBON_ASSERT( IsOwner( ptr ) );
+
+        const SizeT sizeClass = slabClasses[ ( static_cast< U8 * >( ptr ) - heapBegin ) / ms_slabSize ];
+
+        ThreadCache& cache = threadCaches[ Thread::GetCurrentIndex() ];
+        FreeList& list = cache.m_lists[ sizeClass ];
+
+        FreeBlock * block = static_cast< FreeBlock * >( ptr );
+        block->m_next = list.m_head;
+        list.m_head = block;
+        ++list.m_count;
+        ++cache.m_freeCount;
+
+        if ( list.m_count > maxCachedBlockCount )
+        {
+            Flush( cache, sizeClass, transferBatchSize );
+        }
+    }
+
+    void SmallObjectAllocator::FlushThreadCache()
+    {
+        if ( ! heapBegin )
+        {
+            return;
+        }
+
+        ThreadCache& cache = threadCaches[ Thread::GetCurrentIndex() ];
+        for ( SizeT c=0; c<ms_classCount; ++c )
+        {
+            if ( cache.m_lists[ c ].m_count )
+            {
+                Flush( cache, c, 0 );
+            }
+        }
+    }
+
+    Bool SmallObjectAllocator::IsOwner( const void * ptr )
+    {
+        return ( ptr >= heapBegin ) && ( ptr < heapEnd );
+    }
+
+    SizeT SmallObjectAllocator::GetBlockSize( const void * ptr )
+    {
+        CARBON_ASSERT( IsOwner( ptr ) );
+
+        return ClassToSize( slabClasses[ ( static_cast< const U8 * >( ptr ) - heapBegin ) / ms_slabSize ] );
+    }
+
+    void SmallObjectAllocator::SetTag( void * ptr, U8 tag )
+    {
+        CARBON_ASSERT( IsOwner( ptr ) && blockTags );
+
+        blockTags[ ( static_cast< U8 * >( ptr ) - heapBegin ) / ms_granularity ] = tag;
+    }
+
+    U8 SmallObjectAllocator::GetTag( const void * ptr )
+    {
+        CARBON_ASSERT( IsOwner( ptr ) && blockTags );
+
+        return blockTags[ ( static_cast< const U8 * >( ptr ) - heapBegin ) / ms_granularity ];
+    }
+
+    //=============================================================== SmallObjectAllocator
+}
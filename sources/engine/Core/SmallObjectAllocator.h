@@ -0,0 +1,48 @@
+#pragma once
+#ifndef _CORE_SMALLOBJECTALLOCATOR_H
+#define _CORE_SMALLOBJECTALLOCATOR_H
+
+#include "Core/Types.h"
+#include "Core/DLL.h"
+
+namespace Core
+{
+    //====================================================================================
+    // SmallObjectAllocator
+    //====================================================================================
+
+    // Segregated size class allocator for blocks up to ms_maxBlockSize bytes.
+    // Blocks are carved from slabs of one size class taken in a single reserved heap,
+    // so the class of a block is found from its address (no header).
+    // Each thread allocates and frees in its own cache, the shared free lists are only
+    // touched by batches when a cache is empty or too big.
+
+    class _CoreExport SmallObjectAllocator
+    {
+    public:
+        static const SizeT  ms_granularity  = 16;
+        static const SizeT  ms_maxBlockSize = 256;
+        static const SizeT  ms_classCount   = ms_maxBlockSize / ms_granularity;
+        static const SizeT  ms_slabSize     = 64 * 1024;
+
+        static void     Initialize( SizeT heapSize );
+        static void     Destroy();
+
+        static void *   Allocate( SizeT sizeBytes );    // 0 when the heap is exhausted
+        static void     Free( void * ptr );
+
+        // Gives the blocks cached by the current thread to the other threads, when it ends
+        static void     FlushThreadCache();
+
+        static Bool     IsOwner( const void * ptr );
+        static SizeT    GetBlockSize( const void * ptr );
+
+        // Memory tag of a block, kept out of the block for the memory accounting
+        static void     SetTag( void * ptr, U8 tag );
+        static U8       GetTag( const void * ptr );
+    };
+
+    //=============================================================== SmallObjectAllocator
+}
+
+#endif // _CORE_SMALLOBJECTALLOCATOR_H
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef _CORE_SPINLOCK_H
+#define _CORE_SPINLOCK_H
+
+#include "Core/Atomic.h"
+
+namespace Core
+{
+    //====================================================================================
+    // SpinLock
+    //====================================================================================
+
+    // Busy waiting lock, only for very short critical sections.
+
+    class SpinLock
+    {
+    public:
+        SpinLock();
+
+        void Lock();
+        Bool TryLock();
+        void Unlock();
+
+    private:
+        volatile S32    m_lock;
+    };
+
+    //=========================================================================== SpinLock
+
+    inline SpinLock::SpinLock()
+        : m_lock( 0 )
+    {
+    }
+
+    inline void SpinLock::Lock()
+    {
+        while ( ! TryLock() )
+        {
+            while ( AtomicLoad( &m_lock ) != 0 )
+            {
+                CpuPause();
+            }
+        }
+    }
+
+    inline Bool SpinLock::TryLock()
+    {
+        return AtomicCompareExchange( &m_lock, 1, 0 ) == 0;
+    }
+
+    inline void SpinLock::Unlock()
+    {
+        AtomicStore( &m_lock, 0 );
+    }
+
+    //=========================================================================== SpinLock
+
+    //====================================================================================
+    // ScopedLock
+    //====================================================================================
+
+    template< typename L >
+    class ScopedLock
+    {
+    public:
+        ScopedLock( L& lock ) : m_lock( lock )  { m_lock.Lock();    }
+        ~ScopedLock()                           { m_lock.Unlock();  }
+
+    private:
+        ScopedLock( const ScopedLock& );
+        ScopedLock& operator=( const ScopedLock& );
+
+        L&  m_lock;
+    };
+
+    //========================================================================= ScopedLock
+}
+
+#endif // _CORE_SPINLOCK_H
@@ -0,0 +1,126 @@
+#pragma once
+#ifndef _CORE_SPSCQUEUE_H
+#define _CORE_SPSCQUEUE_H
+
+#include "Core/Atomic.h"
+#include "Core/Assert.h"
+
+namespace Core
+{
+    //====================================================================================
+    // SpscQueue
+    //====================================================================================
+
+    // Bounded ring buffer between one producer and one consumer thread, wait free.
+    // C is a power of 2. Indices grow forever and wrap around, each side keeps a copy of
+    // the other index and only reads the shared one when its copy says full or empty.
+
+    template< typename T, SizeT C >
+    class SpscQueue
+    {
+    public:
+        typedef T           ValueType;
+        typedef const T&    ConstReference;
+        typedef T&          Reference;
+        typedef SizeT       SizeType;
+
+    public:
+        SpscQueue();
+
+        Bool            Push( ConstReference value );       // producer, false when full
+        Bool            Pop( Reference value );             // consumer, false when empty
+
+        // Snapshots, exact only from a side which is not running
+        Bool            Empty() const;
+        SizeType        Size() const;
+        SizeType        Capacity() const;
+
+    private:
+        SpscQueue( const SpscQueue& );
+        SpscQueue& operator=( const SpscQueue& );
+
+        static const U32 ms_mask = C - 1;
+
+        volatile S32    m_head;                             // consumer side
+        U32             m_cachedTail;
+        U8              m_pad0[ CARBON_CACHE_LINE_SIZE - 2 * sizeof( U32 ) ];
+        volatile S32    m_tail;                             // producer side
+        U32             m_cachedHead;
+        U8              m_pad1[ CARBON_CACHE_LINE_SIZE - 2 * sizeof( U32 ) ];
+        ValueType       m_items[ C ];
+    };
+
+    //========================================================================== SpscQueue
+
+    template< typename T, SizeT C >
+    SpscQueue< T, C >::SpscQueue()
+        : m_head( 0 )
+        , m_cachedTail( 0 )
+        , m_tail( 0 )
+        , m_cachedHead( 0 )
+    {
+        CARBON_COMPILE_TIME_ASSERT( C > 0 && ( C & ( C - 1 ) ) == 0 );
+    }
+
+    template< typename T, SizeT C >
+    Bool SpscQueue< T, C >::Push( ConstReference value )
+    {
+        const U32 tail = m_tail;
+
+        if ( tail - m_cachedHead == C )
+        {
+            m_cachedHead = AtomicLoad( &m_head );
+            if ( tail - m_cachedHead == C )
+            {
+                return false;
+            }
+        }
+
+        m_items[ tail & ms_mask ] = value;
+        AtomicStore( &m_tail, static_cast< S32 >( tail + 1 ) );
+        return true;
+    }
+
+    template< typename T, SizeT C >
+    Bool SpscQueue< T, C >::Pop( Reference value )
+    {
+        const U32 head = m_head;
+
+        if ( head == m_cachedTail )
+        {
+            m_cachedTail = AtomicLoad( &m_tail );
+            if ( head == m_cachedTail )
+            {
+                return false;
+            }
+        }
+
+        value = m_items[ head & ms_mask ];
+        AtomicStore( &m_head, static_cast< S32 >( head + 1 ) );
+        return true;
+    }
+
+    template< typename T, SizeT C >
+    Bool SpscQueue< T, C >::Empty() const
+    {
+        return Size() == 0;
+    }
+
+    template< typename T, SizeT C >
+    SizeT SpscQueue< T, C >::Size() const
+    {
+        const U32 head = AtomicLoad( &m_head );
+        const U32 tail = AtomicLoad( &m_tail );
+        return tail - head;
+    }
+
+    template< typename T, SizeT C >
+    SizeT SpscQueue< T, C >::Capacity() const
+    {
+        return C;
+    }
+
+    //========================================================================== SpscQueue
+}
+
+#endif // _CORE_SPSCQUEUE_H
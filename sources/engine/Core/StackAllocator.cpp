@@ -5,8 +5,12 @@
 
 namespace Core
 {
+    //====================================================================================
+    // StackAllocator
+    //====================================================================================
+
     StackAllocator::StackAllocator()
-        : mp_buffer(0), m_end(0), m_head(0)
+        : mp_buffer(0), m_end(0), m_head(0), m_highWaterMark(0)
     {
     }
 
@@ -19,6 +23,7 @@ namespace Core
         mp_buffer = buffer;
         m_head = reinterpret_cast< SizeT >( mp_buffer );
         m_end = m_head + sizeBytes;
+        m_highWaterMark = 0;
     }
 
     void StackAllocator::Destroy()
@@ -40,6 +45,132 @@ namespace Core
 
         CARBON_ASSERT( m_head <= m_end );
 
+        if ( GetUsedBytes() > m_highWaterMark )
+        {
+            m_highWaterMark = GetUsedBytes();
+        }
+
+        return reinterpret_cast< void * >( a );
+    }
+
+    StackAllocator::Marker StackAllocator::GetMarker() const
+    {
+        return m_head;
+    }
+
+    void StackAllocator::Rewind( Marker marker )
+    {
+        CARBON_ASSERT( marker >= reinterpret_cast< SizeT >( mp_buffer ) );
+        CARBON_ASSERT( marker <= m_head );
+
+        m_head = marker;
+    }
+
+    SizeT StackAllocator::GetUsedBytes() const
+    {
+        return m_head - reinterpret_cast< SizeT >( mp_buffer );
+    }
+
+    SizeT StackAllocator::GetHighWaterMark() const
+    {
+        return m_highWaterMark;
+    }
+
+    //===================================================================== StackAllocator
+
+    //====================================================================================
+    // DoubleEndedStackAllocator
+    //====================================================================================
+
+    DoubleEndedStackAllocator::DoubleEndedStackAllocator()
+        : mp_buffer(0), m_begin(0), m_end(0), m_bottom(0), m_top(0)
+    {
+    }
+
+    void DoubleEndedStackAllocator::Initialize( void * buffer, SizeT sizeBytes )
+    {
+        CARBON_ASSERT( buffer != 0 );
+        CARBON_ASSERT( sizeBytes > 0 );
+        CARBON_ASSERT( mp_buffer == 0 );
+
+        mp_buffer = buffer;
+        m_begin = m_bottom = reinterpret_cast< SizeT >( mp_buffer );
+        m_end = m_top = m_begin + sizeBytes;
+    }
+
+    void DoubleEndedStackAllocator::Destroy()
+    {
+        mp_buffer = 0;
+        m_begin = m_end = m_bottom = m_top = 0;
+    }
+
+    void DoubleEndedStackAllocator::Clear()
+    {
+        ClearBottom();
+        ClearTop();
+    }
+
+    void DoubleEndedStackAllocator::ClearBottom()
+    {
+        m_bottom = m_begin;
+    }
+
+    void DoubleEndedStackAllocator::ClearTop()
+    {
+        m_top = m_end;
+    }
+
+    void * DoubleEndedStackAllocator::AllocateBottom( SizeT sizeBytes, SizeT align )
+    {
+        SizeT a = MemoryUtils::GetNextAlignedAddress( m_bottom, align );
+
+        CARBON_ASSERT( a + sizeBytes <= m_top );
+
+        m_bottom = a + sizeBytes;
+
+        return reinterpret_cast< void * >( a );
+    }
+
+    void * DoubleEndedStackAllocator::AllocateTop( SizeT sizeBytes, SizeT align )
+    {
+        CARBON_ASSERT( m_top - m_bottom >= sizeBytes );
+
+        // align down
+        SizeT a = ( m_top - sizeBytes ) & ~( align - 1 );
+
+        CARBON_ASSERT( a >= m_bottom );
+
+        m_top = a;
+
         return reinterpret_cast< void * >( a );
     }
+
+    DoubleEndedStackAllocator::Marker DoubleEndedStackAllocator::GetBottomMarker() const
+    {
+        return m_bottom;
+    }
+
+    DoubleEndedStackAllocator::Marker DoubleEndedStackAllocator::GetTopMarker() const
+    {
+        return m_top;
+    }
+
+    void DoubleEndedStackAllocator::RewindBottom( Marker marker )
+    {
+        CARBON_ASSERT( marker >= m_begin && marker <= m_bottom );
+        m_bottom = marker;
+    }
+
+    void DoubleEndedStackAllocator::RewindTop( Marker marker )
+    {
+        CARBON_ASSERT( marker >= m_top && marker <= m_end );
+        m_top = marker;
+    }
+
+    SizeT DoubleEndedStackAllocator::GetFreeBytes() const
+    {
+        return m_top - m_bottom;
+    }
+
+    //========================================================== DoubleEndedStackAllocator
 }
@@ -7,9 +7,18 @@
 
 namespace Core
 {
+    //====================================================================================
+    // StackAllocator
+    //====================================================================================
+
+    // Linear allocator on a user buffer. Memory is given back LIFO-style by rewinding
+    // to a marker taken before the allocations.
+
     class _CoreExport StackAllocator
     {
     public:
+        typedef SizeT Marker;
+
         StackAllocator();
 
         void Initialize( void * buffer, SizeT sizeBytes );
@@ -19,11 +28,100 @@ namespace Core
 
         void * Allocate( SizeT sizeBytes, SizeT align = 1 );
 
+        Marker GetMarker() const;
+        void Rewind( Marker marker );
+
+        SizeT GetUsedBytes() const;
+        SizeT GetHighWaterMark() const;
+
     private:
         void *  mp_buffer;
         SizeT   m_end;
         SizeT   m_head;
+        SizeT   m_highWaterMark;
     };
+
+    //===================================================================== StackAllocator
+
+    //====================================================================================
+    // DoubleEndedStackAllocator
+    //====================================================================================
+
+    // Two stacks sharing one buffer : the bottom grows up and the top grows down.
+    // Typical use is persistent data at the bottom and load-time data at the top.
+
+    class _CoreExport DoubleEndedStackAllocator
+    {
+    public:
+        typedef SizeT Marker;
+
+        DoubleEndedStackAllocator();
+
+        void Initialize( void * buffer, SizeT sizeBytes );
+        void Destroy();
+
+        void Clear();
+        void ClearBottom();
+        void ClearTop();
+
+        void * AllocateBottom( SizeT sizeBytes, SizeT align = 1 );
+        void * AllocateTop( SizeT sizeBytes, SizeT align = 1 );
+
+        Marker GetBottomMarker() const;
+        Marker GetTopMarker() const;
+        void RewindBottom( Marker marker );
+        void RewindTop( Marker marker );
+
+        SizeT GetFreeBytes() const;
+
+    private:
+        void *  mp_buffer;
+        SizeT   m_begin;
+        SizeT   m_end;
+        SizeT   m_bottom;
+        SizeT   m_top;
+    };
+
+    //========================================================== DoubleEndedStackAllocator
+
+    //====================================================================================
+    // StackScope
+    //====================================================================================
+
+    // Rewinds a stack to where it was when the scope was created.
+    // Works with any type providing Marker, GetMarker and Rewind (StackAllocator, LinearArena).
+
+    template< typename Stack >
+    class StackScope
+    {
+    public:
+        explicit StackScope( Stack& stack );
+        ~StackScope();
+
+    private:
+        StackScope( const StackScope& );
+        StackScope& operator=( const StackScope& );
+
+        Stack&                  m_stack;
+        typename Stack::Marker  m_marker;
+    };
+
+    //========================================================================= StackScope
+
+    template< typename Stack >
+    StackScope< Stack >::StackScope( Stack& stack )
+        : m_stack( stack )
+        , m_marker( stack.GetMarker() )
+    {
+    }
+
+    template< typename Stack >
+    StackScope< Stack >::~StackScope()
+    {
+        m_stack.Rewind( m_marker );
+    }
+
+    //========================================================================= StackScope
 }
 
 #endif // _CORE_STACKALLOCATOR_H
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef _CORE_THREAD_H
+#define _CORE_THREAD_H
+
+#include "Core/Types.h"
+#include "Core/DLL.h"
+
+namespace Core
+{
+    typedef void *  ThreadHandle;
+    typedef void    ( *ThreadFunction )( void * data );
+
+    class _CoreExport Thread
+    {
+    public:
+        static const SizeT ms_maxThreadCount = 32;
+
+        // Runs function( data ) on a new thread, Join waits for its end and releases it
+        static ThreadHandle Start( ThreadFunction function, void * data );
+        static void Join( ThreadHandle thread );
+
+        // Small index, unique among the running threads, given on the first call.
+        // Used to address per thread data without locking.
+        static SizeT GetCurrentIndex();
+
+        // Flushes the small object cache of the thread and gives the index back for a
+        // new thread. Called at the end of the threads run by Start, the other threads
+        // call it before they exit.
+        static void ReleaseCurrentIndex();
+
+        static U32 GetCurrentId();
+    };
+}
+
+#endif // _CORE_THREAD_H
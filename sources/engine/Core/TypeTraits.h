@@ -4,6 +4,19 @@
 
 #include "Core/Types.h"
 
+// rvalue references are available from Visual Studio 2010
+#if ( defined( _MSC_VER ) && ( _MSC_VER >= 1600 ) ) || defined( __GXX_EXPERIMENTAL_CXX0X__ ) || ( __cplusplus >= 201103L )
+    #define CARBON_HAS_RVALUE_REFERENCES
+#endif
+
+// constexpr is available from Visual Studio 2015
+#if ( defined( _MSC_VER ) && ( _MSC_VER >= 1900 ) ) || ( __cplusplus >= 201103L )
+    #define CARBON_HAS_CONSTEXPR
+    #define CARBON_CONSTEXPR constexpr
+#else
+    #define CARBON_CONSTEXPR inline
+#endif
+
 namespace Core
 {
     template< typename T, T v >
@@ -45,9 +58,57 @@ namespace Core
 
     template< typename T >
     struct IsPOD< T* const >  : public TrueType { };
+
+    // A trivially relocatable type can be moved to another address with a memcpy, the
+    // source is then considered destroyed. True for POD types and for types which don't
+    // point into themselves (declare them with CARBON_DECLARE_RELOCATABLE_TYPE).
+    template< typename T >
+    struct IsTriviallyRelocatable : public IntegralConstant< Bool, IsPOD< T >::value > { };
+
+    template< typename T >
+    struct RemoveReference { typedef T Type; };
+
+    template< typename T >
+    struct RemoveReference< T& > { typedef T Type; };
+
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+    template< typename T >
+    struct RemoveReference< T&& > { typedef T Type; };
+
+    template< typename T >
+    inline typename RemoveReference< T >::Type&& Move( T&& value )
+    {
+        return static_cast< typename RemoveReference< T >::Type&& >( value );
+    }
+
+    template< typename T >
+    inline T&& Forward( typename RemoveReference< T >::Type& value )
+    {
+        return static_cast< T&& >( value );
+    }
+#else
+    template< typename T >
+    inline T& Move( T& value )
+    {
+        return value;
+    }
+#endif
 }
 
 #define CARBON_DECLARE_POD_TYPE( T ) \
     template< > struct Core::IsPOD< T > : public TrueType { }
 
+#define CARBON_DECLARE_RELOCATABLE_TYPE( T ) \
+    template< > struct Core::IsTriviallyRelocatable< T > : public TrueType { }
+
+// Perfect forwarding of constructor arguments when rvalue references are available,
+// const references otherwise
+#if defined( CARBON_HAS_RVALUE_REFERENCES )
+    #define CARBON_FWD_REF( A )         A&&
+    #define CARBON_FORWARD( A, a )      Core::Forward< A >( a )
+#else
+    #define CARBON_FWD_REF( A )         const A&
+    #define CARBON_FORWARD( A, a )      a
+#endif
+
 #endif // _CORE_TYPETRAITS_H
@@ -21,6 +21,16 @@ typedef double              F64;
 
 #endif
 
+#if defined( _MSC_VER )
+    #define CARBON_ALIGN( n )       __declspec( align( n ) )
+    #define CARBON_FORCE_INLINE     __forceinline
+#else
+    #define CARBON_ALIGN( n )       __attribute__( ( aligned( n ) ) )
+    #define CARBON_FORCE_INLINE     inline __attribute__( ( always_inline ) )
+#endif
+
+#define CARBON_CACHE_LINE_SIZE      64
+
 typedef bool	Bool;
 typedef char	Char;
 typedef U32     SizeT;
@@ -39,6 +39,9 @@ namespace Core
             && ( d[ 2 ] == d[ 3 ] );
     }
 
+    // GCC and Clang vector types already have arithmetic operators, their comparisons give
+    // integer masks : use LessThan and the other comparison functions there
+#if defined( _MSC_VER )
     inline Vector operator-( Vector v )                         { return Neg( v );                      }
     inline Vector operator+( Vector l, Vector r )               { return Add( l, r );                   }
     inline Vector operator-( Vector l, Vector r )               { return Sub( l, r );                   }
@@ -52,6 +55,7 @@ namespace Core
     inline Vector operator>=( Vector l, Vector r )              { return GreaterEqual( l, r );          }
     inline Vector operator==( Vector l, Vector r )              { return Equal( l, r );                 }
     inline Vector operator!=( Vector l, Vector r )              { return NotEqual( l, r );              }
+#endif
 
     // Geometric
     inline Vector Dot( Vector l, Vector r )
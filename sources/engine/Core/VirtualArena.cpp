@@ -0,0 +1,140 @@
+#include "Core/VirtualArena.h"
+
+#include "Core/VirtualMemory.h"
+#include "Core/MemoryUtils.h"
+#include "Core/Assert.h"
+
+namespace Core
+{
+    //====================================================================================
+    // VirtualArena
+    //====================================================================================
+
+    VirtualArena::VirtualArena()
+        : mp_base( 0 ), m_head( 0 ), m_committed( 0 ), m_reserved( 0 ), m_commitGranularity( 0 ), m_largePages( false )
+    {
+    }
+
+    void VirtualArena::Initialize( SizeT reserveSize, Bool largePages, SizeT commitGranularity )
+    {
+        CARBON_ASSERT( mp_base == 0 );
+        CARBON_ASSERT( reserveSize > 0 );
+
+        m_head              = 0;
+        m_commitGranularity = VirtualMemory::RoundUp( commitGranularity, VirtualMemory::GetPageSize() );
+        m_largePages        = false;
+
+        if ( largePages )
+        {
+            mp_base = static_cast< U8 * >( VirtualMemory::ReserveAndCommitLarge( reserveSize ) );
+            if ( mp_base )
+            {
+                m_largePages    = true;
+                m_reserved      = VirtualMemory::RoundUp( reserveSize, VirtualMemory::GetLargePageSize() );
+                m_committed     = m_reserved;
+                return;
+            }
+        }
+
+        m_reserved  = VirtualMemory::RoundUp( reserveSize, VirtualMemory::GetAllocationGranularity() );
+        m_committed = 0;
+        mp_base     = static_cast< U8 * >( VirtualMemory::Reserve( m_reserved ) );
+
+        CARBON_ASSERT( mp_base );
+    }
+
+    void VirtualArena::Destroy()
+    {
+        VirtualMemory::Release( mp_base );
+
+        mp_base     = 0;
+        m_head      = 0;
+        m_committed = 0;
+        m_reserved  = 0;
+    }
+
+    Bool VirtualArena::IsInitialized() const
+    {
+        return mp_base != 0;
+    }
+
+    Bool VirtualArena::UsesLargePages() const
+    {
+        return m_largePages;
+    }
+
+    void * VirtualArena::Allocate( SizeT sizeBytes, SizeT align )
+    {
+        CARBON_ASSERT( mp_base );
+
+        const SizeT base    = reinterpret_cast< SizeT >( mp_base );
+        const SizeT a       = MemoryUtils::GetNextAlignedAddress( base + m_head, align ) - base;
+        const SizeT head    = a + sizeBytes;
+
+        if ( head > m_committed )
+        {
+            if ( head > m_reserved )
+            {
+                CARBON_ASSERT( !"VirtualArena : reserved range exhausted" );
+                return 0;
+            }
+
+            SizeT committed = VirtualMemory::RoundUp( head, m_commitGranularity );
+            if ( committed > m_reserved )
+            {
+                committed = m_reserved;
+            }
+
+            if ( ! VirtualMemory::Commit( mp_base + m_committed, committed - m_committed ) )
+            {
+                return 0;
+            }
+            m_committed = committed;
+        }
+
+        m_head = head;
+
+        return mp_base + a;
+    }
+
+    void VirtualArena::Reset( Bool decommit )
+    {
+        CARBON_ASSERT( mp_base );
+
+        m_head = 0;
+
+        if ( decommit && ! m_largePages && m_committed )
+        {
+            VirtualMemory::Decommit( mp_base, m_committed );
+            m_committed = 0;
+        }
+    }
+
+    VirtualArena::Marker VirtualArena::GetMarker() const
+    {
+        return m_head;
+    }
+
+    void VirtualArena::Rewind( Marker marker )
+    {
+        CARBON_ASSERT( marker <= m_head );
+        m_head = marker;
+    }
+
+    SizeT VirtualArena::GetUsedBytes() const
+    {
+        return m_head;
+    }
+
+    SizeT VirtualArena::GetCommittedBytes() const
+    {
+        return m_committed;
+    }
+
+    SizeT VirtualArena::GetReservedBytes() const
+    {
+        return m_reserved;
+    }
+
+    //======================================================================= VirtualArena
+}
@@ -0,0 +1,59 @@
+#pragma once
+#ifndef _CORE_VIRTUALARENA_H
+#define _CORE_VIRTUALARENA_H
+
+#include "Core/Types.h"
+#include "Core/DLL.h"
+
+namespace Core
+{
+    //====================================================================================
+    // VirtualArena
+    //====================================================================================
+
+    // Linear allocator on a reserved range of address space. Memory is committed on
+    // demand by chunks of commitGranularity bytes, allocations never move and the arena
+    // never copies when it grows. With large pages the whole range is committed at
+    // Initialize (fall back to regular pages if the system refuses).
+    // Not thread safe.
+
+    class _CoreExport VirtualArena
+    {
+    public:
+        typedef SizeT Marker;
+
+        static const SizeT ms_defaultCommitGranularity = 64 * 1024;
+
+        VirtualArena();
+
+        void    Initialize( SizeT reserveSize, Bool largePages = false, SizeT commitGranularity = ms_defaultCommitGranularity );
+        void    Destroy();
+
+        Bool    IsInitialized() const;
+        Bool    UsesLargePages() const;
+
+        void *  Allocate( SizeT sizeBytes, SizeT align = 1 );
+
+        // Keeps the committed memory unless decommit is set
+        void    Reset( Bool decommit = false );
+
+        Marker  GetMarker() const;
+        void    Rewind( Marker marker );
+
+        SizeT   GetUsedBytes() const;
+        SizeT   GetCommittedBytes() const;
+        SizeT   GetReservedBytes() const;
+
+    private:
+        U8 *    mp_base;
+        SizeT   m_head;
+        SizeT   m_committed;
+        SizeT   m_reserved;
+        SizeT   m_commitGranularity;
+        Bool    m_largePages;
+    };
+
+    //======================================================================= VirtualArena
+}
+
+#endif // _CORE_VIRTUALARENA_H
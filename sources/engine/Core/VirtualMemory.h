@@ -0,0 +1,168 @@
+#pragma once
+#ifndef _CORE_VIRTUALMEMORY_H
+#define _CORE_VIRTUALMEMORY_H
+
+#include "Core/Types.h"
+#include "Core/DLL.h"
+#include "Core/MemoryUtils.h"
+
+#include "Core/Assert.h"
+
+namespace Core
+{
+    //====================================================================================
+    // VirtualMemory
+    //====================================================================================
+
+    // Address space is reserved first and backed by physical memory (committed) on demand.
+    // Reservations are aligned on the allocation granularity.
+
+    class _CoreExport VirtualMemory
+    {
+    public:
+        static SizeT    GetPageSize();
+        static SizeT    GetAllocationGranularity();
+        static SizeT    GetLargePageSize();         // 0 when large pages are not supported
+
+        static void *   Reserve( SizeT sizeBytes );
+        static void     Release( void * ptr );
+
+        static Bool     Commit( void * ptr, SizeT sizeBytes );
+        static void     Decommit( void * ptr, SizeT sizeBytes );
+
+        // Large pages can't be committed on demand : the whole range is reserved and
+        // committed at once. Returns 0 when not available (the process needs the lock
+        // pages in memory privilege), the caller should fall back to Reserve.
+        static void *   ReserveAndCommitLarge( SizeT sizeBytes );
+
+        static SizeT    RoundUp( SizeT sizeBytes, SizeT granularity );
+    };
+
+    //====================================================================== VirtualMemory
+
+    inline SizeT VirtualMemory::RoundUp( SizeT sizeBytes, SizeT granularity )
+    {
+        return ( sizeBytes + granularity - 1 ) & ~( granularity - 1 );
+    }
+
+    //====================================================================== VirtualMemory
+
+    //====================================================================================
+    // VirtualAllocator
+    //====================================================================================
+
+    // Allocation policy for growable containers : each block reserves RESERVE bytes of
+    // address space and commits only what is used. TryGrow extends a block in place up to
+    // its reservation, so an Array using it never copies and keeps stable pointers.
+    // A small header at the start of the reservation keeps the block sizes.
+
+    template< SizeT RESERVE >
+    class VirtualAllocator
+    {
+    public:
+        static void *   Allocate( SizeT sizeBytes, SizeT align = 1 );
+        static void     Deallocate( void * ptr );
+        static Bool     TryGrow( void * ptr, SizeT sizeBytes );
+        static void *   Reallocate( void * ptr, SizeT oldSizeBytes, SizeT sizeBytes, SizeT align = 1 );
+
+    private:
+        struct Header
+        {
+            SizeT   m_reserved;
+            SizeT   m_committed;
+        };
+
+        static const SizeT ms_headerSize = 16;
+
+        static U8 *     GetBase( void * ptr );
+    };
+
+    //=================================================================== VirtualAllocator
+
+    template< SizeT RESERVE >
+    void * VirtualAllocator< RESERVE >::Allocate( SizeT sizeBytes, SizeT align )
+    {
+        CARBON_ASSERT( align <= ms_headerSize );
+
+        const SizeT pageSize = VirtualMemory::GetPageSize();
+        const SizeT reserved = VirtualMemory::RoundUp( ( sizeBytes + ms_headerSize > RESERVE ) ? sizeBytes + ms_headerSize : RESERVE
+                                                     , VirtualMemory::GetAllocationGranularity() );
+        const SizeT committed = VirtualMemory::RoundUp( sizeBytes + ms_headerSize, pageSize );
+
+        U8 * base = static_cast< U8 * >( VirtualMemory::Reserve( reserved ) );
+        if ( ! base || ! VirtualMemory::Commit( base, committed ) )
+        {
+            VirtualMemory::Release( base );
+            return 0;
+        }
+
+        Header * header         = reinterpret_cast< Header * >( base );
+        header->m_reserved      = reserved;
+        header->m_committed     = committed;
+
+        return base + ms_headerSize;
+    }
+
+    template< SizeT RESERVE >
+    void VirtualAllocator< RESERVE >::Deallocate( void * ptr )
+    {
+        if ( ptr )
+        {
+            VirtualMemory::Release( GetBase( ptr ) );
+        }
+    }
+
+    template< SizeT RESERVE >
+    Bool VirtualAllocator< RESERVE >::TryGrow( void * ptr, SizeT sizeBytes )
+    {
+        U8 * base       = GetBase( ptr );
+        Header * header = reinterpret_cast< Header * >( base );
+
+        const SizeT needed = sizeBytes + ms_headerSize;
+        if ( needed > header->m_reserved )
+        {
+            return false;
+        }
+
+        if ( needed > header->m_committed )
+        {
+            const SizeT committed = VirtualMemory::RoundUp( needed, VirtualMemory::GetPageSize() );
+            if ( ! VirtualMemory::Commit( base + header->m_committed, committed - header->m_committed ) )
+            {
+                return false;
+            }
+            header->m_committed = committed;
+        }
+
+        return true;
+    }
+
+    template< SizeT RESERVE >
+    void * VirtualAllocator< RESERVE >::Reallocate( void * ptr, SizeT oldSizeBytes, SizeT sizeBytes, SizeT align )
+    {
+        if ( ptr && TryGrow( ptr, sizeBytes ) )
+        {
+            return ptr;
+        }
+
+        // on failure the block is kept, the caller still owns it
+        void * newPtr = Allocate( sizeBytes, align );
+        if ( ptr && newPtr )
+        {
+            MemoryUtils::MemCpy( newPtr, ptr, ( oldSizeBytes < sizeBytes ) ? oldSizeBytes : sizeBytes );
+            Deallocate( ptr );
+        }
+        return newPtr;
+    }
+
+    template< SizeT RESERVE >
+    U8 * VirtualAllocator< RESERVE >::GetBase( void * ptr )
+    {
+        // reservations are aligned on the allocation granularity
+        return reinterpret_cast< U8 * >( reinterpret_cast< SizeT >( ptr ) & ~( VirtualMemory::GetAllocationGranularity() - 1 ) );
+    }
+
+    //=================================================================== VirtualAllocator
+}
+
+#endif // _CORE_VIRTUALMEMORY_H
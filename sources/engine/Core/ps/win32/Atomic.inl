@@ -0,0 +1,75 @@
+#include <intrin.h>
+
+#include "Core/Types.h"
+
+#pragma intrinsic( _InterlockedIncrement )
+#pragma intrinsic( _InterlockedDecrement )
+#pragma intrinsic( _InterlockedExchange )
+#pragma intrinsic( _InterlockedExchangeAdd )
+#pragma intrinsic( _InterlockedCompareExchange )
+#pragma intrinsic( _ReadWriteBarrier )
+
+namespace Core
+{
+    // All operations are full barriers, they return the new value except
+    // Exchange and CompareExchange which return the previous one.
+
+    inline S32 AtomicIncrement( volatile S32 * value )                          { return _InterlockedIncrement( value );                          }
+    inline S32 AtomicDecrement( volatile S32 * value )                          { return _InterlockedDecrement( value );                          }
+    inline S32 AtomicAdd( volatile S32 * value, S32 add )                       { return _InterlockedExchangeAdd( value, add ) + add;             }
+    inline S32 AtomicExchange( volatile S32 * value, S32 exchange )             { return _InterlockedExchange( value, exchange );                 }
+    inline S32 AtomicCompareExchange( volatile S32 * value, S32 exchange, S32 comparand )
+    {
+        return _InterlockedCompareExchange( value, exchange, comparand );
+    }
+
+    inline void * AtomicExchangePointer( void * volatile * ptr, void * exchange )
+    {
+        return reinterpret_cast< void * >( _InterlockedExchange( reinterpret_cast< volatile long * >( ptr ), reinterpret_cast< long >( exchange ) ) );
+    }
+
+    inline void * AtomicCompareExchangePointer( void * volatile * ptr, void * exchange, void * comparand )
+    {
+        return reinterpret_cast< void * >( _InterlockedCompareExchange( reinterpret_cast< volatile long * >( ptr ), reinterpret_cast< long >( exchange ), reinterpret_cast< long >( comparand ) ) );
+    }
+
+    // x86 loads have acquire and stores have release semantic, only the compiler
+    // has to be prevented from reordering (volatile accesses are not enough on every compiler)
+
+    inline S32 AtomicLoad( const volatile S32 * value )
+    {
+        S32 v = *value;
+        _ReadWriteBarrier();
+        return v;
+    }
+
+    inline void AtomicStore( volatile S32 * value, S32 v )
+    {
+        _ReadWriteBarrier();
+        *value = v;
+    }
+
+    inline void * AtomicLoadPointer( void * const volatile * ptr )
+    {
+        void * v = *ptr;
+        _ReadWriteBarrier();
+        return v;
+    }
+
+    inline void AtomicStorePointer( void * volatile * ptr, void * v )
+    {
+        _ReadWriteBarrier();
+        *ptr = v;
+    }
+
+    inline void CpuPause()
+    {
+        _mm_pause();
+    }
+
+    inline void MemoryFence()
+    {
+        volatile long barrier;
+        _InterlockedExchange( &barrier, 0 );
+    }
+}
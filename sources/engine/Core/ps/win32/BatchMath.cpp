@@ -0,0 +1,670 @@
+#include "Core/BatchMath.h"
+
+#include "Core/Assert.h"
+#include "Core/Platform.h"
+#include "Core/Math.h"
+#include "Core/MemoryUtils.h"
+#include "Core/Intrinsics.h"
+#include "Core/Intrinsics256.h"
+
+namespace Core
+{
+    namespace
+    {
+        //================================================================================
+        // Lanes
+        //================================================================================
+
+        // The kernels are written once over a lane type : Lanes1 for the remainders,
+        // Lanes4 for SSE and Lanes8 for AVX2
+
+        struct Lanes1
+        {
+            typedef F32 Type;
+            typedef Bool Mask;
+            static const SizeT ms_count = 1;
+
+            static Type Load( const F32 * p )               { return *p;                    }
+            static void Store( F32 * p, Type v )            { *p = v;                       }
+            static Type Splat( F32 v )                      { return v;                     }
+            static Type Add( Type l, Type r )               { return l + r;                 }
+            static Type Sub( Type l, Type r )               { return l - r;                 }
+            static Type Mul( Type l, Type r )               { return l * r;                 }
+            static Type Div( Type l, Type r )               { return l / r;                 }
+            static Type MulAdd( Type a, Type b, Type c )    { return a * b + c;             }
+            static Type Abs( Type v )                       { return Core::Abs( v );        }
+            static Mask GreaterEqual( Type l, Type r )      { return l >= r;                }
+            static Mask And( Mask l, Mask r )               { return l && r;                }
+            static U32  MoveMask( Mask m )                  { return m ? 1 : 0;             }
+        };
+
+        struct Lanes4
+        {
+            typedef M128 Type;
+            typedef M128 Mask;
+            static const SizeT ms_count = 4;
+
+            static Type Load( const F32 * p )               { return LoadUnaligned( p );    }
+            static void Store( F32 * p, Type v )            { StoreUnaligned( p, v );       }
+            static Type Splat( F32 v )                      { return Core::Splat( v );      }
+            static Type Add( Type l, Type r )               { return Core::Add( l, r );     }
+            static Type Sub( Type l, Type r )               { return Core::Sub( l, r );     }
+            static Type Mul( Type l, Type r )               { return Core::Mul( l, r );     }
+            static Type Div( Type l, Type r )               { return Core::Div( l, r );     }
+            static Type MulAdd( Type a, Type b, Type c )    { return Core::MulAdd( a, b, c ); }
+            static Type Abs( Type v )                       { return Core::Abs( v );        }
+            static Mask GreaterEqual( Type l, Type r )      { return Core::GreaterEqual( l, r ); }
+            static Mask And( Mask l, Mask r )               { return Core::And( l, r );     }
+            static U32  MoveMask( Mask m )                  { return Core::MoveMask( m );   }
+        };
+
+#if defined( CARBON_HAS_AVX2 )
+        struct Lanes8
+        {
+            typedef M256 Type;
+            typedef M256 Mask;
+            static const SizeT ms_count = 8;
+
+            CARBON_AVX2_TARGET static Type Load( const F32 * p )            { return LoadUnaligned8( p );   }
+            CARBON_AVX2_TARGET static void Store( F32 * p, Type v )         { StoreUnaligned8( p, v );      }
+            CARBON_AVX2_TARGET static Type Splat( F32 v )                   { return Splat8( v );           }
+            CARBON_AVX2_TARGET static Type Add( Type l, Type r )            { return Core::Add( l, r );     }
+            CARBON_AVX2_TARGET static Type Sub( Type l, Type r )            { return Core::Sub( l, r );     }
+            CARBON_AVX2_TARGET static Type Mul( Type l, Type r )            { return Core::Mul( l, r );     }
+            CARBON_AVX2_TARGET static Type Div( Type l, Type r )            { return Core::Div( l, r );     }
+            CARBON_AVX2_TARGET static Type MulAdd( Type a, Type b, Type c ) { return Core::MulAdd( a, b, c ); }
+            CARBON_AVX2_TARGET static Type Abs( Type v )                    { return Core::Abs( v );        }
+            CARBON_AVX2_TARGET static Mask GreaterEqual( Type l, Type r )   { return Core::GreaterEqual( l, r ); }
+            CARBON_AVX2_TARGET static Mask And( Mask l, Mask r )            { return Core::And( l, r );     }
+            CARBON_AVX2_TARGET static U32  MoveMask( Mask m )               { return Core::MoveMask( m );   }
+        };
+#endif
+
+        //================================================================================
+        // Kernels
+        //================================================================================
+
+        // Kernels process [ begin, end [, a multiple of the lane count. Every lane is
+        // loaded before being stored, so the destinations can be the sources.
+
+        template< typename L >
+        CARBON_FORCE_INLINE void MulAddKernel( F32 * dest, const F32 * a, const F32 * b, const F32 * c, SizeT begin, SizeT end )
+        {
+            for ( SizeT i=begin; i<end; i+=L::ms_count )
+            {
+                L::Store( dest + i, L::MulAdd( L::Load( a + i ), L::Load( b + i ), L::Load( c + i ) ) );
+            }
+        }
+
+        template< typename L >
+        CARBON_FORCE_INLINE void LerpKernel( F32 * dest, const F32 * a, const F32 * b, F32 ratio, SizeT begin, SizeT end )
+        {
+            const typename L::Type r = L::Splat( ratio );
+
+            for ( SizeT i=begin; i<end; i+=L::ms_count )
+            {
+                const typename L::Type va = L::Load( a + i );
+                L::Store( dest + i, L::MulAdd( L::Sub( L::Load( b + i ), va ), r, va ) );
+            }
+        }
+
+        template< typename L >
+        CARBON_FORCE_INLINE void MulMatricesKernel( const F128 * l, const SoaMatrices& r, const SoaMatrices& dest, SizeT begin, SizeT end )
+        {
+            typedef typename L::Type T;
+
+            // local copies of the array pointers, the stores can not alias them
+            const F32 * src[ 16 ];
+            F32 * out[ 16 ];
+            T e[ 16 ];
+            for ( SizeT k=0; k<16; ++k )
+            {
+                src[ k ] = r.m_element[ k ];
+                out[ k ] = dest.m_element[ k ];
+                e[ k ] = L::Splat( l[ k / 4 ][ k % 4 ] );
+            }
+
+            for ( SizeT i=begin; i<end; i+=L::ms_count )
+            {
+                for ( SizeT c=0; c<4; ++c )
+                {
+                    const T x = L::Load( src[ c * 4 + 0 ] + i );
+                    const T y = L::Load( src[ c * 4 + 1 ] + i );
+                    const T z = L::Load( src[ c * 4 + 2 ] + i );
+                    const T w = L::Load( src[ c * 4 + 3 ] + i );
+
+                    L::Store( out[ c * 4 + 0 ] + i, L::MulAdd( e[ 12 ], w, L::MulAdd( e[ 8 ], z, L::MulAdd( e[ 4 ], y, L::Mul( e[ 0 ], x ) ) ) ) );
+                    L::Store( out[ c * 4 + 1 ] + i, L::MulAdd( e[ 13 ], w, L::MulAdd( e[ 9 ], z, L::MulAdd( e[ 5 ], y, L::Mul( e[ 1 ], x ) ) ) ) );
+                    L::Store( out[ c * 4 + 2 ] + i, L::MulAdd( e[ 14 ], w, L::MulAdd( e[ 10 ], z, L::MulAdd( e[ 6 ], y, L::Mul( e[ 2 ], x ) ) ) ) );
+                    L::Store( out[ c * 4 + 3 ] + i, L::MulAdd( e[ 15 ], w, L::MulAdd( e[ 11 ], z, L::MulAdd( e[ 7 ], y, L::Mul( e[ 3 ], x ) ) ) ) );
+                }
+            }
+        }
+
+        template< typename L >
+        CARBON_FORCE_INLINE void AffineInversesKernel( const SoaMatrices& src, const SoaMatrices& dest, SizeT begin, SizeT end )
+        {
+            typedef typename L::Type T;
+
+            const T zero = L::Splat( 0.0f );
+            const T one = L::Splat( 1.0f );
+
+            for ( SizeT i=begin; i<end; i+=L::ms_count )
+            {
+                T a[ 4 ][ 3 ];
+                for ( SizeT c=0; c<4; ++c )
+                {
+                    a[ c ][ 0 ] = L::Load( src.m_element[ c * 4 + 0 ] + i );
+                    a[ c ][ 1 ] = L::Load( src.m_element[ c * 4 + 1 ] + i );
+                    a[ c ][ 2 ] = L::Load( src.m_element[ c * 4 + 2 ] + i );
+                }
+
+                // rows of the 3x3 inverse are the cross products of the columns
+                T inv[ 3 ][ 3 ];
+                for ( SizeT row=0; row<3; ++row )
+                {
+                    const T * u = a[ ( row + 1 ) % 3 ];
+                    const T * v = a[ ( row + 2 ) % 3 ];
+                    inv[ row ][ 0 ] = L::Sub( L::Mul( u[ 1 ], v[ 2 ] ), L::Mul( u[ 2 ], v[ 1 ] ) );
+                    inv[ row ][ 1 ] = L::Sub( L::Mul( u[ 2 ], v[ 0 ] ), L::Mul( u[ 0 ], v[ 2 ] ) );
+                    inv[ row ][ 2 ] = L::Sub( L::Mul( u[ 0 ], v[ 1 ] ), L::Mul( u[ 1 ], v[ 0 ] ) );
+                }
+
+                T det = L::Mul( a[ 0 ][ 0 ], inv[ 0 ][ 0 ] );
+                det = L::MulAdd( a[ 0 ][ 1 ], inv[ 0 ][ 1 ], det );
+                det = L::MulAdd( a[ 0 ][ 2 ], inv[ 0 ][ 2 ], det );
+                const T invDet = L::Div( one, det );
+
+                for ( SizeT row=0; row<3; ++row )
+                {
+                    inv[ row ][ 0 ] = L::Mul( inv[ row ][ 0 ], invDet );
+                    inv[ row ][ 1 ] = L::Mul( inv[ row ][ 1 ], invDet );
+                    inv[ row ][ 2 ] = L::Mul( inv[ row ][ 2 ], invDet );
+
+                    T t = L::Mul( inv[ row ][ 0 ], a[ 3 ][ 0 ] );
+                    t = L::MulAdd( inv[ row ][ 1 ], a[ 3 ][ 1 ], t );
+                    t = L::MulAdd( inv[ row ][ 2 ], a[ 3 ][ 2 ], t );
+
+                    L::Store( dest.m_element[ 0 * 4 + row ] + i, inv[ row ][ 0 ] );
+                    L::Store( dest.m_element[ 1 * 4 + row ] + i, inv[ row ][ 1 ] );
+                    L::Store( dest.m_element[ 2 * 4 + row ] + i, inv[ row ][ 2 ] );
+                    L::Store( dest.m_element[ 3 * 4 + row ] + i, L::Sub( zero, t ) );
+                }
+
+                L::Store( dest.m_element[ 0 * 4 + 3 ] + i, zero );
+                L::Store( dest.m_element[ 1 * 4 + 3 ] + i, zero );
+                L::Store( dest.m_element[ 2 * 4 + 3 ] + i, zero );
+                L::Store( dest.m_element[ 3 * 4 + 3 ] + i, one );
+            }
+        }
+
+        template< typename L >
+        CARBON_FORCE_INLINE void TransformPointsKernel( const F128 * m, const SoaPoints& src, const SoaPoints& dest, SizeT begin, SizeT end )
+        {
+            typedef typename L::Type T;
+
+            T e[ 4 ][ 3 ];
+            for ( SizeT c=0; c<4; ++c )
+            {
+                e[ c ][ 0 ] = L::Splat( m[ c ][ 0 ] );
+                e[ c ][ 1 ] = L::Splat( m[ c ][ 1 ] );
+                e[ c ][ 2 ] = L::Splat( m[ c ][ 2 ] );
+            }
+
+            for ( SizeT i=begin; i<end; i+=L::ms_count )
+            {
+                const T x = L::Load( src.m_x + i );
+                const T y = L::Load( src.m_y + i );
+                const T z = L::Load( src.m_z + i );
+
+                T r[ 3 ];
+                for ( SizeT row=0; row<3; ++row )
+                {
+                    r[ row ] = L::MulAdd( e[ 0 ][ row ], x, e[ 3 ][ row ] );
+                    r[ row ] = L::MulAdd( e[ 1 ][ row ], y, r[ row ] );
+                    r[ row ] = L::MulAdd( e[ 2 ][ row ], z, r[ row ] );
+                }
+
+                L::Store( dest.m_x + i, r[ 0 ] );
+                L::Store( dest.m_y + i, r[ 1 ] );
+                L::Store( dest.m_z + i, r[ 2 ] );
+            }
+        }
+
+        template< typename L >
+        CARBON_FORCE_INLINE void TransformBoxesKernel( const F128 * m, const SoaBoxes& src, const SoaBoxes& dest, SizeT begin, SizeT end )
+        {
+            typedef typename L::Type T;
+
+            // center is transformed, extents go through the absolute 3x3
+            T e[ 4 ][ 3 ];
+            T a[ 3 ][ 3 ];
+            for ( SizeT c=0; c<4; ++c )
+            {
+                for ( SizeT row=0; row<3; ++row )
+                {
+                    e[ c ][ row ] = L::Splat( m[ c ][ row ] );
+                    if ( c < 3 )
+                    {
+                        a[ c ][ row ] = L::Abs( e[ c ][ row ] );
+                    }
+                }
+            }
+
+            const T half = L::Splat( 0.5f );
+
+            for ( SizeT i=begin; i<end; i+=L::ms_count )
+            {
+                const T minX = L::Load( src.m_min.m_x + i );
+                const T minY = L::Load( src.m_min.m_y + i );
+                const T minZ = L::Load( src.m_min.m_z + i );
+                const T maxX = L::Load( src.m_max.m_x + i );
+                const T maxY = L::Load( src.m_max.m_y + i );
+                const T maxZ = L::Load( src.m_max.m_z + i );
+
+                const T cx = L::Mul( L::Add( minX, maxX ), half );
+                const T cy = L::Mul( L::Add( minY, maxY ), half );
+                const T cz = L::Mul( L::Add( minZ, maxZ ), half );
+                const T ex = L::Mul( L::Sub( maxX, minX ), half );
+                const T ey = L::Mul( L::Sub( maxY, minY ), half );
+                const T ez = L::Mul( L::Sub( maxZ, minZ ), half );
+
+                T center[ 3 ];
+                T extent[ 3 ];
+                for ( SizeT row=0; row<3; ++row )
+                {
+                    center[ row ] = L::MulAdd( e[ 0 ][ row ], cx, e[ 3 ][ row ] );
+                    center[ row ] = L::MulAdd( e[ 1 ][ row ], cy, center[ row ] );
+                    center[ row ] = L::MulAdd( e[ 2 ][ row ], cz, center[ row ] );
+
+                    extent[ row ] = L::Mul( a[ 0 ][ row ], ex );
+                    extent[ row ] = L::MulAdd( a[ 1 ][ row ], ey, extent[ row ] );
+                    extent[ row ] = L::MulAdd( a[ 2 ][ row ], ez, extent[ row ] );
+                }
+
+                L::Store( dest.m_min.m_x + i, L::Sub( center[ 0 ], extent[ 0 ] ) );
+                L::Store( dest.m_min.m_y + i, L::Sub( center[ 1 ], extent[ 1 ] ) );
+                L::Store( dest.m_min.m_z + i, L::Sub( center[ 2 ], extent[ 2 ] ) );
+                L::Store( dest.m_max.m_x + i, L::Add( center[ 0 ], extent[ 0 ] ) );
+                L::Store( dest.m_max.m_y + i, L::Add( center[ 1 ], extent[ 1 ] ) );
+                L::Store( dest.m_max.m_z + i, L::Add( center[ 2 ], extent[ 2 ] ) );
+            }
+        }
+
+        // Visibility bits are or-ed in words cleared by the caller, lane groups never
+        // straddle two words
+        template< typename L >
+        CARBON_FORCE_INLINE void CullSpheresKernel( const F128 * planes, const SoaSpheres& src, U32 * visibility, SizeT begin, SizeT end )
+        {
+            typedef typename L::Type T;
+            typedef typename L::Mask M;
+
+            T p[ FP_COUNT ][ 4 ];
+            for ( SizeT k=0; k<FP_COUNT; ++k )
+            {
+                p[ k ][ 0 ] = L::Splat( planes[ k ][ 0 ] );
+                p[ k ][ 1 ] = L::Splat( planes[ k ][ 1 ] );
+                p[ k ][ 2 ] = L::Splat( planes[ k ][ 2 ] );
+                p[ k ][ 3 ] = L::Splat( planes[ k ][ 3 ] );
+            }
+
+            const T zero = L::Splat( 0.0f );
+            const M all = L::GreaterEqual( zero, zero );
+
+            for ( SizeT i=begin; i<end; i+=L::ms_count )
+            {
+                const T x = L::Load( src.m_center.m_x + i );
+                const T y = L::Load( src.m_center.m_y + i );
+                const T z = L::Load( src.m_center.m_z + i );
+                const T r = L::Load( src.m_radius + i );
+
+                // distance to each plane + radius >= 0
+                M inside = all;
+                for ( SizeT k=0; k<FP_COUNT; ++k )
+                {
+                    T d = L::Add( p[ k ][ 3 ], r );
+                    d = L::MulAdd( p[ k ][ 2 ], z, d );
+                    d = L::MulAdd( p[ k ][ 1 ], y, d );
+                    d = L::MulAdd( p[ k ][ 0 ], x, d );
+
+                    inside = L::And( inside, L::GreaterEqual( d, zero ) );
+                }
+
+                visibility[ i / 32 ] |= L::MoveMask( inside ) << ( i % 32 );
+            }
+        }
+
+        template< typename L >
+        CARBON_FORCE_INLINE void CullBoxesKernel( const F128 * planes, const SoaBoxes& src, U32 * visibility, SizeT begin, SizeT end )
+        {
+            typedef typename L::Type T;
+            typedef typename L::Mask M;
+
+            // center distance to each plane + extents projected on the absolute normal >= 0
+            T p[ FP_COUNT ][ 4 ];
+            T a[ FP_COUNT ][ 3 ];
+            for ( SizeT k=0; k<FP_COUNT; ++k )
+            {
+                p[ k ][ 0 ] = L::Splat( planes[ k ][ 0 ] );
+                p[ k ][ 1 ] = L::Splat( planes[ k ][ 1 ] );
+                p[ k ][ 2 ] = L::Splat( planes[ k ][ 2 ] );
+                p[ k ][ 3 ] = L::Splat( planes[ k ][ 3 ] );
+                a[ k ][ 0 ] = L::Abs( p[ k ][ 0 ] );
+                a[ k ][ 1 ] = L::Abs( p[ k ][ 1 ] );
+                a[ k ][ 2 ] = L::Abs( p[ k ][ 2 ] );
+            }
+
+            const T zero = L::Splat( 0.0f );
+            const T half = L::Splat( 0.5f );
+            const M all = L::GreaterEqual( zero, zero );
+
+            for ( SizeT i=begin; i<end; i+=L::ms_count )
+            {
+                const T minX = L::Load( src.m_min.m_x + i );
+                const T minY = L::Load( src.m_min.m_y + i );
+                const T minZ = L::Load( src.m_min.m_z + i );
+                const T maxX = L::Load( src.m_max.m_x + i );
+                const T maxY = L::Load( src.m_max.m_y + i );
+                const T maxZ = L::Load( src.m_max.m_z + i );
+
+                const T cx = L::Mul( L::Add( minX, maxX ), half );
+                const T cy = L::Mul( L::Add( minY, maxY ), half );
+                const T cz = L::Mul( L::Add( minZ, maxZ ), half );
+                const T ex = L::Mul( L::Sub( maxX, minX ), half );
+                const T ey = L::Mul( L::Sub( maxY, minY ), half );
+                const T ez = L::Mul( L::Sub( maxZ, minZ ), half );
+
+                M inside = all;
+                for ( SizeT k=0; k<FP_COUNT; ++k )
+                {
+                    T d = L::MulAdd( a[ k ][ 0 ], ex, p[ k ][ 3 ] );
+                    d = L::MulAdd( a[ k ][ 1 ], ey, d );
+                    d = L::MulAdd( a[ k ][ 2 ], ez, d );
+                    d = L::MulAdd( p[ k ][ 0 ], cx, d );
+                    d = L::MulAdd( p[ k ][ 1 ], cy, d );
+                    d = L::MulAdd( p[ k ][ 2 ], cz, d );
+
+                    inside = L::And( inside, L::GreaterEqual( d, zero ) );
+                }
+
+                visibility[ i / 32 ] |= L::MoveMask( inside ) << ( i % 32 );
+            }
+        }
+
+        //================================================================================
+        // SSE path
+        //================================================================================
+
+        // Largest multiple of the lane count
+        inline SizeT FullLanes( SizeT count, SizeT lanes )
+        {
+            return count - count % lanes;
+        }
+
+        void MulAddSSE( F32 * dest, const F32 * a, const F32 * b, const F32 * c, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes4::ms_count );
+            MulAddKernel< Lanes4 >( dest, a, b, c, 0, full );
+            MulAddKernel< Lanes1 >( dest, a, b, c, full, count );
+        }
+
+        void LerpSSE( F32 * dest, const F32 * a, const F32 * b, F32 ratio, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes4::ms_count );
+            LerpKernel< Lanes4 >( dest, a, b, ratio, 0, full );
+            LerpKernel< Lanes1 >( dest, a, b, ratio, full, count );
+        }
+
+        void MulMatricesSSE( const F128 * l, const SoaMatrices& r, const SoaMatrices& dest, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes4::ms_count );
+            MulMatricesKernel< Lanes4 >( l, r, dest, 0, full );
+            MulMatricesKernel< Lanes1 >( l, r, dest, full, count );
+        }
+
+        void AffineInversesSSE( const SoaMatrices& src, const SoaMatrices& dest, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes4::ms_count );
+            AffineInversesKernel< Lanes4 >( src, dest, 0, full );
+            AffineInversesKernel< Lanes1 >( src, dest, full, count );
+        }
+
+        void TransformPointsSSE( const F128 * m, const SoaPoints& src, const SoaPoints& dest, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes4::ms_count );
+            TransformPointsKernel< Lanes4 >( m, src, dest, 0, full );
+            TransformPointsKernel< Lanes1 >( m, src, dest, full, count );
+        }
+
+        void TransformBoxesSSE( const F128 * m, const SoaBoxes& src, const SoaBoxes& dest, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes4::ms_count );
+            TransformBoxesKernel< Lanes4 >( m, src, dest, 0, full );
+            TransformBoxesKernel< Lanes1 >( m, src, dest, full, count );
+        }
+
+        void CullSpheresSSE( const F128 * planes, const SoaSpheres& src, U32 * visibility, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes4::ms_count );
+            CullSpheresKernel< Lanes4 >( planes, src, visibility, 0, full );
+            CullSpheresKernel< Lanes1 >( planes, src, visibility, full, count );
+        }
+
+        void CullBoxesSSE( const F128 * planes, const SoaBoxes& src, U32 * visibility, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes4::ms_count );
+            CullBoxesKernel< Lanes4 >( planes, src, visibility, 0, full );
+            CullBoxesKernel< Lanes1 >( planes, src, visibility, full, count );
+        }
+
+        //================================================================================
+        // AVX2 path
+        //================================================================================
+
+#if defined( CARBON_HAS_AVX2 )
+        // The upper YMM halves are cleared before the remainders and the return to SSE
+        // code, to avoid the transition penalty
+
+        CARBON_AVX2_TARGET void MulAddAVX2( F32 * dest, const F32 * a, const F32 * b, const F32 * c, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes8::ms_count );
+            MulAddKernel< Lanes8 >( dest, a, b, c, 0, full );
+            _mm256_zeroupper();
+            MulAddKernel< Lanes1 >( dest, a, b, c, full, count );
+        }
+
+        CARBON_AVX2_TARGET void LerpAVX2( F32 * dest, const F32 * a, const F32 * b, F32 ratio, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes8::ms_count );
+            LerpKernel< Lanes8 >( dest, a, b, ratio, 0, full );
+            _mm256_zeroupper();
+            LerpKernel< Lanes1 >( dest, a, b, ratio, full, count );
+        }
+
+        CARBON_AVX2_TARGET void MulMatricesAVX2( const F128 * l, const SoaMatrices& r, const SoaMatrices& dest, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes8::ms_count );
+            MulMatricesKernel< Lanes8 >( l, r, dest, 0, full );
+            _mm256_zeroupper();
+            MulMatricesKernel< Lanes1 >( l, r, dest, full, count );
+        }
+
+        CARBON_AVX2_TARGET void AffineInversesAVX2( const SoaMatrices& src, const SoaMatrices& dest, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes8::ms_count );
+            AffineInversesKernel< Lanes8 >( src, dest, 0, full );
+            _mm256_zeroupper();
+            AffineInversesKernel< Lanes1 >( src, dest, full, count );
+        }
+
+        CARBON_AVX2_TARGET void TransformPointsAVX2( const F128 * m, const SoaPoints& src, const SoaPoints& dest, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes8::ms_count );
+            TransformPointsKernel< Lanes8 >( m, src, dest, 0, full );
+            _mm256_zeroupper();
+            TransformPointsKernel< Lanes1 >( m, src, dest, full, count );
+        }
+
+        CARBON_AVX2_TARGET void TransformBoxesAVX2( const F128 * m, const SoaBoxes& src, const SoaBoxes& dest, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes8::ms_count );
+            TransformBoxesKernel< Lanes8 >( m, src, dest, 0, full );
+            _mm256_zeroupper();
+            TransformBoxesKernel< Lanes1 >( m, src, dest, full, count );
+        }
+
+        CARBON_AVX2_TARGET void CullSpheresAVX2( const F128 * planes, const SoaSpheres& src, U32 * visibility, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes8::ms_count );
+            CullSpheresKernel< Lanes8 >( planes, src, visibility, 0, full );
+            _mm256_zeroupper();
+            CullSpheresKernel< Lanes1 >( planes, src, visibility, full, count );
+        }
+
+        CARBON_AVX2_TARGET void CullBoxesAVX2( const F128 * planes, const SoaBoxes& src, U32 * visibility, SizeT count )
+        {
+            const SizeT full = FullLanes( count, Lanes8::ms_count );
+            CullBoxesKernel< Lanes8 >( planes, src, visibility, 0, full );
+            _mm256_zeroupper();
+            CullBoxesKernel< Lanes1 >( planes, src, visibility, full, count );
+        }
+#endif
+
+        //================================================================================
+        // Dispatch
+        //================================================================================
+
+        struct Kernels
+        {
+            void ( *m_mulAdd )( F32 *, const F32 *, const F32 *, const F32 *, SizeT );
+            void ( *m_lerp )( F32 *, const F32 *, const F32 *, F32, SizeT );
+            void ( *m_mulMatrices )( const F128 *, const SoaMatrices&, const SoaMatrices&, SizeT );
+            void ( *m_affineInverses )( const SoaMatrices&, const SoaMatrices&, SizeT );
+            void ( *m_transformPoints )( const F128 *, const SoaPoints&, const SoaPoints&, SizeT );
+            void ( *m_transformBoxes )( const F128 *, const SoaBoxes&, const SoaBoxes&, SizeT );
+            void ( *m_cullSpheres )( const F128 *, const SoaSpheres&, U32 *, SizeT );
+            void ( *m_cullBoxes )( const F128 *, const SoaBoxes&, U32 *, SizeT );
+        };
+
+#if defined( CARBON_HAS_AVX2 )
+        const Kernels kernels[ BP_COUNT ] =
+        {
+            { MulAddSSE, LerpSSE, MulMatricesSSE, AffineInversesSSE, TransformPointsSSE, TransformBoxesSSE, CullSpheresSSE, CullBoxesSSE },
+            { MulAddAVX2, LerpAVX2, MulMatricesAVX2, AffineInversesAVX2, TransformPointsAVX2, TransformBoxesAVX2, CullSpheresAVX2, CullBoxesAVX2 }
+        };
+#else
+        const Kernels kernels[ BP_COUNT ] =
+        {
+            { MulAddSSE, LerpSSE, MulMatricesSSE, AffineInversesSSE, TransformPointsSSE, TransformBoxesSSE, CullSpheresSSE, CullBoxesSSE },
+            { MulAddSSE, LerpSSE, MulMatricesSSE, AffineInversesSSE, TransformPointsSSE, TransformBoxesSSE, CullSpheresSSE, CullBoxesSSE }
+        };
+#endif
+
+        BatchPath SelectPath()
+        {
+#if defined( CARBON_HAS_AVX2 )
+            if ( Platform::HasCpuFeatures( CF_AVX2 | CF_FMA ) )
+            {
+                return BP_AVX2;
+            }
+#endif
+            return BP_SSE;
+        }
+
+        BatchPath currentPath = SelectPath();
+        const Kernels * current = &kernels[ currentPath ];
+    }
+
+    BatchPath BatchMath::GetPath()
+    {
+        return currentPath;
+    }
+
+    Bool BatchMath::IsSupported( BatchPath path )
+    {
+        switch ( path )
+        {
+        case BP_SSE:
+            return true;
+        case BP_AVX2:
+#if defined( CARBON_HAS_AVX2 )
+            return Platform::HasCpuFeatures( CF_AVX2 | CF_FMA );
+#else
+            return false;
+#endif
+        default:
+            return false;
+        }
+    }
+
+    void BatchMath::SetPath( BatchPath path )
+    {
+        CARBON_ASSERT( IsSupported( path ) );
+
+        currentPath = path;
+        current = &kernels[ path ];
+    }
+
+    void BatchMath::MulAdd( F32 * dest, const F32 * a, const F32 * b, const F32 * c, SizeT count )
+    {
+        current->m_mulAdd( dest, a, b, c, count );
+    }
+
+    void BatchMath::Lerp( F32 * dest, const F32 * a, const F32 * b, F32 ratio, SizeT count )
+    {
+        current->m_lerp( dest, a, b, ratio, count );
+    }
+
+    void BatchMath::MulMatrices( const Matrix& l, const SoaMatrices& r, const SoaMatrices& dest, SizeT count )
+    {
+        F128 elements[ 4 ];
+        Store( elements, l );
+
+        current->m_mulMatrices( elements, r, dest, count );
+    }
+
+    void BatchMath::AffineInverses( const SoaMatrices& src, const SoaMatrices& dest, SizeT count )
+    {
+        current->m_affineInverses( src, dest, count );
+    }
+
+    void BatchMath::TransformPoints( const Matrix& m, const SoaPoints& src, const SoaPoints& dest, SizeT count )
+    {
+        F128 elements[ 4 ];
+        Store( elements, m );
+
+        current->m_transformPoints( elements, src, dest, count );
+    }
+
+    void BatchMath::TransformBoxes( const Matrix& m, const SoaBoxes& src, const SoaBoxes& dest, SizeT count )
+    {
+        F128 elements[ 4 ];
+        Store( elements, m );
+
+        current->m_transformBoxes( elements, src, dest, count );
+    }
+
+    void BatchMath::CullSpheres( const Frustum& frustum, const SoaSpheres& src, U32 * visibility, SizeT count )
+    {
+        F128 planes[ FP_COUNT ];
+        for ( SizeT k=0; k<FP_COUNT; ++k )
+        {
+            Store( planes[ k ], frustum.m_plane[ k ] );
+        }
+
+        MemoryUtils::MemSet( visibility, 0, VisibilityWordCount( count ) * sizeof( U32 ) );
+        current->m_cullSpheres( planes, src, visibility, count );
+    }
+
+    void BatchMath::CullBoxes( const Frustum& frustum, const SoaBoxes& src, U32 * visibility, SizeT count )
+    {
+        F128 planes[ FP_COUNT ];
+        for ( SizeT k=0; k<FP_COUNT; ++k )
+        {
+            Store( planes[ k ], frustum.m_plane[ k ] );
+        }
+
+        MemoryUtils::MemSet( visibility, 0, VisibilityWordCount( count ) * sizeof( U32 ) );
+        current->m_cullBoxes( planes, src, visibility, count );
+    }
+}
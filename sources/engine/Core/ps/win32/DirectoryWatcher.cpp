@@ -0,0 +1,59 @@
+#include "Core/DirectoryWatcher.h"
+
+#include "Core/Assert.h"
+
+#include <Windows.h>
+
+namespace Core
+{
+    DirectoryWatcher::DirectoryWatcher()
+        : m_handle( 0 )
+    {
+    }
+
+    DirectoryWatcher::~DirectoryWatcher()
+    {
+        Stop();
+    }
+
+    Bool DirectoryWatcher::Watch( const PathString& dir )
+    {
+        CARBON_ASSERT( ! m_handle );
+
+        // renames and deletions too, editors often save through a temporary file
+        HANDLE handle = FindFirstChangeNotification( dir.ConstPtr(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME );
+        if ( handle == INVALID_HANDLE_VALUE )
+        {
+            return false;
+        }
+
+        m_handle = handle;
+        return true;
+    }
+
+    void DirectoryWatcher::Stop()
+    {
+        if ( m_handle )
+        {
+            FindCloseChangeNotification( m_handle );
+            m_handle = 0;
+        }
+    }
+
+    Bool DirectoryWatcher::IsWatching() const
+    {
+        return m_handle != 0;
+    }
+
+    Bool DirectoryWatcher::HasChanged()
+    {
+        if ( ! m_handle || WaitForSingleObject( m_handle, 0 ) != WAIT_OBJECT_0 )
+        {
+            return false;
+        }
+
+        // the next changes signal the handle again
+        FindNextChangeNotification( m_handle );
+        return true;
+    }
+}
@@ -1,10 +1,16 @@
 #include "Core/FileSystem.h"
 
 #include "Core/MemoryManager.h"
+#include "Core/Compression.h"
+#include "Core/Hash.h"
+#include "Core/MemoryUtils.h"
+#include "Core/Pack.h"
+#include "Core/VirtualMemory.h"
 #include "Core/Trace.h"
 
 #include <Windows.h>
 #include <cstdio>
+#include <cstring>
 
 namespace Core
 {
@@ -12,6 +18,155 @@ namespace Core
     static PathString dataPath;
     static PathString cachePath;
 
+    struct MountedPack
+    {
+        PathString  m_name;
+        HANDLE      m_file;
+        HANDLE      m_mapping;
+        U64         m_writeTime;
+        U32         m_slotCount;
+        PackEntry * m_entries;
+    };
+
+    static const SizeT maxPackCount     = 8;
+    static const U32 overriddenSize     = 0xffffffff;   // saved since the mount, the loose file is used
+    static MountedPack packs[ maxPackCount ];
+    static SizeT packCount = 0;
+
+    static U64 GetFileWriteTime( HANDLE hFile )
+    {
+        FILETIME ftCreate, ftAccess, ftWrite;
+        if ( !GetFileTime( hFile, &ftCreate, &ftAccess, &ftWrite ) )
+        {
+            return 0;
+        }
+
+        ULARGE_INTEGER tmp;
+        tmp.LowPart     = ftWrite.dwLowDateTime;
+        tmp.HighPart    = ftWrite.dwHighDateTime;
+
+        return tmp.QuadPart;
+    }
+
+    // Positioned read, several threads can read the same handle. Waits for the reads
+    // of overlapped handles.
+    static Bool ReadAt( HANDLE hFile, U64 offset, void * buffer, SizeT size )
+    {
+        OVERLAPPED overlapped = { 0 };
+        overlapped.Offset       = static_cast< DWORD >( offset );
+        overlapped.OffsetHigh   = static_cast< DWORD >( offset >> 32 );
+
+        DWORD read = 0;
+        if ( ! ReadFile( hFile, buffer, static_cast< DWORD >( size ), &read, &overlapped ) )
+        {
+            if ( GetLastError() != ERROR_IO_PENDING || ! GetOverlappedResult( hFile, &overlapped, &read, TRUE ) )
+            {
+                return false;
+            }
+        }
+        return read == size;
+    }
+
+    // Batch read one file after the other, when no completion port can be created
+    static void ReadSerial( FileRead * reads, SizeT count, ReadCallback callback )
+    {
+        for ( SizeT i=0; i<count; ++i )
+        {
+            FileRead& read = reads[ i ];
+
+            HANDLE hFile = read.m_file ? static_cast< HANDLE >( read.m_file ) : packs[ read.m_pack ].m_file;
+            const Bool success = ( read.m_size == 0 ) || ReadAt( hFile, read.m_offset, read.m_buffer, read.m_size );
+
+            FileSystem::Close( read );
+            callback( read, success );
+        }
+    }
+
+    // Maps [ offset, offset + size ) of a file mapping, views start on the allocation
+    // granularity so the view base is below the data
+    static Bool MapRange( HANDLE mapping, U64 offset, SizeT size, FileView& view )
+    {
+        const U64 start     = offset - offset % VirtualMemory::GetAllocationGranularity();
+        const SizeT delta   = static_cast< SizeT >( offset - start );
+
+        void * base = MapViewOfFile( mapping, FILE_MAP_READ, static_cast< DWORD >( start >> 32 ), static_cast< DWORD >( start ), delta + size );
+        if ( ! base )
+        {
+            return false;
+        }
+
+        view.m_base = base;
+        view.m_data = static_cast< U8 * >( base ) + delta;
+        view.m_size = size;
+
+        return true;
+    }
+
+    // PrefetchVirtualMemory only exists since Windows 8, its range is WIN32_MEMORY_RANGE_ENTRY
+    struct MemoryRange
+    {
+        void *      m_address;
+        SIZE_T      m_size;
+    };
+
+    typedef BOOL ( WINAPI * PrefetchVirtualMemoryProc )( HANDLE process, ULONG_PTR count, MemoryRange * ranges, ULONG flags );
+
+    static PrefetchVirtualMemoryProc GetPrefetchVirtualMemory()
+    {
+        static PrefetchVirtualMemoryProc prefetch = reinterpret_cast< PrefetchVirtualMemoryProc >( GetProcAddress( GetModuleHandle( "kernel32.dll" ), "PrefetchVirtualMemory" ) );
+        return prefetch;
+    }
+
+    // Packed entry of a file under the cache directory, null when no pack holds it or
+    // when it was overridden
+    static PackEntry * FindPackEntry( const PathString& fileName, MountedPack *& pack )
+    {
+        if ( packCount == 0 )
+        {
+            return 0;
+        }
+
+        const SizeT prefixSize = cachePath.Size();
+        const Char * name = fileName.ConstPtr();
+        if ( fileName.Size() <= prefixSize || strncmp( name, cachePath.ConstPtr(), prefixSize ) != 0 )
+        {
+            return 0;
+        }
+
+        // same separators as the pack compiler, callers may double them
+        Char relativeName[ 256 ];
+        SizeT size = 0;
+        for ( const Char * c = name + prefixSize; *c && size < sizeof(relativeName) - 1; ++c )
+        {
+            const Char ch = ( *c == '\\' ) ? '/' : *c;
+            if ( ch != '/' || ( size > 0 && relativeName[ size - 1 ] != '/' ) )
+            {
+                relativeName[ size++ ] = ch;
+            }
+        }
+        relativeName[ size ] = 0;
+
+        const U32 id = HashString( relativeName );
+
+        for ( SizeT p=packCount; p>0; --p )
+        {
+            MountedPack& mounted = packs[ p - 1 ];
+
+            const U32 mask = mounted.m_slotCount - 1;
+            for ( U32 slot = id & mask; mounted.m_entries[ slot ].m_offset; slot = ( slot + 1 ) & mask )
+            {
+                PackEntry& entry = mounted.m_entries[ slot ];
+                if ( entry.m_id == id )
+                {
+                    pack = &mounted;
+                    return ( entry.m_size != overriddenSize ) ? &entry : 0;
+                }
+            }
+        }
+
+        return 0;
+    }
+
     Bool RecursiveCreateDirectory( const Char * dir )
     {
         if ( ! CreateDirectory( dir, NULL ) )
@@ -66,11 +221,73 @@ namespace Core
 
     void FileSystem::Destroy()
     {
+        for ( SizeT p=0; p<packCount; ++p )
+        {
+            packs[ p ].m_name.Clear();
+            CloseHandle( packs[ p ].m_mapping );
+            CloseHandle( packs[ p ].m_file );
+            UnknownAllocator::Deallocate( packs[ p ].m_entries );
+        }
+        packCount = 0;
+
         rootPath.Clear();
         dataPath.Clear();
         cachePath.Clear();
     }
 
+    Bool FileSystem::Mount( const PathString& packName )
+    {
+        CARBON_ASSERT( packCount < maxPackCount );
+
+        HANDLE hFile = CreateFile( packName.ConstPtr(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+        if ( hFile == INVALID_HANDLE_VALUE )
+        {
+            return false;
+        }
+
+        PackHeader header;
+        if ( ! ReadAt( hFile, 0, &header, sizeof(header) ) ||
+             header.m_magic != PackHeader::ms_magic ||
+             header.m_version != PackHeader::ms_version ||
+             header.m_slotCount == 0 ||
+             ( header.m_slotCount & ( header.m_slotCount - 1 ) ) != 0 ||
+             header.m_fileCount >= header.m_slotCount )
+        {
+            CARBON_TRACE( "Invalid pack file\n" );
+            CloseHandle( hFile );
+            return false;
+        }
+
+        // the table stays in memory, a load then costs a single read
+        const SizeT tableSize = header.m_slotCount * sizeof(PackEntry);
+        PackEntry * entries = reinterpret_cast< PackEntry * >( UnknownAllocator::Allocate( tableSize, PackHeader::ms_alignment ) );
+
+        if ( ! ReadAt( hFile, sizeof(header), entries, tableSize ) )
+        {
+            UnknownAllocator::Deallocate( entries );
+            CloseHandle( hFile );
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMapping( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+        if ( ! mapping )
+        {
+            UnknownAllocator::Deallocate( entries );
+            CloseHandle( hFile );
+            return false;
+        }
+
+        MountedPack& pack   = packs[ packCount++ ];
+        pack.m_name         = packName;
+        pack.m_file         = hFile;
+        pack.m_mapping      = mapping;
+        pack.m_writeTime    = GetFileWriteTime( hFile );
+        pack.m_slotCount    = header.m_slotCount;
+        pack.m_entries      = entries;
+
+        return true;
+    }
+
     void FileSystem::BuildPathName( const Char * src, PathString& dest, PathType relativeTo )
     {
         switch ( relativeTo )
@@ -90,6 +307,54 @@ namespace Core
     }
 
     Bool FileSystem::Load( const PathString& fileName, void *& buffer, SizeT& size )
+    {
+        MountedPack * pack;
+        if ( const PackEntry * entry = FindPackEntry( fileName, pack ) )
+        {
+            size = entry->m_size;
+            if ( size == 0 )
+            {
+                return true;
+            }
+
+            buffer = UnknownAllocator::Allocate( size );
+
+            if ( ! ReadAt( pack->m_file, entry->m_offset, buffer, size ) )
+            {
+                UnknownAllocator::Deallocate( buffer );
+                size = 0;
+                return false;
+            }
+
+            // the pack compiler may have compressed it
+            if ( Compression::IsCompressed( buffer, size ) )
+            {
+                const SizeT rawSize = Compression::GetRawSize( buffer );
+                void * raw = rawSize ? UnknownAllocator::Allocate( rawSize ) : 0;
+
+                const Bool decompressed = Compression::Decompress( buffer, raw );
+                UnknownAllocator::Deallocate( buffer );
+
+                if ( ! decompressed )
+                {
+                    if ( raw )
+                        UnknownAllocator::Deallocate( raw );
+                    buffer = 0;
+                    size = 0;
+                    return false;
+                }
+
+                buffer  = raw;
+                size    = rawSize;
+            }
+
+            return true;
+        }
+
+        return LoadLoose( fileName, buffer, size );
+    }
+
+    Bool FileSystem::LoadLoose( const PathString& fileName, void *& buffer, SizeT& size )
     {
         FILE * pFile;
         if ( fopen_s( &pFile, fileName.ConstPtr(), "rb" ) )
@@ -125,6 +390,13 @@ namespace Core
 
     Bool FileSystem::Save( const PathString& fileName, const void * buffer, SizeT size )
     {
+        // the loose file overrides the packed one from now on
+        MountedPack * pack;
+        if ( PackEntry * entry = FindPackEntry( fileName, pack ) )
+        {
+            entry->m_size = overriddenSize;
+        }
+
         Char dir[ 256 ];
         Char * fileStart;
 
@@ -162,8 +434,262 @@ namespace Core
         return true;
     }
 
+    Bool FileSystem::Delete( const PathString& fileName )
+    {
+        return DeleteFile( fileName.ConstPtr() ) != 0;
+    }
+
+    void FileSystem::EvictFromCache( const PathString& fileName )
+    {
+        // an unbuffered open flushes and purges the cached pages of the file
+        HANDLE hFile = CreateFile( fileName.ConstPtr(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, NULL );
+        if ( hFile != INVALID_HANDLE_VALUE )
+        {
+            CloseHandle( hFile );
+        }
+    }
+
+    Bool FileSystem::Map( const PathString& fileName, FileView& view )
+    {
+        view.m_data = 0;
+        view.m_size = 0;
+        view.m_base = 0;
+
+        MountedPack * pack;
+        if ( const PackEntry * entry = FindPackEntry( fileName, pack ) )
+        {
+            return ( entry->m_size == 0 ) || MapRange( pack->m_mapping, entry->m_offset, entry->m_size, view );
+        }
+
+        HANDLE hFile = CreateFile( fileName.ConstPtr(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+        if ( hFile == INVALID_HANDLE_VALUE )
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if ( ! GetFileSizeEx( hFile, &fileSize ) )
+        {
+            CloseHandle( hFile );
+            return false;
+        }
+
+        Bool mapped = ( fileSize.QuadPart == 0 );
+        if ( ! mapped )
+        {
+            // the view keeps the file mapped once both handles are closed
+            HANDLE mapping = CreateFileMapping( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+            if ( mapping )
+            {
+                mapped = MapRange( mapping, 0, static_cast< SizeT >( fileSize.QuadPart ), view );
+                CloseHandle( mapping );
+            }
+        }
+
+        CloseHandle( hFile );
+
+        return mapped;
+    }
+
+    void FileSystem::Unmap( FileView& view )
+    {
+        if ( view.m_base )
+        {
+            UnmapViewOfFile( view.m_base );
+        }
+
+        view.m_data = 0;
+        view.m_size = 0;
+        view.m_base = 0;
+    }
+
+    void FileSystem::Prefetch( const FileView * views, SizeT count )
+    {
+        PrefetchVirtualMemoryProc prefetch = GetPrefetchVirtualMemory();
+        if ( ! prefetch )
+        {
+            return;
+        }
+
+        MemoryRange ranges[ 64 ];
+        SizeT rangeCount = 0;
+
+        for ( SizeT i=0; i<count; ++i )
+        {
+            if ( views[ i ].m_size )
+            {
+                ranges[ rangeCount ].m_address  = const_cast< void * >( views[ i ].m_data );
+                ranges[ rangeCount ].m_size     = views[ i ].m_size;
+                ++rangeCount;
+            }
+
+            if ( rangeCount == 64 || ( rangeCount > 0 && i + 1 == count ) )
+            {
+                prefetch( GetCurrentProcess(), rangeCount, ranges, 0 );
+                rangeCount = 0;
+            }
+        }
+    }
+
+    Bool FileSystem::Open( const PathString& fileName, FileRead& read )
+    {
+        read.m_file     = 0;
+        read.m_pack     = 0;
+        read.m_offset   = 0;
+        read.m_size     = 0;
+
+        MountedPack * pack;
+        if ( const PackEntry * entry = FindPackEntry( fileName, pack ) )
+        {
+            read.m_pack     = pack - packs;
+            read.m_offset   = entry->m_offset;
+            read.m_size     = entry->m_size;
+            return true;
+        }
+
+        HANDLE hFile = CreateFile( fileName.ConstPtr(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+        if ( hFile == INVALID_HANDLE_VALUE )
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if ( ! GetFileSizeEx( hFile, &fileSize ) )
+        {
+            CloseHandle( hFile );
+            return false;
+        }
+
+        read.m_file = hFile;
+        read.m_size = static_cast< SizeT >( fileSize.QuadPart );
+
+        return true;
+    }
+
+    void FileSystem::Close( FileRead& read )
+    {
+        if ( read.m_file )
+        {
+            CloseHandle( static_cast< HANDLE >( read.m_file ) );
+            read.m_file = 0;
+        }
+    }
+
+    void FileSystem::ReadBatch( FileRead * reads, SizeT count, ReadCallback callback )
+    {
+        if ( count == 0 )
+        {
+            return;
+        }
+
+        // one port per batch, so several threads can run their own
+        HANDLE port = CreateIoCompletionPort( INVALID_HANDLE_VALUE, NULL, 0, 1 );
+        if ( ! port )
+        {
+            ReadSerial( reads, count, callback );
+            return;
+        }
+
+        // the mounted handles are synchronous, the packs are opened again for the batch
+        HANDLE packFiles[ maxPackCount ];
+        for ( SizeT p=0; p<maxPackCount; ++p )
+        {
+            packFiles[ p ] = INVALID_HANDLE_VALUE;
+        }
+
+        OVERLAPPED * overlapped = reinterpret_cast< OVERLAPPED * >( UnknownAllocator::Allocate( count * sizeof(OVERLAPPED) ) );
+        MemoryUtils::MemSet( overlapped, 0, count * sizeof(OVERLAPPED) );
+
+        SizeT pendingCount = 0;
+
+        for ( SizeT i=0; i<count; ++i )
+        {
+            FileRead& read = reads[ i ];
+
+            HANDLE hFile = static_cast< HANDLE >( read.m_file );
+            if ( ! hFile )
+            {
+                HANDLE& packFile = packFiles[ read.m_pack ];
+                if ( packFile == INVALID_HANDLE_VALUE )
+                {
+                    packFile = CreateFile( packs[ read.m_pack ].m_name.ConstPtr(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, NULL );
+                    if ( packFile != INVALID_HANDLE_VALUE && ! CreateIoCompletionPort( packFile, port, 0, 0 ) )
+                    {
+                        CloseHandle( packFile );
+                        packFile = INVALID_HANDLE_VALUE;
+                    }
+                }
+                hFile = packFile;
+            }
+            else if ( ! CreateIoCompletionPort( hFile, port, 0, 0 ) )
+            {
+                hFile = INVALID_HANDLE_VALUE;
+            }
+
+            if ( read.m_size == 0 || hFile == INVALID_HANDLE_VALUE )
+            {
+                Close( read );
+                callback( read, read.m_size == 0 );
+                continue;
+            }
+
+            overlapped[ i ].Offset      = static_cast< DWORD >( read.m_offset );
+            overlapped[ i ].OffsetHigh  = static_cast< DWORD >( read.m_offset >> 32 );
+
+            // completed reads are queued to the port too, even the synchronous ones
+            if ( ReadFile( hFile, read.m_buffer, static_cast< DWORD >( read.m_size ), NULL, &overlapped[ i ] ) || GetLastError() == ERROR_IO_PENDING )
+            {
+                ++pendingCount;
+            }
+            else
+            {
+                Close( read );
+                callback( read, false );
+            }
+        }
+
+        while ( pendingCount > 0 )
+        {
+            OVERLAPPED_ENTRY entries[ 64 ];
+            ULONG entryCount = 0;
+            if ( ! GetQueuedCompletionStatusEx( port, entries, 64, &entryCount, INFINITE, FALSE ) )
+            {
+                continue;
+            }
+
+            for ( ULONG e=0; e<entryCount; ++e )
+            {
+                const SizeT i = entries[ e ].lpOverlapped - overlapped;
+                FileRead& read = reads[ i ];
+
+                const Bool success = ( overlapped[ i ].Internal == 0 ) && ( entries[ e ].dwNumberOfBytesTransferred == read.m_size );
+
+                Close( read );
+                callback( read, success );
+                --pendingCount;
+            }
+        }
+
+        for ( SizeT p=0; p<maxPackCount; ++p )
+        {
+            if ( packFiles[ p ] != INVALID_HANDLE_VALUE )
+            {
+                CloseHandle( packFiles[ p ] );
+            }
+        }
+
+        UnknownAllocator::Deallocate( overlapped );
+        CloseHandle( port );
+    }
+
     Bool FileSystem::Exists( const PathString& fileName )
     {
+        MountedPack * pack;
+        if ( FindPackEntry( fileName, pack ) )
+        {
+            return true;
+        }
+
         HANDLE hFile = CreateFile( fileName.ConstPtr(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
         if ( hFile == INVALID_HANDLE_VALUE )
         {
@@ -174,7 +700,7 @@ namespace Core
         return true;
     }
 
-    Bool FileSystem::Find( const Char * searchStr, Core::Array< PathString >& fileNames, Bool absolute )
+    Bool FileSystem::Find( const Char * searchStr, Core::IArray< PathString >& fileNames, Bool absolute )
     {
         WIN32_FIND_DATA ffd;
         HANDLE hFind;
@@ -214,26 +740,27 @@ namespace Core
 
     U64 FileSystem::GetLastWriteTime( const PathString& fileName )
     {
-        HANDLE hFile = CreateFile( fileName.ConstPtr(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
-
-        if ( hFile == INVALID_HANDLE_VALUE )
+        MountedPack * pack;
+        if ( FindPackEntry( fileName, pack ) )
         {
-            return 0;
+            return pack->m_writeTime;
         }
 
-        FILETIME ftCreate, ftAccess, ftWrite;
-        if ( !GetFileTime( hFile, &ftCreate, &ftAccess, &ftWrite ) )
+        return GetLooseWriteTime( fileName );
+    }
+
+    U64 FileSystem::GetLooseWriteTime( const PathString& fileName )
+    {
+        HANDLE hFile = CreateFile( fileName.ConstPtr(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+
+        if ( hFile == INVALID_HANDLE_VALUE )
         {
-            CloseHandle(hFile);
             return 0;
         }
 
+        const U64 writeTime = GetFileWriteTime( hFile );
         CloseHandle(hFile);
 
-        ULARGE_INTEGER tmp;
-        tmp.LowPart     = ftWrite.dwLowDateTime;
-        tmp.HighPart    = ftWrite.dwHighDateTime;
-        
-        return tmp.QuadPart;
+        return writeTime;
     }
 }
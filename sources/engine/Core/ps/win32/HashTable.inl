@@ -0,0 +1,23 @@
+#include <emmintrin.h>
+#include <intrin.h>
+
+#pragma intrinsic( _BitScanForward )
+
+namespace Core
+{
+    inline U32 HashGroup::Match( const U8 * tags, U8 tag )
+    {
+        const __m128i group = _mm_loadu_si128( reinterpret_cast< const __m128i * >( tags ) );
+        const __m128i match = _mm_cmpeq_epi8( group, _mm_set1_epi8( static_cast< char >( tag ) ) );
+        return static_cast< U32 >( _mm_movemask_epi8( match ) );
+    }
+
+    inline U32 HashGroup::FirstBit( U32 mask )
+    {
+        CARBON_ASSERT( mask != 0 );
+
+        unsigned long index;
+        _BitScanForward( &index, mask );
+        return static_cast< U32 >( index );
+    }
+}
@@ -1,9 +1,10 @@
 #include <xmmintrin.h>
+#include <emmintrin.h>
 
 #include "Core/Types.h"
 #include "Core/Assert.h"
 
-typedef __declspec(align(16)) float F128[4];        // storage usage
+typedef CARBON_ALIGN( 16 ) float F128[4];           // storage usage
 typedef __m128                      M128;           // compute usage
 
 
@@ -14,6 +15,8 @@ namespace Core
 
     inline M128 Load( F128 d )                      { return _mm_load_ps( d );                     }
     inline void Store( F128 d, M128 v )             { _mm_store_ps( d, v );                        }
+    inline M128 LoadUnaligned( const F32 * d )      { return _mm_loadu_ps( d );                    }
+    inline void StoreUnaligned( F32 * d, M128 v )   { _mm_storeu_ps( d, v );                       }
 
     // Arithmetic
     inline M128 Neg( M128 v )                       { return _mm_xor_ps( v, Splat( -0.0f ) );      }
@@ -21,6 +24,7 @@ namespace Core
     inline M128 Sub( M128 l, M128 r )               { return _mm_sub_ps( l, r );                   }
     inline M128 Mul( M128 l, M128 r )               { return _mm_mul_ps( l, r );                   }
     inline M128 Div( M128 l, M128 r )               { return _mm_div_ps( l, r );                   }
+    inline M128 MulAdd( M128 a, M128 b, M128 c )    { return _mm_add_ps( _mm_mul_ps( a, b ), c );  }
     inline M128 Sqrt( M128 v )                      { return _mm_sqrt_ps( v );                     }
     inline M128 Rcp( M128 v )                       { return _mm_rcp_ps( v );                      }
     inline M128 Rsqrt( M128 v )                     { return _mm_rsqrt_ps( v );                    }
@@ -39,17 +43,31 @@ namespace Core
         return Add( b, a );
     }
 
-    inline M128  Floor( M128 v );                                                           // TODO
-    inline M128  Ceil( M128 v );                                                            // TODO
-    inline M128  Exp( M128 v );                                                             // TODO
-    inline M128  Log( M128 v );                                                             // TODO
-    inline M128  Sin( M128 angle );                                                         // TODO
-    inline M128  Cos( M128 angle );                                                         // TODO
-    inline M128  Tan( M128 angle );                                                         // TODO
-    inline M128  ASin( M128 v );                                                            // TODO
-    inline M128  ACos( M128 v );                                                            // TODO
-    inline M128  ATan( M128 v );                                                            // TODO
-    inline void  SinCos( M128 angle, M128& sin, M128& cos );                                // TODO
+    // Transcendentals
+    // Vectorized Cephes kernels : range reduction followed by a minimax polynomial.
+    // Max errors against the correctly rounded result :
+    //
+    //      Floor, Ceil         exact
+    //      Exp                 1 ulp, denormals included, +inf above 88.72
+    //      Log                 1 ulp, -inf at 0, NaN below 0
+    //      Sin, Cos, SinCos    2 ulp for |angle| <= pi, 8e-8 absolute for |angle| < 8192 :
+    //                          near the roots of bigger angles the reduction error (1e-9)
+    //                          is hundreds of ulp
+    //      Tan                 3 ulp for |angle| < 100, worse near the poles of bigger angles
+    //      ASin, ACos          3 ulp, NaN outside [-1, 1]
+    //      ATan                3 ulp
+
+    inline M128  Floor( M128 v );
+    inline M128  Ceil( M128 v );
+    inline M128  Exp( M128 v );
+    inline M128  Log( M128 v );
+    inline M128  Sin( M128 angle );
+    inline M128  Cos( M128 angle );
+    inline M128  Tan( M128 angle );
+    inline M128  ASin( M128 v );
+    inline M128  ACos( M128 v );
+    inline M128  ATan( M128 v );
+    inline void  SinCos( M128 angle, M128& sin, M128& cos );
 
     // Logical
     inline M128  And( M128 l, M128 r )              { return _mm_and_ps( l, r );                   }
@@ -70,6 +88,7 @@ namespace Core
     inline M128 UnpackZW( M128 l, M128 r )          { return _mm_unpackhi_ps( l, r );              }
     inline M128 MoveXY( M128 l, M128 r )            { return _mm_movelh_ps( l, r );                }
     inline M128 MoveZW( M128 l, M128 r )            { return _mm_movehl_ps( l, r );                }
+    inline U32  MoveMask( M128 mask )               { return static_cast< U32 >( _mm_movemask_ps( mask ) ); }
 
     inline M128 Select( M128 l, M128 r, M128 mask )
     {
@@ -93,7 +112,258 @@ namespace Core
     template< unsigned X, unsigned Y, unsigned Z, unsigned W >
     inline M128 Mask()
     {
-        __declspec(align(16)) U32 mask[4] = { X * 0xFFFFFFFF, Y * 0xFFFFFFFF, Z * 0xFFFFFFFF, W * 0xFFFFFFFF };
+        CARBON_ALIGN( 16 ) U32 mask[4] = { X * 0xFFFFFFFF, Y * 0xFFFFFFFF, Z * 0xFFFFFFFF, W * 0xFFFFFFFF };
         return _mm_load_ps( (float*)mask );
     }
+
+    // Transcendentals
+
+    inline M128 Floor( M128 v )
+    {
+        // truncation is exact below 2^23, greater values are already integers
+        const M128 trunc = _mm_cvtepi32_ps( _mm_cvttps_epi32( v ) );
+        M128 floor = Sub( trunc, And( GreaterThan( trunc, v ), Splat( 1.0f ) ) );
+        floor = Or( floor, And( v, Splat( -0.0f ) ) );                     // keeps -0
+
+        return Select( v, floor, LessThan( Abs( v ), Splat( 8388608.0f ) ) );
+    }
+
+    inline M128 Ceil( M128 v )
+    {
+        const M128 trunc = _mm_cvtepi32_ps( _mm_cvttps_epi32( v ) );
+        M128 ceil = Add( trunc, And( LessThan( trunc, v ), Splat( 1.0f ) ) );
+        ceil = Or( ceil, And( v, Splat( -0.0f ) ) );                        // ceil( -0.5 ) is -0
+
+        return Select( v, ceil, LessThan( Abs( v ), Splat( 8388608.0f ) ) );
+    }
+
+    inline M128 Exp( M128 v )
+    {
+        // exp( x ) = 2^n * exp( r ), n = round( x / ln2 ), |r| <= ln2 / 2
+        M128 x = Min( Max( v, Splat( -104.0f ) ), Splat( 88.7228394f ) );
+
+        const __m128i n = _mm_cvtps_epi32( Mul( x, Splat( 1.44269504088896341f ) ) );
+        const M128 fn = _mm_cvtepi32_ps( n );
+
+        // ln2 in two parts, the first one is exact in float
+        x = Sub( x, Mul( fn, Splat( 0.693359375f ) ) );
+        x = Sub( x, Mul( fn, Splat( -2.12194440e-4f ) ) );
+
+        const M128 z = Mul( x, x );
+
+        M128 y = Splat( 1.9875691500e-4f );
+        y = Add( Mul( y, x ), Splat( 1.3981999507e-3f ) );
+        y = Add( Mul( y, x ), Splat( 8.3334519073e-3f ) );
+        y = Add( Mul( y, x ), Splat( 4.1665795894e-2f ) );
+        y = Add( Mul( y, x ), Splat( 1.6666665459e-1f ) );
+        y = Add( Mul( y, x ), Splat( 5.0000001201e-1f ) );
+        y = Add( Add( Mul( y, z ), x ), Splat( 1.0f ) );
+
+        // 2^n in two normal factors, n goes from -150 (denormals) to 128
+        const __m128i bias = _mm_set1_epi32( 127 );
+        const __m128i n0 = _mm_srai_epi32( n, 1 );
+        const __m128i n1 = _mm_sub_epi32( n, n0 );
+        y = Mul( y, _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( n0, bias ), 23 ) ) );
+        y = Mul( y, _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( n1, bias ), 23 ) ) );
+
+        y = Select( y, _mm_castsi128_ps( _mm_set1_epi32( 0x7F800000 ) ), GreaterThan( v, Splat( 88.7228394f ) ) );
+
+        return Or( y, _mm_cmpunord_ps( v, v ) );                            // NaN stays NaN
+    }
+
+    inline M128 Log( M128 v )
+    {
+        // log( x ) = e * ln2 + log( m ), sqrt( 0.5 ) <= m < sqrt( 2 )
+        const M128 inf = _mm_castsi128_ps( _mm_set1_epi32( 0x7F800000 ) );
+
+        // denormals are scaled by 2^25 first
+        const M128 denormal = LessThan( v, Splat( 1.17549435e-38f ) );
+        M128 x = Select( v, Mul( v, Splat( 33554432.0f ) ), denormal );
+
+        const __m128i bits = _mm_castps_si128( x );
+        M128 e = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 126 ) ) );
+        e = Sub( e, And( denormal, Splat( 25.0f ) ) );
+
+        // mantissa in [0.5, 1[
+        x = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32( 0x807FFFFF ) ), _mm_set1_epi32( 0x3F000000 ) ) );
+
+        const M128 small = LessThan( x, Splat( 0.707106781186547524f ) );
+        e = Sub( e, And( small, Splat( 1.0f ) ) );
+        x = Sub( Add( x, And( small, x ) ), Splat( 1.0f ) );
+
+        const M128 z = Mul( x, x );
+
+        M128 y = Splat( 7.0376836292e-2f );
+        y = Add( Mul( y, x ), Splat( -1.1514610310e-1f ) );
+        y = Add( Mul( y, x ), Splat( 1.1676998740e-1f ) );
+        y = Add( Mul( y, x ), Splat( -1.2420140846e-1f ) );
+        y = Add( Mul( y, x ), Splat( 1.4249322787e-1f ) );
+        y = Add( Mul( y, x ), Splat( -1.6668057665e-1f ) );
+        y = Add( Mul( y, x ), Splat( 2.0000714765e-1f ) );
+        y = Add( Mul( y, x ), Splat( -2.4999993993e-1f ) );
+        y = Add( Mul( y, x ), Splat( 3.3333331174e-1f ) );
+        y = Mul( Mul( y, x ), z );
+
+        y = Add( y, Mul( e, Splat( -2.12194440e-4f ) ) );
+        y = Sub( y, Mul( z, Splat( 0.5f ) ) );
+        x = Add( x, y );
+        x = Add( x, Mul( e, Splat( 0.693359375f ) ) );
+
+        x = Select( x, inf, Equal( v, inf ) );
+        x = Select( x, Neg( inf ), Equal( v, Splat( 0.0f ) ) );
+
+        return Or( x, _mm_cmpnge_ps( v, Splat( 0.0f ) ) );                  // NaN below 0 and NaN
+    }
+
+    inline void SinCos( M128 angle, M128& sin, M128& cos )
+    {
+        // reduction to [-pi/4, pi/4] in the octant j, pi/4 in three parts
+        M128 sinSign = And( angle, Splat( -0.0f ) );
+        M128 x = Abs( angle );
+
+        __m128i j = _mm_cvttps_epi32( Mul( x, Splat( 1.27323954473516f ) ) );
+        j = _mm_and_si128( _mm_add_epi32( j, _mm_set1_epi32( 1 ) ), _mm_set1_epi32( ~1 ) );
+        const M128 fj = _mm_cvtepi32_ps( j );
+
+        x = Sub( x, Mul( fj, Splat( 0.78515625f ) ) );
+        x = Sub( x, Mul( fj, Splat( 2.4187564849853515625e-4f ) ) );
+        x = Sub( x, Mul( fj, Splat( 3.77489497744594108e-8f ) ) );
+
+        const __m128i four = _mm_set1_epi32( 4 );
+        sinSign = Xor( sinSign, _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( j, four ), 29 ) ) );
+        const M128 cosSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_andnot_si128( _mm_sub_epi32( j, _mm_set1_epi32( 2 ) ), four ), 29 ) );
+
+        // j = 2 or 6 : sine and cosine polynomials are swapped
+        const M128 swap = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( j, _mm_set1_epi32( 2 ) ), _mm_set1_epi32( 2 ) ) );
+
+        const M128 z = Mul( x, x );
+
+        M128 c = Splat( 2.443315711809948e-5f );
+        c = Add( Mul( c, z ), Splat( -1.388731625493765e-3f ) );
+        c = Add( Mul( c, z ), Splat( 4.166664568298827e-2f ) );
+        c = Mul( Mul( c, z ), z );
+        c = Add( Sub( c, Mul( z, Splat( 0.5f ) ) ), Splat( 1.0f ) );
+
+        M128 s = Splat( -1.9515295891e-4f );
+        s = Add( Mul( s, z ), Splat( 8.3321608736e-3f ) );
+        s = Add( Mul( s, z ), Splat( -1.6666654611e-1f ) );
+        s = Add( Mul( Mul( s, z ), x ), x );
+
+        sin = Xor( Select( s, c, swap ), sinSign );
+        cos = Xor( Select( c, s, swap ), cosSign );
+    }
+
+    inline M128 Sin( M128 angle )
+    {
+        M128 sin, cos;
+        SinCos( angle, sin, cos );
+        return sin;
+    }
+
+    inline M128 Cos( M128 angle )
+    {
+        M128 sin, cos;
+        SinCos( angle, sin, cos );
+        return cos;
+    }
+
+    inline M128 Tan( M128 angle )
+    {
+        const M128 sign = And( angle, Splat( -0.0f ) );
+        M128 x = Abs( angle );
+
+        __m128i j = _mm_cvttps_epi32( Mul( x, Splat( 1.27323954473516f ) ) );
+        j = _mm_and_si128( _mm_add_epi32( j, _mm_set1_epi32( 1 ) ), _mm_set1_epi32( ~1 ) );
+        const M128 fj = _mm_cvtepi32_ps( j );
+
+        x = Sub( x, Mul( fj, Splat( 0.78515625f ) ) );
+        x = Sub( x, Mul( fj, Splat( 2.4187564849853515625e-4f ) ) );
+        x = Sub( x, Mul( fj, Splat( 3.77489497744594108e-8f ) ) );
+
+        const M128 z = Mul( x, x );
+
+        M128 y = Splat( 9.38540185543e-3f );
+        y = Add( Mul( y, z ), Splat( 3.11992232697e-3f ) );
+        y = Add( Mul( y, z ), Splat( 2.44301354525e-2f ) );
+        y = Add( Mul( y, z ), Splat( 5.34112807005e-2f ) );
+        y = Add( Mul( y, z ), Splat( 1.33387994085e-1f ) );
+        y = Add( Mul( y, z ), Splat( 3.33331568548e-1f ) );
+        y = Add( Mul( Mul( y, z ), x ), x );
+
+        // j = 2 or 6 : tan( x + pi/2 ) = -1 / tan( x )
+        const M128 cot = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( j, _mm_set1_epi32( 2 ) ), _mm_set1_epi32( 2 ) ) );
+        y = Select( y, Div( Splat( -1.0f ), y ), cot );
+
+        return Xor( y, sign );
+    }
+
+    // asin( x ) for |x| <= 0.5, z = x * x
+    inline M128 ASinKernel( M128 x, M128 z )
+    {
+        M128 y = Splat( 4.2163199048e-2f );
+        y = Add( Mul( y, z ), Splat( 2.4181311049e-2f ) );
+        y = Add( Mul( y, z ), Splat( 4.5470025998e-2f ) );
+        y = Add( Mul( y, z ), Splat( 7.4953002686e-2f ) );
+        y = Add( Mul( y, z ), Splat( 1.6666752422e-1f ) );
+        return Add( Mul( Mul( y, z ), x ), x );
+    }
+
+    inline M128 ASin( M128 v )
+    {
+        // asin( x ) = pi/2 - 2 * asin( sqrt( ( 1 - x ) / 2 ) ) above 0.5
+        const M128 sign = And( v, Splat( -0.0f ) );
+        const M128 a = Abs( v );
+        const M128 big = GreaterThan( a, Splat( 0.5f ) );
+
+        const M128 z = Select( Mul( a, a ), Mul( Sub( Splat( 1.0f ), a ), Splat( 0.5f ) ), big );
+        const M128 x = Select( a, Sqrt( z ), big );
+
+        M128 y = ASinKernel( x, z );
+        y = Select( y, Sub( Splat( 1.57079632679489661923f ), Add( y, y ) ), big );
+
+        return Xor( y, sign );
+    }
+
+    inline M128 ACos( M128 v )
+    {
+        // acos( x ) = 2 * asin( sqrt( ( 1 - x ) / 2 ) ) above 0.5, pi - acos( -x ) below -0.5
+        const M128 a = Abs( v );
+        const M128 big = GreaterThan( a, Splat( 0.5f ) );
+
+        const M128 z = Select( Mul( v, v ), Mul( Sub( Splat( 1.0f ), a ), Splat( 0.5f ) ), big );
+        const M128 x = Select( v, Sqrt( z ), big );
+
+        const M128 y = ASinKernel( x, z );
+        const M128 y2 = Add( y, y );
+
+        const M128 far = Select( y2, Sub( Splat( 3.14159265358979323846f ), y2 ), LessThan( v, Splat( 0.0f ) ) );
+        return Select( Sub( Splat( 1.57079632679489661923f ), y ), far, big );
+    }
+
+    inline M128 ATan( M128 v )
+    {
+        // atan( x ) = pi/2 + atan( -1 / x ) above tan( 3pi/8 ), pi/4 + atan( ( x - 1 ) / ( x + 1 ) ) above tan( pi/8 )
+        const M128 sign = And( v, Splat( -0.0f ) );
+        M128 x = Abs( v );
+
+        const M128 big = GreaterThan( x, Splat( 2.414213562373095f ) );
+        const M128 mid = AndNot( big, GreaterThan( x, Splat( 0.4142135623730950f ) ) );
+
+        const M128 one = Splat( 1.0f );
+        M128 offset = And( mid, Splat( 0.785398163397448309616f ) );
+        offset = Select( offset, Splat( 1.57079632679489661923f ), big );
+
+        x = Select( x, Div( Sub( x, one ), Add( x, one ) ), mid );
+        x = Select( x, Div( Splat( -1.0f ), x ), big );
+
+        const M128 z = Mul( x, x );
+
+        M128 y = Splat( 8.05374449538e-2f );
+        y = Add( Mul( y, z ), Splat( -1.38776856032e-1f ) );
+        y = Add( Mul( y, z ), Splat( 1.99777106478e-1f ) );
+        y = Add( Mul( y, z ), Splat( -3.33329491539e-1f ) );
+        y = Add( Add( Mul( Mul( y, z ), x ), x ), offset );
+
+        return Xor( y, sign );
+    }
 }
@@ -0,0 +1,85 @@
+#include "Core/Intrinsics.h"
+
+// AVX2 and FMA intrinsics come with Visual Studio 2012
+#if ( defined( _MSC_VER ) && ( _MSC_VER >= 1700 ) ) || defined( __GNUC__ )
+    #define CARBON_HAS_AVX2
+#endif
+
+#if defined( CARBON_HAS_AVX2 )
+
+#include <immintrin.h>
+
+// Functions on M256 must only run when Platform::HasCpuFeatures( CF_AVX2 | CF_FMA ).
+// GCC and Clang only compile them in functions flagged with CARBON_AVX2_TARGET, the
+// rest of the code keeps the default instruction set.
+#if defined( _MSC_VER )
+    #define CARBON_AVX2_TARGET
+#else
+    #define CARBON_AVX2_TARGET __attribute__( ( target( "avx2,fma" ) ) )
+#endif
+
+typedef CARBON_ALIGN( 32 ) float F256[8];           // storage usage
+typedef __m256                      M256;           // compute usage
+
+
+namespace Core
+{
+    CARBON_AVX2_TARGET inline M256 Splat8( F32 v )                      { return _mm256_set1_ps( v );                          }
+
+    CARBON_AVX2_TARGET inline M256 Load8( F256 d )                      { return _mm256_load_ps( d );                          }
+    CARBON_AVX2_TARGET inline M256 LoadUnaligned8( const F32 * d )      { return _mm256_loadu_ps( d );                         }
+    CARBON_AVX2_TARGET inline void Store8( F256 d, M256 v )             { _mm256_store_ps( d, v );                             }
+    CARBON_AVX2_TARGET inline void StoreUnaligned8( F32 * d, M256 v )   { _mm256_storeu_ps( d, v );                            }
+
+    // Two M128 halves
+    CARBON_AVX2_TARGET inline M256 Combine( M128 low, M128 high )       { return _mm256_insertf128_ps( _mm256_castps128_ps256( low ), high, 1 ); }
+    CARBON_AVX2_TARGET inline M128 Low( M256 v )                        { return _mm256_castps256_ps128( v );                  }
+    CARBON_AVX2_TARGET inline M128 High( M256 v )                       { return _mm256_extractf128_ps( v, 1 );                }
+
+    // Arithmetic
+    CARBON_AVX2_TARGET inline M256 Neg( M256 v )                        { return _mm256_xor_ps( v, Splat8( -0.0f ) );          }
+    CARBON_AVX2_TARGET inline M256 Add( M256 l, M256 r )                { return _mm256_add_ps( l, r );                        }
+    CARBON_AVX2_TARGET inline M256 Sub( M256 l, M256 r )                { return _mm256_sub_ps( l, r );                        }
+    CARBON_AVX2_TARGET inline M256 Mul( M256 l, M256 r )                { return _mm256_mul_ps( l, r );                        }
+    CARBON_AVX2_TARGET inline M256 Div( M256 l, M256 r )                { return _mm256_div_ps( l, r );                        }
+    CARBON_AVX2_TARGET inline M256 MulAdd( M256 a, M256 b, M256 c )     { return _mm256_fmadd_ps( a, b, c );                   }  // a * b + c, one rounding
+    CARBON_AVX2_TARGET inline M256 MulSub( M256 a, M256 b, M256 c )     { return _mm256_fmsub_ps( a, b, c );                   }  // a * b - c, one rounding
+    CARBON_AVX2_TARGET inline M256 NegMulAdd( M256 a, M256 b, M256 c )  { return _mm256_fnmadd_ps( a, b, c );                  }  // c - a * b, one rounding
+    CARBON_AVX2_TARGET inline M256 Sqrt( M256 v )                       { return _mm256_sqrt_ps( v );                          }
+    CARBON_AVX2_TARGET inline M256 Rcp( M256 v )                        { return _mm256_rcp_ps( v );                           }
+    CARBON_AVX2_TARGET inline M256 Rsqrt( M256 v )                      { return _mm256_rsqrt_ps( v );                         }
+    CARBON_AVX2_TARGET inline M256 Min( M256 a, M256 b )                { return _mm256_min_ps( a, b );                        }
+    CARBON_AVX2_TARGET inline M256 Max( M256 a, M256 b )                { return _mm256_max_ps( a, b );                        }
+    CARBON_AVX2_TARGET inline M256 Abs( M256 v )                        { return _mm256_andnot_ps( Splat8( -0.0f ), v );       }
+    CARBON_AVX2_TARGET inline M256 Floor( M256 v )                      { return _mm256_floor_ps( v );                         }
+    CARBON_AVX2_TARGET inline M256 Ceil( M256 v )                       { return _mm256_ceil_ps( v );                          }
+    CARBON_AVX2_TARGET inline M256 Clamp( M256 v, M256 min, M256 max )
+    {
+        v = Min( v, max );
+        return Max( min, v );
+    }
+    CARBON_AVX2_TARGET inline M256 Lerp( M256 a, M256 b, M256 r )
+    {
+        return MulAdd( Sub( b, a ), r, a );
+    }
+
+    // Logical
+    CARBON_AVX2_TARGET inline M256 And( M256 l, M256 r )                { return _mm256_and_ps( l, r );                        }
+    CARBON_AVX2_TARGET inline M256 AndNot( M256 l, M256 r )             { return _mm256_andnot_ps( l, r );                     }
+    CARBON_AVX2_TARGET inline M256 Or( M256 l, M256 r )                 { return _mm256_or_ps( l, r );                         }
+    CARBON_AVX2_TARGET inline M256 Xor( M256 l, M256 r )                { return _mm256_xor_ps( l, r );                        }
+
+    // Comparison
+    CARBON_AVX2_TARGET inline M256 LessThan( M256 l, M256 r )           { return _mm256_cmp_ps( l, r, _CMP_LT_OQ );            }
+    CARBON_AVX2_TARGET inline M256 LessEqual( M256 l, M256 r )          { return _mm256_cmp_ps( l, r, _CMP_LE_OQ );            }
+    CARBON_AVX2_TARGET inline M256 GreaterThan( M256 l, M256 r )        { return _mm256_cmp_ps( l, r, _CMP_GT_OQ );            }
+    CARBON_AVX2_TARGET inline M256 GreaterEqual( M256 l, M256 r )       { return _mm256_cmp_ps( l, r, _CMP_GE_OQ );            }
+    CARBON_AVX2_TARGET inline M256 Equal( M256 l, M256 r )              { return _mm256_cmp_ps( l, r, _CMP_EQ_OQ );            }
+    CARBON_AVX2_TARGET inline M256 NotEqual( M256 l, M256 r )           { return _mm256_cmp_ps( l, r, _CMP_NEQ_UQ );           }
+
+    // Misc
+    CARBON_AVX2_TARGET inline M256 Select( M256 l, M256 r, M256 mask )  { return _mm256_blendv_ps( l, r, mask );               }
+    CARBON_AVX2_TARGET inline U32  MoveMask( M256 mask )                { return static_cast< U32 >( _mm256_movemask_ps( mask ) ); }
+}
+
+#endif // CARBON_HAS_AVX2
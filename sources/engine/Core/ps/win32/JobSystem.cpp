@@ -0,0 +1,595 @@
+#include "Core/JobSystem.h"
+
+#include "Core/MpmcQueue.h"
+#include "Core/NativeAllocator.h"
+#include "Core/Thread.h"
+#include "Core/Assert.h"
+
+#include <Windows.h>
+
+namespace Core
+{
+    struct JobContinuation
+    {
+        Job                 m_job;
+        JobCounter *        m_counter;
+        JobContinuation *   m_next;
+    };
+
+    namespace
+    {
+        const SizeT maxQueueCount           = JobSystem::ms_maxWorkerCount + 1;
+        const SizeT maxContinuationCount    = 1024;
+        const SizeT spinCount               = 64;       // tries before sleeping or yielding
+
+        struct QueuedJob
+        {
+            Job             m_job;
+            JobCounter *    m_counter;
+        };
+
+        //================================================================================
+        // JobQueue
+        //================================================================================
+
+        // Chase-Lev deque of fixed size. Indices grow forever and wrap around, they are
+        // only compared through their difference. On x86 loads are not reordered with
+        // loads nor stores with stores, the only full fence needed is between the store
+        // of the bottom and the load of the top in Pop.
+
+        class JobQueue
+        {
+        public:
+            void    Clear();
+
+            Bool    Push( const QueuedJob& job );       // owner, false when full
+            Bool    Pop( QueuedJob& job );              // owner
+            Bool    Steal( QueuedJob& job );            // other threads
+
+        private:
+            static S32 Distance( S32 from, S32 to )
+            {
+                return static_cast< S32 >( static_cast< U32 >( to ) - static_cast< U32 >( from ) );
+            }
+
+            static const SizeT ms_mask = JobSystem::ms_maxQueuedJobCount - 1;
+
+            volatile S32    m_top;                      // written by the thieves
+            U8              m_pad0[ CARBON_CACHE_LINE_SIZE - sizeof( S32 ) ];
+            volatile S32    m_bottom;                   // written by the owner
+            U8              m_pad1[ CARBON_CACHE_LINE_SIZE - sizeof( S32 ) ];
+            QueuedJob       m_jobs[ JobSystem::ms_maxQueuedJobCount ];
+        };
+
+        //======================================================================= JobQueue
+
+        void JobQueue::Clear()
+        {
+            m_top       = 0;
+            m_bottom    = 0;
+        }
+
+        Bool JobQueue::Push( const QueuedJob& job )
+        {
+            const S32 b = m_bottom;
+            const S32 t = AtomicLoad( &m_top );
+
+            if ( Distance( t, b ) >= static_cast< S32 >( JobSystem::ms_maxQueuedJobCount ) )
+            {
+                return false;
+            }
+
+            m_jobs[ b & ms_mask ] = job;
+            AtomicStore( &m_bottom, b + 1 );
+            return true;
+        }
+
+        Bool JobQueue::Pop( QueuedJob& job )
+        {
+            const S32 b = m_bottom - 1;
+            AtomicExchange( &m_bottom, b );
+            const S32 t = AtomicLoad( &m_top );
+
+            const S32 size = Distance( t, b );
+            if ( size < 0 )
+            {
+                AtomicStore( &m_bottom, b + 1 );
+                return false;
+            }
+
+            job = m_jobs[ b & ms_mask ];
+            if ( size > 0 )
+            {
+                return true;
+            }
+
+            // last job, race against the thieves
+            const Bool won = AtomicCompareExchange( &m_top, t + 1, t ) == t;
+            AtomicStore( &m_bottom, t + 1 );
+            return won;
+        }
+
+        Bool JobQueue::Steal( QueuedJob& job )
+        {
+            const S32 t = AtomicLoad( &m_top );
+            const S32 b = AtomicLoad( &m_bottom );
+
+            if ( Distance( t, b ) <= 0 )
+            {
+                return false;
+            }
+
+            // the slot can be overwritten once the top moved, the copy is then dropped
+            job = m_jobs[ t & ms_mask ];
+            return AtomicCompareExchange( &m_top, t + 1, t ) == t;
+        }
+
+        //======================================================================= JobQueue
+
+        JobQueue            queues[ maxQueueCount ];
+        SizeT               queueCount          = 0;
+        __declspec( thread ) SizeT threadQueue  = 0;    // queue index + 1, 0 for threads without queue
+
+        // jobs run from threads without queue, taken before stealing
+        MpmcQueue< QueuedJob, JobSystem::ms_maxQueuedJobCount > sharedJobs;
+
+        HANDLE              workers[ JobSystem::ms_maxWorkerCount ];
+        HANDLE              wakeUp              = 0;
+        volatile S32        sleepingCount       = 0;
+        volatile S32        quit                = 0;
+
+        // continuations past the static ones are allocated by blocks, until Destroy
+        struct ContinuationBlock
+        {
+            ContinuationBlock * m_next;
+            JobContinuation     m_continuations[ maxContinuationCount ];
+        };
+
+        JobContinuation     continuations[ maxContinuationCount ];
+        JobContinuation *   freeContinuations   = 0;
+        ContinuationBlock * continuationBlocks  = 0;
+        SpinLock            continuationLock;
+
+        void Execute( const QueuedJob& job );
+        void Complete( JobCounter * counter );
+
+        void WakeUp( SizeT jobCount )
+        {
+            // pairs with the increment of the sleeping count before the last queue check
+            MemoryFence();
+
+            const S32 sleeping = AtomicLoad( &sleepingCount );
+            if ( sleeping > 0 )
+            {
+                const S32 count = jobCount < static_cast< SizeT >( sleeping ) ? static_cast< S32 >( jobCount ) : sleeping;
+                ReleaseSemaphore( wakeUp, count, NULL );
+            }
+        }
+
+        void Push( const Job& job, JobCounter * counter )
+        {
+            QueuedJob queued;
+            queued.m_job        = job;
+            queued.m_counter    = counter;
+
+            if ( threadQueue == 0 )
+            {
+                while ( ! sharedJobs.Push( queued ) )
+                {
+                    CpuPause();     // full until the workers catch up
+                }
+            }
+            else if ( ! queues[ threadQueue - 1 ].Push( queued ) )
+            {
+                // full queue, run the job instead of growing it
+                Execute( queued );
+            }
+        }
+
+        void Execute( const QueuedJob& job )
+        {
+            job.m_job.m_function( job.m_job.m_data );
+
+            if ( job.m_counter )
+            {
+                Complete( job.m_counter );
+            }
+        }
+
+        // Counts a finished job, starts the continuations of the last one
+        void Complete( JobCounter * counter )
+        {
+            // jobs which are not the last ones only decrement
+            S32 left = AtomicLoad( &counter->m_count );
+            while ( left > 1 )
+            {
+                const S32 previous = AtomicCompareExchange( &counter->m_count, left - 1, left );
+                if ( previous == left )
+                {
+                    return;
+                }
+                left = previous;
+            }
+
+            // the last one counts under the lock : it orders the release against RunAfter
+            // checking the counter, and Wait returns only once the lock is released since
+            // the counter can be on the stack of the waiting thread
+            counter->m_lock.Lock();
+            JobContinuation * first = 0;
+            if ( AtomicDecrement( &counter->m_count ) == 0 )
+            {
+                first = counter->m_continuations;
+                counter->m_continuations = 0;
+            }
+            counter->m_lock.Unlock();
+
+            if ( ! first )
+            {
+                return;
+            }
+
+            SizeT count = 0;
+            JobContinuation * last = 0;
+            for ( JobContinuation * c = first; c; c = c->m_next )
+            {
+                Push( c->m_job, c->m_counter );
+                last = c;
+                ++count;
+            }
+
+            continuationLock.Lock();
+            last->m_next        = freeContinuations;
+            freeContinuations   = first;
+            continuationLock.Unlock();
+
+            WakeUp( count );
+        }
+
+        void LinkContinuations( JobContinuation * first, SizeT count )
+        {
+            for ( SizeT i=0; i<count; ++i )
+            {
+                first[ i ].m_next = ( i + 1 < count ) ? &first[ i + 1 ] : 0;
+            }
+        }
+
+        // continuationLock must be locked
+        JobContinuation * AllocateContinuation()
+        {
+            if ( ! freeContinuations )
+            {
+                ContinuationBlock * block = static_cast< ContinuationBlock * >( NativeAllocator::Malloc( sizeof( ContinuationBlock ) ) );
+                block->m_next       = continuationBlocks;
+                continuationBlocks  = block;
+
+                LinkContinuations( block->m_continuations, maxContinuationCount );
+                freeContinuations = block->m_continuations;
+            }
+
+            JobContinuation * c = freeContinuations;
+            freeContinuations   = c->m_next;
+            return c;
+        }
+
+        void PushAll( const Job * jobs, SizeT count, JobCounter * counter )
+        {
+            for ( SizeT i=0; i<count; ++i )
+            {
+                Push( jobs[ i ], counter );
+            }
+
+            WakeUp( count );
+        }
+
+        Bool FindJob( QueuedJob& job )
+        {
+            const SizeT own = threadQueue - 1;
+
+            if ( threadQueue != 0 && queues[ own ].Pop( job ) )
+            {
+                return true;
+            }
+
+            if ( sharedJobs.Pop( job ) )
+            {
+                return true;
+            }
+
+            for ( SizeT i=1; i<=queueCount; ++i )
+            {
+                const SizeT victim = ( own + i ) % queueCount;
+                if ( victim != own && queues[ victim ].Steal( job ) )
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        DWORD WINAPI WorkerMain( LPVOID param )
+        {
+            threadQueue = reinterpret_cast< SizeT >( param );
+
+            SizeT spin = 0;
+            while ( ! AtomicLoad( &quit ) )
+            {
+                QueuedJob job;
+                if ( FindJob( job ) )
+                {
+                    Execute( job );
+                    spin = 0;
+                    continue;
+                }
+
+                if ( ++spin < spinCount )
+                {
+                    CpuPause();
+                    continue;
+                }
+
+                // last check once counted as sleeping : jobs pushed before are found
+                // here, jobs pushed after release the semaphore
+                AtomicIncrement( &sleepingCount );
+                if ( FindJob( job ) )
+                {
+                    AtomicDecrement( &sleepingCount );
+                    Execute( job );
+                }
+                else
+                {
+                    WaitForSingleObject( wakeUp, INFINITE );
+                    AtomicDecrement( &sleepingCount );
+                }
+                spin = 0;
+            }
+
+            Thread::ReleaseCurrentIndex();
+            return 0;
+        }
+
+        struct ParallelRange
+        {
+            RangeFunction   m_function;
+            void *          m_data;
+            SizeT           m_count;
+            SizeT           m_grain;
+            volatile S32    m_next;             // next range index
+        };
+
+        void RunRanges( void * data )
+        {
+            ParallelRange * range = reinterpret_cast< ParallelRange * >( data );
+
+            for ( ;; )
+            {
+                const SizeT begin = static_cast< SizeT >( AtomicIncrement( &range->m_next ) - 1 ) * range->m_grain;
+                if ( begin >= range->m_count )
+                {
+                    break;
+                }
+
+                const SizeT end = ( range->m_count - begin > range->m_grain ) ? begin + range->m_grain : range->m_count;
+                range->m_function( begin, end, range->m_data );
+            }
+        }
+    }
+
+    //====================================================================================
+
+    void JobSystem::Initialize( SizeT workerCount )
+    {
+        CARBON_ASSERT( queueCount == 0 );
+
+        if ( workerCount > ms_maxWorkerCount )
+        {
+            workerCount = ms_maxWorkerCount;
+        }
+
+        LinkContinuations( continuations, maxContinuationCount );
+        freeContinuations = continuations;
+
+        queueCount = workerCount + 1;
+        for ( SizeT i=0; i<queueCount; ++i )
+        {
+            queues[ i ].Clear();
+        }
+
+        threadQueue = 1;
+
+        sleepingCount   = 0;
+        quit            = 0;
+        wakeUp          = CreateSemaphore( NULL, 0, MAXLONG, NULL );
+
+        for ( SizeT i=0; i<workerCount; ++i )
+        {
+            workers[ i ] = CreateThread( NULL, 0, WorkerMain, reinterpret_cast< LPVOID >( i + 2 ), 0, NULL );
+        }
+    }
+
+    void JobSystem::Destroy()
+    {
+        CARBON_ASSERT( queueCount > 0 );
+
+        const SizeT workerCount = queueCount - 1;
+
+        AtomicStore( &quit, 1 );
+        ReleaseSemaphore( wakeUp, static_cast< LONG >( workerCount ), NULL );
+
+        for ( SizeT i=0; i<workerCount; ++i )
+        {
+            WaitForSingleObject( workers[ i ], INFINITE );
+            CloseHandle( workers[ i ] );
+        }
+
+        CloseHandle( wakeUp );
+        wakeUp = 0;
+
+        while ( continuationBlocks )
+        {
+            ContinuationBlock * next = continuationBlocks->m_next;
+            NativeAllocator::Free( continuationBlocks );
+            continuationBlocks = next;
+        }
+        freeContinuations = 0;
+
+        threadQueue = 0;
+        queueCount = 0;
+    }
+
+    SizeT JobSystem::GetWorkerCount()
+    {
+        return queueCount > 0 ? queueCount - 1 : 0;
+    }
+
+    SizeT JobSystem::GetHardwareThreadCount()
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo( &info );
+        return info.dwNumberOfProcessors;
+    }
+
+    void JobSystem::Run( const Job * jobs, SizeT count, JobCounter * counter )
+    {
+        if ( count == 0 )
+        {
+            return;
+        }
+
+        if ( counter )
+        {
+            AtomicAdd( &counter->m_count, static_cast< S32 >( count ) );
+        }
+
+        PushAll( jobs, count, counter );
+    }
+
+    void JobSystem::Run( JobFunction function, void * data, JobCounter * counter )
+    {
+        Job job;
+        job.m_function  = function;
+        job.m_data      = data;
+
+        Run( &job, 1, counter );
+    }
+
+    void JobSystem::RunAfter( JobCounter& dependency, const Job * jobs, SizeT count, JobCounter * counter )
+    {
+        if ( count == 0 )
+        {
+            return;
+        }
+
+        // counted now, a wait on the counter covers the jobs not started yet
+        if ( counter )
+        {
+            AtomicAdd( &counter->m_count, static_cast< S32 >( count ) );
+        }
+
+        dependency.m_lock.Lock();
+
+        if ( dependency.IsDone() )
+        {
+            dependency.m_lock.Unlock();
+
+            PushAll( jobs, count, counter );
+            return;
+        }
+
+        continuationLock.Lock();
+        for ( SizeT i=0; i<count; ++i )
+        {
+            JobContinuation * c = AllocateContinuation();
+
+            c->m_job                    = jobs[ i ];
+            c->m_counter                = counter;
+            c->m_next                   = dependency.m_continuations;
+            dependency.m_continuations  = c;
+        }
+        continuationLock.Unlock();
+
+        dependency.m_lock.Unlock();
+    }
+
+    void JobSystem::Wait( JobCounter * counter )
+    {
+        SizeT spin = 0;
+        while ( ! counter->IsDone() )
+        {
+            if ( RunPendingJob() )
+            {
+                spin = 0;
+            }
+            else if ( ++spin < spinCount )
+            {
+                CpuPause();
+            }
+            else
+            {
+                // the last jobs run on other threads, let them have this core
+                SwitchToThread();
+            }
+        }
+
+        // the last job may still hold the lock
+        counter->m_lock.Lock();
+        counter->m_lock.Unlock();
+    }
+
+    Bool JobSystem::RunPendingJob()
+    {
+        QueuedJob job;
+        if ( ! FindJob( job ) )
+        {
+            return false;
+        }
+
+        Execute( job );
+        return true;
+    }
+
+    void JobSystem::ParallelFor( SizeT count, SizeT grain, RangeFunction function, void * data )
+    {
+        const SizeT workerCount = GetWorkerCount();
+
+        if ( grain == 0 )
+        {
+            // a few ranges per thread to balance uneven items
+            grain = count / ( 4 * ( workerCount + 1 ) );
+            grain = grain > 0 ? grain : 1;
+        }
+
+        const SizeT rangeCount = ( count + grain - 1 ) / grain;
+        if ( rangeCount <= 1 || workerCount == 0 )
+        {
+            if ( count > 0 )
+            {
+                function( 0, count, data );
+            }
+            return;
+        }
+
+        ParallelRange range;
+        range.m_function    = function;
+        range.m_data        = data;
+        range.m_count       = count;
+        range.m_grain       = grain;
+        range.m_next        = 0;
+
+        // each job takes ranges until none is left, the calling thread takes its share
+        Job jobs[ ms_maxWorkerCount ];
+        const SizeT jobCount = ( rangeCount - 1 < workerCount ) ? rangeCount - 1 : workerCount;
+        for ( SizeT i=0; i<jobCount; ++i )
+        {
+            jobs[ i ].m_function    = RunRanges;
+            jobs[ i ].m_data        = &range;
+        }
+
+        JobCounter counter;
+        Run( jobs, jobCount, &counter );
+
+        RunRanges( &range );
+
+        Wait( &counter );
+    }
+}
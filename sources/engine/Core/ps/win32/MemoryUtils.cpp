@@ -19,6 +19,11 @@ namespace Core
         return memcpy( dest, src, sizeBytes );
     }
 
+    void * MemoryUtils::MemMove( void * dest, const void * src, SizeT sizeBytes )
+    {
+        return memmove( dest, src, sizeBytes );
+    }
+
     void * MemoryUtils::MemSet( void * ptr, U8 value, SizeT sizeBytes )
     {
         return memset( ptr, value, sizeBytes );
@@ -1,9 +1,101 @@
 #include "Core/Platform.h"
 
+#if defined( _MSC_VER )
+    #include <intrin.h>
+#else
+    #include <cpuid.h>
+#endif
+
 namespace Core
 {
+    namespace
+    {
+        void CpuId( S32 leaf, S32 subLeaf, U32 regs[ 4 ] )
+        {
+#if defined( _MSC_VER )
+            int info[ 4 ];
+            __cpuidex( info, leaf, subLeaf );
+            regs[ 0 ] = info[ 0 ];
+            regs[ 1 ] = info[ 1 ];
+            regs[ 2 ] = info[ 2 ];
+            regs[ 3 ] = info[ 3 ];
+#else
+            unsigned int a, b, c, d;
+            __cpuid_count( leaf, subLeaf, a, b, c, d );
+            regs[ 0 ] = a;
+            regs[ 1 ] = b;
+            regs[ 2 ] = c;
+            regs[ 3 ] = d;
+#endif
+        }
+
+        // Register states saved by the OS, from XGETBV
+        U32 OsSavedStates()
+        {
+#if defined( _MSC_VER ) && ( _MSC_FULL_VER >= 160040219 )
+            return static_cast< U32 >( _xgetbv( 0 ) );
+#elif defined( __GNUC__ )
+            unsigned int a, d;
+            __asm__ __volatile__( "xgetbv" : "=a"( a ), "=d"( d ) : "c"( 0 ) );
+            return a;
+#else
+            return 0;                   // no _xgetbv before Visual Studio 2010 SP1, no AVX
+#endif
+        }
+
+        U32 QueryCpuFeatures()
+        {
+            U32 regs[ 4 ];
+            U32 features = 0;
+
+            CpuId( 0, 0, regs );
+            const U32 maxLeaf = regs[ 0 ];
+
+            CpuId( 1, 0, regs );
+            const U32 ecx = regs[ 2 ];
+            const U32 edx = regs[ 3 ];
+
+            if ( edx & ( 1 << 26 ) )    features |= CF_SSE2;
+            if ( ecx & ( 1 << 19 ) )    features |= CF_SSE41;
+
+            // AVX needs the OS to save the XMM and YMM states
+            const Bool osxsave = ( ecx & ( 1 << 27 ) ) != 0;
+            if ( osxsave && ( ecx & ( 1 << 28 ) ) && ( OsSavedStates() & 0x6 ) == 0x6 )
+            {
+                features |= CF_AVX;
+
+                if ( ecx & ( 1 << 12 ) )
+                {
+                    features |= CF_FMA;
+                }
+
+                if ( maxLeaf >= 7 )
+                {
+                    CpuId( 7, 0, regs );
+                    if ( regs[ 1 ] & ( 1 << 5 ) )
+                    {
+                        features |= CF_AVX2;
+                    }
+                }
+            }
+
+            return features;
+        }
+    }
+
     const Char * Platform::GetName()
     {
         return "win32";
     }
+
+    U32 Platform::GetCpuFeatures()
+    {
+        static const U32 features = QueryCpuFeatures();
+        return features;
+    }
+
+    Bool Platform::HasCpuFeatures( U32 features )
+    {
+        return ( GetCpuFeatures() & features ) == features;
+    }
 }
@@ -0,0 +1,29 @@
+#include "Core/Semaphore.h"
+
+#include "Core/Assert.h"
+
+#include <Windows.h>
+
+namespace Core
+{
+    Semaphore::Semaphore()
+    {
+        m_handle = CreateSemaphore( NULL, 0, MAXLONG, NULL );
+        CARBON_ASSERT( m_handle );
+    }
+
+    Semaphore::~Semaphore()
+    {
+        CloseHandle( m_handle );
+    }
+
+    void Semaphore::Signal( SizeT count )
+    {
+        ReleaseSemaphore( m_handle, static_cast< LONG >( count ), NULL );
+    }
+
+    void Semaphore::Wait()
+    {
+        WaitForSingleObject( m_handle, INFINITE );
+    }
+}
@@ -0,0 +1,103 @@
+#include "Core/Thread.h"
+
+#include "Core/SmallObjectAllocator.h"
+#include "Core/Atomic.h"
+#include "Core/Assert.h"
+
+#include <Windows.h>
+
+namespace Core
+{
+    static volatile S32         usedIndices = 0;        // one bit per index given to a running thread
+    static __declspec( thread ) SizeT threadIndex = 0;  // index + 1, 0 means not assigned
+
+    struct ThreadStart
+    {
+        ThreadFunction  m_function;
+        void *          m_data;
+    };
+
+    static DWORD WINAPI ThreadMain( LPVOID param )
+    {
+        ThreadStart start = *reinterpret_cast< ThreadStart * >( param );
+        delete reinterpret_cast< ThreadStart * >( param );
+
+        start.m_function( start.m_data );
+
+        Thread::ReleaseCurrentIndex();
+        return 0;
+    }
+
+    ThreadHandle Thread::Start( ThreadFunction function, void * data )
+    {
+        ThreadStart * start = new ThreadStart;
+        start->m_function   = function;
+        start->m_data       = data;
+
+        HANDLE thread = CreateThread( NULL, 0, ThreadMain, start, 0, NULL );
+        CARBON_ASSERT( thread );
+
+        return thread;
+    }
+
+    void Thread::Join( ThreadHandle thread )
+    {
+        WaitForSingleObject( thread, INFINITE );
+        CloseHandle( thread );
+    }
+
+    SizeT Thread::GetCurrentIndex()
+    {
+        if ( threadIndex == 0 )
+        {
+            for ( ;; )
+            {
+                const S32 used = AtomicLoad( &usedIndices );
+
+                SizeT index = 0;
+                while ( index < ms_maxThreadCount && ( used & static_cast< S32 >( 1U << index ) ) )
+                {
+                    ++index;
+                }
+
+                CARBON_ASSERT( index < ms_maxThreadCount );
+
+                if ( AtomicCompareExchange( &usedIndices, used | static_cast< S32 >( 1U << index ), used ) == used )
+                {
+                    threadIndex = index + 1;
+                    break;
+                }
+            }
+        }
+
+        return threadIndex - 1;
+    }
+
+    void Thread::ReleaseCurrentIndex()
+    {
+        if ( threadIndex == 0 )
+        {
+            return;
+        }
+
+        // the per thread data of the index goes to the next thread
+        SmallObjectAllocator::FlushThreadCache();
+
+        const S32 mask = static_cast< S32 >( 1U << ( threadIndex - 1 ) );
+        for ( ;; )
+        {
+            const S32 used = AtomicLoad( &usedIndices );
+            if ( AtomicCompareExchange( &usedIndices, used & ~mask, used ) == used )
+            {
+                break;
+            }
+        }
+
+        threadIndex = 0;
+    }
+
+    U32 Thread::GetCurrentId()
+    {
+        return GetCurrentThreadId();
+    }
+}
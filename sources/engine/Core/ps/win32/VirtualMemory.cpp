@@ -0,0 +1,75 @@
+#include "Core/VirtualMemory.h"
+
+#include <Windows.h>
+
+namespace Core
+{
+    static SizeT pageSize               = 0;
+    static SizeT allocationGranularity  = 0;
+
+    static void InitSystemInfo()
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo( &info );
+
+        allocationGranularity   = info.dwAllocationGranularity;
+        pageSize                = info.dwPageSize;
+    }
+
+    SizeT VirtualMemory::GetPageSize()
+    {
+        if ( pageSize == 0 )
+        {
+            InitSystemInfo();
+        }
+        return pageSize;
+    }
+
+    SizeT VirtualMemory::GetAllocationGranularity()
+    {
+        if ( allocationGranularity == 0 )
+        {
+            InitSystemInfo();
+        }
+        return allocationGranularity;
+    }
+
+    SizeT VirtualMemory::GetLargePageSize()
+    {
+        return (SizeT)GetLargePageMinimum();
+    }
+
+    void * VirtualMemory::Reserve( SizeT sizeBytes )
+    {
+        return VirtualAlloc( 0, sizeBytes, MEM_RESERVE, PAGE_NOACCESS );
+    }
+
+    void VirtualMemory::Release( void * ptr )
+    {
+        if ( ptr )
+        {
+            VirtualFree( ptr, 0, MEM_RELEASE );
+        }
+    }
+
+    Bool VirtualMemory::Commit( void * ptr, SizeT sizeBytes )
+    {
+        return VirtualAlloc( ptr, sizeBytes, MEM_COMMIT, PAGE_READWRITE ) != 0;
+    }
+
+    void VirtualMemory::Decommit( void * ptr, SizeT sizeBytes )
+    {
+        VirtualFree( ptr, sizeBytes, MEM_DECOMMIT );
+    }
+
+    void * VirtualMemory::ReserveAndCommitLarge( SizeT sizeBytes )
+    {
+        const SizeT largePageSize = GetLargePageSize();
+        if ( largePageSize == 0 )
+        {
+            return 0;
+        }
+
+        return VirtualAlloc( 0, RoundUp( sizeBytes, largePageSize ), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    }
+}
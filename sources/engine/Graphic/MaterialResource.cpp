@@ -6,6 +6,8 @@
 
 namespace Graphic
 {
+    CARBON_DEFINE_RESOURCE_POOL( MaterialResource )
+
     MaterialResource::MaterialResource()
         : Core::Resource()
         , m_program( ProgramCache::ms_invalidHandle )
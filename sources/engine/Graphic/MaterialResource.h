@@ -13,6 +13,8 @@ namespace Graphic
 {
     class _GraphicExport MaterialResource : public Core::Resource
     {
+        CARBON_DECLARE_RESOURCE_POOL( MaterialResource )
+
     public:
         struct Texture
         {
@@ -1,6 +1,7 @@
 #include "Graphic/MeshResource.h"
 
 #include "Graphic/MaterialResource.h"
+#include "Core/MemoryUtils.h"
 
 namespace Graphic
 {
@@ -77,10 +78,24 @@ namespace Graphic
         U32             offset;
     };
 
+    CARBON_DEFINE_RESOURCE_POOL( MeshResource )
+
     MeshResource::MeshResource()
         : Core::Resource()
         , m_subMeshCount( 0 )
     {
+        m_bounds.m_min.m_x = m_boundsData[ 0 ];
+        m_bounds.m_min.m_y = m_boundsData[ 1 ];
+        m_bounds.m_min.m_z = m_boundsData[ 2 ];
+        m_bounds.m_max.m_x = m_boundsData[ 3 ];
+        m_bounds.m_max.m_y = m_boundsData[ 4 ];
+        m_bounds.m_max.m_z = m_boundsData[ 5 ];
+
+        m_bvh.m_nodes       = m_bvhNodes;
+        m_bvh.m_nodeCount   = 0;
+        m_bvh.m_items       = m_bvhItems;
+        m_bvh.m_itemCount   = 0;
+        m_bvh.m_bounds      = m_bounds;
     }
 
     MeshResource::~MeshResource()
@@ -122,6 +137,16 @@ namespace Graphic
         return m_subMeshCount;
     }
 
+    const Core::SoaBoxes& MeshResource::GetSubMeshBounds() const
+    {
+        return m_bounds;
+    }
+
+    const Core::Bvh& MeshResource::GetBvh() const
+    {
+        return m_bvh;
+    }
+
     bool MeshResource::Load( const void * data )
     {
         m_primitive = PT_TRIANGLES;
@@ -180,8 +205,29 @@ namespace Graphic
             ptr += sizeof(U32);
 
             sub_mesh.m_material     = ProgramCache::CreateMaterial( materialId );
+
+            const F32 * bounds = (F32*)ptr;
+            ptr += 6 * sizeof(F32);
+
+            for ( SizeT i=0; i<6; ++i )
+            {
+                m_boundsData[ i ][ m_subMeshCount ] = bounds[ i ];
+            }
         }
 
+        SizeT nodeCount = *((U32*)ptr);
+        ptr += sizeof(U32);
+
+        CARBON_ASSERT( nodeCount <= 2 * ms_maxSubMeshCount );
+        Core::MemoryUtils::MemCpy( m_bvhNodes, ptr, nodeCount * sizeof(Core::BvhNode) );
+        ptr += nodeCount * sizeof(Core::BvhNode);
+
+        Core::MemoryUtils::MemCpy( m_bvhItems, ptr, m_subMeshCount * sizeof(U32) );
+        ptr += m_subMeshCount * sizeof(U32);
+
+        m_bvh.m_nodeCount   = nodeCount;
+        m_bvh.m_itemCount   = m_subMeshCount;
+
         return true;
     }
 
@@ -5,6 +5,7 @@
 #include "Graphic/DLL.h"
 
 #include "Core/Resource.h"
+#include "Core/Bvh.h"
 #include "Graphic/RenderDevice.h"
 #include "Graphic/MaterialResource.h"
 
@@ -14,6 +15,8 @@ namespace Graphic
 
     class _GraphicExport MeshResource : public Core::Resource
     {
+        CARBON_DECLARE_RESOURCE_POOL( MeshResource )
+
     public:
         static const SizeT  ms_maxSubMeshCount = 32;
 
@@ -36,6 +39,8 @@ namespace Graphic
         DataType                    GetIndexType() const;
         const SubMesh *             GetSubMeshes() const;
         SizeT                       GetSubMeshCount() const;
+        const Core::SoaBoxes&       GetSubMeshBounds() const;   // in mesh space
+        const Core::Bvh&            GetBvh() const;             // over the sub meshes
 
     protected:
         bool Load( const void * data );
@@ -49,6 +54,11 @@ namespace Graphic
         DataType            m_indexType;
         SubMesh             m_subMeshes[ ms_maxSubMeshCount ];
         SizeT               m_subMeshCount;
+        F32                 m_boundsData[ 6 ][ ms_maxSubMeshCount ];
+        Core::SoaBoxes      m_bounds;
+        Core::BvhNode       m_bvhNodes[ 2 * ms_maxSubMeshCount ];
+        U32                 m_bvhItems[ ms_maxSubMeshCount ];
+        Core::Bvh           m_bvh;
     };
 }
 
@@ -4,7 +4,9 @@
 
 #include "Core/ResourceManager.h"
 #include "Core/FileSystem.h"
+#include "Core/SmallArray.h"
 #include "Core/Hash.h"
+#include "Core/TimeUtils.h"
 #include "Core/Trace.h"
 
 using namespace Core;
@@ -33,9 +35,21 @@ namespace Graphic
 
     const SizeT maxProgramSetCount = 16;
 
+    // The set files and the samplers are rewritten by the tools while the game runs, the
+    // packs hold older copies : the loose files are watched and read first
+    Bool LoadMaterialFile( const PathString& fileName, void *& buffer, SizeT& size )
+    {
+        return FileSystem::LoadLoose( fileName, buffer, size ) || FileSystem::Load( fileName, buffer, size );
+    }
+
+    // Without directory notifications, the files are checked every pollPeriod seconds
+    const F64 pollPeriod = 1.0;
+
     Bool dirtyCache = false;
+    U64 lastPollTime = 0;
 
     const ProgramHandle             ProgramCache::ms_invalidHandle = -1;
+    const U32                       ProgramCache::ms_defaultSetId = HashedString( "" );
 
     Core::PathString                ProgramCache::m_dataPath;
     Core::PathString                ProgramCache::m_cachePath;
@@ -45,6 +59,11 @@ namespace Graphic
     ProgramCache::ProgramSetArray   ProgramCache::m_programSets;
     ProgramCache::SamplerArray      ProgramCache::m_samplers;
 
+    ProgramCache::DependencyArray   ProgramCache::m_dependencies;
+    U64                             ProgramCache::m_samplersWriteTime;
+    DirectoryWatcher                ProgramCache::m_sourceWatcher;
+    DirectoryWatcher                ProgramCache::m_materialWatcher;
+
     Handle                          ProgramCache::m_programCache;
     Handle                          ProgramCache::m_samplerCache[ RenderDevice::ms_maxTextureUnitCount ];
     Handle                          ProgramCache::m_uniformBufferCache;
@@ -61,6 +80,10 @@ namespace Graphic
 
         BuildCache();
 
+        m_sourceWatcher.Watch( m_dataPath );
+        m_materialWatcher.Watch( m_materialPath );
+        lastPollTime = TimeUtils::ClockTime();
+
         m_programCache = 0;
         memset( &m_samplerCache, 0, sizeof(m_samplerCache) );
         m_uniformBufferCache = 0;
@@ -77,6 +100,10 @@ namespace Graphic
         }
         SetUniformBuffer( 0 );
 
+        m_sourceWatcher.Stop();
+        m_materialWatcher.Stop();
+        m_dependencies.Clear();
+
         m_dataPath.Clear();
         m_cachePath.Clear();
         m_materialPath.Clear();
@@ -115,16 +142,35 @@ namespace Graphic
 
     void ProgramCache::Update()
     {
+        // both polled, a notification is only reset once seen
+        const Bool sourcesChanged   = m_sourceWatcher.HasChanged();
+        const Bool materialsChanged = m_materialWatcher.HasChanged();
+
+        if ( sourcesChanged || materialsChanged )
+        {
+            dirtyCache = true;
+        }
+
+        if ( ! ( m_sourceWatcher.IsWatching() && m_materialWatcher.IsWatching() ) )
+        {
+            const U64 time = TimeUtils::ClockTime();
+            if ( ( time - lastPollTime ) * TimeUtils::ClockPeriod() >= pollPeriod )
+            {
+                dirtyCache = true;
+                lastPollTime = time;
+            }
+        }
+
         if ( dirtyCache )
         {
-            ReloadCache();
+            ReloadChanges();
             dirtyCache = false;
         }
     }
 
     U32 ProgramCache::CreateId( const Char * str )
     {
-        return Core::HashString( str );
+        return HashedString( str );
     }
 
     ProgramHandle ProgramCache::GetProgram( U32 nameId, U32 setId )
@@ -133,13 +179,21 @@ namespace Graphic
 
         ProgramHandle handle = ( prg - m_programs.Begin() ) << 4;
 
-        if ( setId == CreateId( "" ) )
+        if ( setId == ms_defaultSetId )
             return handle;
 
         ProgramSetArray::ConstIterator it = m_programSets.Begin() + handle;
         ProgramSetArray::ConstIterator end = it + prg->m_setCount;
         for ( ; it != end && it->m_id != setId; ++it );
 
+#if defined( CARBON_DEBUG )
+        if ( it == end )
+        {
+            Char msg[ 256 ];
+            StringUtils::FormatString( msg, 256, "Program \"%s\" has no set \"%s\"\n", HashedString::GetString( nameId ), HashedString::GetString( setId ) );
+            CARBON_TRACE( msg );
+        }
+#endif
         CARBON_ASSERT( it != end );
 
         return it - m_programSets.Begin();
@@ -238,6 +292,8 @@ namespace Graphic
         }
 
         LoadProgramSets();
+
+        BuildDependencies();
     }
 
     void ProgramCache::ReloadCache()
@@ -249,6 +305,8 @@ namespace Graphic
         }
         SetUniformBuffer( 0 );
 
+        Bool samplersLoaded;
+
         // Reload samplers
         {
             SamplerArray::Iterator it   = m_samplers.Begin();
@@ -258,7 +316,7 @@ namespace Graphic
                 RenderDevice::DestroySampler( *it );
             }
             m_samplers.Clear();
-            LoadSamplerList();
+            samplersLoaded = LoadSamplerList();
         }
         // Reload programs
         {
@@ -283,36 +341,224 @@ namespace Graphic
             m_programSets.Clear();
             LoadProgramSets();
         }
+
+        BuildDependencies();
+
+        // tried again on the next check
+        if ( ! samplersLoaded )
+        {
+            m_samplersWriteTime = 0;
+        }
     }
 
-    void ProgramCache::LoadSamplerList()
+    void ProgramCache::ReloadChanges()
     {
+        // samplers are shared by every program set
+        PathString samplersName = m_materialPath;
+        samplersName += "/";
+        samplersName += samplersFileName;
+
+        if ( FileSystem::GetLooseWriteTime( samplersName ) != m_samplersWriteTime )
+        {
+            CARBON_TRACE( "Samplers changed, reloading every program\n" );
+            ReloadCache();
+            return;
+        }
+
+        // the dependencies of a program follow each other
+        DependencyArray::Iterator it    = m_dependencies.Begin();
+        DependencyArray::Iterator end   = m_dependencies.End();
+        while ( it != end )
+        {
+            const SizeT index = it->m_program;
+            const DependencyArray::Iterator first = it;
+
+            U64 writeTimes[ ST_COUNT + 1 ];
+            Bool programChanged = false;
+            Bool setsChanged    = false;
+
+            for ( ; it != end && it->m_program == index; ++it )
+            {
+                PathString fileName;
+                GetDependencyName( *it, fileName );
+
+                const U64 writeTime = FileSystem::GetLooseWriteTime( fileName );
+                writeTimes[ it - first ] = writeTime;
+
+                if ( writeTime != it->m_writeTime )
+                {
+                    if ( it->m_type == ST_COUNT )
+                        setsChanged = true;
+                    else
+                        programChanged = true;
+                }
+            }
+
+            const Bool programReloaded  = programChanged && ReloadProgram( index );
+            const Bool setsReloaded     = setsChanged && ReloadProgramSets( index );
+
+            // a failed reload, of a file still being written for instance, is tried again
+            // on the next check
+            for ( DependencyArray::Iterator dep = first; dep != it; ++dep )
+            {
+                if ( ( dep->m_type == ST_COUNT ) ? setsReloaded : programReloaded )
+                {
+                    dep->m_writeTime = writeTimes[ dep - first ];
+                }
+            }
+        }
+    }
+
+    void ProgramCache::BuildDependencies()
+    {
+        m_dependencies.Clear();
+
+        for ( SizeT i=0; i<m_programs.Size(); ++i )
+        {
+            Dependency dependency;
+            dependency.m_program = static_cast< U32 >( i );
+
+            for ( SizeT t=0; t<=ST_COUNT; ++t )
+            {
+                if ( t < ST_COUNT && ! ( m_programs[ i ].m_type & ( 1 << t ) ) )
+                {
+                    continue;
+                }
+
+                dependency.m_type = static_cast< U32 >( t );
+
+                PathString fileName;
+                GetDependencyName( dependency, fileName );
+                dependency.m_writeTime = FileSystem::GetLooseWriteTime( fileName );
+
+                m_dependencies.PushBack( dependency );
+            }
+        }
+
         PathString fileName = m_materialPath;
         fileName += "/";
         fileName += samplersFileName;
 
-        void * buffer;
-        SizeT size;
+        m_samplersWriteTime = FileSystem::GetLooseWriteTime( fileName );
+    }
+
+    void ProgramCache::GetDependencyName( const Dependency& dependency, PathString& fileName )
+    {
+        const Program& program = m_programs[ dependency.m_program ];
 
-        if ( FileSystem::Load( fileName, buffer, size ) )
+        if ( dependency.m_type == ST_COUNT )
         {
-            U8 * ptr = (U8*)buffer;
+            fileName = m_materialPath;
+            fileName += "/";
+            fileName += program.m_name;
+            fileName += ".bin";
+        }
+        else
+        {
+            fileName = m_dataPath;
+            fileName += "/";
+            fileName += program.m_name;
+            fileName += Extensions[ dependency.m_type ];
+        }
+    }
 
-            SizeT count     = *((U32*)ptr);
-            ptr            += sizeof(U32);
+    Bool ProgramCache::ReloadProgram( SizeT index )
+    {
+        Program& program = m_programs[ index ];
 
-            m_samplers.Reserve( count );
-            while ( count )
-            {
-                SamplerDesc desc    = *((SamplerDesc*)ptr);
-                ptr                 += sizeof(SamplerDesc);
+        // the new program replaces the previous one only once built
+        const Handle previous = program.m_handle;
+        program.m_handle = 0;
 
-                m_samplers.PushBack( RenderDevice::CreateSampler( (FilterType)desc.m_min, (FilterType)desc.m_mag, (MipType)desc.m_mip, (WrapType)desc.m_wrap ) );
-                --count;
+        LoadProgramFromSources( program );
+
+        if ( ! program.m_handle )
+        {
+            Char msg[ 256 ];
+            StringUtils::FormatString( msg, 256, "Program \"%s\" failed to build, the previous one is kept\n", program.m_name );
+            CARBON_TRACE( msg );
+
+            program.m_handle = previous;
+            return false;
+        }
+
+        if ( m_programCache == previous )
+        {
+            SetProgram( 0 );
+        }
+        RenderDevice::DeleteProgram( previous );
+
+        return true;
+    }
+
+    Bool ProgramCache::ReloadProgramSets( SizeT index )
+    {
+        const Program& program = m_programs[ index ];
+        const SizeT handle = index << 4;
+
+        Handle previous[ maxProgramSetCount ];
+        const SizeT previousCount = program.m_setCount;
+        for ( SizeT i=0; i<previousCount; ++i )
+        {
+            previous[ i ] = m_programSets[ handle + i ].m_uniformBuffer;
+        }
+
+        if ( ! LoadProgramSets( index ) )
+        {
+            return false;
+        }
+
+        for ( SizeT i=0; i<previousCount; ++i )
+        {
+            if ( m_uniformBufferCache == previous[ i ] )
+            {
+                SetUniformBuffer( 0 );
             }
+            RenderDevice::DestroyBuffer( previous[ i ] );
+        }
+
+        return true;
+    }
 
+    Bool ProgramCache::LoadSamplerList()
+    {
+        PathString fileName = m_materialPath;
+        fileName += "/";
+        fileName += samplersFileName;
+
+        void * buffer = 0;
+        SizeT size;
+
+        if ( ! LoadMaterialFile( fileName, buffer, size ) )
+        {
+            return false;
+        }
+
+        // count, then the samplers, a file being written is shorter than its count
+        if ( size < sizeof(U32) || ( size - sizeof(U32) ) / sizeof(SamplerDesc) < *((U32*)buffer) )
+        {
             UnknownAllocator::Deallocate( buffer );
+            return false;
+        }
+
+        U8 * ptr = (U8*)buffer;
+
+        SizeT count     = *((U32*)ptr);
+        ptr            += sizeof(U32);
+
+        m_samplers.Reserve( count );
+        while ( count )
+        {
+            SamplerDesc desc    = *((SamplerDesc*)ptr);
+            ptr                 += sizeof(SamplerDesc);
+
+            m_samplers.PushBack( RenderDevice::CreateSampler( (FilterType)desc.m_min, (FilterType)desc.m_mag, (MipType)desc.m_mip, (WrapType)desc.m_wrap ) );
+            --count;
         }
+
+        UnknownAllocator::Deallocate( buffer );
+
+        return true;
     }
 
     void ProgramCache::LoadProgram( Program& program )
@@ -378,6 +624,7 @@ namespace Graphic
             RenderDevice::GetProgramBinary( program.m_handle, buffer, size );
 
             FileSystem::Save( fileName, buffer, size );
+            GraphicAllocator::Deallocate( buffer );
         }
     }
 
@@ -395,15 +642,16 @@ namespace Graphic
             searchStr += program.m_name;
             searchStr += ".*";
 
-            Array< PathString > shaderFileNames;
+            // a program has a few stage sources at most
+            SmallArray< PathString, 4 > shaderFileNames;
             FileSystem::Find( searchStr.ConstPtr(), shaderFileNames );
 
             U64 binLastWriteTime = FileSystem::GetLastWriteTime( binFileName );
 
             Bool binIsUpToDate = true;
 
-            Array< PathString >::ConstIterator it = shaderFileNames.Begin();
-            Array< PathString >::ConstIterator end = shaderFileNames.End();
+            SmallArray< PathString, 4 >::ConstIterator it = shaderFileNames.Begin();
+            SmallArray< PathString, 4 >::ConstIterator end = shaderFileNames.End();
             for ( ; it != end; ++it )
             {
                 const PathString& shaderFileName = *it;
@@ -434,59 +682,112 @@ namespace Graphic
 
         for ( SizeT i=0; i<m_programs.Size(); ++i )
         {
-            Program& program = m_programs[i];
+            LoadProgramSets( i );
+        }
+    }
 
-            PathString fileName = m_materialPath;
-            fileName += "/";
-            fileName += program.m_name;
-            fileName += ".bin";
+    Bool ProgramCache::LoadProgramSets( SizeT index )
+    {
+        Program& program = m_programs[ index ];
+
+        PathString fileName = m_materialPath;
+        fileName += "/";
+        fileName += program.m_name;
+        fileName += ".bin";
 
-            SizeT handle = i << 4;
+        SizeT handle = index << 4;
 
-            void * buffer;
-            SizeT size;
+        void * buffer = 0;
+        SizeT size;
+
+        if ( ! LoadMaterialFile( fileName, buffer, size ) )
+        {
+            return false;
+        }
+
+        if ( ! IsValidProgramSets( buffer, size ) )
+        {
+            Char msg[ 256 ];
+            StringUtils::FormatString( msg, 256, "Program sets \"%s\" are invalid or incomplete\n", program.m_name );
+            CARBON_TRACE( msg );
+
+            UnknownAllocator::Deallocate( buffer );
+            return false;
+        }
+
+        U8 * ptr = (U8*)buffer;
 
-            FileSystem::Load( fileName, buffer, size );
+        SizeT samplerCount  = *((U32*)ptr);
+        ptr                 += sizeof(U32);
+
+        for ( program.m_samplerCount=0; program.m_samplerCount<samplerCount; ++program.m_samplerCount )
+        {
+            program.m_samplers[ program.m_samplerCount ].m_index    = *((U32*)ptr);
+            ptr                                                     += sizeof(U32);
+            program.m_samplers[ program.m_samplerCount ].m_handle   = m_samplers[ *((U32*)ptr) ];
+            ptr                                                     += sizeof(U32);
+        }
 
-            U8 * ptr = (U8*)buffer;
+        SizeT setSize   = *((U32*)ptr);
+        ptr             += sizeof(U32);
 
-            SizeT samplerCount  = *((U32*)ptr);
-            ptr                 += sizeof(U32);
+        SizeT setCount  = *((U32*)ptr);
+        ptr             += sizeof(U32);
 
-            for ( program.m_samplerCount=0; program.m_samplerCount<samplerCount; ++program.m_samplerCount )
+        for ( program.m_setCount=0; program.m_setCount<setCount; ++program.m_setCount )
+        {
+            ProgramSet& set = m_programSets[ handle + program.m_setCount ];
+
+            set.m_id    = *((U32*)ptr);
+            ptr         += sizeof(U32);
+
+            if ( setSize )
             {
-                program.m_samplers[ program.m_samplerCount ].m_index    = *((U32*)ptr);
-                ptr                                                     += sizeof(U32);
-                program.m_samplers[ program.m_samplerCount ].m_handle   = m_samplers[ *((U32*)ptr) ];
-                ptr                                                     += sizeof(U32);
+                set.m_uniformBuffer = RenderDevice::CreateUniformBuffer( setSize, ptr, BU_STATIC );
+                ptr                 += setSize;
             }
+            else
+            {
+                set.m_uniformBuffer = 0;
+            }
+        }
 
-            SizeT setSize   = *((U32*)ptr);
-            ptr             += sizeof(U32);
+        UnknownAllocator::Deallocate( buffer );
 
-            SizeT setCount  = *((U32*)ptr);
-            ptr             += sizeof(U32);
+        return true;
+    }
 
-            for ( program.m_setCount=0; program.m_setCount<setCount; ++program.m_setCount )
-            {
-                ProgramSet& set = m_programSets[ handle + program.m_setCount ];
+    Bool ProgramCache::IsValidProgramSets( const void * buffer, SizeT size )
+    {
+        // sampler count, ( unit, sampler ) pairs, set size, set count, ( id, set ) pairs :
+        // checked before anything is created, a file being written is shorter than its counts
+        const U32 * words       = reinterpret_cast< const U32 * >( buffer );
+        const SizeT wordCount   = size / sizeof(U32);
 
-                set.m_id    = *((U32*)ptr);
-                ptr         += sizeof(U32);
+        if ( wordCount < 1 )
+        {
+            return false;
+        }
 
-                if ( setSize )
-                {
-                    set.m_uniformBuffer = RenderDevice::CreateUniformBuffer( setSize, ptr, BU_STATIC );
-                    ptr                 += setSize;
-                }
-                else
-                {
-                    set.m_uniformBuffer = 0;
-                }
-            }
+        const SizeT samplerCount = words[ 0 ];
+        if ( samplerCount > RenderDevice::ms_maxTextureUnitCount || wordCount < 3 + 2 * samplerCount )
+        {
+            return false;
+        }
 
-            UnknownAllocator::Deallocate( buffer );
+        for ( SizeT i=0; i<samplerCount; ++i )
+        {
+            if ( words[ 2 + 2 * i ] >= m_samplers.Size() )
+            {
+                return false;
+            }
         }
+
+        const SizeT setSize     = words[ 1 + 2 * samplerCount ];
+        const SizeT setCount    = words[ 2 + 2 * samplerCount ];
+        const SizeT headerSize  = ( 3 + 2 * samplerCount ) * sizeof(U32);
+
+        return ( setCount <= maxProgramSetCount ) && ( setSize <= size ) && ( size - headerSize >= setCount * ( sizeof(U32) + setSize ) );
     }
 
     ProgramCache::ProgramArray::Iterator ProgramCache::Find( U32 id )
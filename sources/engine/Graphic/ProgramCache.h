@@ -6,6 +6,7 @@
 
 #include "Core/FixedString.h"
 #include "Core/Array.h"
+#include "Core/DirectoryWatcher.h"
 
 namespace Graphic
 {
@@ -20,6 +21,7 @@ namespace Graphic
 
     public:
         static const ProgramHandle          ms_invalidHandle;
+        static const U32                    ms_defaultSetId;    // id of ""
 
         static Bool                         Initialize( const Char * shaderPath );
         static void                         Destroy();
@@ -27,26 +29,47 @@ namespace Graphic
 
         static U32                          CreateId( const Char * str );
 
-        static ProgramHandle                GetProgram( U32 nameId, U32 setId = CreateId( "" ) );
+        static ProgramHandle                GetProgram( U32 nameId, U32 setId = ms_defaultSetId );
         static MaterialResource *           CreateMaterial( U32 materialId );
 
         static void                         UseProgram( ProgramHandle handle );
 
+        // Update rebuilds the programs whose sources changed and the sets whose files
+        // changed, as soon as the directories tell so or every few updates when they
+        // cannot be watched. Forces that check on the next Update.
         static void                         NotifySourceChange();
 
     private:
-        typedef Core::Array< Program >      ProgramArray;
-        typedef Core::Array< ProgramSet >   ProgramSetArray;
-        typedef Core::Array< Handle >       SamplerArray;
+        typedef Core::Array< Program, Core::GraphicAllocator >      ProgramArray;
+        typedef Core::Array< ProgramSet, Core::GraphicAllocator >   ProgramSetArray;
+        typedef Core::Array< Handle, Core::GraphicAllocator >       SamplerArray;
+
+        // File a program depends on, one of its sources or its set file
+        struct Dependency
+        {
+            U32     m_program;      // index in m_programs
+            U32     m_type;         // ShaderType, ST_COUNT for the set file
+            U64     m_writeTime;
+        };
+        typedef Core::Array< Dependency, Core::GraphicAllocator >   DependencyArray;
 
         static void                         BuildCache();
         static void                         ReloadCache();
+        static void                         ReloadChanges();
 
-        static void                         LoadSamplerList();
+        static void                         BuildDependencies();
+        static void                         GetDependencyName( const Dependency& dependency, Core::PathString& fileName );
+
+        static Bool                         LoadSamplerList();
         static void                         LoadProgram( Program& program );
         static void                         LoadProgramFromSources( Program& program );
         static void                         LoadProgramFromBinaries( Program& program );
         static void                         LoadProgramSets();
+        static Bool                         LoadProgramSets( SizeT index );
+        static Bool                         IsValidProgramSets( const void * buffer, SizeT size );
+
+        static Bool                         ReloadProgram( SizeT index );
+        static Bool                         ReloadProgramSets( SizeT index );
 
         static ProgramArray::Iterator       Find( U32 id );
 
@@ -62,6 +85,11 @@ namespace Graphic
         static ProgramSetArray              m_programSets;
         static SamplerArray                 m_samplers;
 
+        static DependencyArray              m_dependencies;     // by program
+        static U64                          m_samplersWriteTime;
+        static Core::DirectoryWatcher       m_sourceWatcher;
+        static Core::DirectoryWatcher       m_materialWatcher;
+
         static Handle                       m_programCache;
         static Handle                       m_samplerCache[ RenderDevice::ms_maxTextureUnitCount ];
         static Handle                       m_uniformBufferCache;
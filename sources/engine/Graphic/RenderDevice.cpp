@@ -358,7 +358,7 @@ namespace Graphic
 
         size = binLength + sizeof(GLenum);
 
-        binary          = Core::UnknownAllocator::Allocate( size );
+        binary          = Core::GraphicAllocator::Allocate( size );
         GLenum * fmt    = (GLenum*)binary;
         void * buffer   = fmt + 1;
 
@@ -232,7 +232,7 @@ namespace Graphic
 
         static Handle           CreateProgram( const Char * srcBuffers[], SizeT srcSizes[], ShaderType srcTypes[], SizeT count );
         static void             DeleteProgram( Handle program );
-        static void             GetProgramBinary( Handle program, void *& binary, SizeT& size );
+        static void             GetProgramBinary( Handle program, void *& binary, SizeT& size );  // binary is released with Core::GraphicAllocator
         static Handle           CreateProgramBinary( const void * binary, SizeT size );
         static void             UseProgram( Handle program );
 
@@ -17,6 +17,8 @@ namespace Graphic
         U32 height;
     };
 
+    CARBON_DEFINE_RESOURCE_POOL( TextureResource )
+
     TextureResource::TextureResource()
         : Core::Resource()
     {
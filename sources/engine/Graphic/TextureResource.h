@@ -11,6 +11,8 @@ namespace Graphic
 {
     class _GraphicExport TextureResource : public Core::Resource
     {
+        CARBON_DECLARE_RESOURCE_POOL( TextureResource )
+
     public:
         TextureResource();
         ~TextureResource();
@@ -2,6 +2,7 @@
 #include "UnitTest/Utils.h"
 
 #include "Core/FileSystem.h"
+#include "Core/JobSystem.h"
 #include "Core/ResourceManager.h"
 
 #include "Core/TimeUtils.h"
@@ -16,6 +17,10 @@ const SizeT frameHeight         = 720;
 
 const U32 FRAME_MAX_COUNT       = 60;
 
+// Resource::Load time and file bytes allowed per frame
+const F32 resourceBudgetMs      = 2.0f;
+const SizeT resourceBudgetBytes = 8 * 1024 * 1024;
+
 Bool RegisterInputDevices( HWND hwnd )
 {
     RAWINPUTDEVICE Rid[2];
@@ -46,6 +51,8 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         case WM_KEYDOWN:
 		    if ( wParam == VK_ESCAPE )
 		        PostQuitMessage(0);
+            else if ( wParam == VK_F1 )
+                MemoryManager::DumpStats();
             break;
         default:
             return DefWindowProc(hwnd, msg, wParam, lParam);
@@ -140,8 +147,14 @@ Bool Application::Initialize()
     }
 
     MemoryManager::Initialize( frameAllocatorSize );
+    JobSystem::Initialize( JobSystem::GetHardwareThreadCount() - 1 );
     FileSystem::Initialize( "../../.." );
 
+    // built by the PackCompiler, loose files are used without it
+    PathString packName;
+    FileSystem::BuildPathName( "/cache.pak", packName, FileSystem::PT_ROOT );
+    FileSystem::Mount( packName );
+
     if ( ! m_renderDevice.Initialize( m_window.hInstance, m_window.hwnd ) )
     {
         MessageBox( m_window.hwnd, "Cannot initialize the 3D device !", "Fatal Error", MB_OK );
@@ -156,6 +169,7 @@ Bool Application::Initialize()
     }
 
     ResourceManager::Initialize();
+    ResourceManager::SetFrameBudget( resourceBudgetMs, resourceBudgetBytes );
 
     PreExecute();
 
@@ -173,6 +187,7 @@ void Application::Destroy()
     m_renderDevice.Destroy();
 
     FileSystem::Destroy();
+    JobSystem::Destroy();
     MemoryManager::Destroy();
 }
 
@@ -245,8 +260,8 @@ void Application::DisplayFramerate()
     {
         F64 fps = FRAME_MAX_COUNT * Core::TimeUtils::ClockFrequency() / ( m_ticksCount );
 
-        Char text[ 32 ];
-        SetWindowText( m_window.hwnd, Core::StringUtils::FormatString( text, 32, "CarbonEngine [ %0.0f fps ]", fps ) );
+        Char text[ 64 ];
+        SetWindowText( m_window.hwnd, Core::StringUtils::FormatString( text, 64, "CarbonEngine [ %0.0f fps | frame mem %d / %d bytes ]", fps, MemoryManager::GetFrameHighWaterMark(), MemoryManager::GetFramePeakHighWaterMark() ) );
 
         m_frameCount = 0;
         m_ticksCount = 0;
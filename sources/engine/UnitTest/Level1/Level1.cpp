@@ -2,21 +2,703 @@
 #include "UnitTest/Utils.h"
 
 #include "Core/MemoryManager.h"
+#include "Core/NativeAllocator.h"
+#include "Core/StackAllocator.h"
+#include "Core/Pool.h"
+#include "Core/VirtualMemory.h"
+#include "Core/VirtualArena.h"
 #include "Core/Array.h"
 #include "Core/FixedArray.h"
+#include "Core/SmallArray.h"
 #include "Core/String.h"
 #include "Core/FixedString.h"
+#include "Core/Bucket.h"
+#include "Core/HashTable.h"
+#include "Core/Hash.h"
+#include "Core/StringUtils.h"
+#include "Core/SpscQueue.h"
+#include "Core/MpscQueue.h"
+#include "Core/MpmcQueue.h"
+#include "Core/SpinLock.h"
+#include "Core/SharedPtr.h"
+#include "Core/JobSystem.h"
+#include "Core/Thread.h"
+#include "Core/FileSystem.h"
+#include "Core/Pack.h"
+#include "Core/Resource.h"
+#include "Core/ResourceManager.h"
 
 #include "Core/Timer.h"
+#include "Core/TimeUtils.h"
+
+#include "Graphic/RenderList.h"
+
+#include <Windows.h>
 
 using namespace Core;
 
 #define ALLOC_TYPE  char
 #define ALLOC_COUNT 500000
 
+#define SMALL_ALLOC_COUNT   50000
+#define SMALL_ALLOC_PASS    10
+
+#define POOL_OBJECT_COUNT   20000
+
+#define GROW_COUNT          ( 4 * 1024 * 1024 )
+#define GROW_RESERVE        ( 64 * 1024 * 1024 )
+
+#define PATH_COUNT          4096
+#define ELEMENT_COUNT       ( 256 * 1024 )
+
+#define LIST_COUNT          100000
+#define LIST_SIZE           3
+
+#define HASH_MIN_COUNT      1000
+#define HASH_MAX_COUNT      1000000
+#define BUCKET_MAX_COUNT    100000      // the bucket table is quadratic, it takes minutes past that
+
+#define HASHED_STRING_PASS  1000000
+
+#define SCRATCH_PASS        16
+#define SCRATCH_SIZE        ( 64 * 1024 )
+
+#define QUEUE_CAPACITY      1024
+#define QUEUE_ITEM_COUNT    ( 1024 * 1024 )     // per producer
+#define QUEUE_MAX_THREADS   4
+#define QUEUE_PING_COUNT    100000
+
+#define REFERENCE_COUNT     ( 1024 * 1024 )
+
+#define RESOURCE_COUNT      512
+#define RESOURCE_WORD_COUNT ( 64 * 1024 )
+#define FRAME_BUDGET_MS     16.0
+#define FINALIZE_BUDGET_MS  1.0f
+
 namespace Level1_NS
 {
     void * allocs[ ALLOC_COUNT ];
+
+    SizeT smallSizes[ SMALL_ALLOC_COUNT ];
+
+    struct PoolObject
+    {
+        U32 m_id;
+        U8  m_payload[ 1020 ];      // about the size of a mesh resource
+    };
+
+    // PathString with copy counting, it holds its characters so it is not relocatable
+    struct CountedPath
+    {
+        static U32  ms_copyCount;
+
+        CountedPath( const Char * str ) : m_path( str ) {}
+        CountedPath( const CountedPath& other ) : m_path( other.m_path ) { ++ms_copyCount; }
+        CountedPath& operator=( const CountedPath& other ) { m_path = other.m_path; ++ms_copyCount; return *this; }
+
+        PathString  m_path;
+    };
+
+    U32 CountedPath::ms_copyCount = 0;
+
+    // same layout as a render element, without the POD declaration
+    struct CopiedElement : public Graphic::RenderElement
+    {
+    };
+
+    SizeT GetAllocCount()
+    {
+        MemoryStats stats;
+        MemoryManager::GetStats( MEMORY_TAG_CORE, stats );
+        return stats.m_allocCount;
+    }
+
+    template< typename A >
+    void FillPaths( A& a, Bool emplace )
+    {
+        for ( U32 i=0; i<PATH_COUNT; ++i )
+        {
+            if ( emplace )
+            {
+                a.EmplaceBack( "data/textures/stone.dds" );
+            }
+            else
+            {
+                a.PushBack( CountedPath( "data/textures/stone.dds" ) );
+            }
+        }
+    }
+
+    template< typename T, typename Growth >
+    void GrowElements( const Char * name )
+    {
+        const SizeT allocCount = GetAllocCount();
+        T element;
+        MemoryUtils::MemSet( &element, 0, sizeof( T ) );
+
+        {
+            Array< T, DefaultAllocator, Growth > a;
+
+            CARBON_AUTO_TIMER( growID, name );
+            for ( U32 i=0; i<ELEMENT_COUNT; ++i )
+            {
+                element.m_textureCount = i;
+                a.PushBack( element );
+            }
+        }
+
+        UNIT_TEST_MESSAGE( "%s : %d allocations\n", name, GetAllocCount() - allocCount );
+    }
+
+    template< typename A >
+    U32 BuildLists( const Char * name )
+    {
+        const SizeT allocCount = GetAllocCount();
+        U32 sum = 0;
+
+        {
+            CARBON_AUTO_TIMER( listID, name );
+            for ( U32 i=0; i<LIST_COUNT; ++i )
+            {
+                A a;
+                for ( U32 j=0; j<LIST_SIZE; ++j )
+                {
+                    a.PushBack( i + j );
+                }
+                sum += a.Back();
+            }
+        }
+
+        UNIT_TEST_MESSAGE( "%s : %d allocations\n", name, GetAllocCount() - allocCount );
+        return sum;
+    }
+
+    // Previous hash table layout : 256 buckets of 4 preallocated entries, lookups walk
+    // a whole bucket so its cost grows with count / 256
+    class BucketTable
+    {
+    public:
+        void Insert( U32 key, U32 value )
+        {
+            Pair p = { key, value };
+            m_table[ key % 256 ].PushBack( p );
+        }
+
+        U32 * Find( U32 key )
+        {
+            PairBucket& b = m_table[ key % 256 ];
+            for ( PairBucket::Iterator it = b.Begin(); it != b.End(); ++it )
+            {
+                if ( it->m_key == key )
+                {
+                    return &it->m_value;
+                }
+            }
+            return 0;
+        }
+
+        void Remove( U32 key )
+        {
+            PairBucket& b = m_table[ key % 256 ];
+            for ( PairBucket::Iterator it = b.Begin(); it != b.End(); ++it )
+            {
+                if ( it->m_key == key )
+                {
+                    b.Remove( it );
+                    break;
+                }
+            }
+        }
+
+    private:
+        struct Pair
+        {
+            U32 m_key;
+            U32 m_value;
+        };
+
+        typedef Bucket< Pair > PairBucket;
+
+        PairBucket      m_table[ 256 ];
+    };
+
+    // distinct keys : multiplication by an odd constant is a bijection
+    U32 MakeKey( U32 i )
+    {
+        return i * 2654435761u;
+    }
+
+    template< typename Table >
+    void BenchTable( const Char * name, U32 count )
+    {
+        Char timerName[ 64 ];
+        U32 found = 0;
+
+        Table table;
+
+        StringUtils::FormatString( timerName, sizeof( timerName ), "%s insert", name );
+        {
+            CARBON_AUTO_TIMER( insertID, timerName );
+            for ( U32 i=0; i<count; ++i )
+            {
+                table.Insert( MakeKey( i ), i );
+            }
+        }
+
+        StringUtils::FormatString( timerName, sizeof( timerName ), "%s find", name );
+        {
+            CARBON_AUTO_TIMER( findID, timerName );
+            for ( U32 i=0; i<count; ++i )
+            {
+                found += ( table.Find( MakeKey( i ) ) != 0 );
+            }
+        }
+
+        StringUtils::FormatString( timerName, sizeof( timerName ), "%s miss", name );
+        {
+            CARBON_AUTO_TIMER( missID, timerName );
+            for ( U32 i=count; i<2*count; ++i )
+            {
+                found += ( table.Find( MakeKey( i ) ) != 0 );
+            }
+        }
+
+        StringUtils::FormatString( timerName, sizeof( timerName ), "%s remove", name );
+        {
+            CARBON_AUTO_TIMER( removeID, timerName );
+            for ( U32 i=0; i<count; ++i )
+            {
+                table.Remove( MakeKey( i ) );
+            }
+        }
+
+        CARBON_ASSERT( found == count );
+    }
+
+    void InitSmallSizes()
+    {
+        U32 seed = 12345;
+        for ( int i=0; i<SMALL_ALLOC_COUNT; ++i )
+        {
+            seed = seed * 1103515245 + 12345;
+            smallSizes[ i ] = 16 + ( ( seed >> 16 ) % 241 );   // 16 - 256 bytes
+        }
+    }
+
+    template< typename Alloc >
+    void SmallAllocChurn()
+    {
+        for ( int p=0; p<SMALL_ALLOC_PASS; ++p )
+        {
+            for ( int i=0; i<SMALL_ALLOC_COUNT; ++i )
+            {
+                allocs[ i ] = Alloc::Malloc( smallSizes[ i ] );
+            }
+
+            // free every other block, then reallocate it, to mix the free lists
+            for ( int i=0; i<SMALL_ALLOC_COUNT; i+=2 )
+            {
+                Alloc::Free( allocs[ i ] );
+            }
+            for ( int i=0; i<SMALL_ALLOC_COUNT; i+=2 )
+            {
+                allocs[ i ] = Alloc::Malloc( smallSizes[ SMALL_ALLOC_COUNT - i - 1 ] );
+            }
+
+            for ( int i=0; i<SMALL_ALLOC_COUNT; ++i )
+            {
+                Alloc::Free( allocs[ i ] );
+            }
+        }
+    }
+
+    // Ring buffer behind a lock, the reference for the lock free queues
+    template< typename T, SizeT C >
+    class LockedQueue
+    {
+    public:
+        LockedQueue() : m_head( 0 ), m_tail( 0 ) {}
+
+        Bool Push( const T& value )
+        {
+            ScopedLock< SpinLock > lock( m_lock );
+            if ( m_tail - m_head == C )
+            {
+                return false;
+            }
+            m_items[ m_tail++ % C ] = value;
+            return true;
+        }
+
+        Bool Pop( T& value )
+        {
+            ScopedLock< SpinLock > lock( m_lock );
+            if ( m_tail == m_head )
+            {
+                return false;
+            }
+            value = m_items[ m_head++ % C ];
+            return true;
+        }
+
+    private:
+        SpinLock    m_lock;
+        U32         m_head;
+        U32         m_tail;
+        T           m_items[ C ];
+    };
+
+    // Spins a little then gives the core away, the other side may share it
+    void Backoff( U32& spin )
+    {
+        if ( ++spin < 64 )
+        {
+            CpuPause();
+        }
+        else
+        {
+            SwitchToThread();
+            spin = 0;
+        }
+    }
+
+    // Items carry their producer in the high bits and their rank in the low ones
+    template< typename Q >
+    struct QueueStress
+    {
+        Q               m_queue;
+        U32             m_total;
+        volatile S32    m_popped;
+        volatile S32    m_errors;
+        U64             m_sums[ QUEUE_MAX_THREADS ];
+    };
+
+    template< typename Q >
+    struct QueueThread
+    {
+        QueueStress< Q > *  m_stress;
+        U32                 m_index;
+    };
+
+    template< typename Q >
+    DWORD WINAPI ProduceItems( LPVOID param )
+    {
+        const QueueThread< Q > * thread = reinterpret_cast< const QueueThread< Q > * >( param );
+        Q& queue = thread->m_stress->m_queue;
+
+        U32 spin = 0;
+        for ( U32 i=0; i<QUEUE_ITEM_COUNT; ++i )
+        {
+            const U32 item = ( thread->m_index << 24 ) | i;
+            while ( ! queue.Push( item ) )
+            {
+                Backoff( spin );
+            }
+        }
+        return 0;
+    }
+
+    template< typename Q >
+    DWORD WINAPI ConsumeItems( LPVOID param )
+    {
+        const QueueThread< Q > * thread = reinterpret_cast< const QueueThread< Q > * >( param );
+        QueueStress< Q >& stress = *thread->m_stress;
+
+        // items of a producer come out in order, even split between consumers
+        S32 last[ QUEUE_MAX_THREADS ] = { -1, -1, -1, -1 };
+        U64 sum = 0;
+
+        U32 spin = 0;
+        while ( static_cast< U32 >( AtomicLoad( &stress.m_popped ) ) < stress.m_total )
+        {
+            U32 item;
+            if ( ! stress.m_queue.Pop( item ) )
+            {
+                Backoff( spin );
+                continue;
+            }
+
+            const U32 producer  = item >> 24;
+            const S32 rank      = static_cast< S32 >( item & 0xFFFFFF );
+            if ( producer >= QUEUE_MAX_THREADS || rank <= last[ producer ] )
+            {
+                AtomicIncrement( &stress.m_errors );
+            }
+            else
+            {
+                last[ producer ] = rank;
+            }
+
+            sum += item;
+            AtomicIncrement( &stress.m_popped );
+        }
+
+        stress.m_sums[ thread->m_index ] = sum;
+        return 0;
+    }
+
+    template< typename Q >
+    void StressQueue( const Char * name, U32 producerCount, U32 consumerCount )
+    {
+        QueueStress< Q > * stress = new QueueStress< Q >;
+        stress->m_total     = producerCount * QUEUE_ITEM_COUNT;
+        stress->m_popped    = 0;
+        stress->m_errors    = 0;
+
+        QueueThread< Q > threads[ 2 * QUEUE_MAX_THREADS ];
+        HANDLE handles[ 2 * QUEUE_MAX_THREADS ];
+        const U32 threadCount = producerCount + consumerCount;
+
+        const U64 start = TimeUtils::ClockTime();
+
+        for ( U32 i=0; i<threadCount; ++i )
+        {
+            const Bool producer = i < producerCount;
+            threads[ i ].m_stress   = stress;
+            threads[ i ].m_index    = producer ? i : i - producerCount;
+            handles[ i ] = CreateThread( NULL, 0, producer ? ProduceItems< Q > : ConsumeItems< Q >, &threads[ i ], 0, NULL );
+        }
+        for ( U32 i=0; i<threadCount; ++i )
+        {
+            WaitForSingleObject( handles[ i ], INFINITE );
+            CloseHandle( handles[ i ] );
+        }
+
+        const F64 seconds = ( F64 )( TimeUtils::ClockTime() - start ) * TimeUtils::ClockPeriod();
+
+        // sum of every item : producer bits plus the ranks 0 to QUEUE_ITEM_COUNT - 1
+        U64 expected = 0;
+        for ( U32 p=0; p<producerCount; ++p )
+        {
+            expected += ( U64 )p * ( 1 << 24 ) * QUEUE_ITEM_COUNT + ( U64 )QUEUE_ITEM_COUNT * ( QUEUE_ITEM_COUNT - 1 ) / 2;
+        }
+        U64 sum = 0;
+        for ( U32 c=0; c<consumerCount; ++c )
+        {
+            sum += stress->m_sums[ c ];
+        }
+
+        UNIT_TEST_MESSAGE( "%s %d -> %d : %0.2f M/s, erreurs : %d, somme : %s\n", name, producerCount, consumerCount, stress->m_total / seconds * 1e-6, stress->m_errors, ( sum == expected ) ? "ok" : "erreur" );
+
+        delete stress;
+    }
+
+    struct PingPong
+    {
+        SpscQueue< U32, QUEUE_CAPACITY >    m_ping;
+        SpscQueue< U32, QUEUE_CAPACITY >    m_pong;
+    };
+
+    DWORD WINAPI ReturnPings( LPVOID param )
+    {
+        PingPong * pp = reinterpret_cast< PingPong * >( param );
+
+        U32 spin = 0;
+        for ( U32 i=0; i<QUEUE_PING_COUNT; ++i )
+        {
+            U32 value;
+            while ( ! pp->m_ping.Pop( value ) )
+            {
+                Backoff( spin );
+            }
+            while ( ! pp->m_pong.Push( value ) )
+            {
+                Backoff( spin );
+            }
+        }
+        return 0;
+    }
+
+    class CountedObject : public RefCounted
+    {
+    public:
+        static volatile S32 ms_deleteCount;
+
+    protected:
+        void SelfDelete()
+        {
+            AtomicIncrement( &ms_deleteCount );
+        }
+    };
+
+    volatile S32 CountedObject::ms_deleteCount = 0;
+
+    // Copies and moves of a shared reference, from every thread of the job system
+    void ShareReferences( SizeT begin, SizeT end, void * data )
+    {
+        SharedPtr< CountedObject >& shared = *reinterpret_cast< SharedPtr< CountedObject > * >( data );
+
+        for ( SizeT i=begin; i<end; ++i )
+        {
+            SharedPtr< CountedObject > copy( shared );
+            SharedPtr< CountedObject > moved( Move( copy ) );
+            copy = moved;
+        }
+    }
+
+    void StoreThreadIndex( void * data )
+    {
+        *reinterpret_cast< SizeT * >( data ) = Thread::GetCurrentIndex();
+    }
+
+    // File : word count, checksum, words. Decode sums the words on a worker, Load only
+    // compares the sums like a device upload would only copy.
+    class TestResource : public Resource
+    {
+        CARBON_DECLARE_RESOURCE_POOL( TestResource );
+
+    public:
+        TestResource()
+            : m_sum( 0 )
+        {
+        }
+
+    protected:
+        bool Decode( const void * data )
+        {
+            const U32 * words = reinterpret_cast< const U32 * >( data );
+            const U32 count = words[0];
+
+            U32 sum = 0;
+            for ( U32 i=0; i<count; ++i )
+            {
+                sum = sum * 31 + words[ 2 + i ];
+            }
+            m_sum = sum;
+
+            return true;
+        }
+
+        bool Load( const void * data )
+        {
+            return m_sum == reinterpret_cast< const U32 * >( data )[1];
+        }
+
+        void Unload()
+        {
+        }
+
+    private:
+        U32 m_sum;
+    };
+
+    CARBON_DEFINE_RESOURCE_POOL( TestResource );
+
+    void SaveTestResource( const Char * name, U32 seed, U32 wordCount )
+    {
+        Array< U32 > words;
+        words.Resize( wordCount + 2 );
+
+        U32 sum = 0;
+        for ( U32 i=0; i<wordCount; ++i )
+        {
+            seed = seed * 1664525 + 1013904223;
+            words[ 2 + i ] = seed;
+            sum = sum * 31 + seed;
+        }
+        words[0] = wordCount;
+        words[1] = sum;
+
+        PathString path;
+        FileSystem::BuildPathName( name, path, FileSystem::PT_CACHE );
+        FileSystem::Save( path, words.ConstPtr(), words.Size() * sizeof(U32) );
+    }
+
+    struct TestPackFile
+    {
+        const Char *    m_name;         // relative to the cache directory
+        U32             m_size;
+        U32             m_seed;         // tells the copies of a file apart
+    };
+
+    inline U8 GetTestByte( const TestPackFile& file, SizeT i )
+    {
+        return static_cast< U8 >( file.m_seed * 31 + i * 7 );
+    }
+
+    Bool CheckTestBytes( const TestPackFile& file, const void * data, SizeT size )
+    {
+        if ( size != file.m_size )
+        {
+            return false;
+        }
+
+        const U8 * bytes = static_cast< const U8 * >( data );
+        for ( SizeT i=0; i<size; ++i )
+        {
+            if ( bytes[ i ] != GetTestByte( file, i ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void SaveTestFile( const TestPackFile& file )
+    {
+        Array< U8 > bytes;
+        bytes.Resize( file.m_size );
+        for ( SizeT i=0; i<bytes.Size(); ++i )
+        {
+            bytes[ i ] = GetTestByte( file, i );
+        }
+
+        PathString path;
+        FileSystem::BuildPathName( file.m_name, path, FileSystem::PT_CACHE );
+        FileSystem::Save( path, bytes.ConstPtr(), bytes.Size() );
+    }
+
+    // Same layout as the PackCompiler tool writes, without compression
+    void SaveTestPack( const Char * packName, const TestPackFile * files, U32 fileCount )
+    {
+        const U32 slotCount = 16;
+        CARBON_ASSERT( 2 * fileCount <= slotCount );
+
+        PackHeader header;
+        header.m_magic      = PackHeader::ms_magic;
+        header.m_version    = PackHeader::ms_version;
+        header.m_fileCount  = fileCount;
+        header.m_slotCount  = slotCount;
+
+        PackEntry entries[ slotCount ];
+        MemoryUtils::MemSet( entries, 0, sizeof(entries) );
+
+        Array< U8 > pack;
+        pack.Resize( sizeof(header) + sizeof(entries), 0 );
+
+        for ( U32 i=0; i<fileCount; ++i )
+        {
+            const U32 id = HashString( files[ i ].m_name );
+
+            U32 slot = id & ( slotCount - 1 );
+            while ( entries[ slot ].m_offset )
+            {
+                slot = ( slot + 1 ) & ( slotCount - 1 );
+            }
+
+            entries[ slot ].m_id        = id;
+            entries[ slot ].m_size      = files[ i ].m_size;
+            entries[ slot ].m_offset    = pack.Size();
+
+            for ( SizeT b=0; b<files[ i ].m_size; ++b )
+            {
+                pack.PushBack( GetTestByte( files[ i ], b ) );
+            }
+            pack.Resize( MemoryUtils::GetNextAlignedAddress( pack.Size(), PackHeader::ms_alignment ), 0 );
+        }
+
+        MemoryUtils::MemCpy( pack.Ptr(), &header, sizeof(header) );
+        MemoryUtils::MemCpy( pack.Ptr() + sizeof(header), entries, sizeof(entries) );
+
+        PathString path;
+        FileSystem::BuildPathName( packName, path );
+        FileSystem::Save( path, pack.ConstPtr(), pack.Size() );
+    }
+
+    void StoreReadResult( FileRead& read, Bool success )
+    {
+        *reinterpret_cast< Bool * >( read.m_userData ) = success;
+    }
 }
 
 using namespace Level1_NS;
@@ -48,6 +730,378 @@ void Test_MemoryManager()
             allocs[ i ] = FrameAllocator::Allocate( sizeof( ALLOC_TYPE ) );
         }
     }
+
+    {
+        CARBON_AUTO_TIMER( allocID, "Frame allocator ( overflow pages )" );
+
+        for ( int i=0; i<ALLOC_COUNT; ++i )
+        {
+            allocs[ i ] = FrameAllocator::Allocate( sizeof( ALLOC_TYPE ) );
+        }
+    }
+
+    MemoryManager::FrameUpdate();
+
+    UNIT_TEST_MESSAGE( "Frame high water mark : %d bytes\n\n", MemoryManager::GetFrameHighWaterMark() );
+
+    MemoryManager::DumpStats();
+}
+
+void Test_SmallObjectAllocator()
+{
+    UNIT_TEST_MESSAGE( "\n* Small Object Allocator Benchmark\n\n" );
+    UNIT_TEST_MESSAGE( "Alloc count : %d x %d passes | Alloc block size : 16 - 256\n", SMALL_ALLOC_COUNT, SMALL_ALLOC_PASS );
+
+    InitSmallSizes();
+
+    {
+        CARBON_AUTO_TIMER( allocID, "Native allocator" );
+        SmallAllocChurn< NativeAllocator >();
+    }
+
+    {
+        CARBON_AUTO_TIMER( allocID, "MemoryManager ( size classes )" );
+        SmallAllocChurn< MemoryManager >();
+    }
+}
+
+void Test_StackAllocator()
+{
+    UNIT_TEST_MESSAGE( "\n* Stack Allocator Markers\n\n" );
+
+    U8 buffer[ 1024 ];
+
+    StackAllocator stack;
+    stack.Initialize( buffer, sizeof( buffer ) );
+
+    stack.Allocate( 100 );
+    {
+        StackScope< StackAllocator > scope( stack );
+        stack.Allocate( 200, 16 );
+        {
+            StackScope< StackAllocator > nested( stack );
+            stack.Allocate( 300 );
+        }
+        UNIT_TEST_MESSAGE( "Nested scope released, used : %d bytes\n", stack.GetUsedBytes() );
+    }
+    UNIT_TEST_MESSAGE( "Outer scope released, used : %d bytes | high water mark : %d bytes\n", stack.GetUsedBytes(), stack.GetHighWaterMark() );
+
+    stack.Destroy();
+
+    DoubleEndedStackAllocator deStack;
+    deStack.Initialize( buffer, sizeof( buffer ) );
+
+    deStack.AllocateBottom( 256 );                                      // persistent
+    DoubleEndedStackAllocator::Marker top = deStack.GetTopMarker();
+    deStack.AllocateTop( 512, 16 );                                     // load time
+    UNIT_TEST_MESSAGE( "Double ended, free : %d bytes", deStack.GetFreeBytes() );
+    deStack.RewindTop( top );
+    UNIT_TEST_MESSAGE( " -> %d bytes after the load\n", deStack.GetFreeBytes() );
+
+    deStack.Destroy();
+
+    // Several subsystems using frame scratch memory one after the other
+    MemoryManager::FrameUpdate();
+    for ( int i=0; i<SCRATCH_PASS; ++i )
+    {
+        FrameAllocator::Allocate( SCRATCH_SIZE );
+    }
+    MemoryManager::FrameUpdate();
+    UNIT_TEST_MESSAGE( "Frame scratch without scope, high water mark : %d bytes\n", MemoryManager::GetFrameHighWaterMark() );
+
+    for ( int i=0; i<SCRATCH_PASS; ++i )
+    {
+        FrameScope scope;
+        FrameAllocator::Allocate( SCRATCH_SIZE );
+    }
+    MemoryManager::FrameUpdate();
+    UNIT_TEST_MESSAGE( "Frame scratch with scope, high water mark : %d bytes\n", MemoryManager::GetFrameHighWaterMark() );
+
+    // An overflow released by its scope still grows the first page on Reset
+    LinearArena arena;
+    arena.Initialize( sizeof( buffer ) );
+    for ( int frame=0; frame<2; ++frame )
+    {
+        {
+            StackScope< LinearArena > scope( arena );
+            LinearArena::Marker before = arena.GetMarker();
+            arena.Allocate( 4 * sizeof( buffer ) );
+
+            const Bool newPage = ( arena.GetMarker().m_page != before.m_page );
+            UNIT_TEST_MESSAGE( "Frame %d, debordement dans un scope : %s\n", frame, newPage ? "nouvelle page" : "premiere page" );
+
+            CARBON_ASSERT( frame == 0 || ! newPage );
+        }
+        arena.Reset();
+    }
+    arena.Destroy();
+}
+
+void Test_Pool()
+{
+    UNIT_TEST_MESSAGE( "\n* Pool Benchmark\n\n" );
+    UNIT_TEST_MESSAGE( "Object count : %d | Object size : %d\n", POOL_OBJECT_COUNT, sizeof( PoolObject ) );
+
+    PoolObject ** objects = reinterpret_cast< PoolObject ** >( allocs );
+
+    {
+        CARBON_AUTO_TIMER( allocID, "Default allocator ( create / destroy )" );
+
+        for ( int i=0; i<POOL_OBJECT_COUNT; ++i )
+        {
+            objects[ i ] = static_cast< PoolObject * >( DefaultAllocator::Allocate( sizeof( PoolObject ), MemoryUtils::AlignOf< PoolObject >() ) );
+            objects[ i ]->m_id = i;
+        }
+        for ( int i=0; i<POOL_OBJECT_COUNT; ++i )
+        {
+            DefaultAllocator::Deallocate( objects[ i ] );
+        }
+    }
+
+    Pool< PoolObject > pool;
+
+    for ( int p=0; p<2; ++p )
+    {
+        // the second pass reuses the pages of the first one
+        CARBON_AUTO_TIMER( allocID, p ? "Pool ( create / destroy, warm )" : "Pool ( create / destroy )" );
+
+        for ( int i=0; i<POOL_OBJECT_COUNT; ++i )
+        {
+            objects[ i ] = pool.Create();
+            objects[ i ]->m_id = i;
+        }
+        for ( int i=0; i<POOL_OBJECT_COUNT; ++i )
+        {
+            pool.Destroy( objects[ i ] );
+        }
+    }
+
+    for ( int i=0; i<POOL_OBJECT_COUNT; ++i )
+    {
+        objects[ i ] = pool.Create();
+        objects[ i ]->m_id = i;
+    }
+    for ( int i=0; i<POOL_OBJECT_COUNT; i+=3 )
+    {
+        pool.Destroy( objects[ i ] );
+    }
+
+    U32 sum = 0;
+    {
+        CARBON_AUTO_TIMER( allocID, "Pool ( iterate live objects )" );
+
+        Pool< PoolObject >::Iterator it = pool.Begin();
+        Pool< PoolObject >::Iterator end = pool.End();
+        for ( ; it != end; ++it )
+        {
+            sum += it->m_id;
+        }
+    }
+
+    UNIT_TEST_MESSAGE( "Live objects : %d / %d | id sum : %u\n", pool.Count(), pool.Capacity(), sum );
+
+    for ( int i=0; i<POOL_OBJECT_COUNT; ++i )
+    {
+        if ( i % 3 )
+        {
+            pool.Destroy( objects[ i ] );
+        }
+    }
+}
+
+void Test_VirtualMemory()
+{
+    UNIT_TEST_MESSAGE( "\n* Virtual Memory Benchmark\n\n" );
+    UNIT_TEST_MESSAGE( "Page size : %d | Allocation granularity : %d | Large page size : %d\n"
+                     , VirtualMemory::GetPageSize(), VirtualMemory::GetAllocationGranularity(), VirtualMemory::GetLargePageSize() );
+    UNIT_TEST_MESSAGE( "Push back count : %d\n", GROW_COUNT );
+
+    {
+        Array< U32 > a;
+
+        CARBON_AUTO_TIMER( allocID, "Array ( default allocator )" );
+        for ( U32 i=0; i<GROW_COUNT; ++i )
+        {
+            a.PushBack( i );
+        }
+    }
+
+    {
+        Array< U32, VirtualAllocator< GROW_RESERVE > > a;
+        a.PushBack( 0 );
+        const U32 * first = a.ConstPtr();
+
+        {
+            CARBON_AUTO_TIMER( allocID, "Array ( virtual allocator )" );
+            for ( U32 i=1; i<GROW_COUNT; ++i )
+            {
+                a.PushBack( i );
+            }
+        }
+
+        UNIT_TEST_MESSAGE( "Virtual allocator array kept its address : %s\n", ( first == a.ConstPtr() ) ? "yes" : "no" );
+    }
+
+    VirtualArena arena;
+    arena.Initialize( GROW_RESERVE, true );
+
+    for ( U32 i=0; i<1024; ++i )
+    {
+        arena.Allocate( 1000, 16 );
+    }
+
+    UNIT_TEST_MESSAGE( "Virtual arena ( %s pages ) : used %d | committed %d | reserved %d bytes\n"
+                     , arena.UsesLargePages() ? "large" : "regular"
+                     , arena.GetUsedBytes(), arena.GetCommittedBytes(), arena.GetReservedBytes() );
+
+    arena.Destroy();
+}
+
+void Test_ArrayGrowth()
+{
+    UNIT_TEST_MESSAGE( "\n* Array Growth Benchmark\n\n" );
+
+    {
+        UNIT_TEST_MESSAGE( "Array< PathString >, %d paths\n", PATH_COUNT );
+
+        SizeT allocCount = GetAllocCount();
+        CountedPath::ms_copyCount = 0;
+        {
+            Array< CountedPath > a;
+            FillPaths( a, false );
+        }
+        UNIT_TEST_MESSAGE( "PushBack                  : %d copies, %d allocations\n", CountedPath::ms_copyCount, GetAllocCount() - allocCount );
+
+        allocCount = GetAllocCount();
+        CountedPath::ms_copyCount = 0;
+        {
+            Array< CountedPath > a;
+            FillPaths( a, true );
+        }
+        UNIT_TEST_MESSAGE( "EmplaceBack               : %d copies, %d allocations\n", CountedPath::ms_copyCount, GetAllocCount() - allocCount );
+
+        allocCount = GetAllocCount();
+        CountedPath::ms_copyCount = 0;
+        {
+            Array< CountedPath > a;
+            a.Reserve( PATH_COUNT );
+            FillPaths( a, true );
+        }
+        UNIT_TEST_MESSAGE( "Reserve + EmplaceBack     : %d copies, %d allocations\n", CountedPath::ms_copyCount, GetAllocCount() - allocCount );
+
+        Array< CountedPath > a;
+        a.Reserve( PATH_COUNT );
+        FillPaths( a, true );
+
+        allocCount = GetAllocCount();
+        CountedPath::ms_copyCount = 0;
+        Array< CountedPath > b( Move( a ) );
+        Array< CountedPath > c;
+        c = Move( b );
+        UNIT_TEST_MESSAGE( "Move construct and assign : %d copies, %d allocations\n", CountedPath::ms_copyCount, GetAllocCount() - allocCount );
+
+        CountedPath::ms_copyCount = 0;
+        c.Erase( c.Begin() );
+        c.Insert( c.Begin(), c.Back() );
+        UNIT_TEST_MESSAGE( "Erase and Insert at front : %d copies\n", CountedPath::ms_copyCount );
+    }
+
+    {
+        UNIT_TEST_MESSAGE( "\nArray< RenderElement >, %d elements of %d bytes\n", ELEMENT_COUNT, sizeof( Graphic::RenderElement ) );
+
+        GrowElements< CopiedElement, DoubleGrowth >( "Copy construct x2" );
+        GrowElements< Graphic::RenderElement, DoubleGrowth >( "Reallocate x2" );
+        GrowElements< Graphic::RenderElement, HalfGrowth >( "Reallocate x1.5" );
+    }
+}
+
+void Test_SmallArray()
+{
+    UNIT_TEST_MESSAGE( "\n* Small Array Test\n\n" );
+
+    SmallArray< U32, 4 > a;
+    UNIT_TEST_MESSAGE( "capacite de a : %d; inline : %s\n", a.Capacity(), a.IsInline() ? "oui" : "non" );
+
+    for ( U32 i=0; i<4; ++i )
+    {
+        a.PushBack( i );
+    }
+    UNIT_TEST_MESSAGE( "4 push back sur a, taille : %d; inline : %s\n", a.Size(), a.IsInline() ? "oui" : "non" );
+
+    a.PushBack( 4 );
+    UNIT_TEST_MESSAGE( "push back 4 sur a, taille : %d; capacite : %d; inline : %s\n", a.Size(), a.Capacity(), a.IsInline() ? "oui" : "non" );
+
+    a.Reserve( 0 );
+    UNIT_TEST_MESSAGE( "a.Reserve( 0 ), taille : %d; inline : %s\n", a.Size(), a.IsInline() ? "oui" : "non" );
+
+    UNIT_TEST_MESSAGE( "\n%d lists of %d elements\n", LIST_COUNT, LIST_SIZE );
+
+    const U32 sum0 = BuildLists< Array< U32 > >( "Array" );
+    const U32 sum1 = BuildLists< SmallArray< U32, 4 > >( "SmallArray" );
+
+    CARBON_ASSERT( sum0 == sum1 );
+}
+
+void Test_HashTable()
+{
+    UNIT_TEST_MESSAGE( "\n* Hash Table Benchmark\n" );
+
+    for ( U32 count=HASH_MIN_COUNT; count<=HASH_MAX_COUNT; count*=10 )
+    {
+        UNIT_TEST_MESSAGE( "\n%d keys\n", count );
+
+        if ( count <= BUCKET_MAX_COUNT )
+        {
+            BenchTable< BucketTable >( "Bucket table", count );
+        }
+        BenchTable< HashTable< U32 > >( "Robin Hood table", count );
+    }
+}
+
+void Test_HashedString()
+{
+    UNIT_TEST_MESSAGE( "\n* Hashed String Test\n\n" );
+
+    const U32 literal = HashedString( "level3" );
+    const U32 dynamic = HashString( "level3" );
+    UNIT_TEST_MESSAGE( "hash de \"level3\" : 0x%08x; runtime : 0x%08x\n", literal, dynamic );
+    UNIT_TEST_MESSAGE( "chaine de 0x%08x : %s\n", literal, HashedString::GetString( literal ) );
+
+    CARBON_ASSERT( literal == dynamic );
+    CARBON_ASSERT( HashedString( "" ) == HashString( "" ) );
+
+    Char buffer[ 32 ];
+    StringUtils::StrCpy( buffer, sizeof( buffer ), "level3" );
+    UNIT_TEST_MESSAGE( "hash du buffer \"%s\" : 0x%08x\n", buffer, (U32)HashedString( buffer ) );
+
+    CARBON_ASSERT( HashedString( buffer ) == dynamic );
+
+    const Char padded[ 32 ] = "level3";
+    UNIT_TEST_MESSAGE( "hash du tableau constant \"%s\" : 0x%08x\n", padded, (U32)HashedString( padded ) );
+
+    CARBON_ASSERT( HashedString( padded ) == dynamic );
+
+    UNIT_TEST_MESSAGE( "\n%d hashes\n", HASHED_STRING_PASS );
+
+    const Char * name = "sphere";
+    U32 sum0 = 0;
+    U32 sum1 = 0;
+    {
+        CARBON_AUTO_TIMER( literalID, "Literal" );
+        for ( U32 i=0; i<HASHED_STRING_PASS; ++i )
+        {
+            sum0 += HashedString( "sphere" );
+        }
+    }
+    {
+        CARBON_AUTO_TIMER( runtimeID, "Runtime" );
+        for ( U32 i=0; i<HASHED_STRING_PASS; ++i )
+        {
+            sum1 += HashString( name );
+        }
+    }
+
+    CARBON_ASSERT( sum0 == sum1 );
 }
 
 void Test_Array()
@@ -117,6 +1171,334 @@ void Test_Array()
     UNIT_TEST_MESSAGE( "clear de a, taille : %d\n", a.Size() );
 }
 
+void Test_ConcurrentQueues()
+{
+    UNIT_TEST_MESSAGE( "\n* Concurrent Queues Benchmark\n" );
+    UNIT_TEST_MESSAGE( "\n%d elements par producteur, capacite %d\n\n", QUEUE_ITEM_COUNT, QUEUE_CAPACITY );
+
+    StressQueue< LockedQueue< U32, QUEUE_CAPACITY > >( "LockedQueue", 1, 1 );
+    StressQueue< SpscQueue< U32, QUEUE_CAPACITY > >( "SpscQueue", 1, 1 );
+    UNIT_TEST_MESSAGE( "\n" );
+
+    StressQueue< LockedQueue< U32, QUEUE_CAPACITY > >( "LockedQueue", 3, 1 );
+    StressQueue< MpscQueue< U32, QUEUE_CAPACITY > >( "MpscQueue", 3, 1 );
+    StressQueue< MpmcQueue< U32, QUEUE_CAPACITY > >( "MpmcQueue", 3, 1 );
+    UNIT_TEST_MESSAGE( "\n" );
+
+    StressQueue< LockedQueue< U32, QUEUE_CAPACITY > >( "LockedQueue", 2, 2 );
+    StressQueue< MpmcQueue< U32, QUEUE_CAPACITY > >( "MpmcQueue", 2, 2 );
+    StressQueue< LockedQueue< U32, QUEUE_CAPACITY > >( "LockedQueue", 4, 4 );
+    StressQueue< MpmcQueue< U32, QUEUE_CAPACITY > >( "MpmcQueue", 4, 4 );
+
+    // Round trips between two threads
+    PingPong * pp = new PingPong;
+    HANDLE thread = CreateThread( NULL, 0, ReturnPings, pp, 0, NULL );
+
+    const U64 start = TimeUtils::ClockTime();
+
+    U32 spin = 0;
+    U32 errors = 0;
+    for ( U32 i=0; i<QUEUE_PING_COUNT; ++i )
+    {
+        pp->m_ping.Push( i );
+
+        U32 value;
+        while ( ! pp->m_pong.Pop( value ) )
+        {
+            Backoff( spin );
+        }
+        errors += ( value != i ) ? 1 : 0;
+    }
+
+    const F64 seconds = ( F64 )( TimeUtils::ClockTime() - start ) * TimeUtils::ClockPeriod();
+
+    WaitForSingleObject( thread, INFINITE );
+    CloseHandle( thread );
+    delete pp;
+
+    UNIT_TEST_MESSAGE( "\nSpscQueue aller-retour : %0.0f ns, erreurs : %d\n", seconds * 1e9 / QUEUE_PING_COUNT, errors );
+}
+
+void Test_SharedPtr()
+{
+    UNIT_TEST_MESSAGE( "\n* Shared Pointer Test\n\n" );
+
+    JobSystem::Initialize( JobSystem::GetHardwareThreadCount() - 1 );
+
+    CountedObject object;
+    {
+        SharedPtr< CountedObject > shared( &object );
+
+        {
+            CARBON_AUTO_TIMER( shareID, "Shared references" );
+            JobSystem::ParallelFor( REFERENCE_COUNT, 0, ShareReferences, &shared );
+        }
+
+        UNIT_TEST_MESSAGE( "%d threads, references : %d, destructions : %d\n", JobSystem::GetWorkerCount() + 1, object.GetRefCount(), CountedObject::ms_deleteCount );
+    }
+    UNIT_TEST_MESSAGE( "apres release, references : %d, destructions : %d\n", object.GetRefCount(), CountedObject::ms_deleteCount );
+
+    CARBON_ASSERT( CountedObject::ms_deleteCount == 1 );
+
+    JobSystem::Destroy();
+
+    // the indices of the ended threads are given to the next ones
+    SizeT maxIndex = 0;
+    for ( SizeT i=0; i<2*Thread::ms_maxThreadCount; ++i )
+    {
+        SizeT index;
+        Thread::Join( Thread::Start( StoreThreadIndex, &index ) );
+        maxIndex = ( index > maxIndex ) ? index : maxIndex;
+    }
+    UNIT_TEST_MESSAGE( "%d threads demarres, plus grand index : %d\n", 2 * Thread::ms_maxThreadCount, maxIndex );
+
+    CARBON_ASSERT( maxIndex < Thread::ms_maxThreadCount );
+}
+
+void Test_Pack()
+{
+    UNIT_TEST_MESSAGE( "\n* Pack Test\n\n" );
+
+    FileSystem::Initialize( "../../.." );
+
+    // the files of the second pack are found first
+    const TestPackFile firstFiles[] =
+    {
+        { "pack_test/large.bin",    70000,  1 },
+        { "pack_test/shared.bin",   100,    2 },
+        { "pack_test_saved.bin",    40,     3 },
+        { "pack_test/far.bin",      30,     7 },       // past the allocation granularity
+        { "pack_test/empty.bin",    0,      8 },
+    };
+    const TestPackFile secondFiles[] =
+    {
+        { "pack_test/shared.bin",   60,     4 },
+        { "pack_test/small.bin",    50,     5 },
+    };
+    const TestPackFile savedFile = { "pack_test_saved.bin", 10, 6 };
+    const TestPackFile emptyFile = { "pack_test_empty.bin", 0, 9 };
+
+    SaveTestPack( "pack_test_1.pak", firstFiles, 5 );
+    SaveTestPack( "pack_test_2.pak", secondFiles, 2 );
+
+    PathString firstPack, secondPack;
+    FileSystem::BuildPathName( "pack_test_1.pak", firstPack );
+    FileSystem::BuildPathName( "pack_test_2.pak", secondPack );
+
+    Bool mounted = FileSystem::Mount( firstPack ) && FileSystem::Mount( secondPack );
+    CARBON_ASSERT( mounted );
+
+    // separators folded as the pack compiler writes them
+    PathString large, shared, small, missing, saved, far, empty, emptyLoose;
+    FileSystem::BuildPathName( "pack_test\\large.bin", large, FileSystem::PT_CACHE );
+    FileSystem::BuildPathName( "pack_test//shared.bin", shared, FileSystem::PT_CACHE );
+    FileSystem::BuildPathName( "pack_test/small.bin", small, FileSystem::PT_CACHE );
+    FileSystem::BuildPathName( "pack_test/missing.bin", missing, FileSystem::PT_CACHE );
+    FileSystem::BuildPathName( savedFile.m_name, saved, FileSystem::PT_CACHE );
+    FileSystem::BuildPathName( "pack_test/far.bin", far, FileSystem::PT_CACHE );
+    FileSystem::BuildPathName( "pack_test/empty.bin", empty, FileSystem::PT_CACHE );
+    FileSystem::BuildPathName( emptyFile.m_name, emptyLoose, FileSystem::PT_CACHE );
+
+    Bool exists = FileSystem::Exists( large ) && FileSystem::Exists( shared ) && FileSystem::Exists( small ) && ! FileSystem::Exists( missing );
+    UNIT_TEST_MESSAGE( "Exists : %s\n", exists ? "ok" : "erreur" );
+    CARBON_ASSERT( exists );
+
+    Bool writeTimes = ( FileSystem::GetLastWriteTime( large ) == FileSystem::GetLooseWriteTime( firstPack ) ) &&
+                      ( FileSystem::GetLastWriteTime( shared ) == FileSystem::GetLooseWriteTime( secondPack ) );
+    UNIT_TEST_MESSAGE( "GetLastWriteTime : %s\n", writeTimes ? "ok" : "erreur" );
+    CARBON_ASSERT( writeTimes );
+
+    void * buffer = 0;
+    SizeT size = 0;
+    Bool loaded = FileSystem::Load( large, buffer, size ) && CheckTestBytes( firstFiles[0], buffer, size );
+    UnknownAllocator::Deallocate( buffer );
+    buffer = 0;
+    loaded = loaded && FileSystem::Load( shared, buffer, size ) && CheckTestBytes( secondFiles[0], buffer, size );
+    UnknownAllocator::Deallocate( buffer );
+    UNIT_TEST_MESSAGE( "Load : %s\n", loaded ? "ok" : "erreur" );
+    CARBON_ASSERT( loaded );
+
+    FileView view;
+    Bool mapped = FileSystem::Map( small, view ) && CheckTestBytes( secondFiles[1], view.m_data, view.m_size );
+    FileSystem::Unmap( view );
+    UNIT_TEST_MESSAGE( "Map : %s\n", mapped ? "ok" : "erreur" );
+    CARBON_ASSERT( mapped );
+
+    // the views of packed files start below their data, on the allocation granularity
+    Bool mappedRanges = FileSystem::Map( large, view ) && CheckTestBytes( firstFiles[0], view.m_data, view.m_size ) && ( view.m_data != view.m_base );
+    FileSystem::Unmap( view );
+    mappedRanges = mappedRanges && FileSystem::Map( far, view ) && CheckTestBytes( firstFiles[3], view.m_data, view.m_size ) && ( view.m_data != view.m_base );
+    FileSystem::Unmap( view );
+    UNIT_TEST_MESSAGE( "Map a un offset non aligne : %s\n", mappedRanges ? "ok" : "erreur" );
+    CARBON_ASSERT( mappedRanges );
+
+    SaveTestFile( emptyFile );
+    Bool emptyViews = FileSystem::Map( empty, view ) && ! view.m_data && ! view.m_size && ! view.m_base;
+    emptyViews = emptyViews && FileSystem::Map( emptyLoose, view ) && ! view.m_data && ! view.m_size && ! view.m_base;
+    UNIT_TEST_MESSAGE( "Map de fichiers vides : %s\n", emptyViews ? "ok" : "erreur" );
+    CARBON_ASSERT( emptyViews );
+
+    Array< U8 > readBuffer;
+    Bool readSuccess = false;
+    FileRead read;
+    Bool opened = FileSystem::Open( shared, read ) && ( read.m_file == 0 ) && ( read.m_size == secondFiles[0].m_size );
+    if ( opened )
+    {
+        readBuffer.Resize( read.m_size );
+        read.m_buffer   = readBuffer.Ptr();
+        read.m_userData = &readSuccess;
+        FileSystem::ReadBatch( &read, 1, StoreReadResult );
+    }
+    Bool batched = opened && readSuccess && CheckTestBytes( secondFiles[0], readBuffer.ConstPtr(), readBuffer.Size() );
+    UNIT_TEST_MESSAGE( "Open, ReadBatch : %s\n", batched ? "ok" : "erreur" );
+    CARBON_ASSERT( batched );
+
+    // saved after the mount, the loose file is used from now on
+    SaveTestFile( savedFile );
+    buffer = 0;
+    Bool overridden = FileSystem::Load( saved, buffer, size ) && CheckTestBytes( savedFile, buffer, size ) &&
+                      ( FileSystem::GetLastWriteTime( saved ) == FileSystem::GetLooseWriteTime( saved ) );
+    UnknownAllocator::Deallocate( buffer );
+    UNIT_TEST_MESSAGE( "Fichier sauve apres le montage : %s\n", overridden ? "ok" : "erreur" );
+    CARBON_ASSERT( overridden );
+
+    Bool mappedLoose = FileSystem::Map( saved, view ) && CheckTestBytes( savedFile, view.m_data, view.m_size );
+    FileSystem::Unmap( view );
+    UNIT_TEST_MESSAGE( "Map d'un fichier libre : %s\n", mappedLoose ? "ok" : "erreur" );
+    CARBON_ASSERT( mappedLoose );
+
+    FileSystem::Delete( saved );
+    FileSystem::Delete( emptyLoose );
+    FileSystem::Destroy();
+
+    FileSystem::Delete( firstPack );
+    FileSystem::Delete( secondPack );
+}
+
+void Test_ResourceLoading()
+{
+    UNIT_TEST_MESSAGE( "\n* Resource Loading Test\n\n" );
+
+    FileSystem::Initialize( "../../.." );
+    JobSystem::Initialize( JobSystem::GetHardwareThreadCount() - 1 );
+    ResourceManager::Initialize();
+    ResourceManager::SetFrameBudget( FINALIZE_BUDGET_MS, 0 );
+
+    Char name[64];
+    for ( U32 i=0; i<RESOURCE_COUNT; ++i )
+    {
+        StringUtils::FormatString( name, sizeof(name), "loading_test_%d.bin", i );
+        // sizes on both sides of the mapping threshold : the odd files are mapped, the
+        // even ones read in batches
+        SaveTestResource( name, i, ( i & 1 ) ? RESOURCE_WORD_COUNT : RESOURCE_WORD_COUNT / 16 );
+    }
+
+    SharedPtr< TestResource > resources[ RESOURCE_COUNT ];
+    for ( U32 i=0; i<RESOURCE_COUNT; ++i )
+    {
+        StringUtils::FormatString( name, sizeof(name), "loading_test_%d.bin", i );
+
+        ResourceManager::LoadPriority priority = ( i < RESOURCE_COUNT / 2 ) ? ResourceManager::LP_BACKGROUND : ResourceManager::LP_VISIBLE;
+        if ( i % 64 == 0 )
+        {
+            priority = ResourceManager::LP_BLOCKING;
+        }
+
+        resources[i] = ResourceManager::Create< TestResource >( name, priority );
+    }
+
+    // The main loop keeps ticking while the resources load
+    const F64 period = TimeUtils::ClockPeriod() * 1000.0;
+
+    SizeT frameCount = 0;
+    SizeT spikeCount = 0;
+    F64 totalTime = 0.0;
+    F64 maxTime = 0.0;
+
+    SizeT doneFrames[ ResourceManager::LP_COUNT ] = { 0 };
+    SizeT raisedReadyCount = 0;
+
+    do
+    {
+        const U64 start = TimeUtils::ClockTime();
+
+        ResourceManager::Update();
+        MemoryManager::FrameUpdate();
+
+        const F64 frameTime = ( TimeUtils::ClockTime() - start ) * period;
+
+        // Some background resources become blocking while they wait or load
+        if ( frameCount == 0 )
+        {
+            for ( U32 i=32; i<RESOURCE_COUNT / 2; i+=64 )
+            {
+                StringUtils::FormatString( name, sizeof(name), "loading_test_%d.bin", i );
+                ResourceManager::Create< TestResource >( name, ResourceManager::LP_BLOCKING );
+            }
+        }
+
+        totalTime += frameTime;
+        maxTime = ( frameTime > maxTime ) ? frameTime : maxTime;
+        spikeCount += ( frameTime > FRAME_BUDGET_MS ) ? 1 : 0;
+        ++frameCount;
+
+        for ( SizeT p=0; p<ResourceManager::LP_COUNT; ++p )
+        {
+            ResourceManager::QueueStats stats;
+            ResourceManager::GetQueueStats( static_cast< ResourceManager::LoadPriority >( p ), stats );
+
+            if ( doneFrames[p] == 0 && stats.m_waitingCount + stats.m_loadingCount + stats.m_readyCount == 0 )
+            {
+                doneFrames[p] = frameCount;
+            }
+        }
+
+        if ( doneFrames[ ResourceManager::LP_BLOCKING ] == frameCount )
+        {
+            for ( U32 i=32; i<RESOURCE_COUNT / 2; i+=64 )
+            {
+                raisedReadyCount += resources[i]->IsLoaded() ? 1 : 0;
+            }
+        }
+    }
+    while ( ResourceManager::GetLoadingCount() > 0 );
+
+    SizeT readyCount = 0;
+    for ( U32 i=0; i<RESOURCE_COUNT; ++i )
+    {
+        readyCount += ( resources[i]->IsLoaded() && resources[i]->IsValid() ) ? 1 : 0;
+    }
+
+    UNIT_TEST_MESSAGE( "%d ressources pretes sur %d, %d threads\n", readyCount, RESOURCE_COUNT, JobSystem::GetWorkerCount() + 1 );
+    UNIT_TEST_MESSAGE( "%d frames, moyenne : %0.3f ms, max : %0.3f ms, au dessus de %0.1f ms : %d\n", frameCount, totalTime / frameCount, maxTime, FRAME_BUDGET_MS, spikeCount );
+    UNIT_TEST_MESSAGE( "derniere frame, bloquant : %d, visible : %d, arriere plan : %d\n", doneFrames[ ResourceManager::LP_BLOCKING ], doneFrames[ ResourceManager::LP_VISIBLE ], doneFrames[ ResourceManager::LP_BACKGROUND ] );
+
+    UNIT_TEST_MESSAGE( "ressources devenues bloquantes pretes avec les bloquantes : %d sur %d\n", raisedReadyCount, RESOURCE_COUNT / 128 );
+
+    CARBON_ASSERT( readyCount == RESOURCE_COUNT );
+    CARBON_ASSERT( raisedReadyCount == RESOURCE_COUNT / 128 );
+
+    for ( U32 i=0; i<RESOURCE_COUNT; ++i )
+    {
+        resources[i] = 0;
+    }
+
+    ResourceManager::Destroy();
+    JobSystem::Destroy();
+
+    // not left in the cache, the pack compiler would take them
+    for ( U32 i=0; i<RESOURCE_COUNT; ++i )
+    {
+        StringUtils::FormatString( name, sizeof(name), "loading_test_%d.bin", i );
+
+        PathString path;
+        FileSystem::BuildPathName( name, path, FileSystem::PT_CACHE );
+        FileSystem::Delete( path );
+    }
+
+    FileSystem::Destroy();
+}
+
 void Level1()
 {
     UNIT_TEST_MESSAGE( "\n###########\n# LEVEL 1 #\n###########\n\n" );
@@ -124,7 +1506,19 @@ void Level1()
     MemoryManager::Initialize( sizeof( ALLOC_TYPE ) * ( ALLOC_COUNT + 1 ) );
 
     Test_MemoryManager();
+    Test_SmallObjectAllocator();
+    Test_StackAllocator();
+    Test_Pool();
+    Test_VirtualMemory();
+    Test_ArrayGrowth();
+    Test_SmallArray();
+    Test_HashTable();
+    Test_HashedString();
     Test_Array();
+    Test_ConcurrentQueues();
+    Test_SharedPtr();
+    Test_Pack();
+    Test_ResourceLoading();
 
     MemoryManager::Destroy();
 }
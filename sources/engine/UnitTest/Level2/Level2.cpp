@@ -5,11 +5,473 @@
 #include "Core/Vector.h"
 #include "Core/Matrix.h"
 #include "Core/Quaternion.h"
+#include "Core/BatchMath.h"
+#include "Core/Bvh.h"
+#include "Core/Compression.h"
+#include "Core/FileSystem.h"
+#include "Core/Frustum.h"
+#include "Core/JobSystem.h"
+#include "Core/MemoryManager.h"
+#include "Core/MemoryUtils.h"
+#include "Core/Platform.h"
+#include "Core/Timer.h"
+#include "Core/TimeUtils.h"
+
+#include <cstring>
 
 using namespace Core;
 
+#define TRANSCENDENTAL_COUNT    ( 64 * 1024 )
+#define TRANSCENDENTAL_PASS     32
+
+#define BATCH_COUNT             ( 64 * 1024 + 3 )
+#define BATCH_PASS              256
+
+#define OBJECT_COUNT            ( 4 * 1024 + 3 )
+#define OBJECT_PASS             64
+#define OBJECT_STRIDE           ( 4 * 1024 + 80 )   // rows padded to avoid 4K aliasing between streams
+
+#define CULL_COUNT              ( 100 * 1000 )
+#define CULL_PASS               32
+
+#define JOB_COUNT               1024
+#define JOB_PASS                64
+#define PARALLEL_GRAIN          ( 64 * 32 )         // whole visibility words per range
+
+#define COMPRESSION_MAX_SIZE    ( 64 * 1024 * 1024 )
+#define COMPRESSION_GEN_SIZE    ( 16 * 1024 * 1024 )    // without compiled assets
+#define COMPRESSION_PASS        16
+
+#define IO_FILE_COUNT           1000
+#define IO_MIN_SIZE             ( 16 * 1024 )
+#define IO_MAX_SIZE             ( 256 * 1024 )
+#define IO_BATCH_COUNT          64                  // as the resource loads
+
 namespace Level2_NS
 {
+    F128 inputs[ TRANSCENDENTAL_COUNT / 4 ];
+    F128 scalarOutputs[ TRANSCENDENTAL_COUNT / 4 ];
+    F128 vectorOutputs[ TRANSCENDENTAL_COUNT / 4 ];
+
+    F32 batchA[ BATCH_COUNT ];
+    F32 batchB[ BATCH_COUNT ];
+    F32 batchC[ BATCH_COUNT ];
+    F32 mulAddResults[ BP_COUNT ][ BATCH_COUNT ];
+    F32 lerpResults[ BP_COUNT ][ BATCH_COUNT ];
+
+    const Char * batchPathNames[ BP_COUNT ] = { "SSE", "AVX2" };
+
+    Matrix aosWorlds[ OBJECT_COUNT ];
+    Matrix aosResults[ OBJECT_COUNT ];
+    Vector aosPoints[ OBJECT_COUNT ];
+    F32 soaWorlds[ 16 ][ OBJECT_STRIDE ];
+    F32 soaResults[ 16 ][ OBJECT_STRIDE ];
+    F32 soaBoxes[ 6 ][ OBJECT_STRIDE ];
+
+    F32 cullSpheres[ 4 ][ CULL_COUNT ];
+    F32 cullBoxes[ 6 ][ CULL_COUNT ];
+    U32 cullReference[ ( CULL_COUNT + 31 ) / 32 ];
+    U32 cullVisibility[ ( CULL_COUNT + 31 ) / 32 ];
+    BvhNode bvhNodes[ 2 * CULL_COUNT ];
+    U32 bvhItems[ CULL_COUNT ];
+
+    // Prints elements per second of its scope, on one core
+    class ThroughputTimer
+    {
+    public:
+        ThroughputTimer( const Char * name, U32 count )
+            : m_name( name )
+            , m_count( count )
+            , m_start( TimeUtils::ClockTime() )
+        {
+        }
+
+        ~ThroughputTimer()
+        {
+            const F64 seconds = ( F64 )( TimeUtils::ClockTime() - m_start ) * TimeUtils::ClockPeriod();
+            UNIT_TEST_MESSAGE( "%s : %0.2f M/s\n", m_name, ( F64 )m_count / seconds * 1e-6 );
+        }
+
+    private:
+        const Char *    m_name;
+        U32             m_count;
+        U64             m_start;
+    };
+
+    SoaMatrices SoaView( F32 (&elements)[ 16 ][ OBJECT_STRIDE ] )
+    {
+        SoaMatrices view;
+        for ( SizeT k=0; k<16; ++k )
+        {
+            view.m_element[ k ] = elements[ k ];
+        }
+        return view;
+    }
+
+    F32 MaxDifference( const Matrix * aos, F32 (&soa)[ 16 ][ OBJECT_STRIDE ] )
+    {
+        F32 maxDiff = 0.0f;
+        for ( SizeT i=0; i<OBJECT_COUNT; ++i )
+        {
+            F128 e[ 4 ];
+            Store( e, aos[ i ] );
+            for ( SizeT k=0; k<16; ++k )
+            {
+                maxDiff = Max( maxDiff, Abs( e[ k / 4 ][ k % 4 ] - soa[ k ][ i ] ) );
+            }
+        }
+        return maxDiff;
+    }
+
+    // Linear congruential generator, in [ min, max [
+    F32 Random( U32& seed, F32 min, F32 max )
+    {
+        seed = seed * 1664525 + 1013904223;
+        return min + ( max - min ) * ( F32 )( ( seed >> 8 ) & 0xFFFFFF ) / ( F32 )( 1 << 24 );
+    }
+
+    // Prints the number of visible objects and the disagreements with the reference
+    void CompareVisibility( SizeT count )
+    {
+        U32 visible = 0;
+        U32 differences = 0;
+        for ( SizeT i=0; i<count; ++i )
+        {
+            visible += IsVisible( cullVisibility, i ) ? 1 : 0;
+            differences += ( IsVisible( cullVisibility, i ) != IsVisible( cullReference, i ) ) ? 1 : 0;
+        }
+        UNIT_TEST_MESSAGE( "visibles : %d, differences : %d\n", visible, differences );
+    }
+
+    // Camera at the origin looking down -z, 90 degrees of fov
+    Frustum CullingFrustum()
+    {
+        const F32 n = 0.25f;
+        const F32 f = 50.0f;
+        const F32 ratio = 16.0f / 9.0f;
+
+        Matrix proj;
+        proj.m_column[ 0 ] = Vector4( 1.0f, 0.0f, 0.0f, 0.0f );
+        proj.m_column[ 1 ] = Vector4( 0.0f, ratio, 0.0f, 0.0f );
+        proj.m_column[ 2 ] = Vector4( 0.0f, 0.0f, ( f + n ) / ( n - f ), -1.0f );
+        proj.m_column[ 3 ] = Vector4( 0.0f, 0.0f, ( 2.0f * n * f ) / ( n - f ), 0.0f );
+
+        return ExtractFrustum( proj );
+    }
+
+    void GenerateCullObjects()
+    {
+        U32 seed = 12345;
+        for ( SizeT i=0; i<CULL_COUNT; ++i )
+        {
+            const F32 x = Random( seed, -60.0f, 60.0f );
+            const F32 y = Random( seed, -60.0f, 60.0f );
+            const F32 z = Random( seed, -60.0f, 60.0f );
+
+            cullSpheres[ 0 ][ i ] = x;
+            cullSpheres[ 1 ][ i ] = y;
+            cullSpheres[ 2 ][ i ] = z;
+            cullSpheres[ 3 ][ i ] = Random( seed, 0.5f, 2.5f );
+
+            cullBoxes[ 0 ][ i ] = x - Random( seed, 0.5f, 2.5f );
+            cullBoxes[ 1 ][ i ] = y - Random( seed, 0.5f, 2.5f );
+            cullBoxes[ 2 ][ i ] = z - Random( seed, 0.5f, 2.5f );
+            cullBoxes[ 3 ][ i ] = x + Random( seed, 0.5f, 2.5f );
+            cullBoxes[ 4 ][ i ] = y + Random( seed, 0.5f, 2.5f );
+            cullBoxes[ 5 ][ i ] = z + Random( seed, 0.5f, 2.5f );
+        }
+    }
+
+    SoaSpheres CullSpheresView()
+    {
+        SoaSpheres spheres;
+        spheres.m_center.m_x    = cullSpheres[ 0 ];
+        spheres.m_center.m_y    = cullSpheres[ 1 ];
+        spheres.m_center.m_z    = cullSpheres[ 2 ];
+        spheres.m_radius        = cullSpheres[ 3 ];
+        return spheres;
+    }
+
+    SoaBoxes CullBoxesView()
+    {
+        SoaBoxes boxes;
+        boxes.m_min.m_x = cullBoxes[ 0 ];
+        boxes.m_min.m_y = cullBoxes[ 1 ];
+        boxes.m_min.m_z = cullBoxes[ 2 ];
+        boxes.m_max.m_x = cullBoxes[ 3 ];
+        boxes.m_max.m_y = cullBoxes[ 4 ];
+        boxes.m_max.m_z = cullBoxes[ 5 ];
+        return boxes;
+    }
+
+    Job jobs[ JOB_COUNT ];
+    volatile S32 jobSum;
+    S32 jobCheck;
+
+    void EmptyJob( void * )
+    {
+    }
+
+    void AddJob( void * data )
+    {
+        AtomicAdd( &jobSum, static_cast< S32 >( reinterpret_cast< SizeT >( data ) ) );
+    }
+
+    void CheckJob( void * )
+    {
+        jobCheck = AtomicLoad( &jobSum );
+    }
+
+    struct ParallelCull
+    {
+        Frustum     m_frustum;
+        SoaSpheres  m_spheres;
+        U32 *       m_visibility;
+    };
+
+    void CullSpheresRange( SizeT begin, SizeT end, void * data )
+    {
+        const ParallelCull * cull = reinterpret_cast< const ParallelCull * >( data );
+
+        SoaSpheres spheres;
+        spheres.m_center.m_x    = cull->m_spheres.m_center.m_x + begin;
+        spheres.m_center.m_y    = cull->m_spheres.m_center.m_y + begin;
+        spheres.m_center.m_z    = cull->m_spheres.m_center.m_z + begin;
+        spheres.m_radius        = cull->m_spheres.m_radius + begin;
+
+        BatchMath::CullSpheres( cull->m_frustum, spheres, cull->m_visibility + begin / 32, end - begin );
+    }
+
+    // Compiled assets of the cache, as packed by the PackCompiler
+    const Char * assetPatterns[] = { "*.bmh", "*.btx", "level6/*.bmh", "level6/*.btx", "materials/*" };
+
+    struct ParallelDecompression
+    {
+        const void *    m_file;
+        void *          m_dest;
+    };
+
+    void DecompressRange( SizeT begin, SizeT end, void * data )
+    {
+        const ParallelDecompression * decompression = reinterpret_cast< const ParallelDecompression * >( data );
+
+        for ( SizeT b=begin; b<end; ++b )
+        {
+            Compression::DecompressBlock( decompression->m_file, b, decompression->m_dest );
+        }
+    }
+
+    // Asset files appended in raw, false when the cache has none
+    Bool LoadAssets( Array< U8 >& raw, SizeT& fileCount )
+    {
+        fileCount = 0;
+
+        for ( SizeT i=0; i<sizeof(assetPatterns) / sizeof(assetPatterns[0]); ++i )
+        {
+            PathString searchStr;
+            FileSystem::BuildPathName( assetPatterns[ i ], searchStr, FileSystem::PT_CACHE );
+
+            Array< PathString > fileNames;
+            FileSystem::Find( searchStr.ConstPtr(), fileNames );
+
+            for ( SizeT f=0; f<fileNames.Size(); ++f )
+            {
+                void * buffer = 0;
+                SizeT size = 0;
+                if ( ! FileSystem::Load( fileNames[ f ], buffer, size ) || size == 0 )
+                {
+                    continue;
+                }
+
+                if ( raw.Size() + size <= COMPRESSION_MAX_SIZE )
+                {
+                    const SizeT start = raw.Size();
+                    raw.Resize( start + size );
+                    MemoryUtils::MemCpy( raw.Ptr() + start, buffer, size );
+                    ++fileCount;
+                }
+
+                UnknownAllocator::Deallocate( buffer );
+            }
+        }
+
+        return fileCount > 0;
+    }
+
+    // Mesh like data : quantized positions and normals, indices, a few repeated headers
+    void GenerateAssets( Array< U8 >& raw )
+    {
+        raw.Resize( COMPRESSION_GEN_SIZE );
+
+        U32 seed = 12345;
+        U16 * words = reinterpret_cast< U16 * >( raw.Ptr() );
+        const SizeT wordCount = COMPRESSION_GEN_SIZE / sizeof(U16);
+
+        for ( SizeT i=0; i<wordCount; ++i )
+        {
+            seed = seed * 1664525 + 1013904223;
+
+            switch ( i % 8 )
+            {
+            case 0:     words[ i ] = static_cast< U16 >( i / 64 );                             break;  // index
+            case 1:     words[ i ] = static_cast< U16 >( 0x3c00 );                              break;  // constant w
+            default:    words[ i ] = static_cast< U16 >( ( i / 8 ) * 3 + ( seed >> 29 ) );     break;  // smooth attribute
+            }
+        }
+    }
+
+    void PrintBandwidth( const Char * name, F64 bytes, U64 ticks )
+    {
+        const F64 seconds = ( F64 )ticks * TimeUtils::ClockPeriod();
+        UNIT_TEST_MESSAGE( "%s : %0.2f GB/s\n", name, bytes / seconds * 1e-9 );
+    }
+
+    U32 ioSizes[ IO_FILE_COUNT ];
+    SizeT ioReadCount;
+    SizeT ioErrorCount;
+
+    // Files start with their index, the rest is padding
+    void SaveIOFiles()
+    {
+        Array< U32 > words;
+        words.Resize( IO_MAX_SIZE / sizeof(U32) );
+
+        U32 seed = 4321;
+        Char name[ 64 ];
+        for ( U32 i=0; i<IO_FILE_COUNT; ++i )
+        {
+            seed = seed * 1664525 + 1013904223;
+            ioSizes[ i ] = ( IO_MIN_SIZE + seed % ( IO_MAX_SIZE - IO_MIN_SIZE ) ) & ~3;
+
+            words[ 0 ] = i;
+
+            PathString path;
+            StringUtils::FormatString( name, sizeof(name), "io_test/%d.bin", i );
+            FileSystem::BuildPathName( name, path, FileSystem::PT_CACHE );
+            FileSystem::Save( path, words.ConstPtr(), ioSizes[ i ] );
+        }
+    }
+
+    // Just written or read by the previous pass, the files are in the system file cache :
+    // each pass reads them from the disk
+    void EvictIOFiles( const PathString * paths )
+    {
+        for ( SizeT i=0; i<IO_FILE_COUNT; ++i )
+        {
+            FileSystem::EvictFromCache( paths[ i ] );
+        }
+    }
+
+    void CheckIORead( FileRead& read, Bool success )
+    {
+        const U32 i = static_cast< U32 >( reinterpret_cast< SizeT >( read.m_userData ) );
+
+        if ( ! success || read.m_size != ioSizes[ i ] || *reinterpret_cast< const U32 * >( read.m_buffer ) != i )
+        {
+            ++ioErrorCount;
+        }
+        ++ioReadCount;
+    }
+
+    void PrintLoadTime( const Char * name, U64 bytes, U64 ticks )
+    {
+        const F64 seconds = ( F64 )ticks * TimeUtils::ClockPeriod();
+        UNIT_TEST_MESSAGE( "%s : %0.2f ms, %0.2f GB/s\n", name, seconds * 1000.0, ( F64 )bytes / seconds * 1e-9 );
+    }
+
+    // Distance in ulp, from the float bits made monotonic
+    U32 UlpDistance( F32 a, F32 b )
+    {
+        union { F32 f; S32 i; } ua, ub;
+        ua.f = a;
+        ub.f = b;
+
+        if ( a != a || b != b )
+        {
+            return ( a != a && b != b ) ? 0 : 0xFFFFFFFF;
+        }
+
+        const S32 ia = ( ua.i < 0 ) ? ( S32 )( 0x80000000 - ua.i ) : ua.i;
+        const S32 ib = ( ub.i < 0 ) ? ( S32 )( 0x80000000 - ub.i ) : ub.i;
+        return ( ia < ib ) ? ib - ia : ia - ib;
+    }
+
+    template< M128 (*VF)( M128 ), F32 (*SF)( F32 ) >
+    void BenchTranscendental( const Char * name, F32 min, F32 max )
+    {
+        Char timerName[ 64 ];
+
+        for ( SizeT i=0; i<TRANSCENDENTAL_COUNT; ++i )
+        {
+            inputs[ i / 4 ][ i % 4 ] = min + ( max - min ) * ( F32 )i / ( F32 )( TRANSCENDENTAL_COUNT - 1 );
+        }
+
+        StringUtils::FormatString( timerName, sizeof( timerName ), "%s scalar", name );
+        {
+            CARBON_AUTO_TIMER( scalarID, timerName );
+            for ( SizeT p=0; p<TRANSCENDENTAL_PASS; ++p )
+            {
+                for ( SizeT i=0; i<TRANSCENDENTAL_COUNT; ++i )
+                {
+                    scalarOutputs[ i / 4 ][ i % 4 ] = SF( inputs[ i / 4 ][ i % 4 ] );
+                }
+            }
+        }
+
+        StringUtils::FormatString( timerName, sizeof( timerName ), "%s M128", name );
+        {
+            CARBON_AUTO_TIMER( vectorID, timerName );
+            for ( SizeT p=0; p<TRANSCENDENTAL_PASS; ++p )
+            {
+                for ( SizeT i=0; i<TRANSCENDENTAL_COUNT / 4; ++i )
+                {
+                    Store( vectorOutputs[ i ], VF( Load( inputs[ i ] ) ) );
+                }
+            }
+        }
+
+        // both, the ulp error of small results is big for a small absolute error
+        U32 maxError = 0;
+        F32 maxAbsError = 0.0f;
+        for ( SizeT i=0; i<TRANSCENDENTAL_COUNT; ++i )
+        {
+            const F32 scalar    = scalarOutputs[ i / 4 ][ i % 4 ];
+            const F32 vector    = vectorOutputs[ i / 4 ][ i % 4 ];
+
+            const U32 error = UlpDistance( scalar, vector );
+            maxError = ( error > maxError ) ? error : maxError;
+
+            const F32 absError = ( scalar > vector ) ? scalar - vector : vector - scalar;
+            maxAbsError = ( absError > maxAbsError ) ? absError : maxAbsError;
+        }
+
+        UNIT_TEST_MESSAGE( "%s sur [ %0.2f, %0.2f ] : erreur max %d ulp, %g absolue\n", name, min, max, maxError, maxAbsError );
+    }
+
+    void BenchBatchPath( BatchPath path )
+    {
+        Char timerName[ 64 ];
+
+        BatchMath::SetPath( path );
+
+        StringUtils::FormatString( timerName, sizeof( timerName ), "MulAdd %s", batchPathNames[ path ] );
+        {
+            CARBON_AUTO_TIMER( mulAddID, timerName );
+            for ( SizeT p=0; p<BATCH_PASS; ++p )
+            {
+                BatchMath::MulAdd( mulAddResults[ path ], batchA, batchB, batchC, BATCH_COUNT );
+            }
+        }
+
+        StringUtils::FormatString( timerName, sizeof( timerName ), "Lerp %s", batchPathNames[ path ] );
+        {
+            CARBON_AUTO_TIMER( lerpID, timerName );
+            for ( SizeT p=0; p<BATCH_PASS; ++p )
+            {
+                BatchMath::Lerp( lerpResults[ path ], batchA, batchB, 0.25f, BATCH_COUNT );
+            }
+        }
+    }
 
     Char * SerializeVector( Char * dest, const Vector& v )
     {
@@ -22,6 +484,683 @@ namespace Level2_NS
 
 using namespace Level2_NS;
 
+void Test_Transcendentals()
+{
+    UNIT_TEST_MESSAGE( "\n* Transcendental Benchmark\n" );
+    UNIT_TEST_MESSAGE( "\n%d valeurs, %d passes\n\n", TRANSCENDENTAL_COUNT, TRANSCENDENTAL_PASS );
+
+    BenchTranscendental< Floor, Floor >( "Floor", -1000.0f, 1000.0f );
+    BenchTranscendental< Ceil, Ceil >( "Ceil", -1000.0f, 1000.0f );
+    BenchTranscendental< Exp, Exp >( "Exp", -80.0f, 80.0f );
+    BenchTranscendental< Log, Log >( "Log", 1e-6f, 1e6f );
+    BenchTranscendental< Sin, Sin >( "Sin", -100.0f, 100.0f );
+    BenchTranscendental< Cos, Cos >( "Cos", -100.0f, 100.0f );
+    BenchTranscendental< Tan, Tan >( "Tan", -1.5f, 1.5f );
+    BenchTranscendental< ASin, ASin >( "ASin", -1.0f, 1.0f );
+    BenchTranscendental< ACos, ACos >( "ACos", -1.0f, 1.0f );
+    BenchTranscendental< ATan, ATan >( "ATan", -100.0f, 100.0f );
+}
+
+void Test_BatchMath()
+{
+    const BatchPath bestPath = BatchMath::GetPath();
+
+    UNIT_TEST_MESSAGE( "\n* Batch Math Benchmark\n" );
+    UNIT_TEST_MESSAGE( "\nCPU : SSE4.1 %s; AVX %s; AVX2 %s; FMA %s\n",
+        Platform::HasCpuFeatures( CF_SSE41 ) ? "oui" : "non",
+        Platform::HasCpuFeatures( CF_AVX ) ? "oui" : "non",
+        Platform::HasCpuFeatures( CF_AVX2 ) ? "oui" : "non",
+        Platform::HasCpuFeatures( CF_FMA ) ? "oui" : "non" );
+    UNIT_TEST_MESSAGE( "chemin par defaut : %s\n", batchPathNames[ bestPath ] );
+    UNIT_TEST_MESSAGE( "\n%d valeurs, %d passes\n\n", BATCH_COUNT, BATCH_PASS );
+
+    for ( SizeT i=0; i<BATCH_COUNT; ++i )
+    {
+        batchA[ i ] = ( F32 )i;
+        batchB[ i ] = 1.0f / ( F32 )( i + 1 );
+        batchC[ i ] = -0.5f * ( F32 )i;
+    }
+
+    for ( SizeT path=0; path<BP_COUNT; ++path )
+    {
+        if ( BatchMath::IsSupported( ( BatchPath )path ) )
+        {
+            BenchBatchPath( ( BatchPath )path );
+        }
+    }
+
+    // fused multiply add rounds once, results can differ by one ulp
+    if ( bestPath != BP_SSE )
+    {
+        U32 maxMulAddError = 0;
+        U32 maxLerpError = 0;
+        for ( SizeT i=0; i<BATCH_COUNT; ++i )
+        {
+            const U32 mulAddError = UlpDistance( mulAddResults[ BP_SSE ][ i ], mulAddResults[ bestPath ][ i ] );
+            maxMulAddError = ( mulAddError > maxMulAddError ) ? mulAddError : maxMulAddError;
+
+            const U32 lerpError = UlpDistance( lerpResults[ BP_SSE ][ i ], lerpResults[ bestPath ][ i ] );
+            maxLerpError = ( lerpError > maxLerpError ) ? lerpError : maxLerpError;
+        }
+        UNIT_TEST_MESSAGE( "ecart max SSE / %s : MulAdd %d ulp, Lerp %d ulp\n", batchPathNames[ bestPath ], maxMulAddError, maxLerpError );
+    }
+
+    BatchMath::SetPath( bestPath );
+}
+
+void Test_BatchTransforms()
+{
+    Char name[ 64 ];
+    const BatchPath bestPath = BatchMath::GetPath();
+    const U32 count = OBJECT_COUNT * OBJECT_PASS;
+
+    UNIT_TEST_MESSAGE( "\n* Batch Transform Benchmark\n" );
+    UNIT_TEST_MESSAGE( "\n%d objets, %d passes\n\n", OBJECT_COUNT, OBJECT_PASS );
+
+    Matrix viewProj = Identity();
+    viewProj.m_column[ 0 ] = Vector4( 1.2f, 0.0f, 0.0f, 0.0f );
+    viewProj.m_column[ 2 ] = Vector4( 0.0f, 0.0f, -1.0f, -1.0f );
+    viewProj.m_column[ 3 ] = Vector4( 0.0f, 0.0f, -0.5f, 0.0f );
+
+    for ( SizeT i=0; i<OBJECT_COUNT; ++i )
+    {
+        const F32 t = ( F32 )i;
+        Matrix world = RMatrix( Quaternion( Normalize( Vector3( 1.0f, t, 2.0f ) ), 0.01f * t ) );
+        Scale( world, Vector3( 1.0f + 0.001f * t, 2.0f, 0.5f ) );
+        Translate( world, Vector3( t, -t, 0.5f * t ) );
+        aosWorlds[ i ] = world;
+
+        F128 e[ 4 ];
+        Store( e, world );
+        for ( SizeT k=0; k<16; ++k )
+        {
+            soaWorlds[ k ][ i ] = e[ k / 4 ][ k % 4 ];
+        }
+    }
+
+    const SoaMatrices worlds = SoaView( soaWorlds );
+    const SoaMatrices results = SoaView( soaResults );
+
+    // View projection * world
+    {
+        ThroughputTimer timer( "Mul AoS", count );
+        for ( SizeT p=0; p<OBJECT_PASS; ++p )
+        {
+            for ( SizeT i=0; i<OBJECT_COUNT; ++i )
+            {
+                aosResults[ i ] = Mul( viewProj, aosWorlds[ i ] );
+            }
+        }
+    }
+    for ( SizeT path=0; path<BP_COUNT; ++path )
+    {
+        if ( BatchMath::IsSupported( ( BatchPath )path ) )
+        {
+            BatchMath::SetPath( ( BatchPath )path );
+            StringUtils::FormatString( name, sizeof( name ), "MulMatrices %s", batchPathNames[ path ] );
+
+            ThroughputTimer timer( name, count );
+            for ( SizeT p=0; p<OBJECT_PASS; ++p )
+            {
+                BatchMath::MulMatrices( viewProj, worlds, results, OBJECT_COUNT );
+            }
+        }
+    }
+    UNIT_TEST_MESSAGE( "ecart max : %g\n\n", MaxDifference( aosResults, soaResults ) );
+
+    // Inverses
+    {
+        ThroughputTimer timer( "Inverse AoS", count );
+        for ( SizeT p=0; p<OBJECT_PASS; ++p )
+        {
+            for ( SizeT i=0; i<OBJECT_COUNT; ++i )
+            {
+                aosResults[ i ] = Inverse( aosWorlds[ i ] );
+            }
+        }
+    }
+    {
+        ThroughputTimer timer( "AffineInverse AoS", count );
+        for ( SizeT p=0; p<OBJECT_PASS; ++p )
+        {
+            for ( SizeT i=0; i<OBJECT_COUNT; ++i )
+            {
+                aosResults[ i ] = AffineInverse( aosWorlds[ i ] );
+            }
+        }
+    }
+    for ( SizeT path=0; path<BP_COUNT; ++path )
+    {
+        if ( BatchMath::IsSupported( ( BatchPath )path ) )
+        {
+            BatchMath::SetPath( ( BatchPath )path );
+            StringUtils::FormatString( name, sizeof( name ), "AffineInverses %s", batchPathNames[ path ] );
+
+            ThroughputTimer timer( name, count );
+            for ( SizeT p=0; p<OBJECT_PASS; ++p )
+            {
+                BatchMath::AffineInverses( worlds, results, OBJECT_COUNT );
+            }
+        }
+    }
+    UNIT_TEST_MESSAGE( "ecart max : %g\n\n", MaxDifference( aosResults, soaResults ) );
+
+    // Points, the translations of the worlds
+    SoaPoints points;
+    points.m_x = soaResults[ 0 ];
+    points.m_y = soaResults[ 1 ];
+    points.m_z = soaResults[ 2 ];
+    {
+        ThroughputTimer timer( "TransformVertex AoS", count );
+        for ( SizeT p=0; p<OBJECT_PASS; ++p )
+        {
+            for ( SizeT i=0; i<OBJECT_COUNT; ++i )
+            {
+                aosPoints[ i ] = TransformVertex( aosWorlds[ 0 ], aosWorlds[ i ].m_column[ 3 ] );
+            }
+        }
+    }
+    for ( SizeT path=0; path<BP_COUNT; ++path )
+    {
+        if ( BatchMath::IsSupported( ( BatchPath )path ) )
+        {
+            SoaPoints src;
+            src.m_x = soaWorlds[ 12 ];
+            src.m_y = soaWorlds[ 13 ];
+            src.m_z = soaWorlds[ 14 ];
+
+            BatchMath::SetPath( ( BatchPath )path );
+            StringUtils::FormatString( name, sizeof( name ), "TransformPoints %s", batchPathNames[ path ] );
+
+            ThroughputTimer timer( name, count );
+            for ( SizeT p=0; p<OBJECT_PASS; ++p )
+            {
+                BatchMath::TransformPoints( aosWorlds[ 0 ], src, points, OBJECT_COUNT );
+            }
+        }
+    }
+    {
+        F32 maxDiff = 0.0f;
+        for ( SizeT i=0; i<OBJECT_COUNT; ++i )
+        {
+            F128 e;
+            Store( e, aosPoints[ i ] );
+            maxDiff = Max( maxDiff, Abs( e[ 0 ] - points.m_x[ i ] ) );
+            maxDiff = Max( maxDiff, Abs( e[ 1 ] - points.m_y[ i ] ) );
+            maxDiff = Max( maxDiff, Abs( e[ 2 ] - points.m_z[ i ] ) );
+        }
+        UNIT_TEST_MESSAGE( "ecart max : %g\n\n", maxDiff );
+    }
+
+    // Unit boxes around the translations
+    SoaBoxes boxes;
+    boxes.m_min.m_x = soaBoxes[ 0 ];
+    boxes.m_min.m_y = soaBoxes[ 1 ];
+    boxes.m_min.m_z = soaBoxes[ 2 ];
+    boxes.m_max.m_x = soaBoxes[ 3 ];
+    boxes.m_max.m_y = soaBoxes[ 4 ];
+    boxes.m_max.m_z = soaBoxes[ 5 ];
+    for ( SizeT path=0; path<BP_COUNT; ++path )
+    {
+        if ( BatchMath::IsSupported( ( BatchPath )path ) )
+        {
+            SoaBoxes dest;
+            dest.m_min.m_x = soaResults[ 0 ];
+            dest.m_min.m_y = soaResults[ 1 ];
+            dest.m_min.m_z = soaResults[ 2 ];
+            dest.m_max.m_x = soaResults[ 3 ];
+            dest.m_max.m_y = soaResults[ 4 ];
+            dest.m_max.m_z = soaResults[ 5 ];
+
+            for ( SizeT i=0; i<OBJECT_COUNT; ++i )
+            {
+                for ( SizeT k=0; k<3; ++k )
+                {
+                    soaBoxes[ k ][ i ] = soaWorlds[ 12 + k ][ i ] - 0.5f;
+                    soaBoxes[ 3 + k ][ i ] = soaWorlds[ 12 + k ][ i ] + 0.5f;
+                }
+            }
+
+            BatchMath::SetPath( ( BatchPath )path );
+            StringUtils::FormatString( name, sizeof( name ), "TransformBoxes %s", batchPathNames[ path ] );
+
+            ThroughputTimer timer( name, count );
+            for ( SizeT p=0; p<OBJECT_PASS; ++p )
+            {
+                BatchMath::TransformBoxes( aosWorlds[ 0 ], boxes, dest, OBJECT_COUNT );
+            }
+        }
+    }
+
+    BatchMath::SetPath( bestPath );
+}
+
+void Test_FrustumCulling()
+{
+    Char name[ 64 ];
+    const BatchPath bestPath = BatchMath::GetPath();
+    const U32 count = CULL_COUNT * CULL_PASS;
+
+    UNIT_TEST_MESSAGE( "\n* Frustum Culling Benchmark\n" );
+    UNIT_TEST_MESSAGE( "\n%d objets, %d passes\n\n", CULL_COUNT, CULL_PASS );
+
+    const Frustum frustum = CullingFrustum();
+    GenerateCullObjects();
+
+    const SoaSpheres spheres    = CullSpheresView();
+    const SoaBoxes boxes        = CullBoxesView();
+
+    // Spheres
+    {
+        ThroughputTimer timer( "IsSphereVisible", count );
+        for ( SizeT p=0; p<CULL_PASS; ++p )
+        {
+            MemoryUtils::MemSet( cullReference, 0, sizeof( cullReference ) );
+            for ( SizeT i=0; i<CULL_COUNT; ++i )
+            {
+                const Vector center = Vector4( cullSpheres[ 0 ][ i ], cullSpheres[ 1 ][ i ], cullSpheres[ 2 ][ i ] );
+                if ( IsSphereVisible( frustum, center, cullSpheres[ 3 ][ i ] ) )
+                {
+                    cullReference[ i / 32 ] |= 1u << ( i % 32 );
+                }
+            }
+        }
+    }
+    for ( SizeT path=0; path<BP_COUNT; ++path )
+    {
+        if ( BatchMath::IsSupported( ( BatchPath )path ) )
+        {
+            BatchMath::SetPath( ( BatchPath )path );
+            StringUtils::FormatString( name, sizeof( name ), "CullSpheres %s", batchPathNames[ path ] );
+            {
+                ThroughputTimer timer( name, count );
+                for ( SizeT p=0; p<CULL_PASS; ++p )
+                {
+                    BatchMath::CullSpheres( frustum, spheres, cullVisibility, CULL_COUNT );
+                }
+            }
+            CompareVisibility( CULL_COUNT );
+        }
+    }
+
+    UNIT_TEST_MESSAGE( "\n" );
+
+    // Boxes
+    {
+        ThroughputTimer timer( "IsBoxVisible", count );
+        for ( SizeT p=0; p<CULL_PASS; ++p )
+        {
+            MemoryUtils::MemSet( cullReference, 0, sizeof( cullReference ) );
+            for ( SizeT i=0; i<CULL_COUNT; ++i )
+            {
+                const Vector min = Vector4( cullBoxes[ 0 ][ i ], cullBoxes[ 1 ][ i ], cullBoxes[ 2 ][ i ] );
+                const Vector max = Vector4( cullBoxes[ 3 ][ i ], cullBoxes[ 4 ][ i ], cullBoxes[ 5 ][ i ] );
+                if ( IsBoxVisible( frustum, min, max ) )
+                {
+                    cullReference[ i / 32 ] |= 1u << ( i % 32 );
+                }
+            }
+        }
+    }
+    for ( SizeT path=0; path<BP_COUNT; ++path )
+    {
+        if ( BatchMath::IsSupported( ( BatchPath )path ) )
+        {
+            BatchMath::SetPath( ( BatchPath )path );
+            StringUtils::FormatString( name, sizeof( name ), "CullBoxes %s", batchPathNames[ path ] );
+            {
+                ThroughputTimer timer( name, count );
+                for ( SizeT p=0; p<CULL_PASS; ++p )
+                {
+                    BatchMath::CullBoxes( frustum, boxes, cullVisibility, CULL_COUNT );
+                }
+            }
+            CompareVisibility( CULL_COUNT );
+        }
+    }
+
+    BatchMath::SetPath( bestPath );
+}
+
+void Test_Bvh()
+{
+    const U32 count = CULL_COUNT * CULL_PASS;
+
+    UNIT_TEST_MESSAGE( "\n* Bvh Benchmark\n" );
+    UNIT_TEST_MESSAGE( "\n%d objets, %d passes\n\n", CULL_COUNT, CULL_PASS );
+
+    const Frustum frustum = CullingFrustum();
+    GenerateCullObjects();
+
+    Bvh bvh;
+    bvh.m_nodes     = bvhNodes;
+    bvh.m_items     = bvhItems;
+    bvh.m_itemCount = CULL_COUNT;
+    bvh.m_bounds    = CullBoxesView();
+    {
+        ThroughputTimer timer( "BuildBvh", CULL_COUNT );
+        bvh.m_nodeCount = BuildBvh( bvh.m_bounds, CULL_COUNT, bvhNodes, bvhItems );
+    }
+    UNIT_TEST_MESSAGE( "%d noeuds\n\n", bvh.m_nodeCount );
+
+    // Frustum
+    {
+        ThroughputTimer timer( "CullBoxes", count );
+        for ( SizeT p=0; p<CULL_PASS; ++p )
+        {
+            BatchMath::CullBoxes( frustum, bvh.m_bounds, cullReference, CULL_COUNT );
+        }
+    }
+    {
+        ThroughputTimer timer( "CullBvh", count );
+        for ( SizeT p=0; p<CULL_PASS; ++p )
+        {
+            CullBvh( bvh, frustum, cullVisibility );
+        }
+    }
+    CompareVisibility( CULL_COUNT );
+
+    UNIT_TEST_MESSAGE( "\n" );
+
+    // Distance
+    const F32 center[ 3 ] = { 10.0f, 0.0f, -20.0f };
+    const F32 radius = 15.0f;
+    {
+        ThroughputTimer timer( "Distance", count );
+        for ( SizeT p=0; p<CULL_PASS; ++p )
+        {
+            MemoryUtils::MemSet( cullReference, 0, sizeof( cullReference ) );
+            for ( SizeT i=0; i<CULL_COUNT; ++i )
+            {
+                F32 distance = 0.0f;
+                for ( SizeT k=0; k<3; ++k )
+                {
+                    const F32 d = Max( 0.0f, Max( cullBoxes[ k ][ i ] - center[ k ], center[ k ] - cullBoxes[ 3 + k ][ i ] ) );
+                    distance += d * d;
+                }
+                if ( distance <= radius * radius )
+                {
+                    cullReference[ i / 32 ] |= 1u << ( i % 32 );
+                }
+            }
+        }
+    }
+    {
+        ThroughputTimer timer( "QueryBvh", count );
+        for ( SizeT p=0; p<CULL_PASS; ++p )
+        {
+            QueryBvh( bvh, Vector4( center[ 0 ], center[ 1 ], center[ 2 ] ), radius, cullVisibility );
+        }
+    }
+    CompareVisibility( CULL_COUNT );
+}
+
+void Test_JobSystem()
+{
+    Char name[ 64 ];
+    const U32 count = CULL_COUNT * CULL_PASS;
+    const SizeT hardwareCount = JobSystem::GetHardwareThreadCount();
+    const SizeT maxThreadCount = ( hardwareCount < JobSystem::ms_maxWorkerCount + 1 ) ? hardwareCount : JobSystem::ms_maxWorkerCount + 1;
+
+    UNIT_TEST_MESSAGE( "\n* Job System Benchmark\n" );
+    UNIT_TEST_MESSAGE( "\n%d threads materiels, %d taches, %d objets, %d passes\n", hardwareCount, JOB_COUNT, CULL_COUNT, CULL_PASS );
+
+    GenerateCullObjects();
+
+    ParallelCull cull;
+    cull.m_frustum      = CullingFrustum();
+    cull.m_spheres      = CullSpheresView();
+    cull.m_visibility   = cullVisibility;
+
+    BatchMath::CullSpheres( cull.m_frustum, cull.m_spheres, cullReference, CULL_COUNT );
+
+    const S32 expectedSum = JOB_COUNT * ( JOB_COUNT - 1 ) / 2;
+
+    for ( SizeT threadCount=1; threadCount<=maxThreadCount; ++threadCount )
+    {
+        JobSystem::Initialize( threadCount - 1 );
+
+        UNIT_TEST_MESSAGE( "\n%d threads\n", threadCount );
+
+        // Dependencies : the check runs once every addition is done
+        {
+            for ( SizeT i=0; i<JOB_COUNT; ++i )
+            {
+                jobs[ i ].m_function    = AddJob;
+                jobs[ i ].m_data        = reinterpret_cast< void * >( i );
+            }
+
+            Job check;
+            check.m_function    = CheckJob;
+            check.m_data        = 0;
+
+            jobSum      = 0;
+            jobCheck    = -1;
+
+            JobCounter counter;
+            JobCounter checkCounter;
+            JobSystem::Run( jobs, JOB_COUNT, &counter );
+            JobSystem::RunAfter( counter, &check, 1, &checkCounter );
+            JobSystem::Wait( &checkCounter );
+
+            UNIT_TEST_MESSAGE( "dependances : %s\n", ( jobCheck == expectedSum ) ? "ok" : "erreur" );
+        }
+
+        // Scheduling cost
+        for ( SizeT i=0; i<JOB_COUNT; ++i )
+        {
+            jobs[ i ].m_function    = EmptyJob;
+            jobs[ i ].m_data        = 0;
+        }
+        {
+            ThroughputTimer timer( "Run / Wait", JOB_COUNT * JOB_PASS );
+            for ( SizeT p=0; p<JOB_PASS; ++p )
+            {
+                JobCounter counter;
+                JobSystem::Run( jobs, JOB_COUNT, &counter );
+                JobSystem::Wait( &counter );
+            }
+        }
+
+        // Parallel culling
+        StringUtils::FormatString( name, sizeof( name ), "ParallelFor CullSpheres x%d", threadCount );
+        {
+            ThroughputTimer timer( name, count );
+            for ( SizeT p=0; p<CULL_PASS; ++p )
+            {
+                JobSystem::ParallelFor( CULL_COUNT, PARALLEL_GRAIN, CullSpheresRange, &cull );
+            }
+        }
+        CompareVisibility( CULL_COUNT );
+
+        JobSystem::Destroy();
+    }
+}
+
+void Test_Compression()
+{
+    Char name[ 64 ];
+
+    UNIT_TEST_MESSAGE( "\n* Compression Benchmark\n\n" );
+
+    FileSystem::Initialize( "../../.." );
+
+    Array< U8 > raw;
+    SizeT fileCount;
+    if ( LoadAssets( raw, fileCount ) )
+    {
+        UNIT_TEST_MESSAGE( "%d assets du cache, %0.2f Mo\n", fileCount, raw.Size() / ( 1024.0 * 1024.0 ) );
+    }
+    else
+    {
+        GenerateAssets( raw );
+        UNIT_TEST_MESSAGE( "pas d'assets dans le cache, %0.2f Mo generes\n", raw.Size() / ( 1024.0 * 1024.0 ) );
+    }
+
+    const SizeT rawSize = raw.Size();
+
+    Array< U8 > file;
+    file.Resize( Compression::GetCompressedBound( rawSize ) );
+
+    U64 start = TimeUtils::ClockTime();
+    const SizeT fileSize = Compression::Compress( raw.ConstPtr(), rawSize, file.Ptr() );
+    PrintBandwidth( "Compress", ( F64 )rawSize, TimeUtils::ClockTime() - start );
+
+    const SizeT blockCount = Compression::GetBlockCount( file.ConstPtr() );
+    UNIT_TEST_MESSAGE( "%d blocs, %d -> %d octets, ratio %0.2f\n", blockCount, rawSize, fileSize, ( F64 )rawSize / fileSize );
+
+    Array< U8 > decompressed;
+    decompressed.Resize( rawSize );
+
+    start = TimeUtils::ClockTime();
+    Bool success = true;
+    for ( SizeT p=0; p<COMPRESSION_PASS; ++p )
+    {
+        success = Compression::Decompress( file.ConstPtr(), decompressed.Ptr() ) && success;
+    }
+    PrintBandwidth( "Decompress", ( F64 )rawSize * COMPRESSION_PASS, TimeUtils::ClockTime() - start );
+
+    success = success && memcmp( raw.ConstPtr(), decompressed.ConstPtr(), rawSize ) == 0;
+    UNIT_TEST_MESSAGE( "decompression : %s\n", success ? "ok" : "erreur" );
+
+    // Blocks shared by the workers, as a compressed resource is loaded
+    const SizeT hardwareCount = JobSystem::GetHardwareThreadCount();
+    const SizeT maxThreadCount = ( hardwareCount < JobSystem::ms_maxWorkerCount + 1 ) ? hardwareCount : JobSystem::ms_maxWorkerCount + 1;
+
+    ParallelDecompression decompression;
+    decompression.m_file    = file.ConstPtr();
+    decompression.m_dest    = decompressed.Ptr();
+
+    for ( SizeT threadCount=2; threadCount<=maxThreadCount; threadCount*=2 )
+    {
+        JobSystem::Initialize( threadCount - 1 );
+
+        MemoryUtils::MemSet( decompressed.Ptr(), 0, rawSize );
+
+        StringUtils::FormatString( name, sizeof( name ), "ParallelFor Decompress x%d", threadCount );
+        start = TimeUtils::ClockTime();
+        for ( SizeT p=0; p<COMPRESSION_PASS; ++p )
+        {
+            JobSystem::ParallelFor( blockCount, 1, DecompressRange, &decompression );
+        }
+        PrintBandwidth( name, ( F64 )rawSize * COMPRESSION_PASS, TimeUtils::ClockTime() - start );
+
+        success = memcmp( raw.ConstPtr(), decompressed.ConstPtr(), rawSize ) == 0;
+        UNIT_TEST_MESSAGE( "decompression : %s\n", success ? "ok" : "erreur" );
+
+        JobSystem::Destroy();
+    }
+
+    FileSystem::Destroy();
+}
+
+void Test_BatchLoading()
+{
+    Char name[ 64 ];
+
+    UNIT_TEST_MESSAGE( "\n* Batch Loading Benchmark\n\n" );
+
+    FileSystem::Initialize( "../../.." );
+
+    SaveIOFiles();
+
+    U64 totalSize = 0;
+    for ( SizeT i=0; i<IO_FILE_COUNT; ++i )
+    {
+        totalSize += ioSizes[ i ];
+    }
+
+    UNIT_TEST_MESSAGE( "%d fichiers, %0.2f Mo\n", IO_FILE_COUNT, totalSize / ( 1024.0 * 1024.0 ) );
+
+    static PathString paths[ IO_FILE_COUNT ];
+    for ( SizeT i=0; i<IO_FILE_COUNT; ++i )
+    {
+        StringUtils::FormatString( name, sizeof(name), "io_test/%d.bin", i );
+        FileSystem::BuildPathName( name, paths[ i ], FileSystem::PT_CACHE );
+    }
+
+    // One file after the other
+    {
+        SizeT errorCount = 0;
+
+        EvictIOFiles( paths );
+
+        U64 start = TimeUtils::ClockTime();
+        for ( SizeT i=0; i<IO_FILE_COUNT; ++i )
+        {
+            void * buffer = 0;
+            SizeT size = 0;
+            if ( FileSystem::Load( paths[ i ], buffer, size ) )
+            {
+                errorCount += ( size != ioSizes[ i ] || *reinterpret_cast< const U32 * >( buffer ) != i ) ? 1 : 0;
+                UnknownAllocator::Deallocate( buffer );
+            }
+            else
+            {
+                ++errorCount;
+            }
+        }
+        PrintLoadTime( "Load", totalSize, TimeUtils::ClockTime() - start );
+
+        UNIT_TEST_MESSAGE( "erreurs : %d\n", errorCount );
+    }
+
+    // Batches of reads in flight together
+    static FileRead reads[ IO_FILE_COUNT ];
+    const SizeT batchCounts[] = { IO_BATCH_COUNT, IO_FILE_COUNT };
+
+    for ( SizeT b=0; b<sizeof(batchCounts) / sizeof(batchCounts[0]); ++b )
+    {
+        const SizeT batchCount = batchCounts[ b ];
+
+        ioReadCount     = 0;
+        ioErrorCount    = 0;
+
+        EvictIOFiles( paths );
+
+        U64 start = TimeUtils::ClockTime();
+        for ( SizeT first=0; first<IO_FILE_COUNT; first+=batchCount )
+        {
+            const SizeT count = ( IO_FILE_COUNT - first < batchCount ) ? IO_FILE_COUNT - first : batchCount;
+
+            SizeT readCount = 0;
+            for ( SizeT i=first; i<first+count; ++i )
+            {
+                FileRead& read = reads[ readCount ];
+                if ( ! FileSystem::Open( paths[ i ], read ) )
+                {
+                    ++ioErrorCount;
+                    continue;
+                }
+
+                read.m_buffer   = UnknownAllocator::Allocate( read.m_size );
+                read.m_userData = reinterpret_cast< void * >( i );
+                ++readCount;
+            }
+
+            FileSystem::ReadBatch( reads, readCount, CheckIORead );
+
+            for ( SizeT i=0; i<readCount; ++i )
+            {
+                UnknownAllocator::Deallocate( reads[ i ].m_buffer );
+            }
+        }
+
+        StringUtils::FormatString( name, sizeof( name ), "ReadBatch x%d", batchCount );
+        PrintLoadTime( name, totalSize, TimeUtils::ClockTime() - start );
+
+        UNIT_TEST_MESSAGE( "lectures : %d, erreurs : %d\n", ioReadCount, ioErrorCount );
+    }
+
+    // the next pack should not hold them
+    for ( SizeT i=0; i<IO_FILE_COUNT; ++i )
+    {
+        FileSystem::Delete( paths[ i ] );
+    }
+
+    FileSystem::Destroy();
+}
+
 void Level2()
 {
     UNIT_TEST_MESSAGE( "\n###########\n# LEVEL 2 #\n###########\n\n" );
@@ -177,4 +1316,13 @@ void Level2()
     screen_triangle[ 0 ] = Div( screen_triangle[ 0 ], homogeneous[ 0 ] );
     screen_triangle[ 1 ] = Div( screen_triangle[ 1 ], homogeneous[ 1 ] );
     screen_triangle[ 2 ] = Div( screen_triangle[ 2 ], homogeneous[ 2 ] );
+
+    Test_Transcendentals();
+    Test_BatchMath();
+    Test_BatchTransforms();
+    Test_FrustumCulling();
+    Test_Bvh();
+    Test_JobSystem();
+    Test_Compression();
+    Test_BatchLoading();
 }
@@ -2,6 +2,7 @@
 #include "UnitTest/Utils.h"
 
 #include "Core/FileSystem.h"
+#include "Core/Hash.h"
 
 #include "Graphic/RenderDevice.h"
 #include "Graphic/ProgramCache.h"
@@ -55,7 +56,7 @@ namespace Level3_NS
 
         void Initialize()
         {
-            U32 programId   = ProgramCache::CreateId( "level3" );
+            U32 programId   = HashedString( "level3" );
             m_program       = programCache.GetProgram( programId );
 
             m_geom.m_primitive = PT_TRIANGLES;
@@ -2,6 +2,7 @@
 #include "UnitTest/Utils.h"
 
 #include "Core/FileSystem.h"
+#include "Core/Hash.h"
 
 #include "Graphic/RenderDevice.h"
 #include "Graphic/ProgramCache.h"
@@ -114,7 +115,7 @@ namespace Level4_NS
 
         void Initialize()
         {
-            U32 programId   = ProgramCache::CreateId( "level4" );
+            U32 programId   = HashedString( "level4" );
             m_program       = programCache.GetProgram( programId );
 
             m_geom.m_primitive = PT_TRIANGLES;
@@ -2,6 +2,7 @@
 #include "UnitTest/Utils.h"
 
 #include "Core/FileSystem.h"
+#include "Core/Hash.h"
 #include "Core/ResourceManager.h"
 
 #include "Graphic/RenderDevice.h"
@@ -14,6 +15,9 @@
 #include "Core/Math.h"
 #include "Core/Matrix.h"
 #include "Core/Quaternion.h"
+#include "Core/BatchMath.h"
+#include "Core/Bvh.h"
+#include "Core/Frustum.h"
 
 #include "Core/TimeUtils.h"
 
@@ -90,6 +94,8 @@ namespace Level5_NS
     Handle lightParameters;
     Handle flashParameters;
 
+    Frustum cameraFrustum;
+
     struct CameraData
     {
         Matrix  viewProjMatrix;
@@ -137,7 +143,7 @@ namespace Level5_NS
 
         void Initialize()
         {
-            U32 programId       = ProgramCache::CreateId( "level5" );
+            U32 programId       = HashedString( "level5" );
             m_program           = programCache.GetProgram( programId );
             m_mesh              = ResourceManager::Create< MeshResource >( "level5.bmh" );
             m_uniformBuffers[0] = cameraParameters;
@@ -159,8 +165,17 @@ namespace Level5_NS
                 element.m_uniformBuffers[ element.m_uniformBufferCount ].m_index    = element.m_uniformBufferCount;
             }
 
-            for ( SizeT i=0; i<m_mesh->GetSubMeshCount(); ++i )
+            // the level is modelled in world space
+            const SizeT subMeshCount = m_mesh->GetSubMeshCount();
+
+            U32 visibility[ ( MeshResource::ms_maxSubMeshCount + 31 ) / 32 ];
+            CullBvh( m_mesh->GetBvh(), cameraFrustum, visibility );
+
+            for ( SizeT i=0; i<subMeshCount; ++i )
             {
+                if ( ! IsVisible( visibility, i ) )
+                    continue;
+
                 element.m_geometry = (RenderMesh*)MemoryManager::FrameAlloc( sizeof(RenderMesh), MemoryUtils::AlignOf< RenderMesh >() );
                 ::new( element.m_geometry ) RenderMesh( m_mesh.Ptr(), i );
 
@@ -194,7 +209,7 @@ namespace Level5_NS
 
         void Initialize()
         {
-            U32 programId       = ProgramCache::CreateId( "sphere" );
+            U32 programId       = HashedString( "sphere" );
             m_program           = programCache.GetProgram( programId );
             m_mesh              = ResourceManager::Create< MeshResource >( "sphere.bmh" );
 
@@ -220,9 +235,11 @@ namespace Level5_NS
 
             SphereParameters * params = static_cast< SphereParameters * >( RenderDevice::MapUniformBuffer( m_uniformBuffers[4], BA_WRITE_ONLY ) );
 
-            params->m_world = RMatrix( m_orientation );
-            Scale( params->m_world, m_scale );
-            params->m_world.m_column[3] = m_position;
+            Matrix world = RMatrix( m_orientation );
+            Scale( world, m_scale );
+            world.m_column[3] = m_position;
+
+            params->m_world = world;
 
             params->m_emissiveColor = emissive;
 
@@ -251,8 +268,20 @@ namespace Level5_NS
                 element.m_uniformBuffers[ element.m_uniformBufferCount ].m_index    = element.m_uniformBufferCount;
             }
 
-            for ( SizeT i=0; i<m_mesh->GetSubMeshCount(); ++i )
+            const SizeT subMeshCount = m_mesh->GetSubMeshCount();
+
+            F32 boundsData[ 6 ][ MeshResource::ms_maxSubMeshCount ];
+            SoaBoxes bounds = { { boundsData[0], boundsData[1], boundsData[2] }, { boundsData[3], boundsData[4], boundsData[5] } };
+            BatchMath::TransformBoxes( world, m_mesh->GetSubMeshBounds(), bounds, subMeshCount );
+
+            U32 visibility[ ( MeshResource::ms_maxSubMeshCount + 31 ) / 32 ];
+            BatchMath::CullBoxes( cameraFrustum, bounds, visibility, subMeshCount );
+
+            for ( SizeT i=0; i<subMeshCount; ++i )
             {
+                if ( ! IsVisible( visibility, i ) )
+                    continue;
+
                 element.m_geometry = (RenderMesh*)MemoryManager::FrameAlloc( sizeof(RenderMesh), MemoryUtils::AlignOf< RenderMesh >() );
                 ::new( element.m_geometry ) RenderMesh( m_mesh.Ptr(), i );
 
@@ -559,9 +588,12 @@ namespace Level5_NS
         proj.m_column[2] = Vector4( 0.0f    , 0.0f                  , ( f + n ) / ( n - f )         , -1.0f );
         proj.m_column[3] = Vector4( 0.0f    , 0.0f                  , ( 2.0f * n * f ) / ( n - f )  , 0.0f  );
 
+        Matrix viewProj = Mul( proj, view );
+        cameraFrustum   = ExtractFrustum( viewProj );
+
         CameraData  * cam = static_cast< CameraData * >( RenderDevice::MapUniformBuffer( cameraParameters, BA_WRITE_ONLY ) );
 
-        cam->viewProjMatrix = Mul( proj, view );
+        cam->viewProjMatrix = viewProj;
         cam->position       = cam_base.m_column[3];
 
         RenderDevice::UnmapUniformBuffer( );
@@ -10,6 +10,9 @@
 #include "Core/Math.h"
 #include "Core/Matrix.h"
 #include "Core/Quaternion.h"
+#include "Core/BatchMath.h"
+#include "Core/Bvh.h"
+#include "Core/Frustum.h"
 
 #include "Core/TimeUtils.h"
 
@@ -63,6 +66,8 @@ namespace Level6_NS
     Handle lightParameters;
     Handle flashParameters;
 
+    Frustum cameraFrustum;
+
     struct CameraData
     {
         Matrix  viewProjMatrix;
@@ -129,8 +134,17 @@ namespace Level6_NS
                 element.m_uniformBuffers[ element.m_uniformBufferCount ].m_index    = element.m_uniformBufferCount;
             }
 
-            for ( SizeT i=0; i<m_mesh->GetSubMeshCount(); ++i )
+            // the level is modelled in world space
+            const SizeT subMeshCount = m_mesh->GetSubMeshCount();
+
+            U32 visibility[ ( MeshResource::ms_maxSubMeshCount + 31 ) / 32 ];
+            CullBvh( m_mesh->GetBvh(), cameraFrustum, visibility );
+
+            for ( SizeT i=0; i<subMeshCount; ++i )
             {
+                if ( ! IsVisible( visibility, i ) )
+                    continue;
+
                 const MaterialResource * material = m_mesh->GetSubMeshes()[i].m_material.ConstPtr();
                 element.m_program = material->GetProgram();
                 for ( element.m_textureCount = 0; element.m_textureCount<material->GetTextureCount(); ++element.m_textureCount )
@@ -202,9 +216,11 @@ namespace Level6_NS
 
             SphereParameters * params = static_cast< SphereParameters * >( RenderDevice::MapUniformBuffer( m_uniformBuffers[4], BA_WRITE_ONLY ) );
 
-            params->m_world = RMatrix( m_orientation );
-            Scale( params->m_world, m_scale );
-            params->m_world.m_column[3] = m_position;
+            Matrix world = RMatrix( m_orientation );
+            Scale( world, m_scale );
+            world.m_column[3] = m_position;
+
+            params->m_world = world;
 
             params->m_emissiveColor = emissive;
 
@@ -231,8 +247,19 @@ namespace Level6_NS
                 element.m_uniformBuffers[ element.m_uniformBufferCount ].m_index    = element.m_uniformBufferCount;
             }
 
-            for ( SizeT i=0; i<m_mesh->GetSubMeshCount(); ++i )
+            const SizeT subMeshCount = m_mesh->GetSubMeshCount();
+
+            F32 boundsData[ 6 ][ MeshResource::ms_maxSubMeshCount ];
+            SoaBoxes bounds = { { boundsData[0], boundsData[1], boundsData[2] }, { boundsData[3], boundsData[4], boundsData[5] } };
+            BatchMath::TransformBoxes( world, m_mesh->GetSubMeshBounds(), bounds, subMeshCount );
+
+            U32 visibility[ ( MeshResource::ms_maxSubMeshCount + 31 ) / 32 ];
+            BatchMath::CullBoxes( cameraFrustum, bounds, visibility, subMeshCount );
+
+            for ( SizeT i=0; i<subMeshCount; ++i )
             {
+                if ( ! IsVisible( visibility, i ) )
+                    continue;
 
                 element.m_program = m_mesh->GetSubMeshes()[i].m_material->GetProgram();
                 element.m_geometry = (RenderMesh*)MemoryManager::FrameAlloc( sizeof(RenderMesh), MemoryUtils::AlignOf< RenderMesh >() );
@@ -405,9 +432,12 @@ namespace Level6_NS
         proj.m_column[2] = Vector4( 0.0f    , 0.0f                  , ( f + n ) / ( n - f )         , -1.0f );
         proj.m_column[3] = Vector4( 0.0f    , 0.0f                  , ( 2.0f * n * f ) / ( n - f )  , 0.0f  );
 
+        Matrix viewProj = Mul( proj, view );
+        cameraFrustum   = ExtractFrustum( viewProj );
+
         CameraData  * cam = static_cast< CameraData * >( RenderDevice::MapUniformBuffer( cameraParameters, BA_WRITE_ONLY ) );
 
-        cam->viewProjMatrix = Mul( proj, view );
+        cam->viewProjMatrix = viewProj;
         cam->position       = cam_base.m_column[3];
 
         RenderDevice::UnmapUniformBuffer( );
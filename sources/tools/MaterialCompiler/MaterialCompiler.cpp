@@ -108,15 +108,14 @@ bool FindFiles( const char * searchStr, std::vector< std::string >& fileNames, b
 
 unsigned int HashString( const char * str )
 {
-    // FNV hash
-    // http://eternallyconfuzzled.com/tuts/algorithms/jsw_tut_hashing.aspx
-    // Thx !
+    // FNV-1a hash, must match Core::HashString
+    // http://www.isthe.com/chongo/tech/comp/fnv/
     //
     unsigned int h = 2166136261;
 
-    while ( *(str++) != 0 ) // be sure that the string ends by '\0'
+    for ( ; *str != 0; ++str ) // be sure that the string ends by '\0'
     {
-        h = ( h * 16777619 ) ^ *str;
+        h = ( h ^ (unsigned char)*str ) * 16777619;
     }
     return h;
 };
@@ -7,8 +7,10 @@
 
 #include <vector>
 #include <map>
+#include <algorithm>
 
 #include <cassert>
+#include <cfloat>
 
 #if defined( CARBON_PLATFORM_WIN32 )
 #include <Windows.h>
@@ -71,15 +73,14 @@ bool BuildDirectory( const char * path )
 
 unsigned int HashString( const char * str )
 {
-    // FNV hash
-    // http://eternallyconfuzzled.com/tuts/algorithms/jsw_tut_hashing.aspx
-    // Thx !
+    // FNV-1a hash, must match Core::HashString
+    // http://www.isthe.com/chongo/tech/comp/fnv/
     //
     unsigned int h = 2166136261;
 
-    while ( *(str++) != 0 ) // be sure that the string ends by '\0'
+    for ( ; *str != 0; ++str ) // be sure that the string ends by '\0'
     {
-        h = ( h * 16777619 ) ^ *str;
+        h = ( h ^ (unsigned char)*str ) * 16777619;
     }
     return h;
 };
@@ -1259,6 +1260,157 @@ void BuildTangentSpace( float * tangents,
     }
 }
 
+void ComputeBounds( float * bounds_min,
+                    float * bounds_max,
+                    const float * vertices,
+                    size_t stride,
+                    const size_t * indices,
+                    size_t index_count,
+                    size_t pos_offset )
+{
+    for ( size_t j=0; j<3; ++j )
+    {
+        bounds_min[ j ] = FLT_MAX;
+        bounds_max[ j ] = -FLT_MAX;
+    }
+
+    for ( size_t i=0; i<index_count; ++i )
+    {
+        const float * p = vertices + indices[ i ] * stride + pos_offset;
+        for ( size_t j=0; j<3; ++j )
+        {
+            if ( p[ j ] < bounds_min[ j ] )
+                bounds_min[ j ] = p[ j ];
+            if ( p[ j ] > bounds_max[ j ] )
+                bounds_max[ j ] = p[ j ];
+        }
+    }
+}
+
+struct BvhNode
+{
+    float           min[3];
+    float           max[3];
+    unsigned int    offset;     // right child of inner nodes, first item of leaves
+    unsigned int    count;      // 0 for inner nodes
+};
+
+const size_t bvhMaxLeafSize = 4;
+
+float BoxArea( const float * min, const float * max )
+{
+    float dx = max[0] - min[0];
+    float dy = max[1] - min[1];
+    float dz = max[2] - min[2];
+
+    return dx * dy + dy * dz + dz * dx;
+}
+
+void ResetBox( float * min, float * max )
+{
+    for ( size_t j=0; j<3; ++j )
+    {
+        min[ j ] = FLT_MAX;
+        max[ j ] = -FLT_MAX;
+    }
+}
+
+// box is min[3] followed by max[3]
+void GrowBox( float * min, float * max, const float * box )
+{
+    for ( size_t j=0; j<3; ++j )
+    {
+        if ( box[ j ] < min[ j ] )
+            min[ j ] = box[ j ];
+        if ( box[ 3 + j ] > max[ j ] )
+            max[ j ] = box[ 3 + j ];
+    }
+}
+
+struct CentroidLess
+{
+    CentroidLess( const std::vector< float >& bounds, int axis ) : bounds( bounds ), axis( axis ) {}
+
+    bool operator()( unsigned int l, unsigned int r ) const
+    {
+        return bounds[ 6 * l + axis ] + bounds[ 6 * l + 3 + axis ] < bounds[ 6 * r + axis ] + bounds[ 6 * r + 3 + axis ];
+    }
+
+    const std::vector< float >& bounds;
+    int                         axis;
+};
+
+// Top down build, each node is split where the surface area heuristic is the lowest along
+// the items sorted by centroid. Nodes are stored depth first, the left child follows its
+// parent.
+void BuildBvh( std::vector< BvhNode >& nodes, std::vector< unsigned int >& items, const std::vector< float >& bounds, size_t begin, size_t end )
+{
+    size_t index = nodes.size();
+    nodes.push_back( BvhNode() );
+
+    BvhNode node;
+    ResetBox( node.min, node.max );
+    for ( size_t i=begin; i<end; ++i )
+        GrowBox( node.min, node.max, &bounds[ 6 * items[ i ] ] );
+
+    size_t count        = end - begin;
+    float area          = BoxArea( node.min, node.max );
+    float leaf_cost     = area * count;
+    float split_cost    = FLT_MAX;
+    int split_axis      = -1;
+    size_t split        = 0;
+
+    if ( count > 1 )
+    {
+        std::vector< float > right_area( count );
+        float min[3], max[3];
+
+        for ( int axis=0; axis<3; ++axis )
+        {
+            std::sort( items.begin() + begin, items.begin() + end, CentroidLess( bounds, axis ) );
+
+            ResetBox( min, max );
+            for ( size_t i=count-1; i>0; --i )
+            {
+                GrowBox( min, max, &bounds[ 6 * items[ begin + i ] ] );
+                right_area[ i ] = BoxArea( min, max );
+            }
+
+            // one traversal step costs the parent area
+            ResetBox( min, max );
+            for ( size_t i=1; i<count; ++i )
+            {
+                GrowBox( min, max, &bounds[ 6 * items[ begin + i - 1 ] ] );
+
+                float cost = area + BoxArea( min, max ) * i + right_area[ i ] * ( count - i );
+                if ( cost < split_cost )
+                {
+                    split_cost  = cost;
+                    split_axis  = axis;
+                    split       = i;
+                }
+            }
+        }
+    }
+
+    if ( split_axis == -1 || ( count <= bvhMaxLeafSize && leaf_cost <= split_cost ) )
+    {
+        node.offset = begin;
+        node.count  = count;
+    }
+    else
+    {
+        std::sort( items.begin() + begin, items.begin() + end, CentroidLess( bounds, split_axis ) );
+
+        BuildBvh( nodes, items, bounds, begin, begin + split );
+        node.offset = nodes.size();
+        node.count  = 0;
+        BuildBvh( nodes, items, bounds, begin + split, end );
+    }
+
+    nodes[ index ] = node;
+}
+
 bool BuildMesh(  const char * outFilename , int options )
 {
     MeshHeader header;
@@ -1465,6 +1617,32 @@ bool BuildMesh(  const char * outFilename , int options )
         }
     }
 
+    // Sub mesh bounds, for culling
+    size_t pos_offset = 0;
+    size_t pos_input = 0;
+    for ( ; pos_input<semantic_layout.size() && semantic_layout[ pos_input ] != POSITION; ++pos_input )
+        pos_offset += sources[ source_layout[ pos_input ] ].stride;
+
+    if ( pos_input == semantic_layout.size() )
+        return false;
+
+    std::vector< float > bounds( 6 * sub_meshes.size() );
+    size_t index_start = 0;
+    for ( size_t i=0; i<sub_meshes.size(); ++i )
+    {
+        ComputeBounds( &bounds[ 6 * i ], &bounds[ 6 * i + 3 ], vertex_cache.data(), vertex_stride, indices.data() + index_start, sub_meshes[ i ], pos_offset );
+        index_start += sub_meshes[ i ];
+    }
+
+    // Hierarchy over the sub meshes
+    std::vector< BvhNode > bvh_nodes;
+    std::vector< unsigned int > bvh_items( sub_meshes.size() );
+    for ( size_t i=0; i<sub_meshes.size(); ++i )
+        bvh_items[ i ] = i;
+
+    if ( ! sub_meshes.empty() )
+        BuildBvh( bvh_nodes, bvh_items, bounds, 0, sub_meshes.size() );
+
     // Build input layout
     size_t vertex_size = 0;
     std::vector< MeshInput > input_layout;
@@ -1561,10 +1739,17 @@ bool BuildMesh(  const char * outFilename , int options )
         unsigned int material   = materials[ i ];
 
         fwrite(&material,1,sizeof(unsigned int),fp);
+        fwrite(&bounds[ 6 * i ],1,6*sizeof(float),fp);
 
         index_end += size;
     }
 
+    unsigned int node_count = bvh_nodes.size();
+
+    fwrite(&node_count,1,sizeof(unsigned int),fp);
+    fwrite(bvh_nodes.data(),1,sizeof(BvhNode)*node_count,fp);
+    fwrite(bvh_items.data(),1,sizeof(unsigned int)*bvh_items.size(),fp);
+
     fclose(fp);
 
     free( index_data );
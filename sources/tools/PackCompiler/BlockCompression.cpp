@@ -0,0 +1,158 @@
+#include "BlockCompression.h"
+
+#include <cstring>
+
+// Must match Core/Compression.h
+struct CompressedHeader
+{
+    unsigned int magic;
+    unsigned int blockSize;
+    unsigned int blockCount;
+    unsigned int rawSize;
+};
+
+const unsigned int compressedMagic  = 0x4b4c4243;   // "CBLK"
+const size_t blockSize              = 64 * 1024;
+
+const size_t minMatch               = 4;
+const size_t lastLiterals           = 5;
+const size_t matchLimit             = 12;
+const size_t hashLog                = 12;
+
+unsigned int Read32( const unsigned char * ptr )
+{
+    unsigned int value;
+    memcpy( &value, ptr, sizeof(value) );
+    return value;
+}
+
+unsigned char * WriteLength( unsigned char * out, size_t length )
+{
+    for ( ; length >= 255; length -= 255 )
+    {
+        *out++ = 255;
+    }
+    *out++ = (unsigned char)length;
+    return out;
+}
+
+unsigned char * WriteSequence( unsigned char * out, const unsigned char * literals, size_t literalCount, size_t offset, size_t matchLength )
+{
+    unsigned char * token = out++;
+
+    *token = (unsigned char)( ( ( literalCount < 15 ) ? literalCount : 15 ) << 4 );
+    if ( literalCount >= 15 )
+    {
+        out = WriteLength( out, literalCount - 15 );
+    }
+
+    memcpy( out, literals, literalCount );
+    out += literalCount;
+
+    if ( matchLength )
+    {
+        *out++ = (unsigned char)offset;
+        *out++ = (unsigned char)( offset >> 8 );
+
+        const size_t length = matchLength - minMatch;
+        *token |= (unsigned char)( ( length < 15 ) ? length : 15 );
+        if ( length >= 15 )
+        {
+            out = WriteLength( out, length - 15 );
+        }
+    }
+
+    return out;
+}
+
+// LZ4 block format, same greedy parsing as Core::Compression::CompressBlock
+size_t CompressBlock( const unsigned char * in, size_t size, unsigned char * dest )
+{
+    unsigned char * out = dest;
+    const unsigned char * anchor = in;
+
+    if ( size > matchLimit )
+    {
+        unsigned short table[ 1 << hashLog ];
+        memset( table, 0, sizeof(table) );
+
+        const unsigned char * ip    = in + 1;
+        const unsigned char * limit = in + size - matchLimit;
+        const unsigned char * end   = in + size - lastLiterals;
+
+        while ( ip < limit )
+        {
+            const unsigned int sequence = Read32( ip );
+            const unsigned int hash     = ( sequence * 2654435761u ) >> ( 32 - hashLog );
+            const unsigned char * ref   = in + table[ hash ];
+            table[ hash ]               = (unsigned short)( ip - in );
+
+            if ( Read32( ref ) != sequence )
+            {
+                ++ip;
+                continue;
+            }
+
+            const size_t offset = ip - ref;
+
+            const unsigned char * matchEnd = ip + minMatch;
+            for ( ref += minMatch; matchEnd < end && *matchEnd == *ref; ++ref )
+            {
+                ++matchEnd;
+            }
+
+            out = WriteSequence( out, anchor, ip - anchor, offset, matchEnd - ip );
+
+            ip      = matchEnd;
+            anchor  = ip;
+        }
+    }
+
+    out = WriteSequence( out, anchor, in + size - anchor, 0, 0 );
+
+    return out - dest;
+}
+
+void CompressBlocks( const char * src, size_t size, std::vector< char >& dest )
+{
+    const size_t blockCount = ( size + blockSize - 1 ) / blockSize;
+    const size_t tableSize  = sizeof(CompressedHeader) + blockCount * sizeof(unsigned int);
+
+    dest.resize( tableSize + size );
+
+    CompressedHeader header;
+    header.magic        = compressedMagic;
+    header.blockSize    = (unsigned int)blockSize;
+    header.blockCount   = (unsigned int)blockCount;
+    header.rawSize      = (unsigned int)size;
+    memcpy( &dest[0], &header, sizeof(header) );
+
+    std::vector< unsigned char > scratch( blockSize + blockSize / 255 + 16 );
+
+    const unsigned char * in = (const unsigned char *)src;
+    size_t end = 0;     // from the first block
+
+    for ( size_t b=0; b<blockCount; ++b )
+    {
+        const size_t offset     = b * blockSize;
+        const size_t rawSize    = ( size - offset < blockSize ) ? size - offset : blockSize;
+
+        // a block that does not shrink is stored raw
+        const size_t packedSize = CompressBlock( in + offset, rawSize, &scratch[0] );
+        if ( packedSize < rawSize )
+        {
+            memcpy( &dest[ tableSize + end ], &scratch[0], packedSize );
+            end += packedSize;
+        }
+        else
+        {
+            memcpy( &dest[ tableSize + end ], in + offset, rawSize );
+            end += rawSize;
+        }
+
+        const unsigned int blockEnd = (unsigned int)end;
+        memcpy( &dest[ sizeof(CompressedHeader) + b * sizeof(unsigned int) ], &blockEnd, sizeof(blockEnd) );
+    }
+
+    dest.resize( tableSize + end );
+}
@@ -0,0 +1,11 @@
+#pragma once
+#ifndef _PACKCOMPILER_BLOCKCOMPRESSION_H
+#define _PACKCOMPILER_BLOCKCOMPRESSION_H
+
+#include <vector>
+
+// Compresses size bytes of src in the block format of Core::Compression, dest is resized
+// to the compressed file
+void CompressBlocks( const char * src, size_t size, std::vector< char >& dest );
+
+#endif // _PACKCOMPILER_BLOCKCOMPRESSION_H
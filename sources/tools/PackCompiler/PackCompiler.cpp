@@ -0,0 +1,269 @@
+#include "PackCompiler/PackCompiler.h"
+#include "PackCompiler/BlockCompression.h"
+
+#include <vector>
+#include <string>
+
+#include <cstdio>
+#include <cstring>
+
+#if defined( CARBON_PLATFORM_WIN32 )
+#include <Windows.h>
+#endif
+
+// Must match Core/Pack.h
+struct PackHeader
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int fileCount;
+    unsigned int slotCount;
+};
+
+struct PackEntry
+{
+    unsigned int        id;
+    unsigned int        size;
+    unsigned long long  offset;
+};
+
+const unsigned int packMagic        = 0x4b434150;   // "PACK"
+const unsigned int packVersion      = 1;
+const unsigned int packAlignment    = 16;
+
+// Program binaries depend on the driver, they are rebuilt at runtime
+const char * excludedDirs[] = { "shaders" };
+
+struct PackedFile
+{
+    std::string     name;       // relative to the packed directory, '/' separators
+    std::string     path;
+    unsigned int    id;
+    unsigned int    size;
+    std::vector< char > data;  // as packed, compressed or not
+};
+
+unsigned int HashString( const char * str )
+{
+    // FNV-1a hash, must match Core::HashString
+    // http://www.isthe.com/chongo/tech/comp/fnv/
+    //
+    unsigned int h = 2166136261;
+
+    for ( ; *str != 0; ++str ) // be sure that the string ends by '\0'
+    {
+        h = ( h ^ (unsigned char)*str ) * 16777619;
+    }
+    return h;
+};
+
+unsigned long long AlignOffset( unsigned long long offset )
+{
+    return ( offset + packAlignment - 1 ) & ~(unsigned long long)( packAlignment - 1 );
+}
+
+bool IsExcluded( const std::string& name )
+{
+    for ( size_t i=0; i<sizeof(excludedDirs) / sizeof(excludedDirs[0]); ++i )
+    {
+        if ( name == excludedDirs[i] )
+            return true;
+    }
+    return false;
+}
+
+bool FindFilesRecursive( const std::string& dir, const std::string& relativeDir, std::vector< PackedFile >& files )
+{
+#if defined( CARBON_PLATFORM_WIN32 )
+    WIN32_FIND_DATA ffd;
+    HANDLE hFind;
+
+    std::string searchStr = dir + "/*";
+
+    hFind = FindFirstFile( searchStr.c_str(), &ffd );
+    if ( hFind == INVALID_HANDLE_VALUE )
+    {
+        return false;
+    }
+
+    do
+    {
+        std::string name = relativeDir.empty() ? ffd.cFileName : relativeDir + "/" + ffd.cFileName;
+
+        if ( ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+        {
+            if ( strcmp( ffd.cFileName, "." ) == 0 || strcmp( ffd.cFileName, ".." ) == 0 || IsExcluded( name ) )
+                continue;
+
+            if ( ! FindFilesRecursive( dir + "/" + ffd.cFileName, name, files ) )
+            {
+                FindClose( hFind );
+                return false;
+            }
+        }
+        else
+        {
+            PackedFile file;
+            file.name   = name;
+            file.path   = dir + "/" + ffd.cFileName;
+            file.id     = HashString( name.c_str() );
+            file.size   = ffd.nFileSizeLow;
+            files.push_back( file );
+        }
+    }
+    while ( FindNextFile( hFind, &ffd ) != 0 );
+
+    FindClose( hFind );
+#endif
+    return true;
+}
+
+bool WritePadding( FILE * fp, unsigned long long from, unsigned long long to )
+{
+    static const char zeros[ packAlignment ] = { 0 };
+    return fwrite( zeros, 1, (size_t)( to - from ), fp ) == to - from;
+}
+
+bool ReadPackedFile( PackedFile& file, bool compress )
+{
+    FILE * in;
+    if ( fopen_s( &in, file.path.c_str(), "rb" ) )
+    {
+        return false;
+    }
+
+    std::vector< char > buffer( file.size + 1 );
+    size_t read = fread( &buffer[0], 1, file.size, in );
+    fclose( in );
+
+    if ( read != file.size )
+    {
+        return false;
+    }
+
+    // kept compressed only when it saves space
+    if ( compress && file.size > 0 )
+    {
+        CompressBlocks( &buffer[0], file.size, file.data );
+        if ( file.data.size() < file.size )
+        {
+            file.size = (unsigned int)file.data.size();
+            return true;
+        }
+    }
+
+    buffer.resize( file.size );
+    file.data.swap( buffer );
+    return true;
+}
+
+bool CompilePack( const char * dir, bool compress )
+{
+    char inDir[ 256 ];
+    sprintf( inDir, "%s/cache", dir );
+
+    std::vector< PackedFile > files;
+    if ( ! FindFilesRecursive( inDir, "", files ) )
+    {
+        printf( "Cannot read the directory %s\n", inDir );
+        return false;
+    }
+
+    unsigned long long rawSize = 0;
+    unsigned long long packedSize = 0;
+
+    for ( size_t i=0; i<files.size(); ++i )
+    {
+        PackedFile& file = files[i];
+
+        rawSize += file.size;
+        if ( ! ReadPackedFile( file, compress ) )
+        {
+            printf( "Cannot read the file %s\n", file.path.c_str() );
+            return false;
+        }
+        packedSize += file.size;
+    }
+
+    // Hash table at most half full, so lookups stop after a few probes
+    unsigned int slotCount = 16;
+    while ( slotCount < 2 * files.size() )
+    {
+        slotCount *= 2;
+    }
+
+    std::vector< PackEntry > entries( slotCount );
+    memset( &entries[0], 0, slotCount * sizeof(PackEntry) );
+
+    unsigned long long offset = AlignOffset( sizeof(PackHeader) + slotCount * sizeof(PackEntry) );
+
+    for ( size_t i=0; i<files.size(); ++i )
+    {
+        const PackedFile& file = files[i];
+
+        unsigned int slot = file.id & ( slotCount - 1 );
+        for ( ; entries[ slot ].offset != 0; slot = ( slot + 1 ) & ( slotCount - 1 ) )
+        {
+            if ( entries[ slot ].id == file.id )
+            {
+                printf( "Hash collision : %s and another file give 0x%08x\n", file.name.c_str(), file.id );
+                return false;
+            }
+        }
+
+        entries[ slot ].id      = file.id;
+        entries[ slot ].size    = file.size;
+        entries[ slot ].offset  = offset;
+
+        offset = AlignOffset( offset + file.size );
+    }
+
+    char filename[ 256 ];
+    sprintf( filename, "%s/cache.pak", dir );
+
+    FILE * fp;
+    if ( fopen_s( &fp, filename, "wb" ) )
+    {
+        printf( "Cannot write the file %s\n", filename );
+        return false;
+    }
+
+    PackHeader header;
+    header.magic        = packMagic;
+    header.version      = packVersion;
+    header.fileCount    = (unsigned int)files.size();
+    header.slotCount    = slotCount;
+
+    fwrite( &header, 1, sizeof(PackHeader), fp );
+    fwrite( &entries[0], 1, slotCount * sizeof(PackEntry), fp );
+
+    offset = sizeof(PackHeader) + slotCount * sizeof(PackEntry);
+
+    // Same order as the offsets given above
+    for ( size_t i=0; i<files.size(); ++i )
+    {
+        const PackedFile& file = files[i];
+
+        unsigned long long start = AlignOffset( offset );
+        WritePadding( fp, offset, start );
+
+        if ( file.size > 0 && fwrite( &file.data[0], 1, file.size, fp ) != file.size )
+        {
+            printf( "Cannot pack the file %s\n", file.path.c_str() );
+            fclose( fp );
+            return false;
+        }
+
+        offset = start + file.size;
+    }
+
+    fclose( fp );
+
+    printf( "%d files packed in %s\n", (int)files.size(), filename );
+    if ( compress && packedSize > 0 )
+    {
+        printf( "%llu bytes compressed to %llu, ratio %.2f\n", rawSize, packedSize, (double)rawSize / packedSize );
+    }
+
+    return true;
+}
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef _PACKCOMPILER_PACKCOMPILER_H
+#define _PACKCOMPILER_PACKCOMPILER_H
+
+bool CompilePack( const char * dir, bool compress );
+
+#endif // _PACKCOMPILER_PACKCOMPILER_H
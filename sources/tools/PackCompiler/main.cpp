@@ -0,0 +1,36 @@
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#include "PackCompiler/PackCompiler.h"
+
+int main( int argc, char* argv[] )
+{
+    if ( argc < 2 || argc > 3 )
+        goto exit;
+
+    char * root = argv[--argc];
+
+    bool compress = false;
+    if ( argc > 1 )
+    {
+        if ( strcmp( argv[--argc], "-cmp" ) == 0 )
+            compress = true;
+        else
+            goto exit;
+    }
+
+    if ( ! CompilePack( root, compress ) )
+    {
+        printf( "COMPILATION FAILED !\n" );
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+
+exit :
+    printf( "usage: PackCompiler [-cmp] <root>\n\n" );
+    printf( "    cmp     compress the files in blocks                                   ( optional )\n" );
+    printf( "    root    root directory, <root>/cache is packed in <root>/cache.pak    ( required )\n" );
+    return 0;
+}